@@ -5,11 +5,6 @@
 #define RENDER_GRAPH_CAMERA_SET 1
 #include <shaders/render_graph/common/Groups.h>
 
-layout(push_constant) uniform Node
-{
-	mat4 transform;
-} node;
-
 // Input
 layout(location = 0) in vec3 in_position;
 layout(location = 1) in vec2 in_uv;
@@ -18,6 +13,9 @@ layout(location = 3) in vec3 in_binormal;
 layout(location = 4) in vec3 in_normal;
 layout(location = 5) in vec3 in_color;
 
+// Instance input
+layout(location = 6) in mat4 in_transform;
+
 // Output
 layout(location = 0) out vec2 out_uv;
 layout(location = 1) out vec3 out_tangent_vs;
@@ -29,8 +27,8 @@ layout(location = 5) out vec4 out_position_old_ndc;
 //
 void main()
 {
-	mat4 modelview = camera.view * node.transform;
-	mat4 modelview_old = camera.view_old * node.transform; // TODO: old node transform
+	mat4 modelview = camera.view * in_transform;
+	mat4 modelview_old = camera.view_old * in_transform; // TODO: old node transform
 
 	out_uv = in_uv;
 	out_tangent_vs = vec3(modelview * vec4(in_tangent.xyz, 0.0f));
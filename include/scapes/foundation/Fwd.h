@@ -14,6 +14,9 @@ namespace scapes::foundation
 	{
 		struct EntityID;
 		struct QueryID;
+		struct SnapshotComponent;
+
+		class SnapshotEntityMap;
 
 		class World;
 		class Entity;
@@ -30,6 +33,14 @@ namespace scapes::foundation
 		class Stream;
 	}
 
+	namespace jobs
+	{
+		enum class JobAffinity : uint8_t;
+
+		struct JobCounter;
+		class JobSystem;
+	}
+
 	namespace json = rapidjson;
 	namespace math = glm;
 
@@ -0,0 +1,166 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace scapes::foundation::hash
+{
+	/* wyhash (final version 4), written as constexpr so literal names can be hashed at compile time.
+	 * Reads are byte-wise little-endian, optimizing compilers fold them into plain loads
+	 */
+	namespace detail
+	{
+		static constexpr uint64_t secret[4] =
+		{
+			0x2d358dccaa6c78a5ull,
+			0x8bb84b93962eacc9ull,
+			0x4b33a62ed433d4a3ull,
+			0x4d5a2da51de1aa47ull,
+		};
+
+		constexpr void mum(uint64_t &a, uint64_t &b)
+		{
+#if defined(__SIZEOF_INT128__)
+			__uint128_t r = static_cast<__uint128_t>(a) * b;
+			a = static_cast<uint64_t>(r);
+			b = static_cast<uint64_t>(r >> 64);
+#else
+			uint64_t ha = a >> 32;
+			uint64_t hb = b >> 32;
+			uint64_t la = static_cast<uint32_t>(a);
+			uint64_t lb = static_cast<uint32_t>(b);
+
+			uint64_t rh = ha * hb;
+			uint64_t rm0 = ha * lb;
+			uint64_t rm1 = hb * la;
+			uint64_t rl = la * lb;
+
+			uint64_t t = rl + (rm0 << 32);
+			uint64_t c = (t < rl) ? 1 : 0;
+
+			uint64_t lo = t + (rm1 << 32);
+			c += (lo < t) ? 1 : 0;
+
+			uint64_t hi = rh + (rm0 >> 32) + (rm1 >> 32) + c;
+
+			a = lo;
+			b = hi;
+#endif
+		}
+
+		constexpr uint64_t mix(uint64_t a, uint64_t b)
+		{
+			mum(a, b);
+			return a ^ b;
+		}
+
+		constexpr uint64_t byte(const char *p, size_t i)
+		{
+			return static_cast<uint64_t>(static_cast<uint8_t>(p[i]));
+		}
+
+		constexpr uint64_t read4(const char *p)
+		{
+			return byte(p, 0) | (byte(p, 1) << 8) | (byte(p, 2) << 16) | (byte(p, 3) << 24);
+		}
+
+		constexpr uint64_t read8(const char *p)
+		{
+			return read4(p) | (read4(p + 4) << 32);
+		}
+
+		constexpr uint64_t read3(const char *p, size_t k)
+		{
+			return (byte(p, 0) << 16) | (byte(p, k >> 1) << 8) | byte(p, k - 1);
+		}
+	}
+
+	constexpr uint64_t compute(const char *data, size_t size, uint64_t seed = 0)
+	{
+		const char *p = data;
+		seed ^= detail::mix(seed ^ detail::secret[0], detail::secret[1]);
+
+		uint64_t a = 0;
+		uint64_t b = 0;
+
+		if (size <= 16)
+		{
+			if (size >= 4)
+			{
+				size_t offset = (size >> 3) << 2;
+				a = (detail::read4(p) << 32) | detail::read4(p + offset);
+				b = (detail::read4(p + size - 4) << 32) | detail::read4(p + size - 4 - offset);
+			}
+			else if (size > 0)
+				a = detail::read3(p, size);
+		}
+		else
+		{
+			size_t i = size;
+			if (i > 48)
+			{
+				uint64_t see1 = seed;
+				uint64_t see2 = seed;
+
+				do
+				{
+					seed = detail::mix(detail::read8(p) ^ detail::secret[1], detail::read8(p + 8) ^ seed);
+					see1 = detail::mix(detail::read8(p + 16) ^ detail::secret[2], detail::read8(p + 24) ^ see1);
+					see2 = detail::mix(detail::read8(p + 32) ^ detail::secret[3], detail::read8(p + 40) ^ see2);
+					p += 48;
+					i -= 48;
+				}
+				while (i > 48);
+
+				seed ^= see1 ^ see2;
+			}
+
+			while (i > 16)
+			{
+				seed = detail::mix(detail::read8(p) ^ detail::secret[1], detail::read8(p + 8) ^ seed);
+				i -= 16;
+				p += 16;
+			}
+
+			a = detail::read8(p + i - 16);
+			b = detail::read8(p + i - 8);
+		}
+
+		a ^= detail::secret[1];
+		b ^= seed;
+		detail::mum(a, b);
+
+		return detail::mix(a ^ detail::secret[0] ^ size, b ^ detail::secret[1]);
+	}
+
+	constexpr uint64_t compute(std::string_view str, uint64_t seed = 0)
+	{
+		return compute(str.data(), str.size(), seed);
+	}
+
+	// order-dependent, combine(combine(a, b), c) is the usual way to build composite keys
+	constexpr uint64_t combine(uint64_t a, uint64_t b)
+	{
+		return detail::mix(a ^ detail::secret[0], b ^ detail::secret[1]);
+	}
+}
+
+namespace scapes::foundation
+{
+	/* Precomputed name hash, pass a constexpr instance to skip hashing on lookups:
+	 *   static constexpr StringID camera = "Camera";
+	 */
+	struct StringID
+	{
+		uint64_t value {0};
+
+		constexpr StringID() = default;
+		constexpr StringID(const char *str) : value(hash::compute(std::string_view(str))) { }
+		constexpr StringID(std::string_view str) : value(hash::compute(str)) { }
+		constexpr explicit StringID(uint64_t id) : value(id) { }
+
+		constexpr bool operator==(const StringID &id) const { return value == id.value; }
+		constexpr bool operator!=(const StringID &id) const { return value != id.value; }
+	};
+}
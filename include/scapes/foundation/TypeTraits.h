@@ -1,3 +1,11 @@
 #pragma once
 
+#include <scapes/foundation/Hash.h>
+
 template<typename T> struct TypeTraits { };
+
+// hash of TypeTraits<T>::name, computed at compile time
+template<typename T> struct TypeID
+{
+	static constexpr uint64_t value = scapes::foundation::hash::compute(std::string_view(TypeTraits<T>::name));
+};
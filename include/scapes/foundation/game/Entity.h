@@ -22,7 +22,7 @@ namespace scapes::foundation::game
 		template<typename T>
 		inline T &getComponent()
 		{
-			void *comp = world->getComponent(id, TypeTraits<T>::name, sizeof(T), alignof(T));
+			void *comp = world->getComponent(id, TypeID<T>::value, TypeTraits<T>::name, sizeof(T), alignof(T));
 			assert(comp);
 
 			return *reinterpret_cast<T*>(comp);
@@ -31,7 +31,7 @@ namespace scapes::foundation::game
 		template<typename T>
 		inline const T &getComponent() const
 		{
-			void *comp = world->getComponent(id, TypeTraits<T>::name, sizeof(T), alignof(T));
+			void *comp = world->getComponent(id, TypeID<T>::value, TypeTraits<T>::name, sizeof(T), alignof(T));
 			assert(comp);
 
 			return *reinterpret_cast<T*>(comp);
@@ -40,7 +40,7 @@ namespace scapes::foundation::game
 		template<typename T>
 		inline T &addComponent()
 		{
-			void *comp = world->addComponent(id, TypeTraits<T>::name, sizeof(T), alignof(T), nullptr);
+			void *comp = world->addComponent(id, TypeID<T>::value, TypeTraits<T>::name, sizeof(T), alignof(T), nullptr);
 			assert(comp);
 
 			return *reinterpret_cast<T*>(comp);
@@ -50,12 +50,18 @@ namespace scapes::foundation::game
 		inline T &addComponent(Arguments&&... params)
 		{
 			const T &temp = { std::forward<Arguments>(params)... };
-			void *comp = world->addComponent(id, TypeTraits<T>::name, sizeof(T), alignof(T), reinterpret_cast<const void *>(&temp));
+			void *comp = world->addComponent(id, TypeID<T>::value, TypeTraits<T>::name, sizeof(T), alignof(T), reinterpret_cast<const void *>(&temp));
 			assert(comp);
 
 			return *reinterpret_cast<T*>(comp);
 		}
 
+		template<typename T>
+		inline void markChanged()
+		{
+			world->markChanged(id, TypeID<T>::value, TypeTraits<T>::name, sizeof(T), alignof(T));
+		}
+
 	private:
 		World *world {nullptr};
 		EntityID *id {nullptr};
@@ -1,9 +1,17 @@
 #pragma once
 
 #include <scapes/foundation/game/World.h>
+#include <scapes/foundation/jobs/JobSystem.h>
+
+#include <algorithm>
+#include <utility>
+#include <vector>
 
 namespace scapes::foundation::game
 {
+	/* Lightweight handle, the World keeps the underlying query per component signature,
+	 * still worth keeping as a member for queries that run every frame
+	 */
 	template<typename... Components>
 	class Query
 	{
@@ -16,18 +24,24 @@ namespace scapes::foundation::game
 		Query(World *world) : world(world)
 		{
 			constexpr size_t num_components = sizeof...(Components);
+			uint64_t ids[num_components];
 			const char *names[num_components];
 			size_t sizes[num_components];
 			size_t alignments[num_components];
 
-			collect_args(0, names, sizes, alignments, (typename std::decay<Components>::type*)nullptr...);
+			collect_args(0, ids, names, sizes, alignments, (typename std::decay<Components>::type*)nullptr...);
 
-			query = world->createQuery(num_components, names, sizes, alignments);
+			query = world->createQuery(num_components, ids, names, sizes, alignments);
 		}
 
+		Query(const Query &) = delete;
+		Query &operator=(const Query &) = delete;
+
 		~Query()
 		{
-			world->destroyQuery(query);
+			if (world)
+				world->destroyQuery(query);
+
 			query = nullptr;
 		}
 
@@ -52,21 +66,197 @@ namespace scapes::foundation::game
 			return reinterpret_cast<T*>(world->getQueryComponents(query, index));
 		}
 
+		inline EntityID *const *getEntities()
+		{
+			return world->getQueryEntities(query);
+		}
+
+		// change ticks of the current chunk, nullptr if the component is not tracked
+		inline uint64_t *getChangeTicks(uint32_t index)
+		{
+			return world->getQueryChangeTicks(query, index);
+		}
+
+		// func(uint32_t count, Components *...), column pointers are fetched once per chunk
+		template<typename Func>
+		inline void forEachChunk(Func &&func)
+		{
+			constexpr size_t num_components = sizeof...(Components);
+			void *columns[num_components];
+			uint32_t count = 0;
+
+			world->begin(query);
+
+			while (world->nextChunk(query, count, columns))
+				invoke_chunk(func, count, columns, std::index_sequence_for<Components...>());
+		}
+
+		// func(Components &...), the per-entity loop is inlined into the caller
+		template<typename Func>
+		inline void forEach(Func &&func)
+		{
+			forEachChunk([&func](uint32_t count, Components *... components)
+			{
+				for (uint32_t i = 0; i < count; ++i)
+					func(components[i]...);
+			});
+		}
+
+		/* Same as forEach, but only for entities where any of the tracked components changed after since_tick,
+		 * entities in chunks without tracked components are all passed through
+		 */
+		template<typename Func>
+		inline void forEachChanged(uint64_t since_tick, Func &&func)
+		{
+			constexpr size_t num_components = sizeof...(Components);
+			void *columns[num_components];
+			const uint64_t *ticks[num_components];
+			uint32_t count = 0;
+
+			world->begin(query);
+
+			while (world->nextChunk(query, count, columns))
+			{
+				uint32_t num_ticks = 0;
+				for (uint32_t i = 0; i < num_components; ++i)
+				{
+					const uint64_t *column_ticks = world->getQueryChangeTicks(query, i);
+					if (column_ticks)
+						ticks[num_ticks++] = column_ticks;
+				}
+
+				for (uint32_t i = 0; i < count; ++i)
+				{
+					bool changed = (num_ticks == 0);
+					for (uint32_t j = 0; j < num_ticks && !changed; ++j)
+						changed = ticks[j][i] > since_tick;
+
+					if (changed)
+						invoke_entity(func, i, columns, std::index_sequence_for<Components...>());
+				}
+			}
+		}
+
+		/* Same as forEach, but ranges run on job system threads and the call blocks until all are done.
+		 * Tables are split into ranges of at most batch_size entities, so with a fixed batch size
+		 * the boundaries depend only on table layout; zero picks one from the number of threads.
+		 * Declare components that are only read as const, i.e. Query<const Transform, Renderable>;
+		 * no entities or components may be added or removed until it returns
+		 */
+		template<typename Func>
+		inline void forEachParallel(jobs::JobSystem *job_system, Func &&func, uint32_t batch_size = 0)
+		{
+			forEachChunkParallel(job_system, [&func](uint32_t count, Components *... components)
+			{
+				for (uint32_t i = 0; i < count; ++i)
+					func(components[i]...);
+			}, batch_size);
+		}
+
+		// func(uint32_t count, Components *...) for every range, called concurrently
+		template<typename Func>
+		inline void forEachChunkParallel(jobs::JobSystem *job_system, Func &&func, uint32_t batch_size = 0)
+		{
+			assert(job_system);
+
+			parallel_chunks.clear();
+			parallel_ranges.clear();
+
+			uint32_t num_entities = 0;
+			ParallelChunk chunk;
+
+			world->begin(query);
+
+			while (world->nextChunk(query, chunk.count, chunk.columns))
+			{
+				if (chunk.count == 0)
+					continue;
+
+				parallel_chunks.push_back(chunk);
+				num_entities += chunk.count;
+			}
+
+			if (num_entities == 0)
+				return;
+
+			if (batch_size == 0)
+			{
+				uint32_t num_batches = job_system->getNumThreads() * 4;
+				batch_size = std::max<uint32_t>(MIN_PARALLEL_BATCH_SIZE, (num_entities + num_batches - 1) / num_batches);
+			}
+
+			for (uint32_t i = 0; i < static_cast<uint32_t>(parallel_chunks.size()); ++i)
+			{
+				uint32_t count = parallel_chunks[i].count;
+				for (uint32_t first = 0; first < count; first += batch_size)
+					parallel_ranges.push_back({i, first, std::min(batch_size, count - first)});
+			}
+
+			job_system->parallelFor(0, static_cast<uint32_t>(parallel_ranges.size()), 1, [&](uint32_t index)
+			{
+				const ParallelRange &range = parallel_ranges[index];
+				const ParallelChunk &range_chunk = parallel_chunks[range.chunk];
+
+				invoke_range(func, range_chunk, range, std::index_sequence_for<Components...>());
+			});
+		}
+
 	private:
-		template<typename T, typename... Components>
-		inline void collect_args(int index, const char *names[], size_t sizes[], size_t alignments[], T comp, Components... comps)
+		enum
+		{
+			MIN_PARALLEL_BATCH_SIZE = 64,
+		};
+
+		struct ParallelChunk
+		{
+			void *columns[sizeof...(Components)];
+			uint32_t count {0};
+		};
+
+		struct ParallelRange
+		{
+			uint32_t chunk {0};
+			uint32_t first {0};
+			uint32_t count {0};
+		};
+
+		template<typename Func, size_t... Indices>
+		static inline void invoke_range(Func &func, const ParallelChunk &chunk, const ParallelRange &range, std::index_sequence<Indices...>)
+		{
+			func(range.count, (reinterpret_cast<Components*>(chunk.columns[Indices]) + range.first)...);
+		}
+
+		template<typename Func, size_t... Indices>
+		static inline void invoke_entity(Func &func, uint32_t index, void *columns[], std::index_sequence<Indices...>)
+		{
+			func(reinterpret_cast<Components*>(columns[Indices])[index]...);
+		}
+
+		template<typename Func, size_t... Indices>
+		static inline void invoke_chunk(Func &func, uint32_t count, void *columns[], std::index_sequence<Indices...>)
+		{
+			func(count, reinterpret_cast<Components*>(columns[Indices])...);
+		}
+
+		template<typename T, typename... Rest>
+		inline void collect_args(int index, uint64_t ids[], const char *names[], size_t sizes[], size_t alignments[], T, Rest... comps)
 		{
 			using Component = typename std::remove_pointer<T>::type;
+			ids[index] = TypeID<Component>::value;
 			names[index] = TypeTraits<Component>::name;
 			sizes[index] = sizeof(Component);
 			alignments[index] = alignof(Component);
 
-			if constexpr (sizeof...(Components) != 0)
-				collect_args(index + 1, names, sizes, alignments, comps...);
+			if constexpr (sizeof...(Rest) != 0)
+				collect_args(index + 1, ids, names, sizes, alignments, comps...);
 		}
 
 	private:
 		World *world {nullptr};
 		QueryID *query {nullptr};
+
+		// scratch for parallel iteration, kept between calls to avoid allocations
+		std::vector<ParallelChunk> parallel_chunks;
+		std::vector<ParallelRange> parallel_ranges;
 	};
 }
@@ -2,33 +2,137 @@
 
 #include <scapes/Common.h>
 #include <scapes/foundation/TypeTraits.h>
+#include <scapes/foundation/Fwd.h>
 
 namespace scapes::foundation::game
 {
 	struct EntityID {};
 	struct QueryID {};
 
+	// maps entity ids stored in a snapshot to the entities created for them on load
+	class SnapshotEntityMap
+	{
+	public:
+		virtual ~SnapshotEntityMap() {}
+
+		// nullptr for entities that were not part of the snapshot
+		virtual EntityID *getEntity(EntityID *saved_entity) const = 0;
+	};
+
+	/* Component type allowed in a snapshot. Columns are copied as is, so components with pointers
+	 * need patches: save is called on a copy of the column right before it's written,
+	 * load is called on the column in its table right after all entities are created
+	 */
+	struct SnapshotComponent
+	{
+		using SaveFuncPtr = void (*)(void *user_data, void *components, uint32_t count);
+		using LoadFuncPtr = void (*)(void *user_data, const SnapshotEntityMap &entities, void *components, uint32_t count);
+
+		uint64_t type_id {0};
+		const char *type_name {nullptr};
+		size_t type_size {0};
+		size_t type_alignment {0};
+
+		SaveFuncPtr save {nullptr};
+		LoadFuncPtr load {nullptr};
+		void *user_data {nullptr};
+
+		template<typename T>
+		static inline SnapshotComponent create(SaveFuncPtr save = nullptr, LoadFuncPtr load = nullptr, void *user_data = nullptr)
+		{
+			return { TypeID<T>::value, TypeTraits<T>::name, sizeof(T), alignof(T), save, load, user_data };
+		}
+	};
+
+	enum class WorldBackend : uint8_t
+	{
+		// flecs tables and queries
+		FLECS = 0,
+
+		// in-house archetypes, SoA columns in 64 byte aligned chunks
+		NATIVE,
+	};
+
 	class World
 	{
 	public:
-		static SCAPES_API World *create();
+		static SCAPES_API World *create(WorldBackend backend = WorldBackend::FLECS);
 		static SCAPES_API void destroy(World *world);
 
 		virtual ~World() {}
 
-		virtual QueryID *createQuery(uint32_t num_types, const char *type_names[], size_t type_sizes[], size_t type_alignments[]) = 0;
+		virtual QueryID *createQuery(uint32_t num_types, const uint64_t type_ids[], const char *type_names[], size_t type_sizes[], size_t type_alignments[]) = 0;
 		virtual void destroyQuery(QueryID *query) = 0;
 		virtual bool begin(QueryID *query) const = 0;
 		virtual bool next(QueryID *query) const = 0;
 		// TODO: better names
 		virtual uint32_t getNumQueryComponents(QueryID *query) const = 0;
 		virtual void *getQueryComponents(QueryID *query, uint32_t type_index) const = 0;
+		virtual EntityID *const *getQueryEntities(QueryID *query) const = 0;
+		// advances to the next chunk and fills all column pointers at once, count is the number of entities in it
+		virtual bool nextChunk(QueryID *query, uint32_t &count, void *columns[]) const = 0;
 
 		virtual EntityID *createEntity() = 0;
+
+		// creates count entities straight in the table for the given component set, data[i] points to
+		// count tightly packed values of component i; created ids are written to entities if it's not null
+		virtual void createEntities(uint32_t count, uint32_t num_types, const uint64_t type_ids[], const char *type_names[], const size_t type_sizes[], const size_t type_alignments[], const void *data[], EntityID *entities[] = nullptr) = 0;
+
 		virtual void destroyEntity(EntityID *entity) = 0;
 		virtual void clear() = 0;
 
-		virtual void *addComponent(EntityID *entity, const char *type_name, size_t type_size, size_t type_alignment, const void *data) = 0;
-		virtual void *getComponent(EntityID *entity, const char *type_name, size_t type_size, size_t type_alignment) const = 0;
+		// bumped on every entity creation, destruction and component addition, cached
+		// component pointers stay valid for as long as the version doesn't change
+		virtual uint64_t getStructureVersion() const = 0;
+
+		virtual void *addComponent(EntityID *entity, uint64_t type_id, const char *type_name, size_t type_size, size_t type_alignment, const void *data) = 0;
+		virtual void *getComponent(EntityID *entity, uint64_t type_id, const char *type_name, size_t type_size, size_t type_alignment) const = 0;
+
+		// change tracking is opt-in per component type, every entity with a tracked component keeps the tick
+		// it was last changed at; adding the component counts as a change too
+		virtual void enableChangeTracking(uint64_t type_id, const char *type_name, size_t type_size, size_t type_alignment) = 0;
+
+		// changes are stamped with the current tick; advancing returns the tick that every change so far
+		// is stamped with at most, so consumers keep it and look for newer ticks next time
+		virtual uint64_t getChangeTick() const = 0;
+		virtual uint64_t advanceChangeTick() = 0;
+
+		// writes through component pointers are not tracked, writers have to report them
+		virtual void markChanged(EntityID *entity, uint64_t type_id, const char *type_name, size_t type_size, size_t type_alignment) = 0;
+
+		// change ticks of the current chunk, nullptr if the component is not tracked
+		virtual uint64_t *getQueryChangeTicks(QueryID *query, uint32_t type_index) const = 0;
+
+		// entities are written table by table and column by column, only tables made of the listed components
+		// are written; load creates entities straight in their tables, snapshot components must be listed there too
+		virtual bool saveSnapshot(io::Stream *stream, uint32_t num_components, const SnapshotComponent components[]) = 0;
+		virtual bool loadSnapshot(io::Stream *stream, uint32_t num_components, const SnapshotComponent components[]) = 0;
+
+	public:
+		template<typename T>
+		inline void enableChangeTracking()
+		{
+			enableChangeTracking(TypeID<T>::value, TypeTraits<T>::name, sizeof(T), alignof(T));
+		}
+
+		template<typename T>
+		inline void markChanged(EntityID *entity)
+		{
+			markChanged(entity, TypeID<T>::value, TypeTraits<T>::name, sizeof(T), alignof(T));
+		}
+
+		// world->createEntities<Transform, Renderable>(count, nullptr, transforms, renderables);
+		template<typename... Components>
+		inline void createEntities(uint32_t count, EntityID *entities[], const Components *... data)
+		{
+			constexpr size_t num_components = sizeof...(Components);
+			const uint64_t ids[num_components] = { TypeID<Components>::value... };
+			const char *names[num_components] = { TypeTraits<Components>::name... };
+			const size_t sizes[num_components] = { sizeof(Components)... };
+			const size_t alignments[num_components] = { alignof(Components)... };
+			const void *arrays[num_components] = { reinterpret_cast<const void *>(data)... };
+
+			createEntities(count, static_cast<uint32_t>(num_components), ids, names, sizes, alignments, arrays, entities);
+		}
 	};
 }
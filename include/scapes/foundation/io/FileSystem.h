@@ -63,6 +63,11 @@ namespace scapes::foundation::io
 		virtual uint64_t size() const = 0;
 	};
 
+	using FileChangeCallback = void (*)(const URI &path, void *user_data);
+
+	// size is the number of bytes actually read, it's less than requested at the end of the file
+	using ReadCallback = void (*)(void *data, size_t size, bool success, void *user_data);
+
 	class FileSystem
 	{
 	public:
@@ -73,5 +78,16 @@ namespace scapes::foundation::io
 		virtual void *map(const URI &path, size_t &size) = 0;
 		virtual bool unmap(void *data) = 0;
 		virtual uint64_t mtime(const URI &path) = 0;
+
+		// change notifications, empty path stands for the file system root, directories are watched recursively
+		virtual bool watch(const URI &path) = 0;
+		virtual bool unwatch(const URI &path) = 0;
+		virtual void fetchChanges(FileChangeCallback callback, void *user_data) = 0;
+
+		// non-blocking reads, callbacks are batched and called from fetchReads() / waitReads() on the calling thread,
+		// data must stay valid until the callback is called
+		virtual bool readAsync(const URI &path, uint64_t offset, size_t size, void *data, ReadCallback callback, void *user_data) = 0;
+		virtual uint32_t fetchReads() = 0;
+		virtual void waitReads() = 0;
 	};
 }
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <scapes/Common.h>
+
+#include <functional>
+
+namespace scapes::foundation::jobs
+{
+	struct JobCounter {};
+
+	enum class JobAffinity : uint8_t
+	{
+		// any worker, the thread that waits on a counter helps running them too
+		ANY = 0,
+
+		// thread that created the job system, i.e. for Vulkan command recording
+		MAIN_THREAD,
+	};
+
+	/* Work-stealing job system, every worker and the main thread own a job deque,
+	 * idle threads steal from the others. Jobs submitted from threads outside of the system
+	 * go to a shared queue. Counters track job completion and are used as dependencies
+	 */
+	class JobSystem
+	{
+	public:
+		// zero workers means one per hardware thread except the calling one
+		static SCAPES_API JobSystem *create(uint32_t num_workers = 0);
+		static SCAPES_API void destroy(JobSystem *job_system);
+
+		virtual ~JobSystem() { }
+
+		// workers plus the main thread
+		virtual uint32_t getNumThreads() const = 0;
+
+		// 0 for the main thread, 1..N for workers, ~0 for threads outside of the system
+		virtual uint32_t getThreadIndex() const = 0;
+
+		virtual JobCounter *createCounter() = 0;
+		virtual void destroyCounter(JobCounter *counter) = 0;
+		virtual bool isDone(const JobCounter *counter) const = 0;
+
+		// counter is incremented right away and decremented when the job finishes,
+		// the job is not started until dependency counter reaches zero
+		virtual void submit(std::function<void ()> job, JobCounter *counter = nullptr, JobCounter *dependency = nullptr, JobAffinity affinity = JobAffinity::ANY) = 0;
+
+		// runs other jobs while waiting, main thread jobs are only picked up by the main thread
+		virtual void wait(JobCounter *counter) = 0;
+
+		// runs main thread jobs queued since the last call, call once per frame
+		virtual void update() = 0;
+
+	public:
+		// calls func(index) for every index in [begin, end) and blocks until all batches are done
+		template <typename Func>
+		void parallelFor(uint32_t begin, uint32_t end, uint32_t batch_size, const Func &func)
+		{
+			if (begin >= end)
+				return;
+
+			RangeFuncPtr invoke = [](const void *data, uint32_t batch_begin, uint32_t batch_end)
+			{
+				const Func *f = reinterpret_cast<const Func *>(data);
+
+				for (uint32_t i = batch_begin; i < batch_end; ++i)
+					(*f)(i);
+			};
+
+			parallelForRange(begin, end, batch_size, invoke, &func);
+		}
+
+	protected:
+		using RangeFuncPtr = void (*)(const void *, uint32_t, uint32_t);
+
+		virtual void parallelForRange(uint32_t begin, uint32_t end, uint32_t batch_size, RangeFuncPtr func, const void *data) = 0;
+	};
+}
@@ -6,21 +6,245 @@
 #include <scapes/foundation/Fwd.h>
 #include <scapes/foundation/io/FileSystem.h>
 
+#include <atomic>
+#include <functional>
+#include <string>
+#include <type_traits>
+#include <vector>
+
 template <typename T> struct ResourceTraits { };
 
 namespace scapes::foundation::resources
 {
 	// TODO: better types
 	typedef uint64_t hash_t;
+	typedef uint64_t type_id_t;
 	typedef uint32_t generation_t;
 
+	enum class ResourceState : uint8_t
+	{
+		READY = 0,
+		PENDING,
+		FAILED,
+	};
+
+	// fields that are read without locks are atomic, so handles can be checked from any thread
 	struct ResourceMetadata
 	{
+		std::atomic<generation_t> generation {0};
+		std::atomic<hash_t> hash {0};
+		type_id_t type_id {0};
+		const char *type_name {nullptr};
+		std::atomic<ResourceState> state {ResourceState::READY};
+
+		// set while the resource is linked to an URI, lets unlinked resources skip URI lookups
+		std::atomic<bool> linked {false};
+
+		// resources with zero references are cached until memory budget is exceeded
+		std::atomic<uint32_t> ref_count {0};
+		size_t cpu_memory {0};
+		size_t gpu_memory {0};
+
+		// slot in the per-type handle table
+		uint32_t index {0};
+	};
+
+	// dense per-type table used to resolve index handles, slots are updated when pool memory moves;
+	// slots live in fixed-size pages that are never moved, so lookups don't race with new allocations
+	struct ResourceTable
+	{
+		enum : uint32_t
+		{
+			INVALID_INDEX = 0xFFFFFFFF,
+			SLOTS_IN_PAGE = 1024,
+			MAX_PAGES = 4096,
+		};
+
+		struct Slot
+		{
+			std::atomic<void *> memory {nullptr};
+			std::atomic<generation_t> generation {1};
+			uint32_t next_free {INVALID_INDEX};
+		};
+
+		std::atomic<Slot *> pages[MAX_PAGES] {};
+		std::atomic<uint32_t> num_slots {0};
+		uint32_t free_head {INVALID_INDEX};
+
+		// set while compaction moves memory, lookups must not overlap with it
+		std::atomic<bool> relocating {false};
+
+		SCAPES_INLINE Slot &getSlot(uint32_t index) const
+		{
+			Slot *page = pages[index / SLOTS_IN_PAGE].load(std::memory_order_acquire);
+			assert(page);
+
+			return page[index % SLOTS_IN_PAGE];
+		}
+
+		SCAPES_INLINE void *resolve(uint32_t index, generation_t generation) const
+		{
+			assert(!relocating.load(std::memory_order_relaxed));
+
+			if (index >= num_slots.load(std::memory_order_acquire))
+				return nullptr;
+
+			const Slot &slot = getSlot(index);
+
+			// generation is bumped before memory is cleared, so check it after reading memory
+			void *memory = slot.memory.load(std::memory_order_acquire);
+			if (slot.generation.load(std::memory_order_acquire) != generation)
+				return nullptr;
+
+			return memory;
+		}
+	};
+
+	// POD index handle, stays valid when the pool is compacted
+	template <typename T>
+	struct ResourceID
+	{
+		uint32_t index {ResourceTable::INVALID_INDEX};
 		generation_t generation {0};
-		hash_t hash {0};
+
+		SCAPES_INLINE bool operator==(const ResourceID<T> &id) const { return index == id.index && generation == id.generation; }
+		SCAPES_INLINE bool operator!=(const ResourceID<T> &id) const { return !(*this == id); }
+	};
+
+	// resolves index handles without generation checks in release builds, meant for hot loops;
+	// must not be kept across resource creation, destruction or compaction
+	template <typename T>
+	class ResourceView
+	{
+	public:
+		ResourceView(const ResourceTable *table)
+			: table(table)
+		{
+
+		}
+
+		SCAPES_INLINE T *get(ResourceID<T> id) const
+		{
+			assert(table);
+			assert(!table->relocating.load(std::memory_order_relaxed));
+			assert(id.index < table->num_slots.load(std::memory_order_relaxed));
+
+			const ResourceTable::Slot &slot = table->getSlot(id.index);
+			assert(slot.generation.load(std::memory_order_relaxed) == id.generation);
+
+			void *memory = slot.memory.load(std::memory_order_acquire);
+			assert(memory);
+
+			return reinterpret_cast<T *>(reinterpret_cast<uint8_t *>(memory) + sizeof(ResourceMetadata));
+		}
+
+		SCAPES_INLINE T *tryGet(ResourceID<T> id) const
+		{
+			if (!table)
+				return nullptr;
+
+			void *memory = table->resolve(id.index, id.generation);
+			if (!memory)
+				return nullptr;
+
+			return reinterpret_cast<T *>(reinterpret_cast<uint8_t *>(memory) + sizeof(ResourceMetadata));
+		}
+
+	private:
+		const ResourceTable *table {nullptr};
+	};
+
+	struct MemoryUsage
+	{
+		size_t cpu_bytes {0};
+		size_t gpu_bytes {0};
+
+		// zero budget means unlimited
+		size_t cpu_budget {0};
+		size_t gpu_budget {0};
+
+		uint32_t num_resources {0};
+		uint32_t num_evictable {0};
+	};
+
+	// times are in milliseconds
+	struct ResourceTypeStats
+	{
 		const char *type_name {nullptr};
+
+		uint32_t num_resources {0};
+		uint32_t num_pool_pages {0};
+		size_t pool_bytes {0};
+		size_t cpu_bytes {0};
+		size_t gpu_bytes {0};
+
+		uint32_t num_loads {0};
+		uint32_t num_failed_loads {0};
+		uint32_t num_reloads {0};
+
+		// time spent working on loads and reloads, queueing is not included
+		float total_load_time {0.0f};
+		float max_load_time {0.0f};
+	};
+
+	struct ResourceLoadEvent
+	{
+		const char *type_name {nullptr};
+
+		// empty for resources loaded from memory
+		std::string uri;
+
+		// since resource manager creation
+		float start_time {0.0f};
+
+		// from request to ready, includes waiting in the async queue
+		float total_time {0.0f};
+
+		float io_time {0.0f};
+		float decode_time {0.0f};
+		float commit_time {0.0f};
+
+		bool async {false};
+		bool reload {false};
+		bool success {false};
 	};
 
+	struct AsyncLoadTask
+	{
+		// decode is called on a worker thread and must not touch GPU, commit is called on the main thread
+		using DecodeFuncPtr = bool (*)(ResourceManager *, void *, const uint8_t *, size_t);
+		using CommitFuncPtr = bool (*)(ResourceManager *, void *, const uint8_t *, size_t);
+
+		void *memory {nullptr};
+		size_t offset {0};
+		io::URI uri;
+
+		// in-memory source, used instead of uri if not null
+		const uint8_t *data {nullptr};
+		size_t size {0};
+
+		DecodeFuncPtr decode {nullptr};
+		CommitFuncPtr commit {nullptr};
+	};
+
+	template <typename T, typename = void>
+	struct HasDecodeFromMemory : std::false_type { };
+
+	template <typename T>
+	struct HasDecodeFromMemory<T, std::void_t<decltype(&ResourceTraits<T>::decodeFromMemory)>> : std::true_type { };
+
+	template <typename T, typename = void>
+	struct HasCPUMemory : std::false_type { };
+
+	template <typename T>
+	struct HasCPUMemory<T, std::void_t<decltype(&ResourceTraits<T>::getCPUMemory)>> : std::true_type { };
+
+	template <typename T, typename = void>
+	struct HasGPUMemory : std::false_type { };
+
+	template <typename T>
+	struct HasGPUMemory<T, std::void_t<decltype(&ResourceTraits<T>::getGPUMemory)>> : std::true_type { };
+
 	template <typename T>
 	class ResourceHandle
 	{
@@ -56,6 +280,20 @@ namespace scapes::foundation::resources
 			return reinterpret_cast<T *>(reinterpret_cast<uint8_t *>(memory) + sizeof(ResourceMetadata));
 		}
 
+		SCAPES_INLINE bool isReady() const
+		{
+			return getState() == ResourceState::READY;
+		}
+
+		SCAPES_INLINE ResourceState getState() const
+		{
+			if (!isValid())
+				return ResourceState::FAILED;
+
+			const ResourceMetadata *metadata = reinterpret_cast<const ResourceMetadata *>(memory);
+			return metadata->state;
+		}
+
 		SCAPES_INLINE void *getRaw() const { return memory; }
 		SCAPES_INLINE generation_t getGeneration() const { return generation; }
 
@@ -93,6 +331,11 @@ namespace scapes::foundation::resources
 		generation_t generation {0};
 	};
 
+	/* Resources can be created, fetched, released and destroyed from any thread.
+	 * update(), waitPending() and compact<T>() must be called from the thread that created the manager,
+	 * hot reloads run there too. Async loads are committed in update() or on the thread that waits for them,
+	 * other ResourceTraits<T> callbacks run on the calling thread
+	 */
 	class ResourceManager
 	{
 	public:
@@ -104,31 +347,46 @@ namespace scapes::foundation::resources
 		virtual io::FileSystem *getFileSystem() const = 0;
 		virtual void update(float dt) = 0;
 
+		// blocks until all async loads are finished and committed
+		virtual void waitPending() = 0;
+
+		virtual void setMemoryBudget(size_t cpu_bytes, size_t gpu_bytes) = 0;
+		virtual MemoryUsage getMemoryUsage() const = 0;
+
+		virtual void getResourceStats(std::vector<ResourceTypeStats> &stats) const = 0;
+
+		// only the most recent loads are kept, oldest first
+		virtual void getLoadTimeline(std::vector<ResourceLoadEvent> &events) const = 0;
+		virtual void clearLoadTimeline() = 0;
+
+		// milliseconds since resource manager creation
+		virtual float getTime() const = 0;
+
 	public:
 		template <typename T, typename... Arguments>
 		ResourceHandle<T> create(Arguments &&...params)
 		{
 			size_t size = ResourceTraits<T>::size() + sizeof(ResourceMetadata);
-			void *memory = allocate(TypeTraits<T>::name, size);
+			void *memory = allocate(TypeID<T>::value, TypeTraits<T>::name, size, createVTable<T>());
 			assert(memory);
 
+			// not visible to other threads until the handle is returned, so relaxed stores are enough
 			ResourceMetadata *meta = reinterpret_cast<ResourceMetadata *>(memory);
-			meta->generation++;
-			meta->hash = 0;
+			meta->generation.store(meta->generation.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+			meta->hash.store(0, std::memory_order_relaxed);
+			meta->type_id = TypeID<T>::value;
 			meta->type_name = TypeTraits<T>::name;
-
-			ResourceVTable *vtable = fetchVTable(TypeTraits<T>::name);
-			assert(vtable);
-
-			vtable->destroy = ResourceTraits<T>::destroy;
-			vtable->reload = ResourceTraits<T>::reload;
-			vtable->fetchHash = ResourceTraits<T>::fetchHash;
-			vtable->offset = sizeof(ResourceMetadata);
+			meta->state.store(ResourceState::READY, std::memory_order_relaxed);
+			meta->linked.store(false, std::memory_order_relaxed);
+			meta->ref_count.store(1, std::memory_order_relaxed);
+			meta->cpu_memory = 0;
+			meta->gpu_memory = 0;
 
 			void *resource_memory = reinterpret_cast<uint8_t *>(memory) + sizeof(ResourceMetadata);
 			assert(resource_memory);
 
 			ResourceTraits<T>::create(this, resource_memory, std::forward<Arguments>(params)...);
+			trackMemory(memory);
 
 			return ResourceHandle<T>(memory);
 		}
@@ -151,13 +409,87 @@ namespace scapes::foundation::resources
 			return getLinkedUri(handle.getRaw());
 		}
 
+		// concurrent fetches of the same uri load it once, the others wait and share the result
 		template <typename T, typename... Arguments>
 		ResourceHandle<T> fetch(const io::URI &uri, Arguments &&...params)
 		{
-			if (void *memory = getLinkedMemory(uri); memory)
+			if (void *memory = reserveLinkedMemory(uri); memory)
+			{
+				if (getState(memory) == ResourceState::PENDING)
+					waitMemory(memory);
+
+				return ResourceHandle<T>(memory);
+			}
+
+			ResourceHandle<T> resource = load<T, Arguments...>(uri, std::forward<Arguments>(params)...);
+			finishLinkedLoad(uri);
+
+			return resource;
+		}
+
+		template <typename T, typename... Arguments>
+		ResourceHandle<T> fetchAsync(const io::URI &uri, Arguments &&...params)
+		{
+			if (void *memory = reserveLinkedMemory(uri); memory)
 				return ResourceHandle<T>(memory);
 
-			return load<T, Arguments...>(uri, std::forward<Arguments>(params)...);
+			ResourceHandle<T> resource = loadAsync<T, Arguments...>(uri, std::forward<Arguments>(params)...);
+			finishLinkedLoad(uri);
+
+			return resource;
+		}
+
+		template <typename T, typename... Arguments>
+		ResourceHandle<T> loadAsync(const io::URI &uri, Arguments &&...params)
+		{
+			ResourceHandle<T> resource = create<T, Arguments...>(std::forward<Arguments>(params)...);
+
+			AsyncLoadTask task = createAsyncLoadTask<T>(resource.getRaw());
+			task.uri = uri;
+
+			linkMemory(resource.getRaw(), uri);
+			submitAsync(task);
+
+			return resource;
+		}
+
+		// data must stay alive until the resource leaves pending state
+		template <typename T, typename... Arguments>
+		ResourceHandle<T> loadFromMemoryAsync(const uint8_t *data, size_t size, Arguments &&...params)
+		{
+			ResourceHandle<T> resource = create<T, Arguments...>(std::forward<Arguments>(params)...);
+
+			AsyncLoadTask task = createAsyncLoadTask<T>(resource.getRaw());
+			task.data = data;
+			task.size = size;
+
+			submitAsync(task);
+
+			return resource;
+		}
+
+		template <typename T>
+		bool wait(const ResourceHandle<T> &handle)
+		{
+			if (!handle.isValid())
+				return false;
+
+			if (handle.getState() == ResourceState::PENDING)
+				waitMemory(handle.getRaw());
+
+			return handle.isReady();
+		}
+
+		// callback is called on the thread that commits the load, immediately if the resource is not pending
+		template <typename T>
+		void addLoadCallback(const ResourceHandle<T> &handle, std::function<void (ResourceHandle<T>, bool)> callback)
+		{
+			addMemoryLoadCallback(handle.getRaw(),
+				[callback](void *memory, bool success)
+				{
+					callback(ResourceHandle<T>(memory), success);
+				}
+			);
 		}
 
 		template <typename T, typename... Arguments>
@@ -166,6 +498,9 @@ namespace scapes::foundation::resources
 			io::FileSystem *file_system = getFileSystem();
 			assert(file_system);
 
+			ResourceLoadEvent event;
+			event.start_time = getTime();
+
 			size_t size = 0;
 			uint8_t *data = reinterpret_cast<uint8_t *>(file_system->map(uri, size));
 
@@ -175,26 +510,38 @@ namespace scapes::foundation::resources
 				return ResourceHandle<T>();
 			}
 
-			ResourceHandle<T> resource = loadFromMemory<T>(data, size, std::forward<Arguments>(params)...);
-			file_system->unmap(data);
+			float decode_start_time = getTime();
+			event.io_time = decode_start_time - event.start_time;
 
-			const ResourceMetadata *metadata = reinterpret_cast<ResourceMetadata *>(resource.getRaw());
-			assert(metadata);
+			ResourceHandle<T> resource = create<T, Arguments...>(std::forward<Arguments>(params)...);
+			event.success = ResourceTraits<T>::loadFromMemory(this, resource.get(), data, size);
+			trackMemory(resource.getRaw());
+
+			file_system->unmap(data);
 
-			ResourceVTable *vtable = fetchVTable(metadata->type_name);
-			hash_t hash = vtable->fetchHash(this, file_system, resource.get(), uri);
+			hash_t hash = ResourceTraits<T>::fetchHash(this, file_system, resource.get(), uri);
 
 			setHash(resource.getRaw(), hash);
 			linkMemory(resource.getRaw(), uri);
 
+			event.decode_time = getTime() - decode_start_time;
+			trackLoad(resource.getRaw(), uri, event);
+
 			return resource;
 		}
 
 		template <typename T, typename... Arguments>
 		ResourceHandle<T> loadFromMemory(const uint8_t *data, size_t size, Arguments &&...params)
 		{
+			ResourceLoadEvent event;
+			event.start_time = getTime();
+
 			ResourceHandle<T> resource = create<T, Arguments...>(std::forward<Arguments>(params)...);
-			ResourceTraits<T>::loadFromMemory(this, resource.get(), data, size);
+			event.success = ResourceTraits<T>::loadFromMemory(this, resource.get(), data, size);
+			trackMemory(resource.getRaw());
+
+			event.decode_time = getTime() - event.start_time;
+			trackLoad(resource.getRaw(), io::URI(), event);
 
 			return resource;
 		}
@@ -203,22 +550,147 @@ namespace scapes::foundation::resources
 		void flushToGPU(ResourceHandle<T> resource)
 		{
 			ResourceTraits<T>::flushToGPU(this, resource.get());
+			trackMemory(resource.getRaw());
+		}
+
+		// drops a reference obtained from create/load/fetch, unreferenced resources
+		// linked to an URI stay cached and may be evicted when memory budget is exceeded
+		template <typename T>
+		void release(ResourceHandle<T> resource)
+		{
+			if (!resource.isValid())
+				return;
+
+			releaseMemory(resource.getRaw());
+		}
+
+		// re-measures resource memory after it was changed outside of the resource manager
+		template <typename T>
+		void updateMemoryUsage(ResourceHandle<T> resource)
+		{
+			if (!resource.isValid())
+				return;
+
+			trackMemory(resource.getRaw());
+		}
+
+		template <typename T>
+		ResourceID<T> getID(const ResourceHandle<T> &handle) const
+		{
+			if (!handle.isValid())
+				return ResourceID<T>();
+
+			const ResourceMetadata *metadata = reinterpret_cast<const ResourceMetadata *>(handle.getRaw());
+			const ResourceTable *table = getTable(TypeID<T>::value);
+			assert(table);
+			assert(metadata->index < table->num_slots.load(std::memory_order_relaxed));
+
+			ResourceID<T> result;
+			result.index = metadata->index;
+			result.generation = table->getSlot(metadata->index).generation.load(std::memory_order_acquire);
+
+			return result;
+		}
+
+		template <typename T>
+		ResourceHandle<T> getHandle(ResourceID<T> id) const
+		{
+			const ResourceTable *table = getTable(TypeID<T>::value);
+			if (!table)
+				return ResourceHandle<T>();
+
+			void *memory = table->resolve(id.index, id.generation);
+			if (!memory)
+				return ResourceHandle<T>();
+
+			return ResourceHandle<T>(memory);
+		}
+
+		template <typename T>
+		T *get(ResourceID<T> id) const
+		{
+			return getView<T>().tryGet(id);
 		}
 
+		template <typename T>
+		ResourceView<T> getView() const
+		{
+			return ResourceView<T>(getTable(TypeID<T>::value));
+		}
+
+		// moves resources to fill pool holes and frees empty pages, returns number of moved resources;
+		// ResourceHandle<T> pointers to this type are invalidated, ResourceID<T> stays valid.
+		// Lookups, handle checks and ref counting don't lock, so no other thread may use resources of this type
+		// while it runs. Emptied pages are freed a few update() calls later, stale handles must be dropped by then
+		template <typename T>
+		size_t compact()
+		{
+			static_assert(std::is_trivially_copyable<T>::value, "Only trivially copyable resources can be moved in memory");
+			return compactMemory(TypeID<T>::value);
+		}
+
+		template <typename T>
+		void setMemoryBudget(size_t cpu_bytes, size_t gpu_bytes)
+		{
+			setTypeMemoryBudget(TypeID<T>::value, cpu_bytes, gpu_bytes);
+		}
+
+		template <typename T>
+		MemoryUsage getMemoryUsage() const
+		{
+			return getTypeMemoryUsage(TypeID<T>::value);
+		}
+
+		template <typename T>
+		ResourceTypeStats getResourceStats() const
+		{
+			ResourceTypeStats stats = getTypeStats(TypeID<T>::value);
+			stats.type_name = TypeTraits<T>::name;
+
+			return stats;
+		}
+
+		// handles are invalidated right away, destruction from other threads than the one
+		// that created the resource manager is deferred to the next update()
 		template <typename T>
 		void destroy(ResourceHandle<T> resource)
 		{
-			ResourceMetadata *metadata = reinterpret_cast<ResourceMetadata *>(resource.getRaw());
-			assert(metadata);
+			assert(resource.isValid());
+			destroyMemory(resource.getRaw());
+		}
 
-			ResourceVTable *vtable = fetchVTable(metadata->type_name);
+	private:
+		template <typename T>
+		static bool commitDecoded(ResourceManager *resource_manager, void *memory, const uint8_t *data, size_t size)
+		{
+			ResourceTraits<T>::flushToGPU(resource_manager, memory);
+			return true;
+		}
 
-			T *resource_memory = resource.get();
-			assert(resource_memory);
+		template <typename T>
+		static bool commitFromMemory(ResourceManager *resource_manager, void *memory, const uint8_t *data, size_t size)
+		{
+			return ResourceTraits<T>::loadFromMemory(resource_manager, memory, data, size);
+		}
+
+		template <typename T>
+		static AsyncLoadTask createAsyncLoadTask(void *memory)
+		{
+			setState(memory, ResourceState::PENDING);
 
-			vtable->destroy(this, resource_memory);
+			AsyncLoadTask task = {};
+			task.memory = memory;
+			task.offset = sizeof(ResourceMetadata);
 
-			deallocate(resource.getRaw(), TypeTraits<T>::name);
+			if constexpr (HasDecodeFromMemory<T>::value)
+			{
+				task.decode = ResourceTraits<T>::decodeFromMemory;
+				task.commit = commitDecoded<T>;
+			}
+			else
+				task.commit = commitFromMemory<T>;
+
+			return task;
 		}
 
 	protected:
@@ -227,13 +699,34 @@ namespace scapes::foundation::resources
 			using DestroyFuncPtr = void (*)(ResourceManager *, void *);
 			using ReloadFuncPtr = bool (*)(ResourceManager *, io::FileSystem *, void *, const io::URI &);
 			using FetchHashFuncPtr = hash_t (*)(ResourceManager *, io::FileSystem *, void *, const io::URI &);
+			using MemoryFuncPtr = size_t (*)(ResourceManager *, void *);
 
 			DestroyFuncPtr destroy {nullptr};
 			ReloadFuncPtr reload {nullptr};
 			FetchHashFuncPtr fetchHash {nullptr};
+			MemoryFuncPtr getCPUMemory {nullptr};
+			MemoryFuncPtr getGPUMemory {nullptr};
 			size_t offset {0};
 		};
 
+		template <typename T>
+		static ResourceVTable createVTable()
+		{
+			ResourceVTable vtable;
+			vtable.destroy = ResourceTraits<T>::destroy;
+			vtable.reload = ResourceTraits<T>::reload;
+			vtable.fetchHash = ResourceTraits<T>::fetchHash;
+			vtable.offset = sizeof(ResourceMetadata);
+
+			if constexpr (HasCPUMemory<T>::value)
+				vtable.getCPUMemory = ResourceTraits<T>::getCPUMemory;
+
+			if constexpr (HasGPUMemory<T>::value)
+				vtable.getGPUMemory = ResourceTraits<T>::getGPUMemory;
+
+			return vtable;
+		}
+
 		SCAPES_INLINE static void setHash(void *memory, hash_t hash)
 		{
 			ResourceMetadata *metadata = reinterpret_cast<ResourceMetadata *>(memory);
@@ -250,6 +743,22 @@ namespace scapes::foundation::resources
 			return metadata->hash;
 		}
 
+		SCAPES_INLINE static void setState(void *memory, ResourceState state)
+		{
+			ResourceMetadata *metadata = reinterpret_cast<ResourceMetadata *>(memory);
+			assert(metadata);
+
+			metadata->state = state;
+		}
+
+		SCAPES_INLINE static ResourceState getState(void *memory)
+		{
+			ResourceMetadata *metadata = reinterpret_cast<ResourceMetadata *>(memory);
+			assert(metadata);
+
+			return metadata->state;
+		}
+
 		SCAPES_INLINE static const char *getTypeName(void *memory)
 		{
 			ResourceMetadata *metadata = reinterpret_cast<ResourceMetadata *>(memory);
@@ -258,13 +767,42 @@ namespace scapes::foundation::resources
 			return metadata->type_name;
 		}
 
+		SCAPES_INLINE static type_id_t getTypeID(void *memory)
+		{
+			ResourceMetadata *metadata = reinterpret_cast<ResourceMetadata *>(memory);
+			assert(metadata);
+
+			return metadata->type_id;
+		}
+
 		virtual bool linkMemory(void *memory, const io::URI &uri) = 0;
 		virtual bool unlinkMemory(void *memory) = 0;
 		virtual void *getLinkedMemory(const io::URI &uri) const = 0;
+		virtual void *retainLinkedMemory(const io::URI &uri) = 0;
 		virtual io::URI getLinkedUri(void *memory) const = 0;
 
-		virtual ResourceVTable *fetchVTable(const char *type_name) = 0;
-		virtual void *allocate(const char *type_name, size_t size) = 0;
-		virtual void deallocate(void *memory, const char *type_name) = 0;
+		// returns retained memory linked to the uri, or nullptr if the caller has to load and link it
+		// and call finishLinkedLoad() afterwards; blocks while another thread is loading the same uri
+		virtual void *reserveLinkedMemory(const io::URI &uri) = 0;
+		virtual void finishLinkedLoad(const io::URI &uri) = 0;
+
+		virtual void submitAsync(const AsyncLoadTask &task) = 0;
+		virtual void waitMemory(void *memory) = 0;
+		virtual void cancelMemory(void *memory) = 0;
+		virtual void addMemoryLoadCallback(void *memory, std::function<void (void *, bool)> callback) = 0;
+
+		virtual void trackMemory(void *memory) = 0;
+		virtual void trackLoad(void *memory, const io::URI &uri, ResourceLoadEvent &event) = 0;
+		virtual void retainMemory(void *memory) = 0;
+		virtual void releaseMemory(void *memory) = 0;
+		virtual void setTypeMemoryBudget(type_id_t type_id, size_t cpu_bytes, size_t gpu_bytes) = 0;
+		virtual MemoryUsage getTypeMemoryUsage(type_id_t type_id) const = 0;
+		virtual ResourceTypeStats getTypeStats(type_id_t type_id) const = 0;
+
+		virtual const ResourceTable *getTable(type_id_t type_id) const = 0;
+		virtual size_t compactMemory(type_id_t type_id) = 0;
+
+		virtual void *allocate(type_id_t type_id, const char *type_name, size_t size, const ResourceVTable &vtable) = 0;
+		virtual void destroyMemory(void *memory) = 0;
 	};
 }
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <scapes/Common.h>
+#include <scapes/foundation/math/Math.h>
+#include <scapes/visual/Fwd.h>
+
+namespace scapes::visual
+{
+	/* World space planes pointing inwards, a point p is inside when dot(plane.xyz, p) + plane.w >= 0
+	 */
+	struct Frustum
+	{
+		enum
+		{
+			PLANE_LEFT = 0,
+			PLANE_RIGHT,
+			PLANE_BOTTOM,
+			PLANE_TOP,
+			PLANE_NEAR,
+			PLANE_FAR,
+
+			MAX_PLANES,
+		};
+
+		foundation::math::vec4 planes[MAX_PLANES];
+
+		static SCAPES_API Frustum fromViewProjection(const foundation::math::mat4 &view_projection);
+
+		/* Bounds are passed as separate arrays so several spheres are tested at once,
+		 * writes indices of the spheres touching the frustum and returns how many were written
+		 */
+		SCAPES_API uint32_t cullSpheres(
+			uint32_t count,
+			const float *centers_x,
+			const float *centers_y,
+			const float *centers_z,
+			const float *radii,
+			uint32_t *visible_indices
+		) const;
+	};
+}
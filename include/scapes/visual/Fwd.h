@@ -4,12 +4,16 @@
 
 namespace scapes::visual
 {
+	class GeometryArena;
 	class GlbImporter;
 	class HdriImporter;
 
 	class RenderGraph;
 	class Material;
+	class TransformSystem;
 
+	struct Frustum;
+	struct GeometryRange;
 	struct IBLTexture;
 	struct Mesh;
 	struct Shader;
@@ -25,6 +29,8 @@ namespace scapes::visual
 	namespace components
 	{
 		struct Transform;
+		struct LocalTransform;
+		struct Parent;
 		struct SkyLight;
 		struct Renderable;
 	}
@@ -54,9 +60,11 @@ namespace scapes::visual
 		struct RenderPass_t;
 		struct CommandBuffer_t;
 		struct UniformBuffer_t;
+		struct StorageBuffer_t;
 		struct Shader_t;
 		struct BindSet_t;
 		struct GraphicsPipeline_t;
+		struct ComputePipeline_t;
 		struct SwapChain_t;
 
 		typedef struct VertexBuffer_t *VertexBuffer;
@@ -66,12 +74,16 @@ namespace scapes::visual
 		typedef struct RenderPass_t *RenderPass;
 		typedef struct CommandBuffer_t *CommandBuffer;
 		typedef struct UniformBuffer_t *UniformBuffer;
+		typedef struct StorageBuffer_t *StorageBuffer;
 		typedef struct Shader_t *Shader;
 		typedef struct BindSet_t *BindSet;
 		typedef struct GraphicsPipeline_t *GraphicsPipeline;
+		typedef struct ComputePipeline_t *ComputePipeline;
 		typedef struct SwapChain_t *SwapChain;
 
 		struct VertexAttribute;
+		struct DrawIndexedIndirectCommand;
+		struct DispatchIndirectCommand;
 		struct FrameBufferAttachment;
 		union RenderPassClearColor;
 		struct RenderPassClearDepthStencil;
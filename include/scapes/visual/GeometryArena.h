@@ -0,0 +1,47 @@
+#pragma once
+
+#include <scapes/Common.h>
+#include <scapes/visual/Fwd.h>
+
+namespace scapes::visual
+{
+	/* Part of the shared buffers owned by a single mesh, draws reach it with base_vertex and base_index
+	 */
+	struct GeometryRange
+	{
+		hardware::VertexBuffer vertex_buffer {SCAPES_NULL_HANDLE};
+		hardware::IndexBuffer index_buffer {SCAPES_NULL_HANDLE};
+		uint32_t base_vertex {0};
+		uint32_t base_index {0};
+		uint32_t num_vertices {0};
+		uint32_t num_indices {0};
+	};
+
+	/* Sub-allocates mesh vertices and indices from a few large device local buffers,
+	 * so consecutive draws of different meshes don't rebind geometry.
+	 * A new page is added when existing ones run out of space, meshes bigger than a page get their own
+	 */
+	class GeometryArena
+	{
+	public:
+		static SCAPES_API GeometryArena *create(
+			hardware::Device *device,
+			uint32_t page_vertices,
+			uint32_t page_indices
+		);
+		static SCAPES_API void destroy(GeometryArena *arena);
+
+		virtual ~GeometryArena() { }
+
+	public:
+		virtual hardware::Device *getDevice() const = 0;
+
+		virtual bool allocate(uint32_t num_vertices, uint32_t num_indices, GeometryRange &range) = 0;
+		virtual void free(const GeometryRange &range) = 0;
+
+		virtual uint32_t getNumPages() const = 0;
+		virtual uint32_t getNumAllocations() const = 0;
+		virtual size_t getGPUMemory() const = 0;
+		virtual size_t getUsedGPUMemory() const = 0;
+	};
+}
@@ -5,7 +5,9 @@
 
 namespace scapes::visual
 {
-	/*
+	/* Decoded scenes are cached as snapshots in cache_path, keyed on the source path, size and mtime;
+	 * keep it out of watched directories, every snapshot write would be reported as an asset change.
+	 * Without cache_path every import decodes the source
 	 */
 	class GlbImporter
 	{
@@ -13,7 +15,9 @@ namespace scapes::visual
 		static SCAPES_API GlbImporter *create(
 			foundation::resources::ResourceManager *resource_manager,
 			foundation::game::World *world,
-			hardware::Device *device
+			hardware::Device *device,
+			GeometryArena *geometry_arena,
+			const char *cache_path = nullptr
 		);
 		static SCAPES_API void destroy(GlbImporter *importer);
 		
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <scapes/Common.h>
+#include <scapes/foundation/Hash.h>
 
 #include <scapes/visual/serde/Yaml.h>
 #include <scapes/visual/GroupParameterType.h>
@@ -28,20 +29,20 @@ namespace scapes::visual
 		virtual foundation::serde::yaml::Tree serialize() = 0;
 
 		virtual bool addGroup(const char *name) = 0;
-		virtual bool removeGroup(const char *name) = 0;
+		virtual bool removeGroup(foundation::StringID name) = 0;
 		virtual void removeAllGroups() = 0;
 
-		virtual hardware::BindSet getGroupBindings(const char *name) const = 0;
+		virtual hardware::BindSet getGroupBindings(foundation::StringID name) const = 0;
 
 		virtual bool addGroupParameter(const char *group_name, const char *parameter_name, size_t element_size, size_t num_elements) = 0;
 		virtual bool addGroupParameter(const char *group_name, const char *parameter_name, GroupParameterType type, size_t num_elements) = 0;
-		virtual bool removeGroupParameter(const char *group_name, const char *parameter_name) = 0;
+		virtual bool removeGroupParameter(foundation::StringID group_name, foundation::StringID parameter_name) = 0;
 
 		virtual bool addGroupTexture(const char *group_name, const char *texture_name) = 0;
-		virtual bool removeGroupTexture(const char *group_name, const char *texture_name) = 0;
+		virtual bool removeGroupTexture(foundation::StringID group_name, foundation::StringID texture_name) = 0;
 
-		virtual TextureHandle getGroupTexture(const char *group_name, const char *texture_name) const = 0;
-		virtual bool setGroupTexture(const char *group_name, const char *texture_name, TextureHandle handle) = 0;
+		virtual TextureHandle getGroupTexture(foundation::StringID group_name, foundation::StringID texture_name) const = 0;
+		virtual bool setGroupTexture(foundation::StringID group_name, foundation::StringID texture_name, TextureHandle handle) = 0;
 
 	public:
 		template<typename T>
@@ -62,14 +63,14 @@ namespace scapes::visual
 		}
 
 		template<typename T>
-		SCAPES_INLINE T getGroupParameter(const char *group_name, const char *parameter_name) const
+		SCAPES_INLINE T getGroupParameter(foundation::StringID group_name, foundation::StringID parameter_name) const
 		{
 			const T *data = getGroupParameter<T>(group_name, parameter_name, 0);
 			return *data;
 		}
 
 		template<typename T>
-		SCAPES_INLINE const T *getGroupParameter(const char *group_name, const char *parameter_name, size_t index) const
+		SCAPES_INLINE const T *getGroupParameter(foundation::StringID group_name, foundation::StringID parameter_name, size_t index) const
 		{
 			assert(getGroupParameterElementSize(group_name, parameter_name) == sizeof(T));
 			assert(getGroupParameterNumElements(group_name, parameter_name) > index);
@@ -81,7 +82,7 @@ namespace scapes::visual
 		}
 
 		template<typename T>
-		SCAPES_INLINE bool setGroupParameter(const char *group_name, const char *parameter_name, size_t num_elements, const T *value)
+		SCAPES_INLINE bool setGroupParameter(foundation::StringID group_name, foundation::StringID parameter_name, size_t num_elements, const T *value)
 		{
 			assert(getGroupParameterElementSize(group_name, parameter_name) == sizeof(T));
 			assert(getGroupParameterNumElements(group_name, parameter_name) >= num_elements);
@@ -90,7 +91,7 @@ namespace scapes::visual
 		}
 
 		template<typename T>
-		SCAPES_INLINE bool setGroupParameter(const char *group_name, const char *parameter_name, const T &value)
+		SCAPES_INLINE bool setGroupParameter(foundation::StringID group_name, foundation::StringID parameter_name, const T &value)
 		{
 			return setGroupParameter<T>(group_name, parameter_name, 1, &value);
 		}
@@ -106,10 +107,10 @@ namespace scapes::visual
 		}
 
 	protected:
-		virtual size_t getGroupParameterElementSize(const char *group_name, const char *parameter_name) const = 0;
-		virtual size_t getGroupParameterNumElements(const char *group_name, const char *parameter_name) const = 0;
-		virtual const void *getGroupParameter(const char *group_name, const char *parameter_name, size_t index) const = 0;
-		virtual bool setGroupParameter(const char *group_name, const char *parameter_name, size_t dst_index, size_t num_src_elements, const void *src_data) = 0;
+		virtual size_t getGroupParameterElementSize(foundation::StringID group_name, foundation::StringID parameter_name) const = 0;
+		virtual size_t getGroupParameterNumElements(foundation::StringID group_name, foundation::StringID parameter_name) const = 0;
+		virtual const void *getGroupParameter(foundation::StringID group_name, foundation::StringID parameter_name, size_t index) const = 0;
+		virtual bool setGroupParameter(foundation::StringID group_name, foundation::StringID parameter_name, size_t dst_index, size_t num_src_elements, const void *src_data) = 0;
 	};
 
 	template <>
@@ -5,6 +5,7 @@
 #include <scapes/foundation/resources/ResourceManager.h>
 
 #include <scapes/visual/Fwd.h>
+#include <scapes/visual/GeometryArena.h>
 
 namespace scapes::visual
 {
@@ -22,15 +23,36 @@ namespace scapes::visual
 			foundation::math::vec2 uv;
 		};
 
+		enum
+		{
+			NUM_VERTEX_ATTRIBUTES = 6,
+		};
+
+		static SCAPES_API const hardware::VertexAttribute *getVertexAttributes();
+
 		uint32_t num_vertices {0};
 		Vertex *vertices {nullptr};
 
 		uint32_t num_indices {0};
 		uint32_t *indices {nullptr};
 
+		// local space bounds, recomputed every time vertices are flushed to GPU
+		foundation::math::vec3 aabb_min {0.0f};
+		foundation::math::vec3 aabb_max {0.0f};
+		foundation::math::vec3 sphere_center {0.0f};
+		float sphere_radius {0.0f};
+
+		// arena meshes share these with other meshes, their draws start at base_vertex and base_index
 		hardware::VertexBuffer vertex_buffer {SCAPES_NULL_HANDLE};
 		hardware::IndexBuffer index_buffer {SCAPES_NULL_HANDLE};
+		uint32_t base_vertex {0};
+		uint32_t base_index {0};
+
 		hardware::Device *device {nullptr};
+
+		// range allocated on the last flush, counts above may already differ from it
+		GeometryArena *arena {nullptr};
+		GeometryRange arena_range;
 	};
 
 	template <>
@@ -57,6 +79,15 @@ namespace scapes::visual
 			uint32_t num_indices,
 			uint32_t *indices
 		);
+		static SCAPES_API void create(
+			foundation::resources::ResourceManager *resource_manager,
+			void *memory,
+			GeometryArena *arena,
+			uint32_t num_vertices,
+			Mesh::Vertex *vertices,
+			uint32_t num_indices,
+			uint32_t *indices
+		);
 		static SCAPES_API foundation::resources::hash_t fetchHash(
 			foundation::resources::ResourceManager *resource_manager,
 			foundation::io::FileSystem *file_system,
@@ -77,5 +108,13 @@ namespace scapes::visual
 			foundation::resources::ResourceManager *resource_manager,
 			void *memory
 		);
+		static SCAPES_API size_t getCPUMemory(
+			foundation::resources::ResourceManager *resource_manager,
+			void *memory
+		);
+		static SCAPES_API size_t getGPUMemory(
+			foundation::resources::ResourceManager *resource_manager,
+			void *memory
+		);
 	};
 }
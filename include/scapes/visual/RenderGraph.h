@@ -1,6 +1,7 @@
 #pragma once
 
 #include <scapes/Common.h>
+#include <scapes/foundation/Hash.h>
 #include <scapes/foundation/TypeTraits.h>
 
 #include <scapes/visual/serde/Yaml.h>
@@ -44,6 +45,7 @@ namespace scapes::visual
 		virtual hardware::Device *getDevice() const = 0;
 		virtual shaders::Compiler *getCompiler() const = 0;
 		virtual foundation::game::World *getWorld() const = 0;
+		virtual foundation::jobs::JobSystem *getJobSystem() const = 0;
 		virtual MeshHandle getUnitQuad() const = 0;
 
 		virtual uint32_t getWidth() const = 0;
@@ -63,30 +65,30 @@ namespace scapes::visual
 		virtual const hardware::SwapChain getSwapChain() const = 0;
 
 		virtual bool addGroup(const char *name) = 0;
-		virtual bool removeGroup(const char *name) = 0;
+		virtual bool removeGroup(foundation::StringID name) = 0;
 		virtual void removeAllGroups() = 0;
 
-		virtual hardware::BindSet getGroupBindings(const char *name) const = 0;
+		virtual hardware::BindSet getGroupBindings(foundation::StringID name) const = 0;
 
 		virtual bool addGroupParameter(const char *group_name, const char *parameter_name, size_t element_size, size_t num_elements) = 0;
 		virtual bool addGroupParameter(const char *group_name, const char *parameter_name, GroupParameterType type, size_t num_elements) = 0;
-		virtual bool removeGroupParameter(const char *group_name, const char *parameter_name) = 0;
+		virtual bool removeGroupParameter(foundation::StringID group_name, foundation::StringID parameter_name) = 0;
 
 		virtual bool addGroupTexture(const char *group_name, const char *texture_name) = 0;
-		virtual bool removeGroupTexture(const char *group_name, const char *texture_name) = 0;
+		virtual bool removeGroupTexture(foundation::StringID group_name, foundation::StringID texture_name) = 0;
 
-		virtual TextureHandle getGroupTexture(const char *group_name, const char *texture_name) const = 0;
-		virtual bool setGroupTexture(const char *group_name, const char *texture_name, TextureHandle handle) = 0;
+		virtual TextureHandle getGroupTexture(foundation::StringID group_name, foundation::StringID texture_name) const = 0;
+		virtual bool setGroupTexture(foundation::StringID group_name, foundation::StringID texture_name, TextureHandle handle) = 0;
 
 		virtual bool addRenderBuffer(const char *name, hardware::Format format, uint32_t downscale) = 0;
-		virtual bool removeRenderBuffer(const char *name) = 0;
+		virtual bool removeRenderBuffer(foundation::StringID name) = 0;
 		virtual void removeAllRenderBuffers() = 0;
-		virtual bool swapRenderBuffers(const char *name0, const char *name1) = 0;
+		virtual bool swapRenderBuffers(foundation::StringID name0, foundation::StringID name1) = 0;
 
-		virtual hardware::Texture getRenderBufferTexture(const char *name) const = 0;
-		virtual hardware::BindSet getRenderBufferBindings(const char *name) const = 0;
-		virtual hardware::Format getRenderBufferFormat(const char *name) const = 0;
-		virtual uint32_t getRenderBufferDownscale(const char *name) const = 0;
+		virtual hardware::Texture getRenderBufferTexture(foundation::StringID name) const = 0;
+		virtual hardware::BindSet getRenderBufferBindings(foundation::StringID name) const = 0;
+		virtual hardware::Format getRenderBufferFormat(foundation::StringID name) const = 0;
+		virtual uint32_t getRenderBufferDownscale(foundation::StringID name) const = 0;
 
 		virtual hardware::FrameBuffer fetchFrameBuffer(uint32_t num_attachments, const char *render_buffer_names[]) = 0;
 
@@ -117,14 +119,14 @@ namespace scapes::visual
 		}
 
 		template<typename T>
-		SCAPES_INLINE T getGroupParameter(const char *group_name, const char *parameter_name) const
+		SCAPES_INLINE T getGroupParameter(foundation::StringID group_name, foundation::StringID parameter_name) const
 		{
 			const T *data = getGroupParameter<T>(group_name, parameter_name, 0);
 			return *data;
 		}
 
 		template<typename T>
-		SCAPES_INLINE const T *getGroupParameter(const char *group_name, const char *parameter_name, size_t index) const
+		SCAPES_INLINE const T *getGroupParameter(foundation::StringID group_name, foundation::StringID parameter_name, size_t index) const
 		{
 			assert(getGroupParameterElementSize(group_name, parameter_name) == sizeof(T));
 			assert(getGroupParameterNumElements(group_name, parameter_name) > index);
@@ -136,7 +138,7 @@ namespace scapes::visual
 		}
 
 		template<typename T>
-		SCAPES_INLINE bool setGroupParameter(const char *group_name, const char *parameter_name, size_t num_elements, const T *value)
+		SCAPES_INLINE bool setGroupParameter(foundation::StringID group_name, foundation::StringID parameter_name, size_t num_elements, const T *value)
 		{
 			assert(getGroupParameterElementSize(group_name, parameter_name) == sizeof(T));
 			assert(getGroupParameterNumElements(group_name, parameter_name) >= num_elements);
@@ -145,7 +147,7 @@ namespace scapes::visual
 		}
 
 		template<typename T>
-		SCAPES_INLINE bool setGroupParameter(const char *group_name, const char *parameter_name, const T &value)
+		SCAPES_INLINE bool setGroupParameter(foundation::StringID group_name, foundation::StringID parameter_name, const T &value)
 		{
 			return setGroupParameter<T>(group_name, parameter_name, 1, &value);
 		}
@@ -179,10 +181,10 @@ namespace scapes::visual
 		}
 
 	protected:
-		virtual size_t getGroupParameterElementSize(const char *group_name, const char *parameter_name) const = 0;
-		virtual size_t getGroupParameterNumElements(const char *group_name, const char *parameter_name) const = 0;
-		virtual const void *getGroupParameter(const char *group_name, const char *parameter_name, size_t index) const = 0;
-		virtual bool setGroupParameter(const char *group_name, const char *parameter_name, size_t dst_index, size_t num_src_elements, const void *src_data) = 0;
+		virtual size_t getGroupParameterElementSize(foundation::StringID group_name, foundation::StringID parameter_name) const = 0;
+		virtual size_t getGroupParameterNumElements(foundation::StringID group_name, foundation::StringID parameter_name) const = 0;
+		virtual const void *getGroupParameter(foundation::StringID group_name, foundation::StringID parameter_name, size_t index) const = 0;
+		virtual bool setGroupParameter(foundation::StringID group_name, foundation::StringID parameter_name, size_t dst_index, size_t num_src_elements, const void *src_data) = 0;
 
 		virtual IRenderPass *createRenderPass(const char *type_name, const char *name) = 0;
 
@@ -206,6 +208,7 @@ namespace scapes::visual
 			hardware::Device *device,
 			shaders::Compiler *compiler,
 			foundation::game::World *world,
+			foundation::jobs::JobSystem *job_system,
 			MeshHandle unit_quad
 		);
 		static SCAPES_API void destroy(
@@ -49,6 +49,17 @@ namespace scapes::visual
 			uint32_t mip_levels = 1,
 			uint32_t layers = 1
 		);
+		static SCAPES_API void create(
+			foundation::resources::ResourceManager *resource_manager,
+			void *memory,
+			hardware::Device *device,
+			hardware::Format format,
+			uint32_t width,
+			uint32_t height,
+			uint32_t mip_levels,
+			uint32_t layers,
+			const void *pixels
+		);
 		static SCAPES_API void destroy(
 			foundation::resources::ResourceManager *resource_manager,
 			void *memory
@@ -71,5 +82,23 @@ namespace scapes::visual
 			const uint8_t *data,
 			size_t size
 		);
+		static SCAPES_API bool decodeFromMemory(
+			foundation::resources::ResourceManager *resource_manager,
+			void *memory,
+			const uint8_t *data,
+			size_t size
+		);
+		static SCAPES_API void flushToGPU(
+			foundation::resources::ResourceManager *resource_manager,
+			void *memory
+		);
+		static SCAPES_API size_t getCPUMemory(
+			foundation::resources::ResourceManager *resource_manager,
+			void *memory
+		);
+		static SCAPES_API size_t getGPUMemory(
+			foundation::resources::ResourceManager *resource_manager,
+			void *memory
+		);
 	};
 }
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <scapes/Common.h>
+#include <scapes/visual/Fwd.h>
+
+namespace scapes::visual
+{
+	/* Derives components::Transform from components::LocalTransform and components::Parent.
+	 * Nodes are sorted by depth and updated one hierarchy level at a time, each level in parallel,
+	 * only dirty nodes and their subtrees are recomputed. Tracks changes of components::Parent,
+	 * reported Parent writes rebuild the hierarchy on the next update
+	 */
+	class TransformSystem
+	{
+	public:
+		static SCAPES_API TransformSystem *create(
+			foundation::game::World *world,
+			foundation::jobs::JobSystem *job_system
+		);
+		static SCAPES_API void destroy(TransformSystem *system);
+
+		virtual ~TransformSystem() { }
+
+	public:
+		virtual void update() = 0;
+	};
+}
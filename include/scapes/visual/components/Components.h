@@ -25,6 +25,35 @@ namespace scapes::visual::components
 		static constexpr const char *name = "scapes::visual::components::Transform";
 	};
 
+	/* Relative to the parent, or to the world for entities without Parent,
+	 * set dirty after changing it so TransformSystem updates Transform of the whole subtree
+	 */
+	struct LocalTransform
+	{
+		foundation::math::mat4 transform;
+		bool dirty {true};
+	};
+
+	template<>
+	struct ::TypeTraits<LocalTransform>
+	{
+		static constexpr const char *name = "scapes::visual::components::LocalTransform";
+	};
+
+	/* Writing entity in place moves the node under another parent,
+	 * report it with World::markChanged<Parent>() so TransformSystem picks it up
+	 */
+	struct Parent
+	{
+		foundation::game::EntityID *entity {nullptr};
+	};
+
+	template<>
+	struct ::TypeTraits<Parent>
+	{
+		static constexpr const char *name = "scapes::visual::components::Parent";
+	};
+
 	/*
 	 */
 	struct SkyLight
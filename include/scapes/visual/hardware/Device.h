@@ -212,6 +212,14 @@ namespace scapes::visual::hardware
 		PREFER_FAST_BUILD,
 	};
 
+	enum class VertexInputRate : uint8_t
+	{
+		VERTEX = 0,
+		INSTANCE,
+
+		MAX,
+	};
+
 	enum class CullMode : uint8_t
 	{
 		NONE = 0,
@@ -261,9 +269,11 @@ namespace scapes::visual::hardware
 	typedef struct RenderPass_t *RenderPass;
 	typedef struct CommandBuffer_t *CommandBuffer;
 	typedef struct UniformBuffer_t *UniformBuffer;
+	typedef struct StorageBuffer_t *StorageBuffer;
 	typedef struct Shader_t *Shader;
 	typedef struct BindSet_t *BindSet;
 	typedef struct GraphicsPipeline_t *GraphicsPipeline;
+	typedef struct ComputePipeline_t *ComputePipeline;
 	typedef struct RayTracePipeline_t *RayTracePipeline;
 	typedef struct BottomLevelAccelerationStructure_t *BottomLevelAccelerationStructure;
 	typedef struct TopLevelAccelerationStructure_t *TopLevelAccelerationStructure;
@@ -329,6 +339,24 @@ namespace scapes::visual::hardware
 		float transform[16];
 	};
 
+	// same layout as the command read by indirect draws, so storage buffers can be filled by shaders
+	struct DrawIndexedIndirectCommand
+	{
+		uint32_t num_indices {0};
+		uint32_t num_instances {0};
+		uint32_t base_index {0};
+		int32_t base_vertex {0};
+		uint32_t base_instance {0};
+	};
+
+	// same layout as the arguments read by indirect dispatches
+	struct DispatchIndirectCommand
+	{
+		uint32_t num_groups_x {0};
+		uint32_t num_groups_y {0};
+		uint32_t num_groups_z {0};
+	};
+
 	struct AccelerationStructureInstance
 	{
 		BottomLevelAccelerationStructure blas {SCAPES_NULL_HANDLE};
@@ -446,6 +474,13 @@ namespace scapes::visual::hardware
 			const void *data = nullptr
 		) = 0;
 
+		// can also be used as a source of indirect draw commands
+		virtual StorageBuffer createStorageBuffer(
+			BufferType type,
+			uint32_t size,
+			const void *data = nullptr
+		) = 0;
+
 		virtual Shader createShaderFromSource(
 			ShaderType type,
 			uint32_t size,
@@ -466,6 +501,9 @@ namespace scapes::visual::hardware
 		virtual GraphicsPipeline createGraphicsPipeline(
 		) = 0;
 
+		virtual ComputePipeline createComputePipeline(
+		) = 0;
+
 		virtual BottomLevelAccelerationStructure createBottomLevelAccelerationStructure(
 			uint32_t num_geometries,
 			const AccelerationStructureGeometry *geometries
@@ -491,9 +529,11 @@ namespace scapes::visual::hardware
 		virtual void destroyRenderPass(RenderPass render_pass) = 0;
 		virtual void destroyCommandBuffer(CommandBuffer command_buffer) = 0;
 		virtual void destroyUniformBuffer(UniformBuffer uniform_buffer) = 0;
+		virtual void destroyStorageBuffer(StorageBuffer storage_buffer) = 0;
 		virtual void destroyShader(Shader shader) = 0;
 		virtual void destroyBindSet(BindSet bind_set) = 0;
 		virtual void destroyGraphicsPipeline(GraphicsPipeline pipeline) = 0;
+		virtual void destroyComputePipeline(ComputePipeline pipeline) = 0;
 		virtual void destroyBottomLevelAccelerationStructure(BottomLevelAccelerationStructure acceleration_structure) = 0;
 		virtual void destroyTopLevelAccelerationStructure(TopLevelAccelerationStructure acceleration_structure) = 0;
 		virtual void destroyRayTracePipeline(RayTracePipeline pipeline) = 0;
@@ -516,11 +556,19 @@ namespace scapes::visual::hardware
 		virtual void *map(IndexBuffer index_buffer) = 0;
 		virtual void unmap(IndexBuffer index_buffer) = 0;
 
+		// overwrites a range of an existing buffer, static buffers go through a staging copy
+		virtual void update(VertexBuffer vertex_buffer, uint32_t first_vertex, uint32_t num_vertices, const void *data) = 0;
+		virtual void update(IndexBuffer index_buffer, uint32_t first_index, uint32_t num_indices, const void *data) = 0;
+
 		virtual void *map(UniformBuffer uniform_buffer) = 0;
 		virtual void unmap(UniformBuffer uniform_buffer) = 0;
 
+		virtual void *map(StorageBuffer storage_buffer) = 0;
+		virtual void unmap(StorageBuffer storage_buffer) = 0;
+
 		virtual void flush(BindSet bind_set) = 0;
 		virtual void flush(GraphicsPipeline pipeline) = 0;
+		virtual void flush(ComputePipeline pipeline) = 0;
 		virtual void flush(RayTracePipeline pipeline) = 0;
 
 	public:
@@ -548,6 +596,12 @@ namespace scapes::visual::hardware
 			UniformBuffer uniform_buffer
 		) = 0;
 
+		virtual void bindStorageBuffer(
+			BindSet bind_set,
+			uint32_t binding,
+			StorageBuffer storage_buffer
+		) = 0;
+
 		virtual void bindTexture(
 			BindSet bind_set,
 			uint32_t binding,
@@ -576,6 +630,33 @@ namespace scapes::visual::hardware
 			Texture texture
 		) = 0;
 
+	public:
+		// compute pipeline state
+		virtual void clearPushConstants(
+			ComputePipeline pipeline
+		) = 0;
+
+		virtual void setPushConstants(
+			ComputePipeline pipeline,
+			uint8_t size,
+			const void *data
+		) = 0;
+
+		virtual void clearBindSets(
+			ComputePipeline pipeline
+		) = 0;
+
+		virtual void setBindSet(
+			ComputePipeline pipeline,
+			uint8_t binding,
+			BindSet bind_set
+		) = 0;
+
+		virtual void setShader(
+			ComputePipeline pipeline,
+			Shader shader
+		) = 0;
+
 	public:
 		// raytrace pipeline state
 		virtual void clearBindSets(
@@ -656,8 +737,8 @@ namespace scapes::visual::hardware
 		virtual void setVertexStream(
 			GraphicsPipeline pipeline,
 			uint8_t binding,
-			VertexBuffer vertex_buffer
-			// TODO: vertex stream usage (per vertex or per instance)
+			VertexBuffer vertex_buffer,
+			VertexInputRate input_rate = VertexInputRate::VERTEX
 		) = 0;
 
 		virtual void setViewport(
@@ -769,6 +850,47 @@ namespace scapes::visual::hardware
 			uint32_t base_instance = 0
 		) = 0;
 
+		// commands are DrawIndexedIndirectCommand structs placed at offset with a stride of their size
+		virtual void drawIndexedIndirect(
+			CommandBuffer command_buffer,
+			GraphicsPipeline pipeline,
+			IndexBuffer index_buffer,
+			StorageBuffer commands,
+			uint32_t offset,
+			uint32_t num_draws
+		) = 0;
+
+		// number of draws is read on GPU from count_buffer at count_offset and clamped to max_draws
+		virtual void drawIndexedIndirectCount(
+			CommandBuffer command_buffer,
+			GraphicsPipeline pipeline,
+			IndexBuffer index_buffer,
+			StorageBuffer commands,
+			uint32_t offset,
+			StorageBuffer count_buffer,
+			uint32_t count_offset,
+			uint32_t max_draws
+		) = 0;
+
+		// must be recorded outside of render passes, shader writes are made visible
+		// to indirect draws and shaders of the commands recorded after it,
+		// storage images stay in their own layout before and after the dispatch
+		virtual void dispatch(
+			CommandBuffer command_buffer,
+			ComputePipeline pipeline,
+			uint32_t num_groups_x,
+			uint32_t num_groups_y = 1,
+			uint32_t num_groups_z = 1
+		) = 0;
+
+		// group counts are a DispatchIndirectCommand struct placed at offset, may be written by a previous dispatch
+		virtual void dispatchIndirect(
+			CommandBuffer command_buffer,
+			ComputePipeline pipeline,
+			StorageBuffer commands,
+			uint32_t offset
+		) = 0;
+
 		virtual void traceRays(
 			CommandBuffer command_buffer,
 			RayTracePipeline pipeline,
@@ -1,12 +1,15 @@
 #include "Application.h"
 #include "ApplicationResources.h"
 #include "IO.h"
+#include "PackFileSystem.h"
 
 #include <scapes/visual/shaders/Compiler.h>
 #include <scapes/visual/hardware/Device.h>
 
 #include <scapes/visual/components/Components.h>
+#include <scapes/visual/GeometryArena.h>
 #include <scapes/visual/RenderGraph.h>
+#include <scapes/visual/TransformSystem.h>
 
 #include "SwapChain.h"
 #include "RenderPasses.h"
@@ -23,6 +26,39 @@
 
 using namespace scapes;
 
+namespace config
+{
+	// built by the packer tool, relative to the assets folder
+	static const char *assets_pack = "assets.pack";
+
+	// the compute graph runs Tonemap as RenderPassCompute, opt in with USE_COMPUTE_RENDER_GRAPH
+#if defined(SCAPES_COMPUTE_RENDER_GRAPH)
+	static const char *render_graph_path = "shaders/render_graph/schema_compute.yaml";
+#else
+	static const char *render_graph_path = "shaders/render_graph/schema.yaml";
+#endif
+
+	// geometry arena page, ~19 MB of vertices and 4 MB of indices
+	static constexpr uint32_t geometry_page_vertices = 256 * 1024;
+	static constexpr uint32_t geometry_page_indices = 1024 * 1024;
+}
+
+namespace ids
+{
+	// hashed at compile time, used for per-frame group parameter updates
+	static constexpr foundation::StringID camera = "Camera";
+	static constexpr foundation::StringID camera_view = "View";
+	static constexpr foundation::StringID camera_iview = "IView";
+	static constexpr foundation::StringID camera_projection = "Projection";
+	static constexpr foundation::StringID camera_iprojection = "IProjection";
+	static constexpr foundation::StringID camera_parameters = "Parameters";
+	static constexpr foundation::StringID camera_position = "PositionWS";
+	static constexpr foundation::StringID camera_view_old = "ViewOld";
+
+	static constexpr foundation::StringID application = "Application";
+	static constexpr foundation::StringID application_time = "Time";
+}
+
 /* TODO: remove later
  */
 scapes::visual::hardware::BottomLevelAccelerationStructure rt_blas = SCAPES_NULL_HANDLE;
@@ -226,18 +262,18 @@ void Application::update()
 
 	application_state.current_temporal_frame = (application_state.current_temporal_frame + 1) % ApplicationState::MAX_TEMPORAL_FRAMES;
 
-	render_graph->setGroupParameter("Camera", "View", view);
-	render_graph->setGroupParameter("Camera", "IView", foundation::math::inverse(view));
-	render_graph->setGroupParameter("Camera", "Projection", projection);
-	render_graph->setGroupParameter("Camera", "IProjection", foundation::math::inverse(projection));
-	render_graph->setGroupParameter("Camera", "Parameters", camera_parameters);
-	render_graph->setGroupParameter("Camera", "PositionWS", camera_position);
+	render_graph->setGroupParameter(ids::camera, ids::camera_view, view);
+	render_graph->setGroupParameter(ids::camera, ids::camera_iview, foundation::math::inverse(view));
+	render_graph->setGroupParameter(ids::camera, ids::camera_projection, projection);
+	render_graph->setGroupParameter(ids::camera, ids::camera_iprojection, foundation::math::inverse(projection));
+	render_graph->setGroupParameter(ids::camera, ids::camera_parameters, camera_parameters);
+	render_graph->setGroupParameter(ids::camera, ids::camera_position, camera_position);
 
-	render_graph->setGroupParameter("Application", "Time", time);
+	render_graph->setGroupParameter(ids::application, ids::application_time, time);
 
 	if (application_state.first_frame)
 	{
-		render_graph->setGroupParameter<foundation::math::mat4>("Camera", "ViewOld", view);
+		render_graph->setGroupParameter<foundation::math::mat4>(ids::camera, ids::camera_view_old, view);
 		application_state.first_frame = false;
 	}
 
@@ -321,6 +357,20 @@ void Application::update()
 
 	//
 	ImGui::Text("Application average %.3f ms/frame (%.1f FPS)", 1000.0f / ImGui::GetIO().Framerate, ImGui::GetIO().Framerate);
+
+	RenderPassGeometry *geometry_pass = render_graph->getRenderPass<RenderPassGeometry>("GBuffer");
+	if (geometry_pass)
+	{
+		bool gpu_driven = geometry_pass->isGPUDriven();
+		if (ImGui::Checkbox("GPU Driven GBuffer", &gpu_driven))
+			geometry_pass->setGPUDriven(gpu_driven);
+
+		if (geometry_pass->isGPUDriven())
+			ImGui::Text("GBuffer: %u indirect draws, %u submitted, %u uploaded, culled on GPU", geometry_pass->getNumDrawCalls(), geometry_pass->getNumInstances(), geometry_pass->getNumUploadedInstances());
+		else
+			ImGui::Text("GBuffer: %u draw calls, %u drawn, %u culled", geometry_pass->getNumDrawCalls(), geometry_pass->getNumInstances(), geometry_pass->getNumCulled());
+	}
+
 	ImGui::End();
 
 	ImGui::Begin("RT");
@@ -367,15 +417,131 @@ void Application::update()
 
 	ImGui::End();
 
+	updateResourceStats();
+
 	if (reset_environment)
 	{
 		visual::components::SkyLight &comp = sky_light.getComponent<visual::components::SkyLight>();
 		comp.ibl_environment = application_resources->getIBLTexture(application_state.current_environment);
 	}
 
+	job_system->update();
+	transform_system->update();
 	resource_manager->update(0.0f);
 }
 
+void Application::updateResourceStats()
+{
+	constexpr float mb = 1.0f / (1024.0f * 1024.0f);
+
+	ImGui::Begin("Resources");
+
+	foundation::resources::MemoryUsage usage = resource_manager->getMemoryUsage();
+	ImGui::Text("%u resources (%u cached), CPU %.1f MB, GPU %.1f MB", usage.num_resources, usage.num_evictable, usage.cpu_bytes * mb, usage.gpu_bytes * mb);
+	ImGui::Text("Geometry arena: %u meshes in %u pages, %.1f / %.1f MB", geometry_arena->getNumAllocations(), geometry_arena->getNumPages(), geometry_arena->getUsedGPUMemory() * mb, geometry_arena->getGPUMemory() * mb);
+
+	std::vector<foundation::resources::ResourceTypeStats> stats;
+	resource_manager->getResourceStats(stats);
+
+	std::sort(stats.begin(), stats.end(),
+		[](const foundation::resources::ResourceTypeStats &a, const foundation::resources::ResourceTypeStats &b)
+		{
+			return strcmp(a.type_name, b.type_name) < 0;
+		}
+	);
+
+	const ImGuiTableFlags table_flags = ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_Resizable;
+
+	if (ImGui::BeginTable("Types", 11, table_flags))
+	{
+		const char *columns[] = { "Type", "Live", "Pages", "Pool MB", "CPU MB", "GPU MB", "Loads", "Failed", "Reloads", "Total ms", "Max ms" };
+		for (const char *column : columns)
+			ImGui::TableSetupColumn(column);
+
+		ImGui::TableHeadersRow();
+
+		for (const foundation::resources::ResourceTypeStats &type_stats : stats)
+		{
+			ImGui::TableNextRow();
+
+			ImGui::TableNextColumn(); ImGui::TextUnformatted(type_stats.type_name);
+			ImGui::TableNextColumn(); ImGui::Text("%u", type_stats.num_resources);
+			ImGui::TableNextColumn(); ImGui::Text("%u", type_stats.num_pool_pages);
+			ImGui::TableNextColumn(); ImGui::Text("%.2f", type_stats.pool_bytes * mb);
+			ImGui::TableNextColumn(); ImGui::Text("%.2f", type_stats.cpu_bytes * mb);
+			ImGui::TableNextColumn(); ImGui::Text("%.2f", type_stats.gpu_bytes * mb);
+			ImGui::TableNextColumn(); ImGui::Text("%u", type_stats.num_loads);
+			ImGui::TableNextColumn(); ImGui::Text("%u", type_stats.num_failed_loads);
+			ImGui::TableNextColumn(); ImGui::Text("%u", type_stats.num_reloads);
+			ImGui::TableNextColumn(); ImGui::Text("%.2f", type_stats.total_load_time);
+			ImGui::TableNextColumn(); ImGui::Text("%.2f", type_stats.max_load_time);
+		}
+
+		ImGui::EndTable();
+	}
+
+	if (ImGui::CollapsingHeader("Load Timeline"))
+	{
+		std::vector<foundation::resources::ResourceLoadEvent> events;
+		resource_manager->getLoadTimeline(events);
+
+		ImGui::Checkbox("Slowest first", &sort_load_timeline);
+		ImGui::SameLine();
+
+		if (ImGui::Button("Clear"))
+			resource_manager->clearLoadTimeline();
+
+		if (sort_load_timeline)
+		{
+			std::sort(events.begin(), events.end(),
+				[](const foundation::resources::ResourceLoadEvent &a, const foundation::resources::ResourceLoadEvent &b)
+				{
+					return a.total_time > b.total_time;
+				}
+			);
+		}
+
+		if (ImGui::BeginTable("Timeline", 8, table_flags | ImGuiTableFlags_ScrollY, ImVec2(0.0f, 300.0f)))
+		{
+			const char *columns[] = { "Start ms", "Total ms", "IO ms", "Decode ms", "Commit ms", "Type", "Kind", "URI" };
+			for (const char *column : columns)
+				ImGui::TableSetupColumn(column);
+
+			ImGui::TableSetupScrollFreeze(0, 1);
+			ImGui::TableHeadersRow();
+
+			ImGuiListClipper clipper;
+			clipper.Begin(static_cast<int>(events.size()));
+
+			while (clipper.Step())
+			{
+				for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; ++i)
+				{
+					const foundation::resources::ResourceLoadEvent &event = events[i];
+
+					const char *kind = (event.reload) ? "reload" : (event.async) ? "async" : "sync";
+					const char *uri = (event.uri.empty()) ? "(memory)" : event.uri.c_str();
+
+					ImGui::TableNextRow();
+
+					ImGui::TableNextColumn(); ImGui::Text("%.2f", event.start_time);
+					ImGui::TableNextColumn(); ImGui::Text("%.2f", event.total_time);
+					ImGui::TableNextColumn(); ImGui::Text("%.2f", event.io_time);
+					ImGui::TableNextColumn(); ImGui::Text("%.2f", event.decode_time);
+					ImGui::TableNextColumn(); ImGui::Text("%.2f", event.commit_time);
+					ImGui::TableNextColumn(); ImGui::TextUnformatted(event.type_name);
+					ImGui::TableNextColumn(); ImGui::Text("%s%s", kind, (event.success) ? "" : " (failed)");
+					ImGui::TableNextColumn(); ImGui::TextUnformatted(uri);
+				}
+			}
+
+			ImGui::EndTable();
+		}
+	}
+
+	ImGui::End();
+}
+
 /*
  */
 void Application::render()
@@ -403,8 +569,8 @@ void Application::render()
 
 void Application::postRender()
 {
-	const foundation::math::mat4 &view = render_graph->getGroupParameter<foundation::math::mat4>("Camera", "View");
-	render_graph->setGroupParameter<foundation::math::mat4>("Camera", "ViewOld", view);
+	const foundation::math::mat4 &view = render_graph->getGroupParameter<foundation::math::mat4>(ids::camera, ids::camera_view);
+	render_graph->setGroupParameter<foundation::math::mat4>(ids::camera, ids::camera_view_old, view);
 }
 
 /*
@@ -512,15 +678,24 @@ void Application::onScroll(GLFWwindow *window, double delta_x, double delta_y)
  */
 void Application::initRenderScene()
 {
+	job_system = foundation::jobs::JobSystem::create();
+
+	if (pack_file_system)
+		pack_file_system->setJobSystem(job_system);
+
 	resource_manager = foundation::resources::ResourceManager::create(file_system);
 
 	world = foundation::game::World::create();
+	transform_system = visual::TransformSystem::create(world, job_system);
+
+	geometry_arena = visual::GeometryArena::create(device, config::geometry_page_vertices, config::geometry_page_indices);
 
 	application_resources = new ApplicationResources(
 		resource_manager,
 		device,
 		compiler,
-		world
+		world,
+		geometry_arena
 	);
 	application_resources->init();
 
@@ -535,11 +710,25 @@ void Application::shutdownRenderScene()
 	delete application_resources;
 	application_resources = nullptr;
 
+	// render graph passes keep world queries, it goes away with the resource manager
+	foundation::resources::ResourceManager::destroy(resource_manager);
+	resource_manager = nullptr;
+
+	// meshes hand their ranges back when the resource manager goes away
+	visual::GeometryArena::destroy(geometry_arena);
+	geometry_arena = nullptr;
+
+	visual::TransformSystem::destroy(transform_system);
+	transform_system = nullptr;
+
 	foundation::game::World::destroy(world);
 	world = nullptr;
 
-	foundation::resources::ResourceManager::destroy(resource_manager);
-	resource_manager = nullptr;
+	if (pack_file_system)
+		pack_file_system->setJobSystem(nullptr);
+
+	foundation::jobs::JobSystem::destroy(job_system);
+	job_system = nullptr;
 }
 
 /*
@@ -548,16 +737,18 @@ void Application::initRenderers()
 {
 	scapes::visual::RenderGraph::registerRenderPassType<RenderPassPrepareOld>();
 	scapes::visual::RenderGraph::registerRenderPassType<RenderPassGeometry>();
+	scapes::visual::RenderGraph::registerRenderPassType<RenderPassCompute>();
 	scapes::visual::RenderGraph::registerRenderPassType<RenderPassLBuffer>();
 	scapes::visual::RenderGraph::registerRenderPassType<RenderPassPost>();
 	scapes::visual::RenderGraph::registerRenderPassType<RenderPassImGui>();
 	scapes::visual::RenderGraph::registerRenderPassType<RenderPassSwapRenderBuffers>();
 
 	render_graph = resource_manager->load<visual::RenderGraph>(
-		"shaders/render_graph/schema.yaml",
+		config::render_graph_path,
 		device,
 		compiler,
 		world,
+		job_system,
 		application_resources->getUnitQuad()
 	);
 
@@ -651,7 +842,22 @@ void Application::shutdownImGui()
  */
 void Application::initDriver()
 {
-	file_system = new ApplicationFileSystem("assets/");
+	loose_file_system = new ApplicationFileSystem("assets/");
+	file_system = loose_file_system;
+
+	// pack is optional, loose files are still used for everything it doesn't contain
+	if (loose_file_system->mtime(config::assets_pack) != 0)
+	{
+		pack_file_system = new PackFileSystem(loose_file_system, config::assets_pack);
+
+		if (pack_file_system->isLoaded())
+			file_system = pack_file_system;
+		else
+		{
+			delete pack_file_system;
+			pack_file_system = nullptr;
+		}
+	}
 
 	device = scapes::visual::hardware::Device::create("PBR Sandbox", "Scape", scapes::visual::hardware::Api::VULKAN);
 	compiler = visual::shaders::Compiler::create(visual::shaders::ShaderILType::SPIRV, file_system);
@@ -665,8 +871,12 @@ void Application::shutdownDriver()
 	visual::shaders::Compiler::destroy(compiler);
 	compiler = nullptr;
 
-	delete file_system;
+	delete pack_file_system;
+	delete loose_file_system;
+
 	file_system = nullptr;
+	pack_file_system = nullptr;
+	loose_file_system = nullptr;
 }
 
 /*
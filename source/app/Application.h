@@ -5,10 +5,12 @@
 #include <scapes/foundation/math/Math.h>
 #include <scapes/foundation/game/World.h>
 #include <scapes/foundation/game/Entity.h>
+#include <scapes/foundation/jobs/JobSystem.h>
 #include <scapes/visual/RenderGraph.h>
 
 struct GLFWwindow;
 class ApplicationFileSystem;
+class PackFileSystem;
 class ApplicationResources;
 class SwapChain;
 class RenderPassImGui;
@@ -73,6 +75,7 @@ private:
 	void shutdownImGui();
 
 	void update();
+	void updateResourceStats();
 	void render();
 	void postRender();
 	void mainloop();
@@ -92,7 +95,9 @@ private:
 	scapes::foundation::game::Entity camera;
 
 	ApplicationResources *application_resources {nullptr};
-	ApplicationFileSystem *file_system {nullptr};
+	ApplicationFileSystem *loose_file_system {nullptr};
+	PackFileSystem *pack_file_system {nullptr};
+	scapes::foundation::io::FileSystem *file_system {nullptr};
 
 	ApplicationState application_state;
 	CameraState camera_state;
@@ -104,7 +109,12 @@ private:
 	scapes::visual::hardware::Device *device {nullptr};
 	scapes::visual::shaders::Compiler *compiler {nullptr};
 	scapes::foundation::game::World *world {nullptr};
+	scapes::foundation::jobs::JobSystem *job_system {nullptr};
+	scapes::visual::TransformSystem *transform_system {nullptr};
+	scapes::visual::GeometryArena *geometry_arena {nullptr};
 	scapes::foundation::resources::ResourceManager *resource_manager {nullptr};
 
 	scapes::visual::RenderGraphHandle render_graph;
+
+	bool sort_load_timeline {true};
 };
@@ -4,7 +4,9 @@
 #include <scapes/visual/GlbImporter.h>
 
 #include <cassert>
+#include <filesystem>
 #include <iostream>
+#include <string>
 
 namespace config
 {
@@ -50,6 +52,13 @@ namespace config
 
 	// Materials
 	static const char *default_material_path = "materials/default.mat";
+
+	// Decoded glTF scenes, relative to the working directory so they stay out of the watched assets folder
+	static const char *glb_cache_path = "cache/glb";
+
+	// Memory budgets
+	static constexpr size_t texture_cpu_budget = 256 * 1024 * 1024;
+	static constexpr size_t texture_gpu_budget = 512 * 1024 * 1024;
 }
 
 /*
@@ -71,16 +80,22 @@ ApplicationResources::~ApplicationResources()
  */
 void ApplicationResources::init()
 {
+	resource_manager->setMemoryBudget<scapes::visual::Texture>(config::texture_cpu_budget, config::texture_gpu_budget);
+
 	unit_quad = generateMeshQuad(2.0f);
 	unit_cube = generateMeshCube(2.0f);
 
-	default_material = resource_manager->load<scapes::visual::Material>(config::default_material_path, device, compiler);
-	default_material->flush();
+	// kick off file reads and image decoding early, fetch() calls below wait for pending resources
+	std::vector<scapes::visual::TextureHandle> prefetched_textures;
+	prefetched_textures.reserve(config::ibl_textures.size());
+
+	for (int i = 0; i < config::ibl_textures.size(); ++i)
+		prefetched_textures.push_back(resource_manager->fetchAsync<scapes::visual::Texture>(config::ibl_textures[i], device));
 
 	loaded_shaders.reserve(config::shaders.size());
 	for (int i = 0; i < config::shaders.size(); ++i)
 	{
-		scapes::visual::ShaderHandle shader = resource_manager->fetch<scapes::visual::Shader>(
+		scapes::visual::ShaderHandle shader = resource_manager->fetchAsync<scapes::visual::Shader>(
 			config::shaders[i],
 			config::shader_types[i],
 			device,
@@ -90,6 +105,12 @@ void ApplicationResources::init()
 		loaded_shaders.push_back(shader);
 	}
 
+	default_material = resource_manager->load<scapes::visual::Material>(config::default_material_path, device, compiler);
+	default_material->flush();
+
+	for (scapes::visual::ShaderHandle shader : loaded_shaders)
+		resource_manager->wait(shader);
+
 	scapes::visual::HdriImporter::CreateOptions options = {};
 	options.resource_manager = resource_manager;
 	options.world = world;
@@ -117,7 +138,19 @@ void ApplicationResources::init()
 		loaded_ibl_textures.push_back(ibl_texture);
 	}
 
-	glb_importer = scapes::visual::GlbImporter::create(resource_manager, world, device);
+	for (scapes::visual::TextureHandle texture : prefetched_textures)
+		resource_manager->release(texture);
+
+	std::error_code error;
+	std::filesystem::path glb_cache_path = std::filesystem::absolute(std::filesystem::u8path(config::glb_cache_path), error);
+
+	if (!error)
+		std::filesystem::create_directories(glb_cache_path, error);
+
+	// import still works without the cache, it just decodes every time
+	std::string glb_cache = (error) ? std::string() : glb_cache_path.generic_u8string();
+
+	glb_importer = scapes::visual::GlbImporter::create(resource_manager, world, device, geometry_arena, glb_cache.empty() ? nullptr : glb_cache.c_str());
 	glb_importer->import("scenes/sphere.glb", default_material);
 }
 
@@ -160,7 +193,7 @@ scapes::visual::MeshHandle ApplicationResources::generateMeshQuad(float size)
 		1, 0, 2, 3, 2, 0,
 	};
 
-	return resource_manager->create<scapes::visual::Mesh>(device, num_vertices, vertices, num_indices, indices);
+	return resource_manager->create<scapes::visual::Mesh>(geometry_arena, num_vertices, vertices, num_indices, indices);
 }
 
 scapes::visual::MeshHandle ApplicationResources::generateMeshCube(float size)
@@ -192,5 +225,5 @@ scapes::visual::MeshHandle ApplicationResources::generateMeshCube(float size)
 		4, 0, 3, 3, 7, 4, // -z
 	};
 
-	return resource_manager->create<scapes::visual::Mesh>(device, num_vertices, vertices, num_indices, indices);
+	return resource_manager->create<scapes::visual::Mesh>(geometry_arena, num_vertices, vertices, num_indices, indices);
 }
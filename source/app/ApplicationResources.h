@@ -17,9 +17,10 @@ public:
 		scapes::foundation::resources::ResourceManager *resource_manager,
 		scapes::visual::hardware::Device *device,
 		scapes::visual::shaders::Compiler *compiler,
-		scapes::foundation::game::World *world
+		scapes::foundation::game::World *world,
+		scapes::visual::GeometryArena *geometry_arena
 	)
-		: resource_manager(resource_manager), device(device), compiler(compiler), world(world)
+		: resource_manager(resource_manager), device(device), compiler(compiler), world(world), geometry_arena(geometry_arena)
 	{ }
 
 	virtual ~ApplicationResources();
@@ -42,6 +43,7 @@ private:
 	scapes::visual::hardware::Device *device {nullptr};
 	scapes::visual::shaders::Compiler *compiler {nullptr};
 	scapes::foundation::game::World *world {nullptr};
+	scapes::visual::GeometryArena *geometry_arena {nullptr};
 
 	scapes::visual::MeshHandle unit_quad;
 	scapes::visual::MeshHandle unit_cube;
@@ -0,0 +1,568 @@
+#include "AsyncReader.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+#if defined(_WIN32)
+	#define WIN32_LEAN_AND_MEAN
+	#define NOMINMAX
+	#include <windows.h>
+#else
+	#include <cerrno>
+	#include <fcntl.h>
+	#include <unistd.h>
+#endif
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+	#define SCAPES_IO_URING
+	#include <linux/io_uring.h>
+	#include <sys/mman.h>
+	#include <sys/syscall.h>
+#endif
+
+/*
+ */
+struct AsyncReader::Ring
+{
+	int fd {-1};
+	uint32_t num_submitted {0};
+
+#if defined(SCAPES_IO_URING)
+	void *sq_memory {nullptr};
+	size_t sq_memory_size {0};
+	void *cq_memory {nullptr};
+	size_t cq_memory_size {0};
+
+	io_uring_sqe *sqes {nullptr};
+	size_t sqes_size {0};
+
+	unsigned *sq_head {nullptr};
+	unsigned *sq_tail {nullptr};
+	unsigned *sq_mask {nullptr};
+	unsigned *sq_array {nullptr};
+
+	unsigned *cq_head {nullptr};
+	unsigned *cq_tail {nullptr};
+	unsigned *cq_mask {nullptr};
+	io_uring_cqe *cqes {nullptr};
+#endif
+};
+
+/*
+ */
+AsyncReader::AsyncReader(uint32_t queue_depth)
+	: queue_depth(std::max(1U, queue_depth))
+{
+	if (initRing())
+		return;
+
+	workers_running = true;
+
+	for (uint32_t i = 0; i < NUM_WORKERS; ++i)
+		workers.emplace_back(&AsyncReader::workerLoop, this);
+}
+
+AsyncReader::~AsyncReader()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		workers_running = false;
+	}
+
+	pending_changed.notify_all();
+
+	for (std::thread &worker : workers)
+		worker.join();
+
+	workers.clear();
+
+	// the kernel may still write into request buffers
+	if (ring)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+
+		while (ring->num_submitted > 0)
+		{
+			waitRing();
+			reapRing();
+		}
+	}
+
+	shutdownRing();
+
+	for (Request *request : pending)
+		completed.push_back(request);
+
+	for (Request *request : completed)
+	{
+#if !defined(_WIN32)
+		if (request->fd != -1)
+			::close(request->fd);
+#endif
+		delete request;
+	}
+
+	pending.clear();
+	completed.clear();
+}
+
+/*
+ */
+bool AsyncReader::submit(const std::filesystem::path &path, uint64_t offset, size_t size, void *data, scapes::foundation::io::ReadCallback callback, void *user_data)
+{
+	assert(data || size == 0);
+
+	Request *request = new Request();
+	request->path = path;
+	request->offset = offset;
+	request->size = size;
+	request->data = reinterpret_cast<uint8_t *>(data);
+	request->callback = callback;
+	request->user_data = user_data;
+
+	// open on the calling thread so missing files are reported right away
+#if !defined(_WIN32)
+	request->fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+	if (request->fd == -1)
+	{
+		delete request;
+		return false;
+	}
+#else
+	if (!std::filesystem::is_regular_file(path))
+	{
+		delete request;
+		return false;
+	}
+#endif
+
+	std::lock_guard<std::mutex> lock(mutex);
+	num_in_flight++;
+
+	if (!ring)
+	{
+		pending.push_back(request);
+		pending_changed.notify_one();
+		return true;
+	}
+
+	if (ring->num_submitted < queue_depth && pending.empty())
+		submitRing(request);
+	else
+		pending.push_back(request);
+
+	return true;
+}
+
+uint32_t AsyncReader::fetch()
+{
+	// several threads may fetch at once, i.e. the main loop and a thread waiting for a resource
+	std::vector<Request *> fetched;
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+
+		if (ring && !ring_waiting)
+			reapRing();
+
+		std::swap(completed, fetched);
+	}
+
+	// callbacks may submit new reads
+	for (Request *request : fetched)
+	{
+		if (request->callback)
+			request->callback(request->data, request->bytes_read, request->success, request->user_data);
+
+		delete request;
+	}
+
+	return static_cast<uint32_t>(fetched.size());
+}
+
+void AsyncReader::wait()
+{
+	while (true)
+	{
+		fetch();
+
+		std::unique_lock<std::mutex> lock(mutex);
+
+		if (num_in_flight == 0 && completed.empty())
+			break;
+
+		if (!completed.empty())
+			continue;
+
+		// block in the kernel without the mutex, so submit() and fetch() from other threads go on
+		if (ring && !ring_waiting && ring->num_submitted > 0)
+		{
+			ring_waiting = true;
+			lock.unlock();
+
+			waitRing();
+
+			lock.lock();
+			ring_waiting = false;
+
+			reapRing();
+			completed_changed.notify_all();
+			continue;
+		}
+
+		if (ring && !ring_waiting)
+		{
+			reapRing();
+			continue;
+		}
+
+		completed_changed.wait(lock, [this]() { return !completed.empty() || num_in_flight == 0 || (ring && !ring_waiting); });
+	}
+}
+
+/*
+ */
+bool AsyncReader::readBlocking(Request *request)
+{
+#if defined(_WIN32)
+	HANDLE file = CreateFileW(request->path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+		return false;
+
+	bool result = true;
+
+	while (request->bytes_read < request->size)
+	{
+		uint64_t offset = request->offset + request->bytes_read;
+		DWORD chunk_size = static_cast<DWORD>(std::min<size_t>(request->size - request->bytes_read, 0x40000000));
+		DWORD chunk_read = 0;
+
+		OVERLAPPED overlapped = {};
+		overlapped.Offset = static_cast<DWORD>(offset & 0xFFFFFFFF);
+		overlapped.OffsetHigh = static_cast<DWORD>(offset >> 32);
+
+		if (!ReadFile(file, request->data + request->bytes_read, chunk_size, &chunk_read, &overlapped))
+		{
+			result = (GetLastError() == ERROR_HANDLE_EOF);
+			break;
+		}
+
+		if (chunk_read == 0)
+			break;
+
+		request->bytes_read += chunk_read;
+	}
+
+	CloseHandle(file);
+	return result;
+#else
+	bool result = true;
+
+	while (request->bytes_read < request->size)
+	{
+		off_t offset = static_cast<off_t>(request->offset + request->bytes_read);
+		ssize_t chunk_read = pread(request->fd, request->data + request->bytes_read, request->size - request->bytes_read, offset);
+
+		if (chunk_read < 0 && errno == EINTR)
+			continue;
+
+		if (chunk_read < 0)
+		{
+			result = false;
+			break;
+		}
+
+		if (chunk_read == 0)
+			break;
+
+		request->bytes_read += static_cast<size_t>(chunk_read);
+	}
+
+	::close(request->fd);
+	request->fd = -1;
+
+	return result;
+#endif
+}
+
+void AsyncReader::workerLoop()
+{
+	while (true)
+	{
+		Request *request = nullptr;
+
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			pending_changed.wait(lock, [this]() { return !workers_running || !pending.empty(); });
+
+			if (!workers_running)
+				return;
+
+			request = pending.front();
+			pending.pop_front();
+		}
+
+		request->success = readBlocking(request);
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+
+			completed.push_back(request);
+			num_in_flight--;
+		}
+
+		completed_changed.notify_all();
+	}
+}
+
+/*
+ */
+#if defined(SCAPES_IO_URING)
+
+static int setupRing(uint32_t entries, io_uring_params *params)
+{
+	return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+}
+
+static int enterRing(int fd, uint32_t to_submit, uint32_t min_complete, uint32_t flags)
+{
+	return static_cast<int>(syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, nullptr, 0));
+}
+
+bool AsyncReader::initRing()
+{
+	io_uring_params params = {};
+
+	int fd = setupRing(queue_depth, &params);
+	if (fd < 0)
+		return false;
+
+	// IORING_OP_READ needs 5.6, fast poll came with 5.7 and is the closest feature bit
+	if ((params.features & IORING_FEAT_FAST_POLL) == 0)
+	{
+		::close(fd);
+		return false;
+	}
+
+	Ring *new_ring = new Ring();
+	new_ring->fd = fd;
+
+	new_ring->sq_memory_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+	new_ring->cq_memory_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+
+	bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+	if (single_mmap)
+	{
+		new_ring->sq_memory_size = std::max(new_ring->sq_memory_size, new_ring->cq_memory_size);
+		new_ring->cq_memory_size = new_ring->sq_memory_size;
+	}
+
+	new_ring->sq_memory = mmap(nullptr, new_ring->sq_memory_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+	new_ring->cq_memory = new_ring->sq_memory;
+
+	if (!single_mmap && new_ring->sq_memory != MAP_FAILED)
+		new_ring->cq_memory = mmap(nullptr, new_ring->cq_memory_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+
+	new_ring->sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+	void *sqes_memory = mmap(nullptr, new_ring->sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+
+	if (new_ring->sq_memory == MAP_FAILED || new_ring->cq_memory == MAP_FAILED || sqes_memory == MAP_FAILED)
+	{
+		if (sqes_memory != MAP_FAILED)
+			munmap(sqes_memory, new_ring->sqes_size);
+
+		if (!single_mmap && new_ring->cq_memory != MAP_FAILED && new_ring->cq_memory != new_ring->sq_memory)
+			munmap(new_ring->cq_memory, new_ring->cq_memory_size);
+
+		if (new_ring->sq_memory != MAP_FAILED)
+			munmap(new_ring->sq_memory, new_ring->sq_memory_size);
+
+		::close(fd);
+		delete new_ring;
+		return false;
+	}
+
+	uint8_t *sq = reinterpret_cast<uint8_t *>(new_ring->sq_memory);
+	uint8_t *cq = reinterpret_cast<uint8_t *>(new_ring->cq_memory);
+
+	new_ring->sqes = reinterpret_cast<io_uring_sqe *>(sqes_memory);
+	new_ring->sq_head = reinterpret_cast<unsigned *>(sq + params.sq_off.head);
+	new_ring->sq_tail = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+	new_ring->sq_mask = reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+	new_ring->sq_array = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+
+	new_ring->cq_head = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+	new_ring->cq_tail = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+	new_ring->cq_mask = reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+	new_ring->cqes = reinterpret_cast<io_uring_cqe *>(cq + params.cq_off.cqes);
+
+	// the kernel may round the queue up, never keep more reads in flight than the submission queue holds
+	queue_depth = std::min(queue_depth, params.sq_entries);
+
+	ring = new_ring;
+	return true;
+}
+
+void AsyncReader::shutdownRing()
+{
+	if (!ring)
+		return;
+
+	munmap(ring->sqes, ring->sqes_size);
+
+	if (ring->cq_memory != ring->sq_memory)
+		munmap(ring->cq_memory, ring->cq_memory_size);
+
+	munmap(ring->sq_memory, ring->sq_memory_size);
+
+	::close(ring->fd);
+
+	delete ring;
+	ring = nullptr;
+}
+
+bool AsyncReader::submitRing(Request *request)
+{
+	assert(ring);
+	assert(ring->num_submitted < queue_depth);
+
+	unsigned tail = *ring->sq_tail;
+	unsigned index = tail & *ring->sq_mask;
+
+	// reads larger than 2GB complete partially and get resubmitted
+	size_t size = std::min<size_t>(request->size - request->bytes_read, 0x7FFFF000);
+
+	io_uring_sqe *sqe = &ring->sqes[index];
+	memset(sqe, 0, sizeof(io_uring_sqe));
+
+	sqe->opcode = IORING_OP_READ;
+	sqe->fd = request->fd;
+	sqe->addr = reinterpret_cast<uint64_t>(request->data + request->bytes_read);
+	sqe->len = static_cast<uint32_t>(size);
+	sqe->off = request->offset + request->bytes_read;
+	sqe->user_data = reinterpret_cast<uint64_t>(request);
+
+	ring->sq_array[index] = index;
+	__atomic_store_n(ring->sq_tail, tail + 1, __ATOMIC_RELEASE);
+
+	ring->num_submitted++;
+
+	// also picks up entries left over from failed submits
+	unsigned to_submit = tail + 1 - __atomic_load_n(ring->sq_head, __ATOMIC_ACQUIRE);
+
+	int result = 0;
+	do
+	{
+		result = enterRing(ring->fd, to_submit, 0, 0);
+	}
+	while (result < 0 && errno == EINTR);
+
+	return result >= 0;
+}
+
+bool AsyncReader::waitRing()
+{
+	assert(ring);
+
+	// num_submitted may change meanwhile, but the caller keeps others from reaping what it waits for
+	int result = enterRing(ring->fd, 0, 1, IORING_ENTER_GETEVENTS);
+
+	return result >= 0 || errno == EINTR;
+}
+
+bool AsyncReader::reapRing()
+{
+	assert(ring);
+
+	unsigned head = *ring->cq_head;
+	unsigned tail = __atomic_load_n(ring->cq_tail, __ATOMIC_ACQUIRE);
+
+	std::vector<Request *> resubmitted;
+
+	for (; head != tail; ++head)
+	{
+		io_uring_cqe *cqe = &ring->cqes[head & *ring->cq_mask];
+		Request *request = reinterpret_cast<Request *>(cqe->user_data);
+		int32_t result = cqe->res;
+
+		assert(ring->num_submitted > 0);
+		ring->num_submitted--;
+
+		if (result == -EINTR || result == -EAGAIN)
+		{
+			resubmitted.push_back(request);
+			continue;
+		}
+
+		if (result > 0)
+			request->bytes_read += static_cast<size_t>(result);
+
+		// short reads are retried, zero means the end of the file
+		if (result > 0 && request->bytes_read < request->size)
+		{
+			resubmitted.push_back(request);
+			continue;
+		}
+
+		request->success = (result >= 0);
+
+		::close(request->fd);
+		request->fd = -1;
+
+		completed.push_back(request);
+		num_in_flight--;
+	}
+
+	__atomic_store_n(ring->cq_head, head, __ATOMIC_RELEASE);
+
+	for (Request *request : resubmitted)
+		pending.push_front(request);
+
+	flushRing();
+
+	return true;
+}
+
+void AsyncReader::flushRing()
+{
+	while (!pending.empty() && ring->num_submitted < queue_depth)
+	{
+		Request *request = pending.front();
+		pending.pop_front();
+
+		submitRing(request);
+	}
+}
+
+#else
+
+bool AsyncReader::initRing()
+{
+	return false;
+}
+
+void AsyncReader::shutdownRing()
+{
+}
+
+bool AsyncReader::submitRing(Request *request)
+{
+	return false;
+}
+
+void AsyncReader::flushRing()
+{
+}
+
+bool AsyncReader::reapRing()
+{
+	return false;
+}
+
+bool AsyncReader::waitRing()
+{
+	return false;
+}
+
+#endif
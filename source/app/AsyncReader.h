@@ -0,0 +1,84 @@
+#pragma once
+
+#include <scapes/foundation/io/FileSystem.h>
+
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/* Keeps many file reads in flight, uses io_uring where available and falls back
+ * to blocking reads on a small thread pool otherwise.
+ */
+class AsyncReader
+{
+public:
+	AsyncReader(uint32_t queue_depth = DEFAULT_QUEUE_DEPTH);
+	~AsyncReader();
+
+	bool submit(const std::filesystem::path &path, uint64_t offset, size_t size, void *data, scapes::foundation::io::ReadCallback callback, void *user_data);
+
+	// calls callbacks of completed reads, returns the number of completed reads
+	uint32_t fetch();
+	void wait();
+
+	SCAPES_INLINE bool isNative() const { return ring != nullptr; }
+	SCAPES_INLINE uint32_t getQueueDepth() const { return queue_depth; }
+
+private:
+	enum
+	{
+		DEFAULT_QUEUE_DEPTH = 64,
+		NUM_WORKERS = 4,
+	};
+
+	struct Request
+	{
+		std::filesystem::path path;
+		uint64_t offset {0};
+		size_t size {0};
+		uint8_t *data {nullptr};
+		scapes::foundation::io::ReadCallback callback {nullptr};
+		void *user_data {nullptr};
+
+		int fd {-1};
+		size_t bytes_read {0};
+		bool success {false};
+	};
+
+	struct Ring;
+
+	bool initRing();
+	void shutdownRing();
+	bool submitRing(Request *request);
+	void flushRing();
+	bool reapRing();
+	bool waitRing();
+
+	void workerLoop();
+
+	static bool readBlocking(Request *request);
+
+private:
+	uint32_t queue_depth {DEFAULT_QUEUE_DEPTH};
+
+	std::mutex mutex;
+	std::condition_variable pending_changed;
+	std::condition_variable completed_changed;
+
+	std::deque<Request *> pending;
+	std::vector<Request *> completed;
+	uint32_t num_in_flight {0};
+
+	// io_uring
+	Ring *ring {nullptr};
+
+	// only one thread blocks on the ring, nobody else reaps completions meanwhile
+	bool ring_waiting {false};
+
+	// thread pool fallback
+	std::vector<std::thread> workers;
+	bool workers_running {false};
+};
@@ -9,6 +9,21 @@
 #include <sys/types.h>
 #include <sys/stat.h>
 
+#if defined(_WIN32)
+	#define WIN32_LEAN_AND_MEAN
+	#define NOMINMAX
+	#include <windows.h>
+#else
+	#include <sys/mman.h>
+	#include <fcntl.h>
+	#include <unistd.h>
+#endif
+
+#if defined(__linux__)
+	#include <sys/inotify.h>
+	#include <poll.h>
+#endif
+
 /*
  */
 ApplicationStream::ApplicationStream(FILE *file) : file(file)
@@ -64,12 +79,48 @@ uint64_t ApplicationStream::size() const
  */
 ApplicationFileSystem::ApplicationFileSystem(const char *root) : root_path(root)
 {
-	root_path = std::filesystem::u8path(root);
+	root_path = std::filesystem::u8path(root).lexically_normal();
+
+	if (!root_path.has_filename())
+		root_path = root_path.parent_path();
+
+#if defined(__linux__)
+	native_handle = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+#endif
 }
 
 ApplicationFileSystem::~ApplicationFileSystem()
 {
-
+	{
+		std::lock_guard<std::mutex> lock(mapping_mutex);
+
+		for (auto &it : mappings)
+		{
+#if defined(_WIN32)
+			UnmapViewOfFile(it.second.data);
+			CloseHandle(it.second.mapping_handle);
+#else
+			munmap(it.second.data, it.second.size);
+#endif
+		}
+
+		mappings.clear();
+		mapping_by_key.clear();
+	}
+
+	watch_running = false;
+	watch_stopped.notify_all();
+
+	if (watch_thread.joinable())
+		watch_thread.join();
+
+#if defined(__linux__)
+	if (native_handle != -1)
+		::close(native_handle);
+#endif
+
+	native_handle = -1;
+	native_watches.clear();
 }
 
 scapes::foundation::io::Stream *ApplicationFileSystem::open(const scapes::foundation::io::URI &uri, const char *mode)
@@ -99,6 +150,15 @@ void *ApplicationFileSystem::map(const scapes::foundation::io::URI &uri, size_t
 {
 	size = 0;
 
+	std::filesystem::path path = std::filesystem::u8path(uri.c_str());
+
+	if (!path.is_absolute())
+		path = root_path / path;
+
+	if (void *data = mapNative(path, size); data)
+		return data;
+
+	// fallback: copy whole file to the heap
 	scapes::foundation::io::Stream *stream = open(uri, "rb");
 	if (!stream)
 		return nullptr;
@@ -118,7 +178,11 @@ void *ApplicationFileSystem::map(const scapes::foundation::io::URI &uri, size_t
 bool ApplicationFileSystem::unmap(void *data)
 {
 	assert(data);
-	delete[] data;
+
+	if (unmapNative(data))
+		return true;
+
+	delete[] reinterpret_cast<uint8_t *>(data);
 
 	return true;
 }
@@ -130,9 +194,450 @@ uint64_t ApplicationFileSystem::mtime(const scapes::foundation::io::URI &uri)
 	if (!path.is_absolute())
 		path = root_path / path;
 
-	struct stat info;
-	if (stat(path.u8string().c_str(), &info) != 0)
+	// full clock resolution, edits within the same second still change it
+	std::error_code error;
+	std::filesystem::file_time_type time = std::filesystem::last_write_time(path, error);
+	if (error)
 		return 0;
 
-	return static_cast<uint64_t>(info.st_mtime);
+	return static_cast<uint64_t>(time.time_since_epoch().count());
+}
+
+/*
+ */
+void *ApplicationFileSystem::mapNative(const std::filesystem::path &path, size_t &size)
+{
+#if defined(_WIN32)
+	HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+		return nullptr;
+
+	BY_HANDLE_FILE_INFORMATION info = {};
+	if (!GetFileInformationByHandle(file, &info))
+	{
+		CloseHandle(file);
+		return nullptr;
+	}
+
+	uint64_t file_size = (static_cast<uint64_t>(info.nFileSizeHigh) << 32) | info.nFileSizeLow;
+	if (file_size < MIN_MAPPED_SIZE)
+	{
+		CloseHandle(file);
+		return nullptr;
+	}
+
+	// identify file contents, so a changed file never reuses a stale mapping
+	std::string key = std::to_string(info.dwVolumeSerialNumber) + ":" +
+		std::to_string(info.nFileIndexHigh) + ":" + std::to_string(info.nFileIndexLow) + ":" +
+		std::to_string(info.ftLastWriteTime.dwHighDateTime) + ":" + std::to_string(info.ftLastWriteTime.dwLowDateTime) + ":" +
+		std::to_string(file_size);
+#else
+	int file = ::open(path.u8string().c_str(), O_RDONLY | O_CLOEXEC);
+	if (file == -1)
+		return nullptr;
+
+	struct stat info;
+	if (fstat(file, &info) != 0 || static_cast<size_t>(info.st_size) < MIN_MAPPED_SIZE)
+	{
+		::close(file);
+		return nullptr;
+	}
+
+	uint64_t file_size = static_cast<uint64_t>(info.st_size);
+
+	// identify file contents, so a changed file never reuses a stale mapping;
+	// nanoseconds matter, mtime() sees rewrites within the same second too
+	std::string key = std::to_string(info.st_dev) + ":" + std::to_string(info.st_ino) + ":" +
+		std::to_string(info.st_mtim.tv_sec) + "." + std::to_string(info.st_mtim.tv_nsec) + ":" +
+		std::to_string(file_size);
+#endif
+
+	std::lock_guard<std::mutex> lock(mapping_mutex);
+
+	auto it = mapping_by_key.find(key);
+	if (it != mapping_by_key.end())
+	{
+		FileMapping &mapping = mappings[it->second];
+		mapping.ref_count++;
+
+		size = mapping.size;
+
+#if defined(_WIN32)
+		CloseHandle(file);
+#else
+		::close(file);
+#endif
+		return mapping.data;
+	}
+
+	FileMapping mapping;
+	mapping.size = static_cast<size_t>(file_size);
+	mapping.ref_count = 1;
+	mapping.key = key;
+
+#if defined(_WIN32)
+	HANDLE mapping_handle = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	CloseHandle(file);
+
+	if (!mapping_handle)
+		return nullptr;
+
+	void *data = MapViewOfFile(mapping_handle, FILE_MAP_READ, 0, 0, 0);
+	if (!data)
+	{
+		CloseHandle(mapping_handle);
+		return nullptr;
+	}
+
+	WIN32_MEMORY_RANGE_ENTRY range = {};
+	range.VirtualAddress = data;
+	range.NumberOfBytes = mapping.size;
+	PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+
+	mapping.mapping_handle = mapping_handle;
+#else
+	void *data = mmap(nullptr, mapping.size, PROT_READ, MAP_PRIVATE, file, 0);
+	::close(file);
+
+	if (data == MAP_FAILED)
+		return nullptr;
+
+	// files are parsed front to back right after mapping
+	madvise(data, mapping.size, MADV_SEQUENTIAL);
+	madvise(data, mapping.size, MADV_WILLNEED);
+#endif
+
+	mapping.data = data;
+
+	mappings.insert({data, mapping});
+	mapping_by_key.insert({key, data});
+
+	size = mapping.size;
+	return data;
+}
+
+bool ApplicationFileSystem::unmapNative(void *data)
+{
+	std::lock_guard<std::mutex> lock(mapping_mutex);
+
+	auto it = mappings.find(data);
+	if (it == mappings.end())
+		return false;
+
+	FileMapping &mapping = it->second;
+	assert(mapping.ref_count > 0);
+
+	if (--mapping.ref_count > 0)
+		return true;
+
+#if defined(_WIN32)
+	UnmapViewOfFile(mapping.data);
+	CloseHandle(mapping.mapping_handle);
+#else
+	munmap(mapping.data, mapping.size);
+#endif
+
+	mapping_by_key.erase(mapping.key);
+	mappings.erase(it);
+
+	return true;
+}
+
+/*
+ */
+bool ApplicationFileSystem::watch(const scapes::foundation::io::URI &uri)
+{
+	std::filesystem::path path = getAbsolutePath(uri);
+
+	std::error_code error;
+	if (!std::filesystem::exists(path, error))
+		return false;
+
+	bool recursive = std::filesystem::is_directory(path, error);
+
+	{
+		std::lock_guard<std::mutex> lock(watch_mutex);
+
+		watched_paths.push_back(path);
+
+		if (native_handle != -1)
+			addNativeWatch(recursive ? path : path.parent_path(), recursive);
+		else
+			scanFiles(path, false);
+	}
+
+	if (!watch_thread.joinable())
+	{
+		watch_running = true;
+		watch_thread = std::thread(&ApplicationFileSystem::watchLoop, this);
+	}
+
+	return true;
+}
+
+bool ApplicationFileSystem::unwatch(const scapes::foundation::io::URI &uri)
+{
+	std::filesystem::path path = getAbsolutePath(uri);
+
+	std::lock_guard<std::mutex> lock(watch_mutex);
+
+	auto it = std::find(watched_paths.begin(), watched_paths.end(), path);
+	if (it == watched_paths.end())
+		return false;
+
+	watched_paths.erase(it);
+
+	if (native_handle != -1)
+		removeNativeWatches(path);
+
+	for (auto file_it = file_times.begin(); file_it != file_times.end(); )
+	{
+		if (file_it->first.rfind(path.generic_u8string(), 0) == 0)
+			file_it = file_times.erase(file_it);
+		else
+			++file_it;
+	}
+
+	return true;
+}
+
+void ApplicationFileSystem::fetchChanges(scapes::foundation::io::FileChangeCallback callback, void *user_data)
+{
+	assert(callback);
+
+	std::vector<std::string> changes;
+
+	{
+		std::lock_guard<std::mutex> lock(watch_mutex);
+
+		if (changed_paths.empty())
+			return;
+
+		std::swap(changes, changed_paths);
+	}
+
+	for (const std::string &change : changes)
+		callback(scapes::foundation::io::URI(change.c_str()), user_data);
+}
+
+/*
+ */
+bool ApplicationFileSystem::readAsync(const scapes::foundation::io::URI &uri, uint64_t offset, size_t size, void *data, scapes::foundation::io::ReadCallback callback, void *user_data)
+{
+	return async_reader.submit(getAbsolutePath(uri), offset, size, data, callback, user_data);
+}
+
+uint32_t ApplicationFileSystem::fetchReads()
+{
+	return async_reader.fetch();
+}
+
+void ApplicationFileSystem::waitReads()
+{
+	async_reader.wait();
+}
+
+/*
+ */
+std::filesystem::path ApplicationFileSystem::getAbsolutePath(const scapes::foundation::io::URI &uri) const
+{
+	std::filesystem::path path = std::filesystem::u8path(uri.c_str());
+
+	if (!path.is_absolute())
+		path = root_path / path;
+
+	path = path.lexically_normal();
+
+	if (!path.has_filename())
+		path = path.parent_path();
+
+	return path;
+}
+
+std::string ApplicationFileSystem::getRelativePath(const std::filesystem::path &path) const
+{
+	std::filesystem::path relative_path = path.lexically_relative(root_path);
+
+	if (relative_path.empty() || *relative_path.begin() == "..")
+		return path.generic_u8string();
+
+	return relative_path.generic_u8string();
+}
+
+/*
+ */
+void ApplicationFileSystem::watchLoop()
+{
+	while (watch_running)
+	{
+#if defined(__linux__)
+		if (native_handle != -1)
+		{
+			pollfd descriptor = {};
+			descriptor.fd = native_handle;
+			descriptor.events = POLLIN;
+
+			if (poll(&descriptor, 1, NATIVE_TIMEOUT_MS) > 0)
+				processNativeEvents();
+
+			continue;
+		}
+#endif
+
+		std::unique_lock<std::mutex> lock(watch_mutex);
+		watch_stopped.wait_for(lock, std::chrono::milliseconds(POLL_INTERVAL_MS), [this]() { return !watch_running; });
+
+		if (!watch_running)
+			break;
+
+		for (const std::filesystem::path &path : watched_paths)
+			scanFiles(path, true);
+	}
+}
+
+void ApplicationFileSystem::pushChange(const std::filesystem::path &path)
+{
+	std::string relative_path = getRelativePath(path);
+
+	if (std::find(changed_paths.begin(), changed_paths.end(), relative_path) != changed_paths.end())
+		return;
+
+	changed_paths.push_back(relative_path);
+}
+
+/*
+ */
+void ApplicationFileSystem::addNativeWatch(const std::filesystem::path &path, bool recursive)
+{
+#if defined(__linux__)
+	constexpr uint32_t mask = IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_DELETE;
+
+	int descriptor = inotify_add_watch(native_handle, path.u8string().c_str(), mask);
+	if (descriptor == -1)
+		return;
+
+	native_watches[descriptor] = path;
+
+	if (!recursive)
+		return;
+
+	std::error_code error;
+	auto options = std::filesystem::directory_options::skip_permission_denied;
+
+	for (const auto &entry : std::filesystem::directory_iterator(path, options, error))
+		if (entry.is_directory(error))
+			addNativeWatch(entry.path(), true);
+#endif
+}
+
+void ApplicationFileSystem::removeNativeWatches(const std::filesystem::path &path)
+{
+#if defined(__linux__)
+	const std::string prefix = path.generic_u8string();
+
+	for (auto it = native_watches.begin(); it != native_watches.end(); )
+	{
+		bool is_watched_elsewhere = std::any_of(watched_paths.begin(), watched_paths.end(),
+			[&it](const std::filesystem::path &watched_path)
+			{
+				return it->second.generic_u8string().rfind(watched_path.generic_u8string(), 0) == 0;
+			}
+		);
+
+		if (it->second.generic_u8string().rfind(prefix, 0) != 0 || is_watched_elsewhere)
+		{
+			++it;
+			continue;
+		}
+
+		inotify_rm_watch(native_handle, it->first);
+		it = native_watches.erase(it);
+	}
+#endif
+}
+
+void ApplicationFileSystem::processNativeEvents()
+{
+#if defined(__linux__)
+	alignas(inotify_event) char buffer[4096];
+
+	while (true)
+	{
+		ssize_t length = read(native_handle, buffer, sizeof(buffer));
+		if (length <= 0)
+			break;
+
+		std::lock_guard<std::mutex> lock(watch_mutex);
+
+		for (ssize_t offset = 0; offset < length; )
+		{
+			const inotify_event *event = reinterpret_cast<const inotify_event *>(buffer + offset);
+			offset += sizeof(inotify_event) + event->len;
+
+			auto it = native_watches.find(event->wd);
+			if (it == native_watches.end())
+				continue;
+
+			if (event->mask & IN_IGNORED)
+			{
+				native_watches.erase(it);
+				continue;
+			}
+
+			if (event->len == 0)
+				continue;
+
+			std::filesystem::path path = it->second / std::filesystem::u8path(event->name);
+
+			if (event->mask & IN_ISDIR)
+			{
+				if (event->mask & (IN_CREATE | IN_MOVED_TO))
+					addNativeWatch(path, true);
+
+				continue;
+			}
+
+			// files are reported once they are complete
+			if (event->mask & IN_CREATE)
+				continue;
+
+			pushChange(path);
+		}
+	}
+#endif
+}
+
+/*
+ */
+void ApplicationFileSystem::scanFiles(const std::filesystem::path &path, bool notify)
+{
+	std::error_code error;
+
+	auto check_file = [this, notify, &error](const std::filesystem::path &file_path)
+	{
+		std::filesystem::file_time_type time = std::filesystem::last_write_time(file_path, error);
+		if (error)
+			return;
+
+		auto [it, inserted] = file_times.insert({file_path.generic_u8string(), time});
+		if (!inserted && it->second == time)
+			return;
+
+		it->second = time;
+
+		if (notify)
+			pushChange(file_path);
+	};
+
+	if (!std::filesystem::is_directory(path, error))
+	{
+		check_file(path);
+		return;
+	}
+
+	auto options = std::filesystem::directory_options::skip_permission_denied;
+
+	for (const auto &entry : std::filesystem::recursive_directory_iterator(path, options, error))
+		if (entry.is_regular_file(error))
+			check_file(entry.path());
 }
@@ -2,8 +2,16 @@
 
 #include <scapes/foundation/io/FileSystem.h>
 
+#include "AsyncReader.h"
+
 #include <string>
 #include <filesystem>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
 
 class ApplicationStream : public scapes::foundation::io::Stream
 {
@@ -34,6 +42,73 @@ public:
 	bool unmap(void *data) final;
 	uint64_t mtime(const scapes::foundation::io::URI &uri) final;
 
+	bool watch(const scapes::foundation::io::URI &uri) final;
+	bool unwatch(const scapes::foundation::io::URI &uri) final;
+	void fetchChanges(scapes::foundation::io::FileChangeCallback callback, void *user_data) final;
+
+	bool readAsync(const scapes::foundation::io::URI &uri, uint64_t offset, size_t size, void *data, scapes::foundation::io::ReadCallback callback, void *user_data) final;
+	uint32_t fetchReads() final;
+	void waitReads() final;
+
+private:
+	void *mapNative(const std::filesystem::path &path, size_t &size);
+	bool unmapNative(void *data);
+
+	std::filesystem::path getAbsolutePath(const scapes::foundation::io::URI &uri) const;
+	std::string getRelativePath(const std::filesystem::path &path) const;
+
+	void watchLoop();
+	void pushChange(const std::filesystem::path &path);
+
+	void addNativeWatch(const std::filesystem::path &path, bool recursive);
+	void removeNativeWatches(const std::filesystem::path &path);
+	void processNativeEvents();
+
+	void scanFiles(const std::filesystem::path &path, bool notify);
+
 private:
+	enum
+	{
+		POLL_INTERVAL_MS = 500,
+		NATIVE_TIMEOUT_MS = 100,
+	};
+
+	// small files are cheaper to read than to map
+	static constexpr size_t MIN_MAPPED_SIZE = 64 * 1024;
+
+	struct FileMapping
+	{
+		void *data {nullptr};
+		size_t size {0};
+		uint32_t ref_count {0};
+		std::string key;
+
+#if defined(_WIN32)
+		void *mapping_handle {nullptr};
+#endif
+	};
+
 	std::filesystem::path root_path;
+
+	// files can be mapped from loader threads
+	std::mutex mapping_mutex;
+	std::unordered_map<void *, FileMapping> mappings;
+	std::unordered_map<std::string, void *> mapping_by_key;
+
+	AsyncReader async_reader;
+
+	std::thread watch_thread;
+	std::atomic<bool> watch_running {false};
+	std::condition_variable watch_stopped;
+	std::mutex watch_mutex;
+
+	std::vector<std::filesystem::path> watched_paths;
+	std::vector<std::string> changed_paths;
+
+	// inotify, not available on all platforms
+	int native_handle {-1};
+	std::unordered_map<int, std::filesystem::path> native_watches;
+
+	// polling fallback
+	std::unordered_map<std::string, std::filesystem::file_time_type> file_times;
 };
@@ -0,0 +1,512 @@
+#include "PackFileSystem.h"
+
+#include <scapes/foundation/Log.h>
+#include <scapes/foundation/jobs/JobSystem.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <filesystem>
+#include <vector>
+
+/*
+ */
+PackStream::PackStream(const uint8_t *data, size_t size, bool owns_data)
+	: data(data), data_size(size), owns_data(owns_data)
+{
+	assert(data || size == 0);
+}
+
+PackStream::~PackStream()
+{
+	if (owns_data)
+		delete[] data;
+
+	data = nullptr;
+}
+
+size_t PackStream::read(void *dst, size_t element_size, size_t element_count)
+{
+	if (element_size == 0)
+		return 0;
+
+	size_t num_elements = std::min(element_count, (data_size - position) / element_size);
+	size_t num_bytes = num_elements * element_size;
+
+	if (num_bytes == 0)
+		return 0;
+
+	memcpy(dst, data + position, num_bytes);
+	position += num_bytes;
+
+	return num_elements;
+}
+
+size_t PackStream::write(const void *, size_t, size_t)
+{
+	// packs are read-only
+	return 0;
+}
+
+bool PackStream::seek(uint64_t offset, scapes::foundation::io::SeekOrigin origin)
+{
+	uint64_t base_position = 0;
+
+	switch (origin)
+	{
+		case scapes::foundation::io::SeekOrigin::SET: base_position = 0; break;
+		case scapes::foundation::io::SeekOrigin::CUR: base_position = position; break;
+		case scapes::foundation::io::SeekOrigin::END: base_position = data_size; break;
+		default: return false;
+	}
+
+	// offset is unsigned but callers may pass negative values casted to uint64_t
+	uint64_t new_position = base_position + offset;
+	if (new_position > data_size)
+		return false;
+
+	position = static_cast<size_t>(new_position);
+	return true;
+}
+
+uint64_t PackStream::tell() const
+{
+	return position;
+}
+
+uint64_t PackStream::size() const
+{
+	return data_size;
+}
+
+/*
+ */
+PackFileSystem::PackFileSystem(scapes::foundation::io::FileSystem *base, const scapes::foundation::io::URI &pack_uri)
+	: base(base)
+{
+	assert(base);
+
+	pack_data = base->map(pack_uri, pack_size);
+	if (!pack_data)
+		return;
+
+	const uint8_t *bytes = reinterpret_cast<const uint8_t *>(pack_data);
+	const pack::Header *pack_header = reinterpret_cast<const pack::Header *>(bytes);
+
+	bool valid = pack_size >= sizeof(pack::Header);
+	valid = valid && memcmp(pack_header->magic, pack::MAGIC, sizeof(pack::MAGIC)) == 0;
+	valid = valid && pack_header->version == pack::VERSION;
+	valid = valid && pack_header->index_offset + static_cast<uint64_t>(pack_header->num_entries) * sizeof(pack::Entry) <= pack_size;
+	valid = valid && pack_header->strings_offset + pack_header->strings_size <= pack_size;
+	valid = valid && (pack_header->index_offset % alignof(pack::Entry)) == 0;
+
+	if (!valid)
+	{
+		scapes::foundation::Log::error("PackFileSystem::PackFileSystem(): \"%s\" is not a valid pack file\n", pack_uri.c_str());
+
+		base->unmap(pack_data);
+		pack_data = nullptr;
+		pack_size = 0;
+		return;
+	}
+
+	header = pack_header;
+	entries = reinterpret_cast<const pack::Entry *>(bytes + header->index_offset);
+	strings = reinterpret_cast<const char *>(bytes + header->strings_offset);
+
+	// entries are trusted from now on, open(), map() and reads index the pack with them directly
+	for (uint32_t i = 0; i < header->num_entries; ++i)
+	{
+		if (isValidEntry(entries[i]))
+			continue;
+
+		scapes::foundation::Log::error("PackFileSystem::PackFileSystem(): \"%s\" has a corrupted entry %u\n", pack_uri.c_str(), i);
+
+		base->unmap(pack_data);
+		pack_data = nullptr;
+		pack_size = 0;
+
+		header = nullptr;
+		entries = nullptr;
+		strings = nullptr;
+		return;
+	}
+}
+
+PackFileSystem::~PackFileSystem()
+{
+	for (void *data : extracted_data)
+		delete[] reinterpret_cast<uint8_t *>(data);
+
+	extracted_data.clear();
+	overrides.clear();
+
+	if (pack_data)
+		base->unmap(pack_data);
+
+	pack_data = nullptr;
+	pack_size = 0;
+
+	header = nullptr;
+	entries = nullptr;
+	strings = nullptr;
+}
+
+/*
+ */
+scapes::foundation::io::Stream *PackFileSystem::open(const scapes::foundation::io::URI &uri, const char *mode)
+{
+	bool read_only = (strchr(mode, 'w') == nullptr) && (strchr(mode, 'a') == nullptr) && (strchr(mode, '+') == nullptr);
+
+	const pack::Entry *entry = (read_only) ? findEntry(uri) : nullptr;
+	if (!entry)
+		return base->open(uri, mode);
+
+	const uint8_t *bytes = reinterpret_cast<const uint8_t *>(pack_data);
+
+	if ((entry->flags & pack::ENTRY_FLAG_COMPRESSED) == 0)
+		return new PackStream(bytes + entry->data_offset, static_cast<size_t>(entry->size), false);
+
+	uint8_t *data = extract(*entry);
+	if (!data)
+		return nullptr;
+
+	return new PackStream(data, static_cast<size_t>(entry->size), true);
+}
+
+bool PackFileSystem::close(scapes::foundation::io::Stream *stream)
+{
+	PackStream *pack_stream = dynamic_cast<PackStream *>(stream);
+	if (!pack_stream)
+		return base->close(stream);
+
+	delete pack_stream;
+	return true;
+}
+
+void *PackFileSystem::map(const scapes::foundation::io::URI &uri, size_t &size)
+{
+	const pack::Entry *entry = findEntry(uri);
+	if (!entry)
+		return base->map(uri, size);
+
+	uint8_t *bytes = reinterpret_cast<uint8_t *>(pack_data);
+
+	// zero-copy, entries are aligned inside the pack
+	if ((entry->flags & pack::ENTRY_FLAG_COMPRESSED) == 0)
+	{
+		size = static_cast<size_t>(entry->size);
+		return bytes + entry->data_offset;
+	}
+
+	uint8_t *data = extract(*entry);
+	if (!data)
+		return nullptr;
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		extracted_data.insert(data);
+	}
+
+	size = static_cast<size_t>(entry->size);
+	return data;
+}
+
+bool PackFileSystem::unmap(void *data)
+{
+	if (isInsidePack(data))
+		return true;
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+
+		auto it = extracted_data.find(data);
+		if (it != extracted_data.end())
+		{
+			extracted_data.erase(it);
+			delete[] reinterpret_cast<uint8_t *>(data);
+			return true;
+		}
+	}
+
+	return base->unmap(data);
+}
+
+uint64_t PackFileSystem::mtime(const scapes::foundation::io::URI &uri)
+{
+	const pack::Entry *entry = findEntry(uri);
+	if (!entry)
+		return base->mtime(uri);
+
+	return entry->mtime;
+}
+
+/*
+ */
+bool PackFileSystem::watch(const scapes::foundation::io::URI &uri)
+{
+	return base->watch(uri);
+}
+
+bool PackFileSystem::unwatch(const scapes::foundation::io::URI &uri)
+{
+	return base->unwatch(uri);
+}
+
+void PackFileSystem::fetchChanges(scapes::foundation::io::FileChangeCallback callback, void *user_data)
+{
+	struct Context
+	{
+		PackFileSystem *file_system {nullptr};
+		scapes::foundation::io::FileChangeCallback callback {nullptr};
+		void *user_data {nullptr};
+	};
+
+	auto on_change = [](const scapes::foundation::io::URI &uri, void *data)
+	{
+		Context *context = reinterpret_cast<Context *>(data);
+
+		// changed files are served from the underlying file system from now on
+		{
+			std::lock_guard<std::mutex> lock(context->file_system->mutex);
+			context->file_system->overrides.insert(normalizePath(uri.c_str()));
+		}
+
+		if (context->callback)
+			context->callback(uri, context->user_data);
+	};
+
+	Context context;
+	context.file_system = this;
+	context.callback = callback;
+	context.user_data = user_data;
+
+	base->fetchChanges(on_change, &context);
+}
+
+/*
+ */
+bool PackFileSystem::readAsync(const scapes::foundation::io::URI &uri, uint64_t offset, size_t size, void *data, scapes::foundation::io::ReadCallback callback, void *user_data)
+{
+	const pack::Entry *entry = findEntry(uri);
+	if (!entry)
+		return base->readAsync(uri, offset, size, data, callback, user_data);
+
+	CompletedRead read;
+	read.data = data;
+	read.callback = callback;
+	read.user_data = user_data;
+
+	if (offset < entry->size)
+	{
+		read.size = static_cast<size_t>(std::min<uint64_t>(size, entry->size - offset));
+		read.success = readEntry(*entry, offset, read.size, reinterpret_cast<uint8_t *>(data));
+	}
+	else
+		read.success = true;
+
+	if (!read.success)
+		read.size = 0;
+
+	std::lock_guard<std::mutex> lock(mutex);
+	completed_reads.push_back(read);
+
+	return true;
+}
+
+uint32_t PackFileSystem::fetchReads()
+{
+	std::vector<CompletedRead> reads;
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		std::swap(reads, completed_reads);
+	}
+
+	for (const CompletedRead &read : reads)
+		if (read.callback)
+			read.callback(read.data, read.size, read.success, read.user_data);
+
+	return static_cast<uint32_t>(reads.size()) + base->fetchReads();
+}
+
+void PackFileSystem::waitReads()
+{
+	fetchReads();
+	base->waitReads();
+}
+
+/*
+ */
+const pack::Entry *PackFileSystem::findEntry(const scapes::foundation::io::URI &uri) const
+{
+	if (!header || header->num_entries == 0)
+		return nullptr;
+
+	std::string path = normalizePath(uri.c_str());
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		if (!overrides.empty() && overrides.find(path) != overrides.end())
+			return nullptr;
+	}
+
+	uint64_t hash = pack::hashPath(path);
+
+	const pack::Entry *begin = entries;
+	const pack::Entry *end = entries + header->num_entries;
+
+	auto compare = [](const pack::Entry &entry, uint64_t hash) { return entry.path_hash < hash; };
+
+	for (const pack::Entry *it = std::lower_bound(begin, end, hash, compare); it != end && it->path_hash == hash; ++it)
+	{
+		std::string_view entry_path(strings + it->path_offset, it->path_length);
+		if (entry_path == path)
+			return it;
+	}
+
+	return nullptr;
+}
+
+bool PackFileSystem::isInsidePack(const void *data) const
+{
+	const uint8_t *begin = reinterpret_cast<const uint8_t *>(pack_data);
+	const uint8_t *end = begin + pack_size;
+	const uint8_t *ptr = reinterpret_cast<const uint8_t *>(data);
+
+	return pack_data && ptr >= begin && ptr < end;
+}
+
+bool PackFileSystem::isValidEntry(const pack::Entry &entry) const
+{
+	if (entry.path_offset + static_cast<uint64_t>(entry.path_length) > header->strings_size)
+		return false;
+
+	// written as subtractions, offsets near UINT64_MAX must not wrap around
+	if ((entry.flags & pack::ENTRY_FLAG_COMPRESSED) == 0)
+		return entry.data_offset <= pack_size && entry.size <= pack_size - entry.data_offset;
+
+	uint64_t table_size = static_cast<uint64_t>(entry.num_blocks) * sizeof(uint32_t);
+
+	bool valid = entry.num_blocks == pack::getNumBlocks(entry.size);
+	valid = valid && entry.data_offset <= pack_size && entry.stored_size <= pack_size - entry.data_offset;
+	valid = valid && table_size <= entry.stored_size;
+
+	return valid;
+}
+
+uint8_t *PackFileSystem::extract(const pack::Entry &entry) const
+{
+	uint8_t *data = new uint8_t[static_cast<size_t>(entry.size)];
+
+	bool result = true;
+
+	if (!job_system || entry.num_blocks < MIN_PARALLEL_BLOCKS * 2)
+	{
+		result = decompressBlocks(entry, data, 0, entry.num_blocks);
+	}
+	else
+	{
+		// blocks are compressed independently, every job decompresses its own contiguous range
+		uint32_t num_ranges = (entry.num_blocks + MIN_PARALLEL_BLOCKS - 1) / MIN_PARALLEL_BLOCKS;
+		std::atomic<bool> succeeded {true};
+
+		job_system->parallelFor(0, num_ranges, 1,
+			[this, &entry, data, &succeeded](uint32_t range)
+			{
+				uint32_t first_block = range * MIN_PARALLEL_BLOCKS;
+				uint32_t last_block = std::min<uint32_t>(entry.num_blocks, first_block + MIN_PARALLEL_BLOCKS);
+
+				uint8_t *dst = data + static_cast<size_t>(first_block) * pack::BLOCK_SIZE;
+
+				if (!decompressBlocks(entry, dst, first_block, last_block))
+					succeeded.store(false, std::memory_order_relaxed);
+			}
+		);
+
+		result = succeeded.load();
+	}
+
+	if (!result)
+	{
+		scapes::foundation::Log::error("PackFileSystem::extract(): can't decompress \"%.*s\"\n", static_cast<int>(entry.path_length), strings + entry.path_offset);
+
+		delete[] data;
+		return nullptr;
+	}
+
+	return data;
+}
+
+bool PackFileSystem::readEntry(const pack::Entry &entry, uint64_t offset, size_t size, uint8_t *dst) const
+{
+	const uint8_t *bytes = reinterpret_cast<const uint8_t *>(pack_data);
+
+	if (offset > entry.size || size > entry.size - offset)
+		return false;
+
+	if ((entry.flags & pack::ENTRY_FLAG_COMPRESSED) == 0)
+	{
+		memcpy(dst, bytes + entry.data_offset + offset, size);
+		return true;
+	}
+
+	if (size == 0)
+		return true;
+
+	// only blocks overlapping the requested range are decompressed
+	uint32_t first_block = static_cast<uint32_t>(offset / pack::BLOCK_SIZE);
+	uint32_t last_block = static_cast<uint32_t>((offset + size - 1) / pack::BLOCK_SIZE) + 1;
+
+	std::vector<uint8_t> blocks(static_cast<size_t>(last_block - first_block) * pack::BLOCK_SIZE);
+	if (!decompressBlocks(entry, blocks.data(), first_block, last_block))
+		return false;
+
+	memcpy(dst, blocks.data() + (offset - static_cast<uint64_t>(first_block) * pack::BLOCK_SIZE), size);
+	return true;
+}
+
+bool PackFileSystem::decompressBlocks(const pack::Entry &entry, uint8_t *dst, uint32_t first_block, uint32_t last_block) const
+{
+	const uint8_t *bytes = reinterpret_cast<const uint8_t *>(pack_data) + entry.data_offset;
+	const uint8_t *bytes_end = bytes + entry.stored_size;
+
+	const uint8_t *block_table = bytes;
+	const uint8_t *block_data = bytes + entry.num_blocks * sizeof(uint32_t);
+
+	// skip preceding blocks, the table is small compared to the data
+	for (uint32_t i = 0; i < first_block; ++i)
+		block_data += pack::lz4::read32(block_table + i * sizeof(uint32_t)) & ~pack::RAW_BLOCK_FLAG;
+
+	for (uint32_t i = first_block; i < last_block; ++i)
+	{
+		uint32_t block_info = pack::lz4::read32(block_table + i * sizeof(uint32_t));
+		uint32_t stored_size = block_info & ~pack::RAW_BLOCK_FLAG;
+
+		uint64_t entry_offset = static_cast<uint64_t>(i) * pack::BLOCK_SIZE;
+		size_t size = static_cast<size_t>(std::min<uint64_t>(pack::BLOCK_SIZE, entry.size - entry_offset));
+		size_t offset = static_cast<size_t>(i - first_block) * pack::BLOCK_SIZE;
+
+		if (block_data > bytes_end || static_cast<size_t>(bytes_end - block_data) < stored_size)
+			return false;
+
+		if (block_info & pack::RAW_BLOCK_FLAG)
+		{
+			if (stored_size != size)
+				return false;
+
+			memcpy(dst + offset, block_data, size);
+		}
+		else if (!pack::lz4::decompress(block_data, stored_size, dst + offset, size))
+			return false;
+
+		block_data += stored_size;
+	}
+
+	return true;
+}
+
+std::string PackFileSystem::normalizePath(const char *path)
+{
+	return std::filesystem::path(path).lexically_normal().generic_u8string();
+}
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <scapes/foundation/Fwd.h>
+#include <scapes/foundation/io/FileSystem.h>
+
+#include "PackFormat.h"
+
+#include <mutex>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+class PackStream : public scapes::foundation::io::Stream
+{
+public:
+	PackStream(const uint8_t *data, size_t size, bool owns_data);
+	~PackStream() final;
+
+	size_t read(void *data, size_t element_size, size_t element_count) final;
+	size_t write(const void *data, size_t element_size, size_t element_count) final;
+
+	bool seek(uint64_t offset, scapes::foundation::io::SeekOrigin origin) final;
+	uint64_t tell() const final;
+	uint64_t size() const final;
+
+private:
+	const uint8_t *data {nullptr};
+	size_t data_size {0};
+	size_t position {0};
+	bool owns_data {false};
+};
+
+/* Serves files from a single pack built by the packer tool, everything else
+ * goes to the underlying file system. Files reported as changed by the underlying
+ * file system are served from it from then on, so hot reload keeps working.
+ */
+class PackFileSystem : public scapes::foundation::io::FileSystem
+{
+public:
+	PackFileSystem(scapes::foundation::io::FileSystem *base, const scapes::foundation::io::URI &pack_uri);
+	~PackFileSystem() final;
+
+	SCAPES_INLINE bool isLoaded() const { return header != nullptr; }
+	SCAPES_INLINE uint32_t getNumEntries() const { return (header) ? header->num_entries : 0; }
+
+	// large compressed entries are decompressed on the job system if there is one
+	SCAPES_INLINE void setJobSystem(scapes::foundation::jobs::JobSystem *system) { job_system = system; }
+
+	scapes::foundation::io::Stream *open(const scapes::foundation::io::URI &uri, const char *mode) final;
+	bool close(scapes::foundation::io::Stream *stream) final;
+	void *map(const scapes::foundation::io::URI &uri, size_t &size) final;
+	bool unmap(void *data) final;
+	uint64_t mtime(const scapes::foundation::io::URI &uri) final;
+
+	bool watch(const scapes::foundation::io::URI &uri) final;
+	bool unwatch(const scapes::foundation::io::URI &uri) final;
+	void fetchChanges(scapes::foundation::io::FileChangeCallback callback, void *user_data) final;
+
+	bool readAsync(const scapes::foundation::io::URI &uri, uint64_t offset, size_t size, void *data, scapes::foundation::io::ReadCallback callback, void *user_data) final;
+	uint32_t fetchReads() final;
+	void waitReads() final;
+
+private:
+	const pack::Entry *findEntry(const scapes::foundation::io::URI &uri) const;
+	bool isInsidePack(const void *data) const;
+	bool isValidEntry(const pack::Entry &entry) const;
+
+	uint8_t *extract(const pack::Entry &entry) const;
+	bool readEntry(const pack::Entry &entry, uint64_t offset, size_t size, uint8_t *dst) const;
+
+	// dst receives blocks starting from first_block
+	bool decompressBlocks(const pack::Entry &entry, uint8_t *dst, uint32_t first_block, uint32_t last_block) const;
+
+	static std::string normalizePath(const char *path);
+
+private:
+	enum
+	{
+		// blocks per job, entries with fewer than two jobs worth are decompressed on the calling thread
+		MIN_PARALLEL_BLOCKS = 8,
+	};
+
+	scapes::foundation::io::FileSystem *base {nullptr};
+	scapes::foundation::jobs::JobSystem *job_system {nullptr};
+
+	void *pack_data {nullptr};
+	size_t pack_size {0};
+
+	const pack::Header *header {nullptr};
+	const pack::Entry *entries {nullptr};
+	const char *strings {nullptr};
+
+	mutable std::mutex mutex;
+	std::unordered_set<std::string> overrides;
+	std::unordered_set<void *> extracted_data;
+
+	struct CompletedRead
+	{
+		void *data {nullptr};
+		size_t size {0};
+		bool success {false};
+		scapes::foundation::io::ReadCallback callback {nullptr};
+		void *user_data {nullptr};
+	};
+
+	// pack entries are already in memory, reads from them complete right away
+	std::vector<CompletedRead> completed_reads;
+};
@@ -0,0 +1,278 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+/* Pack file layout:
+ *
+ * [Header]
+ * [entry data, every entry starts at Header::alignment]
+ * [Entry index, sorted by path hash]
+ * [path strings]
+ *
+ * Compressed entries start with a table of uint32_t block sizes followed by
+ * independently compressed blocks (LZ4 block format) of BLOCK_SIZE bytes each,
+ * blocks with RAW_BLOCK_FLAG set are stored as is.
+ */
+namespace pack
+{
+	static constexpr char MAGIC[4] = { 'S', 'P', 'A', 'K' };
+	static constexpr uint32_t VERSION = 1;
+	static constexpr uint32_t DEFAULT_ALIGNMENT = 4096;
+	static constexpr uint32_t BLOCK_SIZE = 64 * 1024;
+	static constexpr uint32_t RAW_BLOCK_FLAG = 0x80000000;
+
+	enum EntryFlags : uint32_t
+	{
+		ENTRY_FLAG_NONE = 0,
+		ENTRY_FLAG_COMPRESSED = 1 << 0,
+	};
+
+	struct Header
+	{
+		char magic[4] {};
+		uint32_t version {0};
+		uint32_t num_entries {0};
+		uint32_t alignment {0};
+		uint64_t index_offset {0};
+		uint64_t strings_offset {0};
+		uint64_t strings_size {0};
+	};
+
+	struct Entry
+	{
+		uint64_t path_hash {0};
+		uint64_t data_offset {0};
+		uint64_t size {0};
+		uint64_t stored_size {0};
+		uint64_t mtime {0};
+		uint32_t path_offset {0};
+		uint32_t path_length {0};
+		uint32_t flags {ENTRY_FLAG_NONE};
+		uint32_t num_blocks {0};
+	};
+
+	/*
+	 */
+	inline uint64_t hashPath(std::string_view path)
+	{
+		// FNV-1a, must stay stable between the packer and the runtime
+		uint64_t hash = 0xcbf29ce484222325ULL;
+
+		for (char c : path)
+		{
+			hash ^= static_cast<uint8_t>(c);
+			hash *= 0x100000001b3ULL;
+		}
+
+		return hash;
+	}
+
+	inline uint32_t getNumBlocks(uint64_t size)
+	{
+		return static_cast<uint32_t>((size + BLOCK_SIZE - 1) / BLOCK_SIZE);
+	}
+
+	/*
+	 */
+	namespace lz4
+	{
+		static constexpr size_t MIN_MATCH = 4;
+		static constexpr size_t LAST_LITERALS = 5;
+		static constexpr size_t MATCH_FIND_LIMIT = 12;
+		static constexpr size_t MAX_OFFSET = 65535;
+		static constexpr uint32_t HASH_LOG = 12;
+
+		inline uint32_t read32(const uint8_t *data)
+		{
+			uint32_t result = 0;
+			memcpy(&result, data, sizeof(uint32_t));
+			return result;
+		}
+
+		inline size_t getMaxCompressedSize(size_t size)
+		{
+			return size + size / 255 + 16;
+		}
+
+		inline bool writeLength(uint8_t *&dst, const uint8_t *dst_end, size_t length)
+		{
+			while (length >= 255)
+			{
+				if (dst >= dst_end)
+					return false;
+
+				*dst++ = 255;
+				length -= 255;
+			}
+
+			if (dst >= dst_end)
+				return false;
+
+			*dst++ = static_cast<uint8_t>(length);
+			return true;
+		}
+
+		inline bool writeSequence(uint8_t *&dst, const uint8_t *dst_end, const uint8_t *literals, size_t num_literals, size_t offset, size_t match_length)
+		{
+			if (dst >= dst_end)
+				return false;
+
+			uint8_t *token = dst++;
+			*token = static_cast<uint8_t>(std::min<size_t>(num_literals, 15) << 4);
+
+			if (num_literals >= 15 && !writeLength(dst, dst_end, num_literals - 15))
+				return false;
+
+			if (static_cast<size_t>(dst_end - dst) < num_literals)
+				return false;
+
+			memcpy(dst, literals, num_literals);
+			dst += num_literals;
+
+			// last sequence has literals only
+			if (match_length == 0)
+				return true;
+
+			if (static_cast<size_t>(dst_end - dst) < 2)
+				return false;
+
+			*dst++ = static_cast<uint8_t>(offset & 0xFF);
+			*dst++ = static_cast<uint8_t>((offset >> 8) & 0xFF);
+
+			size_t extra_length = match_length - MIN_MATCH;
+			*token |= static_cast<uint8_t>(std::min<size_t>(extra_length, 15));
+
+			if (extra_length >= 15 && !writeLength(dst, dst_end, extra_length - 15))
+				return false;
+
+			return true;
+		}
+
+		// returns compressed size or 0 if data doesn't fit into dst
+		inline size_t compress(const uint8_t *src, size_t src_size, uint8_t *dst, size_t dst_capacity)
+		{
+			uint32_t table[1 << HASH_LOG] = {};
+
+			const uint8_t *src_end = src + src_size;
+			const uint8_t *anchor = src;
+			const uint8_t *current = src;
+
+			uint8_t *dst_current = dst;
+			const uint8_t *dst_end = dst + dst_capacity;
+
+			if (src_size > MATCH_FIND_LIMIT)
+			{
+				const uint8_t *match_find_limit = src_end - MATCH_FIND_LIMIT;
+				const uint8_t *match_end_limit = src_end - LAST_LITERALS;
+
+				while (current < match_find_limit)
+				{
+					uint32_t sequence = read32(current);
+					uint32_t hash = (sequence * 2654435761U) >> (32 - HASH_LOG);
+
+					const uint8_t *candidate = src + table[hash];
+					table[hash] = static_cast<uint32_t>(current - src);
+
+					if (candidate >= current || static_cast<size_t>(current - candidate) > MAX_OFFSET || read32(candidate) != sequence)
+					{
+						current++;
+						continue;
+					}
+
+					size_t match_length = MIN_MATCH;
+					while (current + match_length < match_end_limit && current[match_length] == candidate[match_length])
+						match_length++;
+
+					size_t num_literals = static_cast<size_t>(current - anchor);
+					size_t offset = static_cast<size_t>(current - candidate);
+
+					if (!writeSequence(dst_current, dst_end, anchor, num_literals, offset, match_length))
+						return 0;
+
+					current += match_length;
+					anchor = current;
+				}
+			}
+
+			size_t num_literals = static_cast<size_t>(src_end - anchor);
+			if (!writeSequence(dst_current, dst_end, anchor, num_literals, 0, 0))
+				return 0;
+
+			return static_cast<size_t>(dst_current - dst);
+		}
+
+		inline bool readLength(const uint8_t *&src, const uint8_t *src_end, size_t &length)
+		{
+			uint8_t value = 255;
+
+			while (value == 255)
+			{
+				if (src >= src_end)
+					return false;
+
+				value = *src++;
+				length += value;
+			}
+
+			return true;
+		}
+
+		// dst_size must match the uncompressed size exactly
+		inline bool decompress(const uint8_t *src, size_t src_size, uint8_t *dst, size_t dst_size)
+		{
+			const uint8_t *src_end = src + src_size;
+			uint8_t *dst_current = dst;
+			const uint8_t *dst_end = dst + dst_size;
+
+			while (src < src_end)
+			{
+				uint8_t token = *src++;
+
+				size_t num_literals = token >> 4;
+				if (num_literals == 15 && !readLength(src, src_end, num_literals))
+					return false;
+
+				if (static_cast<size_t>(src_end - src) < num_literals || static_cast<size_t>(dst_end - dst_current) < num_literals)
+					return false;
+
+				memcpy(dst_current, src, num_literals);
+				src += num_literals;
+				dst_current += num_literals;
+
+				if (src == src_end)
+					break;
+
+				if (static_cast<size_t>(src_end - src) < 2)
+					return false;
+
+				size_t offset = static_cast<size_t>(src[0]) | (static_cast<size_t>(src[1]) << 8);
+				src += 2;
+
+				if (offset == 0 || offset > static_cast<size_t>(dst_current - dst))
+					return false;
+
+				size_t match_length = token & 0x0F;
+				if (match_length == 15 && !readLength(src, src_end, match_length))
+					return false;
+
+				match_length += MIN_MATCH;
+
+				if (static_cast<size_t>(dst_end - dst_current) < match_length)
+					return false;
+
+				// matches may overlap the output, so copy byte by byte
+				const uint8_t *match = dst_current - offset;
+				for (size_t i = 0; i < match_length; ++i)
+					dst_current[i] = match[i];
+
+				dst_current += match_length;
+			}
+
+			return dst_current == dst_end;
+		}
+	}
+}
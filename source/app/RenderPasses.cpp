@@ -1,18 +1,31 @@
 #include "RenderPasses.h"
 
+#include <scapes/foundation/Hash.h>
 #include <scapes/foundation/game/World.h>
 #include <scapes/foundation/game/Query.h>
+#include <scapes/foundation/profiler/Profiler.h>
 
 #include <scapes/visual/components/Components.h>
+#include <scapes/visual/Frustum.h>
+#include <scapes/visual/Mesh.h>
 #include <scapes/visual/Shader.h>
 
 #include <imgui.h>
 #include <imgui_internal.h>
 
+#include <algorithm>
+
 using namespace scapes;
 
 namespace yaml = scapes::foundation::serde::yaml;
 
+namespace ids
+{
+	static constexpr foundation::StringID camera = "Camera";
+	static constexpr foundation::StringID camera_view = "View";
+	static constexpr foundation::StringID camera_projection = "Projection";
+}
+
 namespace c4
 {
 	/*
@@ -33,6 +46,12 @@ RenderPassGraphicsBase::RenderPassGraphicsBase()
 RenderPassGraphicsBase::~RenderPassGraphicsBase()
 {
 	clear();
+
+	replaceShader(vertex_shader, visual::ShaderHandle());
+	replaceShader(tessellation_control_shader, visual::ShaderHandle());
+	replaceShader(tessellation_evaluation_shader, visual::ShaderHandle());
+	replaceShader(geometry_shader, visual::ShaderHandle());
+	replaceShader(fragment_shader, visual::ShaderHandle());
 }
 
 /*
@@ -90,6 +109,8 @@ void RenderPassGraphicsBase::render(visual::hardware::CommandBuffer command_buff
 		device->setBindSet(graphics_pipeline, current_binding++, bindings);
 	}
 
+	onPrepare(command_buffer);
+
 	if (render_pass_swapchain)
 	{
 		visual::hardware::SwapChain swap_chain = render_graph->getSwapChain();
@@ -273,9 +294,18 @@ void RenderPassGraphicsBase::deserializeShader(yaml::NodeRef node, visual::Shade
 	yaml::csubstr node_value = node.val();
 	std::string path = std::string(node_value.data(), node_value.size());
 
-	handle = resource_manager->fetch<visual::Shader>(path.c_str(), shader_type, device, compiler);
+	replaceShader(handle, resource_manager->fetch<visual::Shader>(path.c_str(), shader_type, device, compiler));
 };
 
+void RenderPassGraphicsBase::replaceShader(visual::ShaderHandle &handle, visual::ShaderHandle new_handle)
+{
+	// passes that were never attached to a graph can't hold any references
+	if (resource_manager)
+		resource_manager->release(handle);
+
+	handle = new_handle;
+}
+
 /*
  */
 bool RenderPassGraphicsBase::serialize(yaml::NodeRef node)
@@ -523,6 +553,7 @@ void RenderPassGraphicsBase::setRenderGraph(visual::RenderGraph *graph)
 
 	device = nullptr;
 	world = nullptr;
+	job_system = nullptr;
 	resource_manager = nullptr;
 	compiler = nullptr;
 	unit_quad = visual::MeshHandle();
@@ -531,6 +562,7 @@ void RenderPassGraphicsBase::setRenderGraph(visual::RenderGraph *graph)
 	{
 		device = render_graph->getDevice();
 		world = render_graph->getWorld();
+		job_system = render_graph->getJobSystem();
 		resource_manager = render_graph->getResourceManager();
 		compiler = render_graph->getCompiler();
 		unit_quad = render_graph->getUnitQuad();
@@ -650,12 +682,25 @@ void RenderPassPrepareOld::onRender(visual::hardware::CommandBuffer command_buff
 		command_buffer,
 		graphics_pipeline,
 		unit_quad->index_buffer,
-		unit_quad->num_indices
+		unit_quad->num_indices,
+		unit_quad->base_index,
+		static_cast<int32_t>(unit_quad->base_vertex)
 	);
 
 	first_frame = false;
 }
 
+/* Pass pipeline is fixed, so keys order draws by material bindings first and by mesh second;
+ * pointers are hashed to fit both into 64 bits
+ */
+static uint64_t getSortKey(const visual::Mesh *mesh, visual::hardware::BindSet material_bindings)
+{
+	uint64_t material_bits = foundation::hash::combine(0, reinterpret_cast<uint64_t>(material_bindings)) >> 32;
+	uint64_t mesh_bits = foundation::hash::combine(0, reinterpret_cast<uint64_t>(mesh)) >> 32;
+
+	return (material_bits << 32) | mesh_bits;
+}
+
 /*
  */
 visual::IRenderPass *RenderPassGeometry::create(visual::RenderGraph *render_graph)
@@ -666,6 +711,12 @@ visual::IRenderPass *RenderPassGeometry::create(visual::RenderGraph *render_grap
 	return result;
 }
 
+RenderPassGeometry::~RenderPassGeometry()
+{
+	replaceShader(culling_shader, visual::ShaderHandle());
+	replaceShader(indirect_vertex_shader, visual::ShaderHandle());
+}
+
 /*
  */
 void RenderPassGeometry::onInit()
@@ -673,36 +724,576 @@ void RenderPassGeometry::onInit()
 	device->setCullMode(graphics_pipeline, visual::hardware::CullMode::BACK);
 	device->setDepthTest(graphics_pipeline, true);
 	device->setDepthWrite(graphics_pipeline, true);
+
+	culling_pipeline = device->createComputePipeline();
+	culling_bindings = device->createBindSet();
+	transform_bindings = device->createBindSet();
+
+	query = new foundation::game::Query<const visual::components::Transform, const visual::components::Renderable>(world);
+
+	// the GPU driven path only uploads instances whose transform changed since the last frame
+	world->enableChangeTracking<visual::components::Transform>();
+	world->enableChangeTracking<visual::components::Renderable>();
+}
+
+void RenderPassGeometry::onShutdown()
+{
+	delete query;
+	query = nullptr;
+
+	device->destroyVertexBuffer(instances);
+	instances = SCAPES_NULL_HANDLE;
+	max_instances = 0;
+
+	device->destroyStorageBuffer(indirect_instances);
+	indirect_instances = SCAPES_NULL_HANDLE;
+
+	device->destroyStorageBuffer(indirect_bounds);
+	indirect_bounds = SCAPES_NULL_HANDLE;
+
+	device->destroyStorageBuffer(indirect_commands);
+	indirect_commands = SCAPES_NULL_HANDLE;
+
+	device->destroyStorageBuffer(visible_transforms);
+	visible_transforms = SCAPES_NULL_HANDLE;
+
+	max_indirect_instances = 0;
+	max_indirect_batches = 0;
+	indirect_structure_version = ~0ull;
+
+	device->destroyBindSet(culling_bindings);
+	culling_bindings = SCAPES_NULL_HANDLE;
+
+	device->destroyBindSet(transform_bindings);
+	transform_bindings = SCAPES_NULL_HANDLE;
+
+	device->destroyComputePipeline(culling_pipeline);
+	culling_pipeline = SCAPES_NULL_HANDLE;
+}
+
+void RenderPassGeometry::onPrepare(visual::hardware::CommandBuffer command_buffer)
+{
+	if (!isGPUDriven())
+	{
+		// nothing keeps persistent instances up to date on the CPU path
+		indirect_structure_version = ~0ull;
+		return;
+	}
+
+	// changes stamped up to this tick are uploaded now, later ones next frame
+	uint64_t since_tick = indirect_change_tick;
+	indirect_change_tick = world->advanceChangeTick();
+
+	uint64_t structure_version = world->getStructureVersion();
+
+	if (structure_version != indirect_structure_version || !updateIndirectInstances(since_tick))
+	{
+		buildIndirectBatches();
+		indirect_structure_version = structure_version;
+	}
+
+	num_culled = 0;
+	num_draw_calls = 0;
+
+	if (indirect_batches.empty())
+		return;
+
+	writeIndirectCommands();
+
+	SCAPES_PROFILER_N("Dispatch culling");
+
+	visual::Frustum frustum = getFrustum();
+
+	CullingConstants constants;
+	std::copy(std::begin(frustum.planes), std::end(frustum.planes), constants.planes);
+	constants.num_instances = num_instances;
+
+	device->setShader(culling_pipeline, culling_shader->shader);
+	device->clearBindSets(culling_pipeline);
+	device->setBindSet(culling_pipeline, 0, culling_bindings);
+	device->setPushConstants(culling_pipeline, static_cast<uint8_t>(sizeof(CullingConstants)), &constants);
+
+	constexpr uint32_t group_size = 64;
+	device->dispatch(command_buffer, culling_pipeline, (num_instances + group_size - 1) / group_size);
 }
 
 void RenderPassGeometry::onRender(visual::hardware::CommandBuffer command_buffer)
 {
-	auto query = foundation::game::Query<visual::components::Transform, visual::components::Renderable>(world);
+	if (isGPUDriven())
+	{
+		recordIndirectBatches(command_buffer);
+		return;
+	}
+
+	visual::Frustum frustum = getFrustum();
+	gatherDrawItems(&frustum);
+
+	num_culled = 0;
+	for (const DrawList &draw_list : draw_lists)
+		num_culled += draw_list.num_culled;
+
+	buildDrawBatches();
+
+	num_draw_calls = static_cast<uint32_t>(draw_batches.size());
+
+	recordDrawBatches(command_buffer);
+}
+
+visual::Frustum RenderPassGeometry::getFrustum() const
+{
+	foundation::math::mat4 view = render_graph->getGroupParameter<foundation::math::mat4>(ids::camera, ids::camera_view);
+	foundation::math::mat4 projection = render_graph->getGroupParameter<foundation::math::mat4>(ids::camera, ids::camera_projection);
+
+	return visual::Frustum::fromViewProjection(projection * view);
+}
+
+void RenderPassGeometry::gatherDrawItems(const visual::Frustum *frustum)
+{
+	foundation::StringID group_name(material_group_name);
+
+	draw_lists.resize(job_system->getNumThreads());
+	for (DrawList &draw_list : draw_lists)
+	{
+		draw_list.items.clear();
+		draw_list.num_culled = 0;
+	}
+
+	assert(frustum);
+
+	// culling and resolving bindings don't touch the device, so only recording stays on this thread
+	query->forEachChunkParallel(job_system, [&](uint32_t count, const visual::components::Transform *transforms, const visual::components::Renderable *renderables)
+	{
+		SCAPES_PROFILER_N("Cull chunk");
+
+		DrawList &draw_list = draw_lists[job_system->getThreadIndex()];
+
+		draw_list.resizeBounds(count);
+
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			// resolve handles once, every -> does a generation check
+			const visual::Mesh *mesh = renderables[i].mesh.get();
+			const foundation::math::mat4 &transform = transforms[i].transform;
+
+			foundation::math::vec3 center = foundation::math::vec3(transform * foundation::math::vec4(mesh->sphere_center, 1.0f));
+
+			// non-uniform scale stretches the sphere along the longest axis at most
+			float scale_squared = std::max({
+				foundation::math::dot(transform[0], transform[0]),
+				foundation::math::dot(transform[1], transform[1]),
+				foundation::math::dot(transform[2], transform[2]),
+			});
+
+			draw_list.meshes[i] = mesh;
+			draw_list.centers_x[i] = center.x;
+			draw_list.centers_y[i] = center.y;
+			draw_list.centers_z[i] = center.z;
+			draw_list.radii[i] = mesh->sphere_radius * sqrtf(scale_squared);
+		}
+
+		uint32_t num_visible = frustum->cullSpheres(
+			count,
+			draw_list.centers_x.data(),
+			draw_list.centers_y.data(),
+			draw_list.centers_z.data(),
+			draw_list.radii.data(),
+			draw_list.visible_indices.data()
+		);
+
+		draw_list.num_culled += count - num_visible;
+
+		for (uint32_t j = 0; j < num_visible; ++j)
+		{
+			uint32_t i = draw_list.visible_indices[j];
+
+			const visual::Mesh *mesh = draw_list.meshes[i];
+			const visual::Material *material = renderables[i].material.get();
+			visual::hardware::BindSet material_bindings = material->getGroupBindings(group_name);
+
+			draw_list.items.push_back({transforms[i].transform, mesh, material_bindings, getSortKey(mesh, material_bindings)});
+		}
+	});
+}
+
+void RenderPassGeometry::recordDrawBatches(visual::hardware::CommandBuffer command_buffer)
+{
+	if (draw_batches.empty())
+		return;
+
+	SCAPES_PROFILER_N("Record draw batches");
+
+	// batches are sorted, so state only changes at batch boundaries
+	visual::hardware::VertexBuffer current_vertex_buffer = SCAPES_NULL_HANDLE;
+	visual::hardware::BindSet current_material_bindings = SCAPES_NULL_HANDLE;
+
+	device->clearVertexStreams(graphics_pipeline);
+	device->setVertexStream(graphics_pipeline, 1, instances, visual::hardware::VertexInputRate::INSTANCE);
+
+	for (const DrawBatch &batch : draw_batches)
+	{
+		if (batch.mesh->vertex_buffer != current_vertex_buffer)
+		{
+			device->setVertexStream(graphics_pipeline, 0, batch.mesh->vertex_buffer);
+			current_vertex_buffer = batch.mesh->vertex_buffer;
+		}
+
+		if (batch.material_bindings != current_material_bindings)
+		{
+			device->setBindSet(graphics_pipeline, material_binding, batch.material_bindings);
+			current_material_bindings = batch.material_bindings;
+		}
+
+		device->drawIndexedPrimitiveInstanced(
+			command_buffer,
+			graphics_pipeline,
+			batch.mesh->index_buffer,
+			batch.mesh->num_indices,
+			batch.mesh->base_index,
+			static_cast<int32_t>(batch.mesh->base_vertex),
+			batch.num_instances,
+			batch.first_instance
+		);
+	}
+}
+
+void RenderPassGeometry::buildDrawBatches()
+{
+	SCAPES_PROFILER_N("Build draw batches");
+
+	draw_keys.clear();
+	draw_batches.clear();
+
+	for (const DrawList &draw_list : draw_lists)
+		for (const DrawItem &item : draw_list.items)
+			draw_keys.push_back({item.sort_key, &item});
+
+	num_instances = static_cast<uint32_t>(draw_keys.size());
+	if (num_instances == 0)
+		return;
+
+	// keys are hashes, so ties are broken by the actual state to keep equal items together
+	std::sort(draw_keys.begin(), draw_keys.end(), [](const DrawKey &a, const DrawKey &b)
+	{
+		if (a.sort_key != b.sort_key)
+			return a.sort_key < b.sort_key;
+
+		if (a.item->material_bindings != b.item->material_bindings)
+			return a.item->material_bindings < b.item->material_bindings;
+
+		// meshes from the same geometry arena page share buffers, keep them next to each other
+		if (a.item->mesh->vertex_buffer != b.item->mesh->vertex_buffer)
+			return a.item->mesh->vertex_buffer < b.item->mesh->vertex_buffer;
+
+		return a.item->mesh < b.item->mesh;
+	});
+
+	if (max_instances < num_instances)
+	{
+		static const uint8_t num_attributes = 4;
+		static visual::hardware::VertexAttribute attributes[4] =
+		{
+			{ visual::hardware::Format::R32G32B32A32_SFLOAT, 0, },
+			{ visual::hardware::Format::R32G32B32A32_SFLOAT, 16, },
+			{ visual::hardware::Format::R32G32B32A32_SFLOAT, 32, },
+			{ visual::hardware::Format::R32G32B32A32_SFLOAT, 48, },
+		};
+
+		constexpr uint16_t instance_size = static_cast<uint16_t>(sizeof(foundation::math::mat4));
+		static_assert(instance_size == 64, "Wrong instance size");
+
+		max_instances = num_instances;
+
+		device->destroyVertexBuffer(instances);
+		instances = device->createVertexBuffer(visual::hardware::BufferType::DYNAMIC, instance_size, max_instances, num_attributes, attributes, nullptr);
+	}
+
+	foundation::math::mat4 *instance_data = reinterpret_cast<foundation::math::mat4 *>(device->map(instances));
+
+	for (uint32_t i = 0; i < num_instances; ++i)
+	{
+		const DrawItem *item = draw_keys[i].item;
+		instance_data[i] = item->transform;
+
+		bool same_batch = !draw_batches.empty()
+			&& draw_batches.back().mesh == item->mesh
+			&& draw_batches.back().material_bindings == item->material_bindings;
+
+		if (!same_batch)
+			draw_batches.push_back({item->mesh, item->material_bindings, i, 0});
+
+		draw_batches.back().num_instances++;
+	}
+
+	device->unmap(instances);
+}
+
+void RenderPassGeometry::buildIndirectBatches()
+{
+	SCAPES_PROFILER_N("Build indirect batches");
+
+	foundation::StringID group_name(material_group_name);
+
+	indirect_batches.clear();
+	indirect_order.clear();
+	indirect_batch_lookup.clear();
+	indirect_instance_batches.clear();
+
+	num_uploaded_instances = 0;
+
+	uint32_t current_batch = 0;
+
+	// instance rows follow query order, so later frames find moved entities by walking the query again
+	query->forEachChunk([&](uint32_t count, const visual::components::Transform *transforms, const visual::components::Renderable *renderables)
+	{
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			const visual::Mesh *mesh = renderables[i].mesh.get();
+			const visual::Material *material = renderables[i].material.get();
+			visual::hardware::BindSet material_bindings = material->getGroupBindings(group_name);
+
+			bool same_batch = !indirect_batches.empty()
+				&& indirect_batches[current_batch].mesh == mesh
+				&& indirect_batches[current_batch].material_bindings == material_bindings;
+
+			if (!same_batch)
+			{
+				auto result = indirect_batch_lookup.insert({{mesh, material_bindings}, static_cast<uint32_t>(indirect_batches.size())});
+				if (result.second)
+					indirect_batches.push_back({mesh, material, material_bindings, getSortKey(mesh, material_bindings), 0, 0, 0});
+
+				current_batch = result.first->second;
+			}
+
+			indirect_batches[current_batch].num_instances++;
+			indirect_instance_batches.push_back(current_batch);
+		}
+	});
+
+	num_instances = static_cast<uint32_t>(indirect_instance_batches.size());
+	if (num_instances == 0)
+		return;
+
+	uint32_t num_batches = static_cast<uint32_t>(indirect_batches.size());
+
+	indirect_order.resize(num_batches);
+	for (uint32_t i = 0; i < num_batches; ++i)
+		indirect_order[i] = i;
+
+	std::sort(indirect_order.begin(), indirect_order.end(), [this](uint32_t a, uint32_t b)
+	{
+		const IndirectBatch &batch_a = indirect_batches[a];
+		const IndirectBatch &batch_b = indirect_batches[b];
+
+		if (batch_a.sort_key != batch_b.sort_key)
+			return batch_a.sort_key < batch_b.sort_key;
+
+		if (batch_a.material_bindings != batch_b.material_bindings)
+			return batch_a.material_bindings < batch_b.material_bindings;
+
+		if (batch_a.mesh->vertex_buffer != batch_b.mesh->vertex_buffer)
+			return batch_a.mesh->vertex_buffer < batch_b.mesh->vertex_buffer;
+
+		return batch_a.mesh < batch_b.mesh;
+	});
+
+	// commands follow the sorted order, so neighbouring batches sharing state go out as one multi draw
+	uint32_t base_instance = 0;
+	for (uint32_t i = 0; i < num_batches; ++i)
+	{
+		IndirectBatch &batch = indirect_batches[indirect_order[i]];
+		batch.command = i;
+		batch.base_instance = base_instance;
+		base_instance += batch.num_instances;
+	}
+
+	reserveIndirectBuffers(num_instances, num_batches);
+
+	// the compute shader scatters visible instances into their batch range
+	IndirectInstance *instance_data = reinterpret_cast<IndirectInstance *>(device->map(indirect_instances));
+	uint32_t row = 0;
+
+	query->forEachChunk([&](uint32_t count, const visual::components::Transform *transforms, const visual::components::Renderable *renderables)
+	{
+		for (uint32_t i = 0; i < count; ++i, ++row)
+		{
+			instance_data[row].transform = transforms[i].transform;
+			instance_data[row].batch = indirect_batches[indirect_instance_batches[row]].command;
+		}
+	});
+
+	device->unmap(indirect_instances);
+
+	num_uploaded_instances = num_instances;
+}
+
+bool RenderPassGeometry::updateIndirectInstances(uint64_t since_tick)
+{
+	SCAPES_PROFILER_N("Update indirect instances");
+
+	num_uploaded_instances = 0;
 
-	query.begin();
+	if (num_instances == 0)
+		return true;
+
+	IndirectInstance *instance_data = nullptr;
+	uint32_t first_row = 0;
+	bool needs_rebuild = false;
 
-	while (query.next())
+	query->forEachChunk([&](uint32_t count, const visual::components::Transform *transforms, const visual::components::Renderable *renderables)
 	{
-		uint32_t num_items = query.getNumComponents();
-		visual::components::Transform *transforms = query.getComponents<visual::components::Transform>(0);
-		visual::components::Renderable *renderables = query.getComponents<visual::components::Renderable>(1);
+		const uint64_t *transform_ticks = query->getChangeTicks(0);
+		const uint64_t *renderable_ticks = query->getChangeTicks(1);
 
-		for (uint32_t i = 0; i < num_items; ++i)
+		// a swapped mesh or material moves the instance to another batch
+		needs_rebuild = needs_rebuild || !transform_ticks || !renderable_ticks;
+
+		for (uint32_t i = 0; i < count && !needs_rebuild; ++i)
 		{
-			const visual::components::Transform &transform = transforms[i];
-			const visual::components::Renderable &renderable = renderables[i];
-			const foundation::math::mat4 &node_transform = transform.transform;
+			needs_rebuild = renderable_ticks[i] > since_tick;
+
+			if (transform_ticks[i] <= since_tick)
+				continue;
+
+			if (!instance_data)
+				instance_data = reinterpret_cast<IndirectInstance *>(device->map(indirect_instances));
+
+			instance_data[first_row + i].transform = transforms[i].transform;
+			num_uploaded_instances++;
+		}
 
-			visual::hardware::BindSet material_bindings = renderable.material->getGroupBindings(material_group_name.c_str());
+		first_row += count;
+	});
 
-			device->clearVertexStreams(graphics_pipeline);
-			device->setVertexStream(graphics_pipeline, 0, renderable.mesh->vertex_buffer);
+	if (instance_data)
+		device->unmap(indirect_instances);
 
-			device->setBindSet(graphics_pipeline, material_binding, material_bindings);
-			device->setPushConstants(graphics_pipeline, static_cast<uint8_t>(sizeof(foundation::math::mat4)), &node_transform);
+	return !needs_rebuild;
+}
+
+void RenderPassGeometry::writeIndirectCommands()
+{
+	foundation::StringID group_name(material_group_name);
+
+	uint32_t num_batches = static_cast<uint32_t>(indirect_order.size());
+
+	foundation::math::vec4 *bounds_data = reinterpret_cast<foundation::math::vec4 *>(device->map(indirect_bounds));
+	visual::hardware::DrawIndexedIndirectCommand *command_data = reinterpret_cast<visual::hardware::DrawIndexedIndirectCommand *>(device->map(indirect_commands));
+
+	for (uint32_t i = 0; i < num_batches; ++i)
+	{
+		IndirectBatch &batch = indirect_batches[indirect_order[i]];
 
-			device->drawIndexedPrimitiveInstanced(command_buffer, graphics_pipeline, renderable.mesh->index_buffer, renderable.mesh->num_indices);
+		// a reload may replace material bindings or move the mesh, both are cheap to refresh per batch
+		batch.material_bindings = batch.material->getGroupBindings(group_name);
+
+		bounds_data[i] = foundation::math::vec4(batch.mesh->sphere_center, batch.mesh->sphere_radius);
+
+		// instance count is accumulated by the compute shader
+		visual::hardware::DrawIndexedIndirectCommand &command = command_data[i];
+		command.num_indices = batch.mesh->num_indices;
+		command.num_instances = 0;
+		command.base_index = batch.mesh->base_index;
+		command.base_vertex = static_cast<int32_t>(batch.mesh->base_vertex);
+		command.base_instance = batch.base_instance;
+	}
+
+	device->unmap(indirect_commands);
+	device->unmap(indirect_bounds);
+}
+
+void RenderPassGeometry::recordIndirectBatches(visual::hardware::CommandBuffer command_buffer)
+{
+	if (indirect_batches.empty())
+		return;
+
+	SCAPES_PROFILER_N("Record indirect batches");
+
+	visual::hardware::VertexBuffer current_vertex_buffer = SCAPES_NULL_HANDLE;
+	visual::hardware::BindSet current_material_bindings = SCAPES_NULL_HANDLE;
+
+	device->setShader(graphics_pipeline, indirect_vertex_shader->type, indirect_vertex_shader->shader);
+	device->clearVertexStreams(graphics_pipeline);
+	device->setBindSet(graphics_pipeline, transform_binding, transform_bindings);
+
+	uint32_t num_batches = static_cast<uint32_t>(indirect_order.size());
+	uint32_t first = 0;
+
+	while (first < num_batches)
+	{
+		const IndirectBatch &batch = indirect_batches[indirect_order[first]];
+
+		// same material and same arena page, one multi draw covers the whole run
+		uint32_t last = first + 1;
+		for (; last < num_batches; ++last)
+		{
+			const IndirectBatch &next = indirect_batches[indirect_order[last]];
+
+			bool same_state = next.material_bindings == batch.material_bindings
+				&& next.mesh->vertex_buffer == batch.mesh->vertex_buffer
+				&& next.mesh->index_buffer == batch.mesh->index_buffer;
+
+			if (!same_state)
+				break;
 		}
+
+		if (batch.mesh->vertex_buffer != current_vertex_buffer)
+		{
+			device->setVertexStream(graphics_pipeline, 0, batch.mesh->vertex_buffer);
+			current_vertex_buffer = batch.mesh->vertex_buffer;
+		}
+
+		if (batch.material_bindings != current_material_bindings)
+		{
+			device->setBindSet(graphics_pipeline, material_binding, batch.material_bindings);
+			current_material_bindings = batch.material_bindings;
+		}
+
+		device->drawIndexedIndirect(
+			command_buffer,
+			graphics_pipeline,
+			batch.mesh->index_buffer,
+			indirect_commands,
+			first * sizeof(visual::hardware::DrawIndexedIndirectCommand),
+			last - first
+		);
+
+		num_draw_calls++;
+		first = last;
+	}
+}
+
+void RenderPassGeometry::reserveIndirectBuffers(uint32_t num_instances, uint32_t num_batches)
+{
+	static_assert(sizeof(IndirectInstance) == 80, "Wrong indirect instance size");
+	static_assert(sizeof(CullingConstants) <= 128, "Culling constants don't fit into push constants");
+
+	if (max_indirect_instances < num_instances)
+	{
+		max_indirect_instances = num_instances;
+
+		device->destroyStorageBuffer(indirect_instances);
+		device->destroyStorageBuffer(visible_transforms);
+
+		indirect_instances = device->createStorageBuffer(visual::hardware::BufferType::DYNAMIC, max_indirect_instances * sizeof(IndirectInstance));
+		visible_transforms = device->createStorageBuffer(visual::hardware::BufferType::STATIC, max_indirect_instances * sizeof(foundation::math::mat4));
+
+		device->bindStorageBuffer(culling_bindings, 0, indirect_instances);
+		device->bindStorageBuffer(culling_bindings, 3, visible_transforms);
+		device->bindStorageBuffer(transform_bindings, 0, visible_transforms);
+	}
+
+	if (max_indirect_batches < num_batches)
+	{
+		max_indirect_batches = num_batches;
+
+		device->destroyStorageBuffer(indirect_bounds);
+		device->destroyStorageBuffer(indirect_commands);
+
+		indirect_bounds = device->createStorageBuffer(visual::hardware::BufferType::DYNAMIC, max_indirect_batches * sizeof(foundation::math::vec4));
+		indirect_commands = device->createStorageBuffer(visual::hardware::BufferType::DYNAMIC, max_indirect_batches * sizeof(visual::hardware::DrawIndexedIndirectCommand));
+
+		device->bindStorageBuffer(culling_bindings, 1, indirect_bounds);
+		device->bindStorageBuffer(culling_bindings, 2, indirect_commands);
 	}
 }
 
@@ -717,6 +1308,18 @@ bool RenderPassGeometry::onDeserialize(const yaml::NodeRef node)
 
 		else if (child_key.compare("input_material_group_name") == 0 && child.has_val())
 			child >> material_group_name;
+
+		else if (child_key.compare("input_transform_binding") == 0 && child.has_val())
+			child >> transform_binding;
+
+		else if (child_key.compare("gpu_driven") == 0 && child.has_val())
+			child >> gpu_driven;
+
+		else if (child_key.compare("culling_shader") == 0)
+			deserializeShader(child, culling_shader, visual::hardware::ShaderType::COMPUTE);
+
+		else if (child_key.compare("indirect_vertex_shader") == 0)
+			deserializeShader(child, indirect_vertex_shader, visual::hardware::ShaderType::VERTEX);
 	}
 
 	return true;
@@ -725,6 +1328,11 @@ bool RenderPassGeometry::onDeserialize(const yaml::NodeRef node)
 bool RenderPassGeometry::onSerialize(yaml::NodeRef node)
 {
 	node["input_material_binding"] << material_binding;
+	node["input_transform_binding"] << transform_binding;
+	node["gpu_driven"] << gpu_driven;
+
+	serializeShader(node, "culling_shader", culling_shader);
+	serializeShader(node, "indirect_vertex_shader", indirect_vertex_shader);
 
 	return true;
 }
@@ -745,32 +1353,30 @@ void RenderPassLBuffer::onInit()
 {
 	device->clearVertexStreams(graphics_pipeline);
 	device->setVertexStream(graphics_pipeline, 0, unit_quad->vertex_buffer);
+
+	query = new foundation::game::Query<visual::components::SkyLight>(world);
 }
 
-void RenderPassLBuffer::onRender(visual::hardware::CommandBuffer command_buffer)
+void RenderPassLBuffer::onShutdown()
 {
-	auto query = foundation::game::Query<visual::components::SkyLight>(world);
-
-	query.begin();
+	delete query;
+	query = nullptr;
+}
 
-	while (query.next())
+void RenderPassLBuffer::onRender(visual::hardware::CommandBuffer command_buffer)
+{
+	query->forEach([&](const visual::components::SkyLight &light)
 	{
-		uint32_t num_items = query.getNumComponents();
-		visual::components::SkyLight *skylights = query.getComponents<visual::components::SkyLight>(0);
-
-		for (uint32_t i = 0; i < num_items; ++i)
-		{
-			const visual::components::SkyLight &light = skylights[i];
-
-			device->setBindSet(graphics_pipeline, light_binding, light.ibl_environment->bindings);
-			device->drawIndexedPrimitiveInstanced(
-				command_buffer,
-				graphics_pipeline,
-				unit_quad->index_buffer,
-				unit_quad->num_indices
-			);
-		}
-	}
+		device->setBindSet(graphics_pipeline, light_binding, light.ibl_environment->bindings);
+		device->drawIndexedPrimitiveInstanced(
+			command_buffer,
+			graphics_pipeline,
+			unit_quad->index_buffer,
+			unit_quad->num_indices,
+			unit_quad->base_index,
+			static_cast<int32_t>(unit_quad->base_vertex)
+		);
+	});
 }
 
 bool RenderPassLBuffer::onDeserialize(const yaml::NodeRef node)
@@ -817,10 +1423,284 @@ void RenderPassPost::onRender(visual::hardware::CommandBuffer command_buffer)
 		command_buffer,
 		graphics_pipeline,
 		unit_quad->index_buffer,
-		unit_quad->num_indices
+		unit_quad->num_indices,
+		unit_quad->base_index,
+		static_cast<int32_t>(unit_quad->base_vertex)
+	);
+}
+
+/*
+ */
+visual::IRenderPass *RenderPassCompute::create(visual::RenderGraph *render_graph)
+{
+	RenderPassCompute *result = new RenderPassCompute();
+	result->setRenderGraph(render_graph);
+
+	return result;
+}
+
+/*
+ */
+RenderPassCompute::RenderPassCompute()
+{
+}
+
+RenderPassCompute::~RenderPassCompute()
+{
+	// passes that were never attached to a graph have nothing to release
+	if (device)
+		destroyResources();
+
+	setComputeShader(visual::ShaderHandle());
+}
+
+/*
+ */
+void RenderPassCompute::setComputeShader(visual::ShaderHandle handle)
+{
+	if (resource_manager)
+		resource_manager->release(compute_shader);
+
+	compute_shader = handle;
+}
+
+/*
+ */
+void RenderPassCompute::init()
+{
+	compute_pipeline = device->createComputePipeline();
+	output_bindings = device->createBindSet();
+}
+
+void RenderPassCompute::shutdown()
+{
+	// keep the deserialized configuration, init() may follow
+	destroyResources();
+}
+
+void RenderPassCompute::render(visual::hardware::CommandBuffer command_buffer)
+{
+	if (!compute_shader.get() || output_render_buffers.empty())
+		return;
+
+	device->setShader(compute_pipeline, compute_shader->shader);
+	device->clearBindSets(compute_pipeline);
+
+	uint8_t current_binding = 0;
+	for (size_t i = 0; i < input_groups.size(); ++i)
+	{
+		const char *group_name = input_groups[i].c_str();
+		visual::hardware::BindSet bindings = render_graph->getGroupBindings(group_name);
+		device->setBindSet(compute_pipeline, current_binding++, bindings);
+	}
+
+	for (size_t i = 0; i < input_render_buffers.size(); ++i)
+	{
+		const char *texture_name = input_render_buffers[i].c_str();
+		visual::hardware::BindSet bindings = render_graph->getRenderBufferBindings(texture_name);
+		device->setBindSet(compute_pipeline, current_binding++, bindings);
+	}
+
+	// render buffers may be recreated or swapped between frames
+	for (size_t i = 0; i < output_render_buffers.size(); ++i)
+	{
+		const char *texture_name = output_render_buffers[i].c_str();
+		visual::hardware::Texture texture = render_graph->getRenderBufferTexture(texture_name);
+		device->bindStorageImage(output_bindings, static_cast<uint32_t>(i), texture);
+	}
+
+	device->setBindSet(compute_pipeline, current_binding++, output_bindings);
+
+	uint32_t downscale = render_graph->getRenderBufferDownscale(output_render_buffers[0].c_str());
+	uint32_t width = std::max<uint32_t>(1, render_graph->getWidth() / downscale);
+	uint32_t height = std::max<uint32_t>(1, render_graph->getHeight() / downscale);
+
+	device->dispatch(
+		command_buffer,
+		compute_pipeline,
+		(width + group_size_x - 1) / group_size_x,
+		(height + group_size_y - 1) / group_size_y
 	);
 }
 
+void RenderPassCompute::invalidate()
+{
+}
+
+/*
+ */
+bool RenderPassCompute::deserialize(const yaml::NodeRef node)
+{
+	for (const yaml::NodeRef child : node.children())
+	{
+		yaml::csubstr child_key = child.key();
+
+		if (child_key.compare("input_groups") == 0)
+		{
+			for (const yaml::NodeRef input_group : child.children())
+			{
+				yaml::csubstr value = input_group.val();
+				std::string group_name = std::string(value.data(), value.size());
+
+				addInputGroup(group_name.c_str());
+			}
+		}
+
+		else if (child_key.compare("input_renderbuffers") == 0)
+		{
+			for (const yaml::NodeRef input_renderbuffer : child.children())
+			{
+				yaml::csubstr value = input_renderbuffer.val();
+				std::string renderbuffer_name = std::string(value.data(), value.size());
+
+				addInputRenderBuffer(renderbuffer_name.c_str());
+			}
+		}
+
+		else if (child_key.compare("output_renderbuffers") == 0)
+		{
+			for (const yaml::NodeRef output_renderbuffer : child.children())
+			{
+				yaml::csubstr value = output_renderbuffer.val();
+				std::string renderbuffer_name = std::string(value.data(), value.size());
+
+				addOutputRenderBuffer(renderbuffer_name.c_str());
+			}
+		}
+
+		else if (child_key.compare("group_size_x") == 0 && child.has_val())
+			child >> group_size_x;
+
+		else if (child_key.compare("group_size_y") == 0 && child.has_val())
+			child >> group_size_y;
+
+		else if (child_key.compare("compute_shader") == 0 && child.has_val())
+		{
+			yaml::csubstr value = child.val();
+			std::string path = std::string(value.data(), value.size());
+
+			setComputeShader(resource_manager->fetch<visual::Shader>(path.c_str(), visual::hardware::ShaderType::COMPUTE, device, compiler));
+		}
+	}
+
+	return true;
+}
+
+bool RenderPassCompute::serialize(yaml::NodeRef node)
+{
+	if (input_groups.size() > 0)
+	{
+		yaml::NodeRef container = node.append_child();
+		container.set_key("input_groups");
+		container |= yaml::SEQ;
+
+		for (const std::string &name : input_groups)
+		{
+			yaml::NodeRef child = container.append_child();
+			child << name.c_str();
+		}
+	}
+
+	if (input_render_buffers.size() > 0)
+	{
+		yaml::NodeRef container = node.append_child();
+		container.set_key("input_renderbuffers");
+		container |= yaml::SEQ;
+
+		for (const std::string &name : input_render_buffers)
+		{
+			yaml::NodeRef child = container.append_child();
+			child << name.c_str();
+		}
+	}
+
+	if (output_render_buffers.size() > 0)
+	{
+		yaml::NodeRef container = node.append_child();
+		container.set_key("output_renderbuffers");
+		container |= yaml::SEQ;
+
+		for (const std::string &name : output_render_buffers)
+		{
+			yaml::NodeRef child = container.append_child();
+			child << name.c_str();
+		}
+	}
+
+	node["group_size_x"] << group_size_x;
+	node["group_size_y"] << group_size_y;
+
+	if (compute_shader.get())
+	{
+		const foundation::io::URI &uri = resource_manager->getUri(compute_shader);
+		if (!uri.empty())
+			node["compute_shader"] << uri.c_str();
+	}
+
+	return true;
+}
+
+/*
+ */
+void RenderPassCompute::addInputGroup(const char *name)
+{
+	input_groups.push_back(std::string(name));
+}
+
+void RenderPassCompute::removeAllInputGroups()
+{
+	input_groups.clear();
+}
+
+void RenderPassCompute::addInputRenderBuffer(const char *name)
+{
+	input_render_buffers.push_back(std::string(name));
+}
+
+void RenderPassCompute::removeAllInputRenderBuffers()
+{
+	input_render_buffers.clear();
+}
+
+void RenderPassCompute::addOutputRenderBuffer(const char *name)
+{
+	output_render_buffers.push_back(std::string(name));
+}
+
+void RenderPassCompute::removeAllOutputRenderBuffers()
+{
+	output_render_buffers.clear();
+}
+
+/*
+ */
+void RenderPassCompute::setRenderGraph(visual::RenderGraph *graph)
+{
+	render_graph = graph;
+
+	device = nullptr;
+	resource_manager = nullptr;
+	compiler = nullptr;
+
+	if (render_graph)
+	{
+		device = render_graph->getDevice();
+		resource_manager = render_graph->getResourceManager();
+		compiler = render_graph->getCompiler();
+	}
+}
+
+/*
+ */
+void RenderPassCompute::destroyResources()
+{
+	device->destroyBindSet(output_bindings);
+	output_bindings = SCAPES_NULL_HANDLE;
+
+	device->destroyComputePipeline(compute_pipeline);
+	compute_pipeline = SCAPES_NULL_HANDLE;
+}
+
 /*
  */
 visual::IRenderPass *RenderPassImGui::create(visual::RenderGraph *render_graph)
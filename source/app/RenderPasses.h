@@ -1,13 +1,16 @@
 #pragma once
 
 #include <scapes/foundation/math/Math.h>
+#include <scapes/foundation/Hash.h>
 #include <scapes/visual/hardware/Device.h>
 
+#include <scapes/visual/Frustum.h>
 #include <scapes/visual/RenderGraph.h>
 
 #include <string>
 #include <vector>
 #include <map>
+#include <unordered_map>
 
 /*
  */
@@ -65,23 +68,25 @@ public:
 	SCAPES_INLINE scapes::visual::RenderGraph *getRenderGraph() { return render_graph; }
 	SCAPES_INLINE const scapes::visual::RenderGraph *getRenderGraph() const { return render_graph; }
 
-	SCAPES_INLINE void setVertexShader(scapes::visual::ShaderHandle handle) { vertex_shader = handle; }
+	// the pass takes over the caller's reference and releases the shader it replaces
+	SCAPES_INLINE void setVertexShader(scapes::visual::ShaderHandle handle) { replaceShader(vertex_shader, handle); }
 	SCAPES_INLINE scapes::visual::ShaderHandle getVertexShader() const { return vertex_shader; }
 
-	SCAPES_INLINE void setTessellationControlShader(scapes::visual::ShaderHandle handle) { tessellation_control_shader = handle; }
+	SCAPES_INLINE void setTessellationControlShader(scapes::visual::ShaderHandle handle) { replaceShader(tessellation_control_shader, handle); }
 	SCAPES_INLINE scapes::visual::ShaderHandle getTessellationControlShader() const { return tessellation_control_shader; }
 
-	SCAPES_INLINE void setTesselationEvaluationShader(scapes::visual::ShaderHandle handle) { tessellation_evaluation_shader = handle; }
+	SCAPES_INLINE void setTesselationEvaluationShader(scapes::visual::ShaderHandle handle) { replaceShader(tessellation_evaluation_shader, handle); }
 	SCAPES_INLINE scapes::visual::ShaderHandle getTesselationEvaluationShader() const { return tessellation_evaluation_shader; }
 
-	SCAPES_INLINE void setGeometryShader(scapes::visual::ShaderHandle handle) { geometry_shader = handle; }
+	SCAPES_INLINE void setGeometryShader(scapes::visual::ShaderHandle handle) { replaceShader(geometry_shader, handle); }
 	SCAPES_INLINE scapes::visual::ShaderHandle getGeometryShader() const { return geometry_shader; }
 
-	SCAPES_INLINE void setFragmentShader(scapes::visual::ShaderHandle handle) { fragment_shader = handle; }
+	SCAPES_INLINE void setFragmentShader(scapes::visual::ShaderHandle handle) { replaceShader(fragment_shader, handle); }
 	SCAPES_INLINE scapes::visual::ShaderHandle getFragmentShader() const { return fragment_shader; }
 
 protected:
 	virtual bool canRender() const { return true; }
+	virtual void onPrepare(scapes::visual::hardware::CommandBuffer command_buffer) {} // called outside of the render pass, before onRender
 	virtual void onRender(scapes::visual::hardware::CommandBuffer command_buffer) {}
 	virtual void onInit() {}
 	virtual void onShutdown() {}
@@ -112,10 +117,13 @@ private:
 
 	void deserializeFrameBufferOutput(scapes::foundation::serde::yaml::NodeRef node, bool is_depthstencil);
 	void deserializeSwapChainOutput(scapes::foundation::serde::yaml::NodeRef node);
-	void deserializeShader(scapes::foundation::serde::yaml::NodeRef node, scapes::visual::ShaderHandle &handle, scapes::visual::hardware::ShaderType shader_type);
 
 	void serializeFrameBufferOutput(scapes::foundation::serde::yaml::NodeRef node, const FrameBufferOutput &data, bool is_depthstencil);
 	void serializeSwapChainOutput(scapes::foundation::serde::yaml::NodeRef node, const SwapChainOutput &data);
+
+protected:
+	void deserializeShader(scapes::foundation::serde::yaml::NodeRef node, scapes::visual::ShaderHandle &handle, scapes::visual::hardware::ShaderType shader_type);
+	void replaceShader(scapes::visual::ShaderHandle &handle, scapes::visual::ShaderHandle new_handle);
 	void serializeShader(scapes::foundation::serde::yaml::NodeRef node, const char *name, scapes::visual::ShaderHandle handle);
 
 protected:
@@ -134,6 +142,7 @@ protected:
 	scapes::visual::hardware::Device *device {nullptr};
 	scapes::visual::shaders::Compiler *compiler {nullptr};
 	scapes::foundation::game::World *world {nullptr};
+	scapes::foundation::jobs::JobSystem *job_system {nullptr};
 
 	scapes::visual::MeshHandle unit_quad;
 
@@ -177,20 +186,184 @@ class RenderPassGeometry final : public RenderPassGraphicsBase
 {
 public:
 	static scapes::visual::IRenderPass *create(scapes::visual::RenderGraph *render_graph);
+	~RenderPassGeometry() override;
 
 public:
 	SCAPES_INLINE void setMaterialBinding(uint32_t binding) { material_binding = binding; }
 	SCAPES_INLINE void setMaterialGroupName(const char *name) { material_group_name = std::string(name); }
+	SCAPES_INLINE void setTransformBinding(uint32_t binding) { transform_binding = binding; }
+
+	// culls and fills draw commands in a compute shader, needs both culling and indirect vertex shaders
+	SCAPES_INLINE void setGPUDriven(bool enabled) { gpu_driven = enabled; }
+	SCAPES_INLINE bool isGPUDriven() const { return gpu_driven && culling_shader.get() && indirect_vertex_shader.get(); }
+
+	SCAPES_INLINE void setCullingShader(scapes::visual::ShaderHandle handle) { replaceShader(culling_shader, handle); }
+	SCAPES_INLINE scapes::visual::ShaderHandle getCullingShader() const { return culling_shader; }
+
+	SCAPES_INLINE void setIndirectVertexShader(scapes::visual::ShaderHandle handle) { replaceShader(indirect_vertex_shader, handle); }
+	SCAPES_INLINE scapes::visual::ShaderHandle getIndirectVertexShader() const { return indirect_vertex_shader; }
+
+	// last frame stats, nothing is counted as culled when culling runs on the GPU
+	SCAPES_INLINE uint32_t getNumDrawCalls() const { return num_draw_calls; }
+	SCAPES_INLINE uint32_t getNumInstances() const { return num_instances; }
+	SCAPES_INLINE uint32_t getNumCulled() const { return num_culled; }
+
+	// instances written to the GPU last frame, only moved ones unless entities or renderables changed
+	SCAPES_INLINE uint32_t getNumUploadedInstances() const { return num_uploaded_instances; }
 
 private:
 	void onInit() final;
+	void onShutdown() final;
+	void onPrepare(scapes::visual::hardware::CommandBuffer command_buffer) final;
 	void onRender(scapes::visual::hardware::CommandBuffer command_buffer) final;
 	bool onDeserialize(const scapes::foundation::serde::yaml::NodeRef node) final;
 	bool onSerialize(scapes::foundation::serde::yaml::NodeRef node) final;
 
+	scapes::visual::Frustum getFrustum() const;
+	void gatherDrawItems(const scapes::visual::Frustum *frustum);
+
+	void buildDrawBatches();
+	void recordDrawBatches(scapes::visual::hardware::CommandBuffer command_buffer);
+
+	void buildIndirectBatches();
+	bool updateIndirectInstances(uint64_t since_tick);
+	void writeIndirectCommands();
+	void recordIndirectBatches(scapes::visual::hardware::CommandBuffer command_buffer);
+	void reserveIndirectBuffers(uint32_t num_instances, uint32_t num_batches);
+
+private:
+	struct DrawItem
+	{
+		scapes::foundation::math::mat4 transform;
+		const scapes::visual::Mesh *mesh {nullptr};
+		scapes::visual::hardware::BindSet material_bindings {SCAPES_NULL_HANDLE};
+		uint64_t sort_key {0};
+	};
+
+	// one per job system thread, padded so appends from different threads don't share cache lines
+	struct alignas(64) DrawList
+	{
+		std::vector<DrawItem> items;
+		uint32_t num_culled {0};
+
+		// world space bounding spheres of the chunk being culled
+		std::vector<const scapes::visual::Mesh *> meshes;
+		std::vector<float> centers_x;
+		std::vector<float> centers_y;
+		std::vector<float> centers_z;
+		std::vector<float> radii;
+		std::vector<uint32_t> visible_indices;
+
+		SCAPES_INLINE void resizeBounds(uint32_t count)
+		{
+			meshes.resize(count);
+			centers_x.resize(count);
+			centers_y.resize(count);
+			centers_z.resize(count);
+			radii.resize(count);
+			visible_indices.resize(count);
+		}
+	};
+
+	struct DrawKey
+	{
+		uint64_t sort_key {0};
+		const DrawItem *item {nullptr};
+	};
+
+	// consecutive instances with the same mesh and material
+	struct DrawBatch
+	{
+		const scapes::visual::Mesh *mesh {nullptr};
+		scapes::visual::hardware::BindSet material_bindings {SCAPES_NULL_HANDLE};
+		uint32_t first_instance {0};
+		uint32_t num_instances {0};
+	};
+
+	// instance layout of GBufferCulling.comp, std430 pads it to 80 bytes
+	struct IndirectInstance
+	{
+		scapes::foundation::math::mat4 transform;
+		uint32_t batch {0};
+		uint32_t padding[3];
+	};
+
+	// every instance with the same mesh and material, the compute shader fills its draw command
+	struct IndirectBatch
+	{
+		const scapes::visual::Mesh *mesh {nullptr};
+		const scapes::visual::Material *material {nullptr};
+		scapes::visual::hardware::BindSet material_bindings {SCAPES_NULL_HANDLE};
+		uint64_t sort_key {0};
+		uint32_t command {0};
+		uint32_t base_instance {0};
+		uint32_t num_instances {0};
+	};
+
+	// frustum planes and instance count, matches GBufferCulling.comp push constants
+	struct CullingConstants
+	{
+		scapes::foundation::math::vec4 planes[scapes::visual::Frustum::MAX_PLANES];
+		uint32_t num_instances {0};
+	};
+
+	using IndirectBatchKey = std::pair<const scapes::visual::Mesh *, scapes::visual::hardware::BindSet>;
+
+	struct IndirectBatchKeyHasher
+	{
+		std::size_t operator()(const IndirectBatchKey &key) const
+		{
+			uint64_t hash = scapes::foundation::hash::combine(0, reinterpret_cast<uint64_t>(key.first));
+			hash = scapes::foundation::hash::combine(hash, reinterpret_cast<uint64_t>(key.second));
+
+			return static_cast<std::size_t>(hash);
+		}
+	};
+
 private:
 	uint32_t material_binding {0};
 	std::string material_group_name;
+
+	scapes::foundation::game::Query<const scapes::visual::components::Transform, const scapes::visual::components::Renderable> *query {nullptr};
+	std::vector<DrawList> draw_lists;
+	std::vector<DrawKey> draw_keys;
+	std::vector<DrawBatch> draw_batches;
+
+	// per instance transforms in draw order, bound as the second vertex stream
+	scapes::visual::hardware::VertexBuffer instances {SCAPES_NULL_HANDLE};
+	uint32_t max_instances {0};
+
+	// gpu driven path
+	bool gpu_driven {false};
+	uint32_t transform_binding {0};
+
+	scapes::visual::ShaderHandle culling_shader;
+	scapes::visual::ShaderHandle indirect_vertex_shader;
+
+	std::vector<IndirectBatch> indirect_batches;
+	std::vector<uint32_t> indirect_order;
+	std::vector<uint32_t> indirect_instance_batches;
+	std::unordered_map<IndirectBatchKey, uint32_t, IndirectBatchKeyHasher> indirect_batch_lookup;
+
+	scapes::visual::hardware::ComputePipeline culling_pipeline {SCAPES_NULL_HANDLE};
+	scapes::visual::hardware::BindSet culling_bindings {SCAPES_NULL_HANDLE};
+	scapes::visual::hardware::BindSet transform_bindings {SCAPES_NULL_HANDLE};
+
+	scapes::visual::hardware::StorageBuffer indirect_instances {SCAPES_NULL_HANDLE};
+	scapes::visual::hardware::StorageBuffer indirect_bounds {SCAPES_NULL_HANDLE};
+	scapes::visual::hardware::StorageBuffer indirect_commands {SCAPES_NULL_HANDLE};
+	scapes::visual::hardware::StorageBuffer visible_transforms {SCAPES_NULL_HANDLE};
+	uint32_t max_indirect_instances {0};
+	uint32_t max_indirect_batches {0};
+
+	// instance rows follow query order, they stay valid until the world structure changes
+	uint64_t indirect_structure_version {~0ull};
+	uint64_t indirect_change_tick {0};
+	uint32_t num_uploaded_instances {0};
+
+	uint32_t num_draw_calls {0};
+	uint32_t num_instances {0};
+	uint32_t num_culled {0};
 };
 
 template <>
@@ -211,12 +384,15 @@ public:
 
 private:
 	void onInit() final;
+	void onShutdown() final;
 	void onRender(scapes::visual::hardware::CommandBuffer command_buffer) final;
 	bool onDeserialize(const scapes::foundation::serde::yaml::NodeRef node) final;
 	bool onSerialize(scapes::foundation::serde::yaml::NodeRef node) final;
 
 private:
 	uint32_t light_binding {0};
+
+	scapes::foundation::game::Query<scapes::visual::components::SkyLight> *query {nullptr};
 };
 
 template <>
@@ -243,6 +419,75 @@ struct TypeTraits<RenderPassPost>
 	static constexpr const char *name = "RenderPassPost";
 };
 
+/* Output render buffers are bound as storage images in one bind set after the inputs,
+ * their formats must support storage, dispatch size follows the first one
+ */
+class RenderPassCompute : public scapes::visual::IRenderPass
+{
+public:
+	static scapes::visual::IRenderPass *create(scapes::visual::RenderGraph *render_graph);
+
+public:
+	RenderPassCompute();
+	~RenderPassCompute() override;
+
+public:
+	void init() final;
+	void shutdown() final;
+	void render(scapes::visual::hardware::CommandBuffer command_buffer) final;
+	void invalidate() final;
+
+	bool deserialize(const scapes::foundation::serde::yaml::NodeRef node) override;
+	bool serialize(scapes::foundation::serde::yaml::NodeRef node) override;
+
+	void addInputGroup(const char *name);
+	void removeAllInputGroups();
+
+	void addInputRenderBuffer(const char *name);
+	void removeAllInputRenderBuffers();
+
+	void addOutputRenderBuffer(const char *name);
+	void removeAllOutputRenderBuffers();
+
+	void setRenderGraph(scapes::visual::RenderGraph *graph);
+	SCAPES_INLINE scapes::visual::RenderGraph *getRenderGraph() { return render_graph; }
+	SCAPES_INLINE const scapes::visual::RenderGraph *getRenderGraph() const { return render_graph; }
+
+	// the pass takes over the caller's reference and releases the shader it replaces
+	void setComputeShader(scapes::visual::ShaderHandle handle);
+	SCAPES_INLINE scapes::visual::ShaderHandle getComputeShader() const { return compute_shader; }
+
+	// must match local_size_x and local_size_y of the shader
+	SCAPES_INLINE void setGroupSize(uint32_t x, uint32_t y) { group_size_x = x; group_size_y = y; }
+
+private:
+	void destroyResources();
+
+private:
+	std::vector<std::string> input_groups;
+	std::vector<std::string> input_render_buffers;
+	std::vector<std::string> output_render_buffers;
+
+	uint32_t group_size_x {8};
+	uint32_t group_size_y {8};
+
+	scapes::visual::RenderGraph *render_graph {nullptr};
+	scapes::foundation::resources::ResourceManager *resource_manager {nullptr};
+	scapes::visual::hardware::Device *device {nullptr};
+	scapes::visual::shaders::Compiler *compiler {nullptr};
+
+	scapes::visual::ShaderHandle compute_shader;
+
+	scapes::visual::hardware::ComputePipeline compute_pipeline {SCAPES_NULL_HANDLE};
+	scapes::visual::hardware::BindSet output_bindings {SCAPES_NULL_HANDLE};
+};
+
+template <>
+struct TypeTraits<RenderPassCompute>
+{
+	static constexpr const char *name = "RenderPassCompute";
+};
+
 /*
  */
 struct ImGuiContext;
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+
+#if defined(_MSC_VER)
+	#include <intrin.h>
+#endif
+
+namespace scapes::common
+{
+	class BitUtils
+	{
+	public:
+		// Returns index of the lowest set bit, mask must not be zero
+		static inline uint32_t countTrailingZeros(uint64_t mask)
+		{
+			assert(mask != 0);
+
+#if defined(_MSC_VER)
+			unsigned long index = 0;
+			_BitScanForward64(&index, mask);
+			return static_cast<uint32_t>(index);
+#else
+			return static_cast<uint32_t>(__builtin_ctzll(mask));
+#endif
+		}
+
+		static inline uint32_t countBits(uint64_t mask)
+		{
+#if defined(_MSC_VER)
+			return static_cast<uint32_t>(__popcnt64(mask));
+#else
+			return static_cast<uint32_t>(__builtin_popcountll(mask));
+#endif
+		}
+	};
+}
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <scapes/foundation/Hash.h>
+
 #include <algorithm>
 
 namespace scapes::common
@@ -13,5 +15,10 @@ namespace scapes::common
 			std::hash<T> h;
 			s^= h(v) + 0x9e3779b9 + (s<< 6) + (s>> 2);
 		}
+
+		static void combine(uint64_t &s, std::string_view v)
+		{
+			s = foundation::hash::combine(s, foundation::hash::compute(v));
+		}
 	};
 }
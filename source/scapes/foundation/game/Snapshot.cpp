@@ -0,0 +1,227 @@
+#include "Snapshot.h"
+
+#include <scapes/foundation/Log.h>
+
+namespace scapes::foundation::game::snapshot
+{
+	/*
+	 */
+	template <typename T>
+	static bool writeValue(io::Stream *stream, const T &value)
+	{
+		return stream->write(&value, sizeof(T), 1) == 1;
+	}
+
+	template <typename T>
+	static bool readValue(io::Stream *stream, T &value)
+	{
+		return stream->read(&value, sizeof(T), 1) == 1;
+	}
+
+	/*
+	 */
+	bool writeHeader(io::Stream *stream, uint32_t num_tables)
+	{
+		bool success = writeValue<uint32_t>(stream, MAGIC);
+		success = success && writeValue<uint32_t>(stream, VERSION);
+		success = success && writeValue(stream, num_tables);
+
+		return success;
+	}
+
+	bool writeTableHeader(io::Stream *stream, const Table &table)
+	{
+		bool success = writeValue(stream, static_cast<uint32_t>(table.components.size()));
+		success = success && writeValue(stream, table.count);
+
+		for (const SnapshotComponent *component : table.components)
+		{
+			success = success && writeValue<uint64_t>(stream, component->type_id);
+			success = success && writeValue<uint64_t>(stream, component->type_size);
+		}
+
+		return success;
+	}
+
+	bool writeColumn(io::Stream *stream, const SnapshotComponent *component, const void *data, uint32_t count, std::vector<uint8_t> &scratch)
+	{
+		size_t size = component->type_size * count;
+		const uint8_t *bytes = reinterpret_cast<const uint8_t *>(data);
+
+		if (component->save)
+		{
+			scratch.assign(bytes, bytes + size);
+			component->save(component->user_data, scratch.data(), count);
+
+			bytes = scratch.data();
+		}
+
+		return stream->write(bytes, 1, size) == size;
+	}
+
+	/*
+	 */
+	static bool hasBytes(io::Stream *stream, uint64_t element_size, uint64_t count)
+	{
+		// counts come from the file, check them before they turn into allocations
+		uint64_t size = stream->size();
+		uint64_t remaining = size - std::min(stream->tell(), size);
+
+		return element_size == 0 || count <= remaining / element_size;
+	}
+
+	bool readTables(World *world, io::Stream *stream, uint32_t num_components, const SnapshotComponent components[], std::vector<Table> &tables, std::vector<EntityID *> &saved_entities, std::vector<EntityID *> &created_entities)
+	{
+		assert(world);
+		assert(stream);
+
+		uint32_t magic = 0;
+		uint32_t version = 0;
+		uint32_t num_tables = 0;
+
+		if (!readValue(stream, magic) || !readValue(stream, version) || !readValue(stream, num_tables))
+		{
+			Log::error("World::loadSnapshot(): can't read the header\n");
+			return false;
+		}
+
+		if (magic != MAGIC || version != VERSION)
+		{
+			Log::error("World::loadSnapshot(): unsupported snapshot, magic %08x, version %u\n", magic, version);
+			return false;
+		}
+
+		constexpr uint64_t table_header_size = sizeof(uint32_t) * 2;
+		constexpr uint64_t type_header_size = sizeof(uint64_t) * 2;
+
+		if (!hasBytes(stream, table_header_size, num_tables))
+		{
+			Log::error("World::loadSnapshot(): %u tables don't fit the snapshot\n", num_tables);
+			return false;
+		}
+
+		std::unordered_map<uint64_t, const SnapshotComponent *> snapshot_components;
+		for (uint32_t i = 0; i < num_components; ++i)
+			snapshot_components.insert({components[i].type_id, &components[i]});
+
+		tables.resize(num_tables);
+
+		// every table is read before any entity is created, so a truncated snapshot leaves the world untouched
+		std::vector<std::vector<std::vector<uint8_t>>> table_columns(num_tables);
+
+		for (uint32_t table_index = 0; table_index < num_tables; ++table_index)
+		{
+			Table &table = tables[table_index];
+
+			uint32_t num_types = 0;
+			if (!readValue(stream, num_types) || !readValue(stream, table.count))
+			{
+				Log::error("World::loadSnapshot(): can't read table header\n");
+				return false;
+			}
+
+			if (!hasBytes(stream, type_header_size, num_types) || num_types > num_components)
+			{
+				Log::error("World::loadSnapshot(): table has %u components, only %u are listed\n", num_types, num_components);
+				return false;
+			}
+
+			for (uint32_t i = 0; i < num_types; ++i)
+			{
+				uint64_t type_id = 0;
+				uint64_t type_size = 0;
+
+				if (!readValue(stream, type_id) || !readValue(stream, type_size))
+				{
+					Log::error("World::loadSnapshot(): can't read table header\n");
+					return false;
+				}
+
+				auto it = snapshot_components.find(type_id);
+				if (it == snapshot_components.end() || it->second->type_size != type_size)
+				{
+					Log::error("World::loadSnapshot(): component %016llx is not listed or has a different size\n", static_cast<unsigned long long>(type_id));
+					return false;
+				}
+
+				table.components.push_back(it->second);
+			}
+
+			if (!hasBytes(stream, sizeof(EntityID *), table.count))
+			{
+				Log::error("World::loadSnapshot(): %u entities don't fit the snapshot\n", table.count);
+				return false;
+			}
+
+			table.first = saved_entities.size();
+
+			saved_entities.resize(table.first + table.count);
+
+			if (stream->read(saved_entities.data() + table.first, sizeof(EntityID *), table.count) != table.count)
+			{
+				Log::error("World::loadSnapshot(): can't read entities\n");
+				return false;
+			}
+
+			std::vector<std::vector<uint8_t>> &columns = table_columns[table_index];
+			columns.resize(num_types);
+
+			for (uint32_t i = 0; i < num_types; ++i)
+			{
+				const SnapshotComponent *component = table.components[i];
+
+				if (!hasBytes(stream, component->type_size, table.count))
+				{
+					Log::error("World::loadSnapshot(): \"%s\" column doesn't fit the snapshot\n", component->type_name);
+					return false;
+				}
+
+				size_t size = component->type_size * table.count;
+
+				columns[i].resize(size);
+				if (stream->read(columns[i].data(), 1, size) != size)
+				{
+					Log::error("World::loadSnapshot(): can't read \"%s\" column\n", component->type_name);
+					return false;
+				}
+			}
+		}
+
+		created_entities.resize(saved_entities.size());
+
+		std::vector<uint64_t> type_ids;
+		std::vector<const char *> type_names;
+		std::vector<size_t> type_sizes;
+		std::vector<size_t> type_alignments;
+		std::vector<const void *> data;
+
+		for (uint32_t table_index = 0; table_index < num_tables; ++table_index)
+		{
+			const Table &table = tables[table_index];
+			const std::vector<std::vector<uint8_t>> &columns = table_columns[table_index];
+
+			uint32_t num_types = static_cast<uint32_t>(table.components.size());
+
+			type_ids.resize(num_types);
+			type_names.resize(num_types);
+			type_sizes.resize(num_types);
+			type_alignments.resize(num_types);
+			data.resize(num_types);
+
+			for (uint32_t i = 0; i < num_types; ++i)
+			{
+				const SnapshotComponent *component = table.components[i];
+
+				type_ids[i] = component->type_id;
+				type_names[i] = component->type_name;
+				type_sizes[i] = component->type_size;
+				type_alignments[i] = component->type_alignment;
+				data[i] = columns[i].data();
+			}
+
+			world->createEntities(table.count, num_types, type_ids.data(), type_names.data(), type_sizes.data(), type_alignments.data(), data.data(), created_entities.data() + table.first);
+		}
+
+		return true;
+	}
+}
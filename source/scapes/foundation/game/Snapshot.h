@@ -0,0 +1,98 @@
+#pragma once
+
+#include <scapes/foundation/game/World.h>
+#include <scapes/foundation/io/FileSystem.h>
+
+#include <algorithm>
+#include <cassert>
+#include <unordered_map>
+#include <vector>
+
+namespace scapes::foundation::game::snapshot
+{
+	/* Shared by all world backends, so snapshots don't depend on the backend that saved them:
+	 * magic, version, table count, then per table: type count, entity count, (type id, type size) per type,
+	 * saved entity ids and tightly packed columns in the same type order
+	 */
+	enum : uint32_t
+	{
+		MAGIC = 0x53574353, // SCWS
+		VERSION = 1,
+	};
+
+	struct Table
+	{
+		std::vector<const SnapshotComponent *> components;
+		uint32_t count {0};
+
+		// index of the first entity of the table in saved and created entity arrays
+		size_t first {0};
+	};
+
+	bool writeHeader(io::Stream *stream, uint32_t num_tables);
+	bool writeTableHeader(io::Stream *stream, const Table &table);
+
+	// runs the save patch on a copy if the component has one, scratch is reused between calls
+	bool writeColumn(io::Stream *stream, const SnapshotComponent *component, const void *data, uint32_t count, std::vector<uint8_t> &scratch);
+
+	/* Reads and validates every table, then bulk creates their entities, so entities of a table take
+	 * consecutive rows in the world and a rejected snapshot creates nothing; load patches are left to the backend
+	 */
+	bool readTables(World *world, io::Stream *stream, uint32_t num_components, const SnapshotComponent components[], std::vector<Table> &tables, std::vector<EntityID *> &saved_entities, std::vector<EntityID *> &created_entities);
+
+	/*
+	 */
+	class EntityMap : public SnapshotEntityMap
+	{
+	public:
+		EntityMap(const std::vector<EntityID *> &saved_entities, const std::vector<EntityID *> &created_entities)
+		{
+			assert(saved_entities.size() == created_entities.size());
+
+			if (saved_entities.empty())
+				return;
+
+			auto range = std::minmax_element(saved_entities.begin(), saved_entities.end());
+
+			first = toID(*range.first);
+			uint64_t last = toID(*range.second);
+
+			// entity ids are mostly dense, a flat table beats hashing when they are
+			if (last - first < saved_entities.size() * 4)
+			{
+				dense_entities.resize(last - first + 1, nullptr);
+				for (size_t i = 0; i < saved_entities.size(); ++i)
+					dense_entities[toID(saved_entities[i]) - first] = created_entities[i];
+
+				return;
+			}
+
+			entities.reserve(saved_entities.size());
+			for (size_t i = 0; i < saved_entities.size(); ++i)
+				entities.insert({saved_entities[i], created_entities[i]});
+		}
+
+		EntityID *getEntity(EntityID *saved_entity) const final
+		{
+			if (!dense_entities.empty())
+			{
+				uint64_t index = toID(saved_entity) - first;
+				return (index < dense_entities.size()) ? dense_entities[index] : nullptr;
+			}
+
+			auto it = entities.find(saved_entity);
+			if (it == entities.end())
+				return nullptr;
+
+			return it->second;
+		}
+
+	private:
+		static SCAPES_INLINE uint64_t toID(EntityID *entity) { return reinterpret_cast<uint64_t>(entity); }
+
+	private:
+		uint64_t first {0};
+		std::vector<EntityID *> dense_entities;
+		std::unordered_map<EntityID *, EntityID *> entities;
+	};
+}
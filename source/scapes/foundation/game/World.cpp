@@ -1,10 +1,17 @@
 #include <game/flecs/World.h>
+#include <game/native/World.h>
 
 namespace scapes::foundation::game
 {
-	World *World::create()
+	World *World::create(WorldBackend backend)
 	{
-		return new flecs::World();
+		switch (backend)
+		{
+			case WorldBackend::FLECS: return new flecs::World();
+			case WorldBackend::NATIVE: return new native::World();
+		}
+
+		return nullptr;
 	}
 
 	void World::destroy(World *world)
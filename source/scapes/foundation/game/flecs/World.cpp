@@ -1,7 +1,12 @@
 #include "World.h"
-#include "HashUtils.h"
+#include <game/Snapshot.h>
 
+#include <scapes/foundation/Hash.h>
+#include <scapes/foundation/Log.h>
+
+#include <algorithm>
 #include <string>
+#include <unordered_set>
 
 namespace scapes::foundation::game::flecs
 {
@@ -15,6 +20,19 @@ namespace scapes::foundation::game::flecs
 	{
 		clear();
 
+		for (auto it : cached_queries)
+		{
+			ecs_query_free(it.second->query);
+			delete it.second;
+		}
+
+		cached_queries.clear();
+
+		for (auto it : change_tick_components)
+			ecs_delete(world.c_ptr(), it.second);
+
+		change_tick_components.clear();
+
 		for(auto it : registered_components)
 			ecs_delete(world.c_ptr(), it.second);
 
@@ -23,31 +41,10 @@ namespace scapes::foundation::game::flecs
 
 	/*
 	 */
-	game::QueryID *World::createQuery(uint32_t num_types, const char *type_names[], size_t type_sizes[], size_t type_alignments[])
+	game::QueryID *World::createQuery(uint32_t num_types, const uint64_t type_ids[], const char *type_names[], size_t type_sizes[], size_t type_alignments[])
 	{
 		QueryID *result = new QueryID();
-
-		std::stringstream ss;
-		for (uint32_t i = 0; i < num_types; ++i)
-		{
-			if (i)
-				ss << ", ";
-
-			::flecs::entity_t comp_id = fetchComponentID(type_names[i], type_sizes[i], type_alignments[i]);
-
-			char *full_flecs_path = ecs_get_fullpath(world.c_ptr(), comp_id);
-			ss << full_flecs_path;
-
-			delete[] full_flecs_path;
-		}
-
-		const std::string &expression = ss.str();
-
-		result->query = ecs_query_new(world.c_ptr(), expression.c_str());
-		result->type_sizes.resize(num_types);
-		result->num_types = num_types;
-
-		memcpy(result->type_sizes.data(), type_sizes, sizeof(size_t) * num_types);
+		result->cached = fetchCachedQuery(num_types, type_ids, type_names, type_sizes, type_alignments);
 
 		return result;
 	}
@@ -56,7 +53,6 @@ namespace scapes::foundation::game::flecs
 	{
 		QueryID *flecs_query = static_cast<QueryID *>(query);
 
-		ecs_query_free(flecs_query->query);
 		delete flecs_query;
 	}
 
@@ -64,7 +60,7 @@ namespace scapes::foundation::game::flecs
 	{
 		QueryID *flecs_query = static_cast<QueryID *>(query);
 
-		flecs_query->iter = ecs_query_iter(flecs_query->query);
+		flecs_query->iter = ecs_query_iter(flecs_query->cached->query);
 
 		return true;
 	}
@@ -87,7 +83,31 @@ namespace scapes::foundation::game::flecs
 	{
 		QueryID *flecs_query = static_cast<QueryID *>(query);
 
-		return ecs_column_w_size(&flecs_query->iter, flecs_query->type_sizes[type_index], type_index + 1);
+		return ecs_column_w_size(&flecs_query->iter, flecs_query->cached->type_sizes[type_index], type_index + 1);
+	}
+
+	game::EntityID *const *World::getQueryEntities(game::QueryID *query) const
+	{
+		QueryID *flecs_query = static_cast<QueryID *>(query);
+
+		// entity handles are flecs ids in disguise
+		static_assert(sizeof(game::EntityID *) == sizeof(::flecs::entity_t));
+		return reinterpret_cast<game::EntityID *const *>(flecs_query->iter.entities);
+	}
+
+	bool World::nextChunk(game::QueryID *query, uint32_t &count, void *columns[]) const
+	{
+		QueryID *flecs_query = static_cast<QueryID *>(query);
+
+		if (!ecs_query_next(&flecs_query->iter))
+			return false;
+
+		const std::vector<size_t> &type_sizes = flecs_query->cached->type_sizes;
+		for (size_t i = 0; i < type_sizes.size(); ++i)
+			columns[i] = ecs_column_w_size(&flecs_query->iter, type_sizes[i], static_cast<int32_t>(i + 1));
+
+		count = static_cast<uint32_t>(flecs_query->iter.count);
+		return true;
 	}
 
 	/*
@@ -97,27 +117,89 @@ namespace scapes::foundation::game::flecs
 		::flecs::entity entity = world.entity();
 		::flecs::entity_t id = entity.id();
 
+		structure_version++;
+
 		return reinterpret_cast<game::EntityID*>(id);
 	}
 
+	void World::createEntities(uint32_t count, uint32_t num_types, const uint64_t type_ids[], const char *type_names[], const size_t type_sizes[], const size_t type_alignments[], const void *data[], game::EntityID *entities[])
+	{
+		if (count == 0)
+			return;
+
+		assert(num_types > 0);
+
+		structure_version++;
+
+		// flecs expects data arrays in table type order, which is sorted by component id
+		std::vector<std::pair<::flecs::entity_t, void *>> columns(num_types);
+		for (uint32_t i = 0; i < num_types; ++i)
+		{
+			assert(type_names[i]);
+			assert(type_sizes[i] > 0);
+
+			columns[i].first = fetchComponentID(type_ids[i], type_names[i], type_sizes[i], type_alignments[i]);
+			columns[i].second = const_cast<void *>(data[i]);
+		}
+
+		// new entities count as changed, all tracked components share the same tick array
+		std::vector<uint64_t> ticks;
+		for (uint32_t i = 0; i < num_types; ++i)
+		{
+			::flecs::entity_t tick_id = getChangeTickComponentID(columns[i].first);
+			if (tick_id == 0)
+				continue;
+
+			if (ticks.empty())
+				ticks.assign(count, change_tick);
+
+			columns.push_back({tick_id, ticks.data()});
+		}
+
+		num_types = static_cast<uint32_t>(columns.size());
+
+		std::sort(columns.begin(), columns.end(), [](const auto &a, const auto &b) { return a.first < b.first; });
+
+		std::vector<::flecs::entity_t> comp_ids(num_types);
+		std::vector<void *> comp_data(num_types);
+		for (uint32_t i = 0; i < num_types; ++i)
+		{
+			comp_ids[i] = columns[i].first;
+			comp_data[i] = columns[i].second;
+		}
+
+		ecs_entities_t components = { comp_ids.data(), static_cast<int32_t>(num_types) };
+
+		const ::flecs::entity_t *ids = ecs_bulk_new_w_data(world.c_ptr(), static_cast<int32_t>(count), &components, comp_data.data());
+		assert(ids);
+
+		if (entities)
+			for (uint32_t i = 0; i < count; ++i)
+				entities[i] = reinterpret_cast<game::EntityID*>(ids[i]);
+	}
+
 	void World::destroyEntity(game::EntityID *entity)
 	{
 		::flecs::entity_t id = reinterpret_cast<::flecs::entity_t>(entity);
 		ecs_delete(world.c_ptr(), id);
+
+		structure_version++;
 	}
 
 	void World::clear()
 	{
 		world.delete_entities(::flecs::filter());
+
+		structure_version++;
 	}
 
-	void *World::addComponent(game::EntityID *entity, const char *type_name, size_t type_size, size_t type_alignment, const void *data)
+	void *World::addComponent(game::EntityID *entity, uint64_t type_id, const char *type_name, size_t type_size, size_t type_alignment, const void *data)
 	{
 		assert(type_name);
 		assert(type_size > 0);
 
 		::flecs::entity_t id = reinterpret_cast<::flecs::entity_t>(entity);
-		::flecs::entity_t comp_id = fetchComponentID(type_name, type_size, type_alignment);
+		::flecs::entity_t comp_id = fetchComponentID(type_id, type_name, type_size, type_alignment);
 
 		assert(id != 0);
 		assert(comp_id != 0);
@@ -125,6 +207,12 @@ namespace scapes::foundation::game::flecs
 		::flecs::entity_t result_id = ecs_set_ptr_w_entity(world.c_ptr(), id, comp_id, type_size, data);
 		assert(result_id == id);
 
+		::flecs::entity_t tick_id = getChangeTickComponentID(comp_id);
+		if (tick_id != 0)
+			ecs_set_ptr_w_entity(world.c_ptr(), id, tick_id, sizeof(uint64_t), &change_tick);
+
+		structure_version++;
+
 		bool is_added = false;
 
 		void *result = ecs_get_mut_w_entity(world.c_ptr(), id, comp_id, &is_added);
@@ -133,13 +221,13 @@ namespace scapes::foundation::game::flecs
 		return result;
 	}
 
-	void *World::getComponent(game::EntityID *entity, const char *type_name, size_t type_size, size_t type_alignment) const
+	void *World::getComponent(game::EntityID *entity, uint64_t type_id, const char *type_name, size_t type_size, size_t type_alignment) const
 	{
 		assert(type_name);
 		assert(type_size > 0);
 
 		::flecs::entity_t id = reinterpret_cast<::flecs::entity_t>(entity);
-		::flecs::entity_t comp_id = fetchComponentID(type_name, type_size, type_alignment);
+		::flecs::entity_t comp_id = fetchComponentID(type_id, type_name, type_size, type_alignment);
 
 		assert(id != 0);
 		assert(comp_id != 0);
@@ -154,20 +242,308 @@ namespace scapes::foundation::game::flecs
 
 	/*
 	 */
-	::flecs::entity_t World::fetchComponentID(const char *type_name, size_t size, size_t alignment) const
+	void World::enableChangeTracking(uint64_t type_id, const char *type_name, size_t type_size, size_t type_alignment)
+	{
+		assert(type_name);
+		assert(type_size > 0);
+
+		::flecs::entity_t comp_id = fetchComponentID(type_id, type_name, type_size, type_alignment);
+		if (getChangeTickComponentID(comp_id) != 0)
+			return;
+
+		std::string tick_name = std::string(type_name) + "ChangeTick";
+
+		::flecs::entity_t tick_id = ecs_new_component(world.c_ptr(), 0, nullptr, sizeof(uint64_t), alignof(uint64_t));
+		ecs_add_path_w_sep(world.c_ptr(), tick_id, 0, tick_name.c_str(), "::", "::");
+
+		change_tick_components[comp_id] = tick_id;
+
+		// entities that already have the component start out as changed
+		char *full_flecs_path = ecs_get_fullpath(world.c_ptr(), comp_id);
+		::flecs::query_t *existing_query = ecs_query_new(world.c_ptr(), full_flecs_path);
+		ecs_os_free(full_flecs_path);
+
+		std::vector<::flecs::entity_t> existing_entities;
+
+		ecs_iter_t iter = ecs_query_iter(existing_query);
+		while (ecs_query_next(&iter))
+			existing_entities.insert(existing_entities.end(), iter.entities, iter.entities + iter.count);
+
+		ecs_query_free(existing_query);
+
+		for (::flecs::entity_t id : existing_entities)
+			ecs_set_ptr_w_entity(world.c_ptr(), id, tick_id, sizeof(uint64_t), &change_tick);
+
+		if (!existing_entities.empty())
+			structure_version++;
+
+		// queries with the component have to fetch its ticks from now on
+		for (auto it : cached_queries)
+		{
+			const std::vector<::flecs::entity_t> &component_ids = it.second->component_ids;
+			if (std::find(component_ids.begin(), component_ids.end(), comp_id) == component_ids.end())
+				continue;
+
+			ecs_query_free(it.second->query);
+			buildCachedQuery(it.second);
+		}
+	}
+
+	void World::markChanged(game::EntityID *entity, uint64_t type_id, const char *type_name, size_t type_size, size_t type_alignment)
+	{
+		::flecs::entity_t id = reinterpret_cast<::flecs::entity_t>(entity);
+		::flecs::entity_t comp_id = fetchComponentID(type_id, type_name, type_size, type_alignment);
+		::flecs::entity_t tick_id = getChangeTickComponentID(comp_id);
+
+		assert(id != 0);
+
+		if (tick_id == 0)
+			return;
+
+		bool is_added = false;
+
+		uint64_t *tick = reinterpret_cast<uint64_t *>(ecs_get_mut_w_entity(world.c_ptr(), id, tick_id, &is_added));
+		assert(is_added == false);
+
+		*tick = change_tick;
+	}
+
+	uint64_t *World::getQueryChangeTicks(game::QueryID *query, uint32_t type_index) const
+	{
+		QueryID *flecs_query = static_cast<QueryID *>(query);
+
+		int32_t column = flecs_query->cached->tick_columns[type_index];
+		if (column == 0)
+			return nullptr;
+
+		return reinterpret_cast<uint64_t *>(ecs_column_w_size(&flecs_query->iter, sizeof(uint64_t), column));
+	}
+
+	/*
+	 */
+	bool World::saveSnapshot(io::Stream *stream, uint32_t num_components, const SnapshotComponent components[])
+	{
+		assert(stream);
+
+		std::unordered_map<::flecs::entity_t, const SnapshotComponent *> snapshot_components;
+		for (uint32_t i = 0; i < num_components; ++i)
+		{
+			const SnapshotComponent &component = components[i];
+			assert(component.type_name);
+			assert(component.type_size > 0);
+
+			::flecs::entity_t comp_id = fetchComponentID(component.type_id, component.type_name, component.type_size, component.type_alignment);
+			snapshot_components.insert({comp_id, &component});
+		}
+
+		// ticks are not saved, loaded entities count as changed anyway
+		std::unordered_set<::flecs::entity_t> tick_ids;
+		for (auto it : change_tick_components)
+			tick_ids.insert(it.second);
+
+		struct Table : public snapshot::Table
+		{
+			const ::flecs::entity_t *entities {nullptr};
+			std::vector<const void *> columns;
+		};
+
+		std::vector<Table> tables;
+
+		// tables don't change while saving, so column pointers stay valid
+		ecs_iter_t iter = ecs_filter_iter(world.c_ptr(), nullptr);
+		while (ecs_filter_next(&iter))
+		{
+			if (iter.count == 0)
+				continue;
+
+			ecs_type_t type = ecs_iter_type(&iter);
+			int32_t num_types = ecs_vector_count(type);
+			const ::flecs::entity_t *type_ids = ecs_vector_first(type, ::flecs::entity_t);
+
+			Table table;
+			table.entities = iter.entities;
+			table.count = static_cast<uint32_t>(iter.count);
+
+			bool listed = true;
+			for (int32_t i = 0; i < num_types; ++i)
+			{
+				if (tick_ids.find(type_ids[i]) != tick_ids.end())
+					continue;
+
+				auto it = snapshot_components.find(type_ids[i]);
+				if (it == snapshot_components.end())
+				{
+					listed = false;
+					break;
+				}
+
+				table.components.push_back(it->second);
+				table.columns.push_back(ecs_table_column(&iter, i));
+			}
+
+			if (listed && !table.columns.empty())
+				tables.push_back(std::move(table));
+		}
+
+		static_assert(sizeof(game::EntityID *) == sizeof(::flecs::entity_t));
+
+		bool success = snapshot::writeHeader(stream, static_cast<uint32_t>(tables.size()));
+
+		std::vector<uint8_t> scratch;
+
+		for (const Table &table : tables)
+		{
+			success = success && snapshot::writeTableHeader(stream, table);
+			success = success && stream->write(table.entities, sizeof(::flecs::entity_t), table.count) == table.count;
+
+			for (size_t i = 0; i < table.columns.size(); ++i)
+				success = success && snapshot::writeColumn(stream, table.components[i], table.columns[i], table.count, scratch);
+		}
+
+		if (!success)
+		{
+			Log::error("World::saveSnapshot(): can't write to the stream\n");
+			return false;
+		}
+
+		return true;
+	}
+
+	bool World::loadSnapshot(io::Stream *stream, uint32_t num_components, const SnapshotComponent components[])
 	{
-		uint64_t hash = 0;
-		common::HashUtils::combine(hash, std::string_view(type_name));
+		std::vector<snapshot::Table> tables;
+		std::vector<game::EntityID *> saved_entities;
+		std::vector<game::EntityID *> created_entities;
+
+		if (!snapshot::readTables(this, stream, num_components, components, tables, saved_entities, created_entities))
+			return false;
+
+		bool has_patches = std::any_of(components, components + num_components, [](const SnapshotComponent &component)
+		{
+			return component.load != nullptr;
+		});
+
+		if (!has_patches)
+			return true;
+
+		// references between entities can only be patched once every entity exists
+		snapshot::EntityMap entity_map(saved_entities, created_entities);
+
+		for (const snapshot::Table &table : tables)
+		{
+			if (table.count == 0)
+				continue;
+
+			::flecs::entity_t first_id = reinterpret_cast<::flecs::entity_t>(created_entities[table.first]);
+
+			for (const SnapshotComponent *component : table.components)
+			{
+				if (!component->load)
+					continue;
+
+				::flecs::entity_t comp_id = fetchComponentID(component->type_id, component->type_name, component->type_size, component->type_alignment);
+
+				// bulk created entities take consecutive rows of their table
+				bool is_added = false;
+
+				void *column = ecs_get_mut_w_entity(world.c_ptr(), first_id, comp_id, &is_added);
+				assert(is_added == false);
+
+				component->load(component->user_data, entity_map, column, table.count);
+			}
+		}
+
+		return true;
+	}
 
-		auto it = registered_components.find(hash);
+	/*
+	 */
+	::flecs::entity_t World::fetchComponentID(uint64_t type_id, const char *type_name, size_t size, size_t alignment) const
+	{
+		auto it = registered_components.find(type_id);
 		if (it != registered_components.end())
 			return it->second;
 
 		::flecs::entity_t result = ecs_new_component(world.c_ptr(), 0, nullptr, size, alignment);
 		ecs_add_path_w_sep(world.c_ptr(), result, 0, type_name, "::", "::");
 
-		registered_components[hash] = result;
+		registered_components[type_id] = result;
+
+		return result;
+	}
+
+	/*
+	 */
+	const CachedQuery *World::fetchCachedQuery(uint32_t num_types, const uint64_t type_ids[], const char *type_names[], size_t type_sizes[], size_t type_alignments[])
+	{
+		// column order matters, so does the signature hash
+		uint64_t signature = num_types;
+		for (uint32_t i = 0; i < num_types; ++i)
+			signature = hash::combine(signature, type_ids[i]);
+
+		auto it = cached_queries.find(signature);
+		if (it != cached_queries.end())
+		{
+			assert(std::equal(type_ids, type_ids + num_types, it->second->type_ids.begin(), it->second->type_ids.end()));
+			return it->second;
+		}
+
+		CachedQuery *result = new CachedQuery();
+		result->type_ids.assign(type_ids, type_ids + num_types);
+		result->type_sizes.assign(type_sizes, type_sizes + num_types);
+
+		result->component_ids.resize(num_types);
+		for (uint32_t i = 0; i < num_types; ++i)
+			result->component_ids[i] = fetchComponentID(type_ids[i], type_names[i], type_sizes[i], type_alignments[i]);
+
+		buildCachedQuery(result);
+
+		cached_queries[signature] = result;
 
 		return result;
 	}
+
+	void World::buildCachedQuery(CachedQuery *cached_query) const
+	{
+		const std::vector<::flecs::entity_t> &component_ids = cached_query->component_ids;
+		uint32_t num_types = static_cast<uint32_t>(component_ids.size());
+
+		// tick components go after the requested ones, so query columns keep their indices
+		std::vector<::flecs::entity_t> columns(component_ids.begin(), component_ids.end());
+
+		cached_query->tick_columns.assign(num_types, 0);
+		for (uint32_t i = 0; i < num_types; ++i)
+		{
+			::flecs::entity_t tick_id = getChangeTickComponentID(component_ids[i]);
+			if (tick_id == 0)
+				continue;
+
+			columns.push_back(tick_id);
+			cached_query->tick_columns[i] = static_cast<int32_t>(columns.size());
+		}
+
+		std::stringstream ss;
+		for (size_t i = 0; i < columns.size(); ++i)
+		{
+			if (i)
+				ss << ", ";
+
+			char *full_flecs_path = ecs_get_fullpath(world.c_ptr(), columns[i]);
+			ss << full_flecs_path;
+
+			ecs_os_free(full_flecs_path);
+		}
+
+		const std::string &expression = ss.str();
+		cached_query->query = ecs_query_new(world.c_ptr(), expression.c_str());
+	}
+
+	::flecs::entity_t World::getChangeTickComponentID(::flecs::entity_t component_id) const
+	{
+		auto it = change_tick_components.find(component_id);
+		if (it == change_tick_components.end())
+			return 0;
+
+		return it->second;
+	}
 }
@@ -7,11 +7,21 @@
 
 namespace scapes::foundation::game::flecs
 {
-	struct QueryID : public game::QueryID
+	// flecs queries are matched incrementally against new tables, so one per signature is kept for the world lifetime
+	struct CachedQuery
 	{
 		::flecs::query_t *query {nullptr};
-		uint32_t num_types {0};
+		std::vector<uint64_t> type_ids;
 		std::vector<size_t> type_sizes;
+		std::vector<::flecs::entity_t> component_ids;
+
+		// flecs column of the change ticks per type, zero if the type is not tracked
+		std::vector<int32_t> tick_columns;
+	};
+
+	struct QueryID : public game::QueryID
+	{
+		const CachedQuery *cached {nullptr};
 		ecs_iter_t iter {0};
 	};
 
@@ -21,25 +31,52 @@ namespace scapes::foundation::game::flecs
 		World();
 		~World() final;
 
-		game::QueryID *createQuery(uint32_t num_types, const char *type_names[], size_t type_sizes[], size_t type_alignments[]) final;
+		game::QueryID *createQuery(uint32_t num_types, const uint64_t type_ids[], const char *type_names[], size_t type_sizes[], size_t type_alignments[]) final;
 		void destroyQuery(game::QueryID *query) final;
 		bool begin(game::QueryID *query) const final;
 		bool next(game::QueryID *query) const final;
 		uint32_t getNumQueryComponents(game::QueryID *query) const final;
 		void *getQueryComponents(game::QueryID *query, uint32_t type_index) const final;
+		game::EntityID *const *getQueryEntities(game::QueryID *query) const final;
+		bool nextChunk(game::QueryID *query, uint32_t &count, void *columns[]) const final;
 
 		game::EntityID *createEntity() final;
+		void createEntities(uint32_t count, uint32_t num_types, const uint64_t type_ids[], const char *type_names[], const size_t type_sizes[], const size_t type_alignments[], const void *data[], game::EntityID *entities[]) final;
 		void destroyEntity(game::EntityID *entity) final;
 		void clear() final;
 
-		void *addComponent(game::EntityID *entity, const char *type_name, size_t type_size, size_t type_alignment, const void *data) final;
-		void *getComponent(EntityID *entity, const char *type_name, size_t type_size, size_t type_alignment) const final;
+		SCAPES_INLINE uint64_t getStructureVersion() const final { return structure_version; }
+
+		void *addComponent(game::EntityID *entity, uint64_t type_id, const char *type_name, size_t type_size, size_t type_alignment, const void *data) final;
+		void *getComponent(EntityID *entity, uint64_t type_id, const char *type_name, size_t type_size, size_t type_alignment) const final;
+
+		void enableChangeTracking(uint64_t type_id, const char *type_name, size_t type_size, size_t type_alignment) final;
+
+		SCAPES_INLINE uint64_t getChangeTick() const final { return change_tick; }
+		SCAPES_INLINE uint64_t advanceChangeTick() final { return change_tick++; }
+
+		void markChanged(game::EntityID *entity, uint64_t type_id, const char *type_name, size_t type_size, size_t type_alignment) final;
+		uint64_t *getQueryChangeTicks(game::QueryID *query, uint32_t type_index) const final;
+
+		bool saveSnapshot(io::Stream *stream, uint32_t num_components, const SnapshotComponent components[]) final;
+		bool loadSnapshot(io::Stream *stream, uint32_t num_components, const SnapshotComponent components[]) final;
 
 	private:
-		::flecs::entity_t fetchComponentID(const char *type_name, size_t size, size_t alignment) const;
+		::flecs::entity_t fetchComponentID(uint64_t type_id, const char *type_name, size_t size, size_t alignment) const;
+		const CachedQuery *fetchCachedQuery(uint32_t num_types, const uint64_t type_ids[], const char *type_names[], size_t type_sizes[], size_t type_alignments[]);
+		void buildCachedQuery(CachedQuery *cached_query) const;
+		::flecs::entity_t getChangeTickComponentID(::flecs::entity_t component_id) const;
 
 	private:
 		::flecs::world world;
 		mutable std::unordered_map<uint64_t, ::flecs::entity_t> registered_components;
+		std::unordered_map<uint64_t, CachedQuery *> cached_queries;
+
+		// tracked component id -> id of the hidden component with its change ticks,
+		// flecs keeps both in the same table row so ticks follow entities between tables
+		std::unordered_map<::flecs::entity_t, ::flecs::entity_t> change_tick_components;
+
+		uint64_t structure_version {0};
+		uint64_t change_tick {1};
 	};
 }
@@ -0,0 +1,988 @@
+#include "World.h"
+#include <game/Snapshot.h>
+
+#include <scapes/foundation/Hash.h>
+#include <scapes/foundation/Log.h>
+
+#include <algorithm>
+#include <cstring>
+#include <new>
+#include <numeric>
+
+namespace scapes::foundation::game::native
+{
+	/*
+	 */
+	static SCAPES_INLINE uint64_t toID(game::EntityID *entity)
+	{
+		return reinterpret_cast<uint64_t>(entity);
+	}
+
+	static SCAPES_INLINE game::EntityID *makeEntity(uint32_t index, uint32_t generation)
+	{
+		// index is biased by one, so no valid entity is null
+		uint64_t id = (static_cast<uint64_t>(generation) << 32) | (static_cast<uint64_t>(index) + 1);
+		return reinterpret_cast<game::EntityID *>(id);
+	}
+
+	static SCAPES_INLINE uint32_t getIndex(game::EntityID *entity)
+	{
+		return static_cast<uint32_t>(toID(entity) & 0xFFFFFFFF) - 1;
+	}
+
+	static SCAPES_INLINE uint32_t getGeneration(game::EntityID *entity)
+	{
+		return static_cast<uint32_t>(toID(entity) >> 32);
+	}
+
+	static SCAPES_INLINE uint32_t alignOffset(uint32_t offset)
+	{
+		return (offset + CHUNK_ALIGNMENT - 1) & ~(CHUNK_ALIGNMENT - 1);
+	}
+
+	static uint64_t getSignature(const uint64_t type_ids[], size_t num_types)
+	{
+		uint64_t signature = num_types;
+		for (size_t i = 0; i < num_types; ++i)
+			signature = hash::combine(signature, type_ids[i]);
+
+		return signature;
+	}
+
+	/*
+	 */
+	static uint8_t *allocateChunk(uint32_t size)
+	{
+		return reinterpret_cast<uint8_t *>(::operator new(size, std::align_val_t(CHUNK_ALIGNMENT)));
+	}
+
+	static void freeChunk(uint8_t *chunk)
+	{
+		::operator delete(chunk, std::align_val_t(CHUNK_ALIGNMENT));
+	}
+
+	/*
+	 */
+	static uint32_t findColumn(const Archetype *archetype, uint64_t type_id)
+	{
+		auto it = std::lower_bound(archetype->type_ids.begin(), archetype->type_ids.end(), type_id);
+		if (it == archetype->type_ids.end() || *it != type_id)
+			return INVALID_OFFSET;
+
+		return static_cast<uint32_t>(it - archetype->type_ids.begin());
+	}
+
+	static SCAPES_INLINE uint8_t *getChunk(const Archetype *archetype, uint32_t row)
+	{
+		return archetype->chunks[row / archetype->capacity];
+	}
+
+	static SCAPES_INLINE uint8_t *getElement(uint8_t *chunk, uint32_t offset, uint32_t size, uint32_t index)
+	{
+		return chunk + offset + size * index;
+	}
+
+	static void copyRow(const Archetype *archetype, uint32_t dst_row, uint32_t src_row)
+	{
+		uint8_t *dst_chunk = getChunk(archetype, dst_row);
+		uint8_t *src_chunk = getChunk(archetype, src_row);
+
+		uint32_t dst_index = dst_row % archetype->capacity;
+		uint32_t src_index = src_row % archetype->capacity;
+
+		game::EntityID **entities = reinterpret_cast<game::EntityID **>(dst_chunk);
+		entities[dst_index] = reinterpret_cast<game::EntityID **>(src_chunk)[src_index];
+
+		for (const Column &column : archetype->columns)
+		{
+			uint32_t size = column.component->type_size;
+			memcpy(getElement(dst_chunk, column.offset, size, dst_index), getElement(src_chunk, column.offset, size, src_index), size);
+
+			if (column.tick_offset != INVALID_OFFSET)
+				memcpy(getElement(dst_chunk, column.tick_offset, sizeof(uint64_t), dst_index), getElement(src_chunk, column.tick_offset, sizeof(uint64_t), src_index), sizeof(uint64_t));
+		}
+	}
+
+	// func(uint8_t *chunk, uint32_t index, uint32_t count, uint32_t offset) for every chunk part of rows [first, first + count)
+	template <typename Func>
+	static void forEachRange(const Archetype *archetype, uint32_t first, uint32_t count, Func &&func)
+	{
+		uint32_t offset = 0;
+		while (offset < count)
+		{
+			uint32_t row = first + offset;
+			uint32_t index = row % archetype->capacity;
+			uint32_t num_rows = std::min(archetype->capacity - index, count - offset);
+
+			func(getChunk(archetype, row), index, num_rows, offset);
+
+			offset += num_rows;
+		}
+	}
+
+	/*
+	 */
+	World::World()
+	{
+		root_archetype = fetchArchetype({});
+	}
+
+	World::~World()
+	{
+		for (Archetype *archetype : archetypes)
+		{
+			for (uint8_t *chunk : archetype->chunks)
+				freeChunk(chunk);
+
+			delete archetype;
+		}
+
+		archetypes.clear();
+		archetype_signatures.clear();
+
+		for (auto it : cached_queries)
+			delete it.second;
+
+		cached_queries.clear();
+	}
+
+	/*
+	 */
+	game::QueryID *World::createQuery(uint32_t num_types, const uint64_t type_ids[], const char *type_names[], size_t type_sizes[], size_t type_alignments[])
+	{
+		QueryID *result = new QueryID();
+		result->cached = fetchCachedQuery(num_types, type_ids, type_names, type_sizes, type_alignments);
+
+		return result;
+	}
+
+	void World::destroyQuery(game::QueryID *query)
+	{
+		QueryID *native_query = static_cast<QueryID *>(query);
+
+		delete native_query;
+	}
+
+	bool World::begin(game::QueryID *query) const
+	{
+		QueryID *native_query = static_cast<QueryID *>(query);
+
+		native_query->match_index = 0;
+		native_query->chunk_index = 0;
+		native_query->count = 0;
+		native_query->chunk = nullptr;
+
+		return true;
+	}
+
+	bool World::next(game::QueryID *query) const
+	{
+		QueryID *native_query = static_cast<QueryID *>(query);
+		const std::vector<QueryMatch> &matches = native_query->cached->matches;
+
+		// chunk_index is the next chunk to visit in the current match
+		while (native_query->match_index < matches.size())
+		{
+			const Archetype *archetype = matches[native_query->match_index].archetype;
+			uint32_t num_chunks = (archetype->count + archetype->capacity - 1) / archetype->capacity;
+
+			if (native_query->chunk_index < num_chunks)
+			{
+				uint32_t first = native_query->chunk_index * archetype->capacity;
+
+				native_query->chunk = archetype->chunks[native_query->chunk_index];
+				native_query->count = std::min(archetype->capacity, archetype->count - first);
+				native_query->chunk_index++;
+
+				return true;
+			}
+
+			native_query->match_index++;
+			native_query->chunk_index = 0;
+		}
+
+		native_query->chunk = nullptr;
+		native_query->count = 0;
+
+		return false;
+	}
+
+	uint32_t World::getNumQueryComponents(game::QueryID *query) const
+	{
+		QueryID *native_query = static_cast<QueryID *>(query);
+
+		return native_query->count;
+	}
+
+	void *World::getQueryComponents(game::QueryID *query, uint32_t type_index) const
+	{
+		QueryID *native_query = static_cast<QueryID *>(query);
+		assert(native_query->chunk);
+
+		const QueryMatch &match = native_query->cached->matches[native_query->match_index];
+		const Column &column = match.archetype->columns[match.columns[type_index]];
+
+		return const_cast<uint8_t *>(native_query->chunk) + column.offset;
+	}
+
+	game::EntityID *const *World::getQueryEntities(game::QueryID *query) const
+	{
+		QueryID *native_query = static_cast<QueryID *>(query);
+		assert(native_query->chunk);
+
+		// entity ids always go first in a chunk
+		return reinterpret_cast<game::EntityID *const *>(native_query->chunk);
+	}
+
+	bool World::nextChunk(game::QueryID *query, uint32_t &count, void *columns[]) const
+	{
+		QueryID *native_query = static_cast<QueryID *>(query);
+
+		if (!next(query))
+			return false;
+
+		const QueryMatch &match = native_query->cached->matches[native_query->match_index];
+		uint8_t *chunk = const_cast<uint8_t *>(native_query->chunk);
+
+		for (size_t i = 0; i < match.columns.size(); ++i)
+			columns[i] = chunk + match.archetype->columns[match.columns[i]].offset;
+
+		count = native_query->count;
+		return true;
+	}
+
+	/*
+	 */
+	game::EntityID *World::createEntity()
+	{
+		uint32_t row = allocateRows(root_archetype, 1);
+
+		game::EntityID *entity = allocateEntity(root_archetype, row);
+		reinterpret_cast<game::EntityID **>(getChunk(root_archetype, row))[row % root_archetype->capacity] = entity;
+
+		structure_version++;
+
+		return entity;
+	}
+
+	void World::createEntities(uint32_t count, uint32_t num_types, const uint64_t type_ids[], const char *type_names[], const size_t type_sizes[], const size_t type_alignments[], const void *data[], game::EntityID *entities[])
+	{
+		if (count == 0)
+			return;
+
+		assert(num_types > 0);
+
+		structure_version++;
+
+		// archetype columns are sorted by type id, data arrays follow the caller's order
+		std::vector<uint32_t> order(num_types);
+		std::iota(order.begin(), order.end(), 0);
+		std::sort(order.begin(), order.end(), [type_ids](uint32_t a, uint32_t b) { return type_ids[a] < type_ids[b]; });
+
+		std::vector<uint64_t> sorted_ids(num_types);
+		for (uint32_t i = 0; i < num_types; ++i)
+		{
+			uint32_t type = order[i];
+			sorted_ids[i] = type_ids[type];
+
+			fetchComponent(type_ids[type], type_names[type], type_sizes[type], type_alignments[type]);
+		}
+
+		assert(std::adjacent_find(sorted_ids.begin(), sorted_ids.end()) == sorted_ids.end());
+
+		Archetype *archetype = fetchArchetype(sorted_ids);
+		uint32_t first = allocateRows(archetype, count);
+
+		forEachRange(archetype, first, count, [&](uint8_t *chunk, uint32_t index, uint32_t num_rows, uint32_t offset)
+		{
+			game::EntityID **chunk_entities = reinterpret_cast<game::EntityID **>(chunk) + index;
+			for (uint32_t i = 0; i < num_rows; ++i)
+				chunk_entities[i] = allocateEntity(archetype, first + offset + i);
+
+			if (entities)
+				memcpy(entities + offset, chunk_entities, sizeof(game::EntityID *) * num_rows);
+
+			for (uint32_t i = 0; i < num_types; ++i)
+			{
+				const Column &column = archetype->columns[i];
+				uint32_t size = column.component->type_size;
+
+				uint8_t *dst = getElement(chunk, column.offset, size, index);
+				const uint8_t *src = reinterpret_cast<const uint8_t *>(data[order[i]]);
+
+				if (src)
+					memcpy(dst, src + size * offset, size * num_rows);
+				else
+					memset(dst, 0, size * num_rows);
+
+				// new entities count as changed
+				if (column.tick_offset == INVALID_OFFSET)
+					continue;
+
+				uint64_t *ticks = reinterpret_cast<uint64_t *>(getElement(chunk, column.tick_offset, sizeof(uint64_t), index));
+				std::fill(ticks, ticks + num_rows, change_tick);
+			}
+		});
+	}
+
+	void World::destroyEntity(game::EntityID *entity)
+	{
+		Record *record = getRecord(entity);
+		assert(record);
+
+		if (!record)
+			return;
+
+		removeRow(record->archetype, record->row);
+
+		record->archetype = nullptr;
+		record->row = 0;
+		record->generation++;
+
+		free_records.push_back(getIndex(entity));
+
+		structure_version++;
+	}
+
+	void World::clear()
+	{
+		for (Archetype *archetype : archetypes)
+		{
+			for (uint8_t *chunk : archetype->chunks)
+				freeChunk(chunk);
+
+			archetype->chunks.clear();
+			archetype->count = 0;
+		}
+
+		// ids from before the clear stay invalid
+		free_records.clear();
+		for (uint32_t i = static_cast<uint32_t>(records.size()); i > 0; --i)
+		{
+			Record &record = records[i - 1];
+			if (record.archetype)
+				record.generation++;
+
+			record.archetype = nullptr;
+			record.row = 0;
+
+			free_records.push_back(i - 1);
+		}
+
+		structure_version++;
+	}
+
+	void *World::addComponent(game::EntityID *entity, uint64_t type_id, const char *type_name, size_t type_size, size_t type_alignment, const void *data)
+	{
+		assert(type_name);
+		assert(type_size > 0);
+
+		Record *record = getRecord(entity);
+		assert(record);
+
+		fetchComponent(type_id, type_name, type_size, type_alignment);
+
+		Archetype *source = record->archetype;
+		uint32_t column_index = findColumn(source, type_id);
+
+		if (column_index == INVALID_OFFSET)
+		{
+			Archetype *target = nullptr;
+
+			auto it = source->add_edges.find(type_id);
+			if (it != source->add_edges.end())
+			{
+				target = it->second;
+			}
+			else
+			{
+				std::vector<uint64_t> target_ids = source->type_ids;
+				target_ids.insert(std::upper_bound(target_ids.begin(), target_ids.end(), type_id), type_id);
+
+				target = fetchArchetype(target_ids);
+				source->add_edges.insert({type_id, target});
+			}
+
+			// added component is zeroed and stamped while moving
+			moveEntity(record, target);
+			column_index = findColumn(target, type_id);
+		}
+
+		structure_version++;
+
+		Archetype *archetype = record->archetype;
+		const Column &column = archetype->columns[column_index];
+
+		uint8_t *chunk = getChunk(archetype, record->row);
+		uint32_t index = record->row % archetype->capacity;
+
+		void *result = getElement(chunk, column.offset, column.component->type_size, index);
+		if (data)
+			memcpy(result, data, type_size);
+
+		if (column.tick_offset != INVALID_OFFSET)
+			*reinterpret_cast<uint64_t *>(getElement(chunk, column.tick_offset, sizeof(uint64_t), index)) = change_tick;
+
+		return result;
+	}
+
+	void *World::getComponent(game::EntityID *entity, uint64_t type_id, const char *, size_t, size_t) const
+	{
+		const Record *record = getRecord(entity);
+		assert(record);
+
+		if (!record)
+			return nullptr;
+
+		const Archetype *archetype = record->archetype;
+
+		uint32_t column_index = findColumn(archetype, type_id);
+		if (column_index == INVALID_OFFSET)
+			return nullptr;
+
+		const Column &column = archetype->columns[column_index];
+		assert(column.component->type_size == type_size);
+
+		return getElement(getChunk(archetype, record->row), column.offset, column.component->type_size, record->row % archetype->capacity);
+	}
+
+	/*
+	 */
+	void World::enableChangeTracking(uint64_t type_id, const char *type_name, size_t type_size, size_t type_alignment)
+	{
+		assert(type_name);
+		assert(type_size > 0);
+
+		fetchComponent(type_id, type_name, type_size, type_alignment);
+
+		Component &component = registered_components[type_id];
+		if (component.tracked)
+			return;
+
+		component.tracked = true;
+
+		// existing archetypes get a tick column, entities already there start out as changed
+		for (Archetype *archetype : archetypes)
+		{
+			if (findColumn(archetype, type_id) == INVALID_OFFSET)
+				continue;
+
+			relayoutArchetype(archetype);
+
+			if (archetype->count > 0)
+				structure_version++;
+		}
+	}
+
+	void World::markChanged(game::EntityID *entity, uint64_t type_id, const char *, size_t, size_t)
+	{
+		Record *record = getRecord(entity);
+		assert(record);
+
+		if (!record)
+			return;
+
+		const Archetype *archetype = record->archetype;
+
+		uint32_t column_index = findColumn(archetype, type_id);
+		if (column_index == INVALID_OFFSET)
+			return;
+
+		const Column &column = archetype->columns[column_index];
+		if (column.tick_offset == INVALID_OFFSET)
+			return;
+
+		uint8_t *chunk = getChunk(archetype, record->row);
+		*reinterpret_cast<uint64_t *>(getElement(chunk, column.tick_offset, sizeof(uint64_t), record->row % archetype->capacity)) = change_tick;
+	}
+
+	uint64_t *World::getQueryChangeTicks(game::QueryID *query, uint32_t type_index) const
+	{
+		QueryID *native_query = static_cast<QueryID *>(query);
+		assert(native_query->chunk);
+
+		const QueryMatch &match = native_query->cached->matches[native_query->match_index];
+		const Column &column = match.archetype->columns[match.columns[type_index]];
+
+		if (column.tick_offset == INVALID_OFFSET)
+			return nullptr;
+
+		return reinterpret_cast<uint64_t *>(const_cast<uint8_t *>(native_query->chunk) + column.tick_offset);
+	}
+
+	/*
+	 */
+	bool World::saveSnapshot(io::Stream *stream, uint32_t num_components, const SnapshotComponent components[])
+	{
+		assert(stream);
+
+		std::unordered_map<uint64_t, const SnapshotComponent *> snapshot_components;
+		for (uint32_t i = 0; i < num_components; ++i)
+		{
+			const SnapshotComponent &component = components[i];
+			assert(component.type_name);
+			assert(component.type_size > 0);
+
+			snapshot_components.insert({component.type_id, &component});
+		}
+
+		struct Table : public snapshot::Table
+		{
+			const Archetype *archetype {nullptr};
+		};
+
+		std::vector<Table> tables;
+
+		// ticks are not saved, loaded entities count as changed anyway
+		for (const Archetype *archetype : archetypes)
+		{
+			if (archetype->count == 0 || archetype->type_ids.empty())
+				continue;
+
+			Table table;
+			table.archetype = archetype;
+			table.count = archetype->count;
+
+			bool listed = true;
+			for (uint64_t type_id : archetype->type_ids)
+			{
+				auto it = snapshot_components.find(type_id);
+				if (it == snapshot_components.end() || it->second->type_size != registered_components[type_id].type_size)
+				{
+					listed = false;
+					break;
+				}
+
+				table.components.push_back(it->second);
+			}
+
+			if (listed)
+				tables.push_back(std::move(table));
+		}
+
+		bool success = snapshot::writeHeader(stream, static_cast<uint32_t>(tables.size()));
+
+		std::vector<uint8_t> scratch;
+
+		for (const Table &table : tables)
+		{
+			const Archetype *archetype = table.archetype;
+
+			success = success && snapshot::writeTableHeader(stream, table);
+
+			forEachRange(archetype, 0, table.count, [&](uint8_t *chunk, uint32_t index, uint32_t num_rows, uint32_t)
+			{
+				game::EntityID **entities = reinterpret_cast<game::EntityID **>(chunk) + index;
+				success = success && stream->write(entities, sizeof(game::EntityID *), num_rows) == num_rows;
+			});
+
+			// columns are written whole, one chunk part after another
+			for (size_t i = 0; i < archetype->columns.size(); ++i)
+			{
+				const Column &column = archetype->columns[i];
+				const SnapshotComponent *component = table.components[i];
+
+				forEachRange(archetype, 0, table.count, [&](uint8_t *chunk, uint32_t index, uint32_t num_rows, uint32_t)
+				{
+					const uint8_t *data = getElement(chunk, column.offset, column.component->type_size, index);
+					success = success && snapshot::writeColumn(stream, component, data, num_rows, scratch);
+				});
+			}
+		}
+
+		if (!success)
+		{
+			Log::error("World::saveSnapshot(): can't write to the stream\n");
+			return false;
+		}
+
+		return true;
+	}
+
+	bool World::loadSnapshot(io::Stream *stream, uint32_t num_components, const SnapshotComponent components[])
+	{
+		std::vector<snapshot::Table> tables;
+		std::vector<game::EntityID *> saved_entities;
+		std::vector<game::EntityID *> created_entities;
+
+		if (!snapshot::readTables(this, stream, num_components, components, tables, saved_entities, created_entities))
+			return false;
+
+		bool has_patches = std::any_of(components, components + num_components, [](const SnapshotComponent &component)
+		{
+			return component.load != nullptr;
+		});
+
+		if (!has_patches)
+			return true;
+
+		// references between entities can only be patched once every entity exists
+		snapshot::EntityMap entity_map(saved_entities, created_entities);
+
+		for (const snapshot::Table &table : tables)
+		{
+			if (table.count == 0)
+				continue;
+
+			// bulk created entities take consecutive rows of their archetype
+			const Record *record = getRecord(created_entities[table.first]);
+			assert(record);
+
+			const Archetype *archetype = record->archetype;
+
+			for (const SnapshotComponent *component : table.components)
+			{
+				if (!component->load)
+					continue;
+
+				const Column &column = archetype->columns[findColumn(archetype, component->type_id)];
+
+				forEachRange(archetype, record->row, table.count, [&](uint8_t *chunk, uint32_t index, uint32_t num_rows, uint32_t)
+				{
+					void *data = getElement(chunk, column.offset, column.component->type_size, index);
+					component->load(component->user_data, entity_map, data, num_rows);
+				});
+			}
+		}
+
+		return true;
+	}
+
+	/*
+	 */
+	const Component *World::fetchComponent(uint64_t type_id, const char *type_name, size_t type_size, size_t type_alignment)
+	{
+		auto it = registered_components.find(type_id);
+		if (it != registered_components.end())
+		{
+			assert(it->second.type_size == type_size);
+			return &it->second;
+		}
+
+		assert(type_name);
+		assert(type_size > 0);
+		assert(type_alignment <= CHUNK_ALIGNMENT);
+
+		Component &component = registered_components[type_id];
+		component.type_id = type_id;
+		component.type_name = type_name;
+		component.type_size = static_cast<uint32_t>(type_size);
+		component.type_alignment = static_cast<uint32_t>(type_alignment);
+
+		return &component;
+	}
+
+	const Component *World::findComponent(uint64_t type_id) const
+	{
+		auto it = registered_components.find(type_id);
+		if (it == registered_components.end())
+			return nullptr;
+
+		return &it->second;
+	}
+
+	/*
+	 */
+	Archetype *World::fetchArchetype(const std::vector<uint64_t> &type_ids)
+	{
+		uint64_t signature = getSignature(type_ids.data(), type_ids.size());
+
+		auto it = archetype_signatures.find(signature);
+		if (it != archetype_signatures.end())
+		{
+			assert(it->second->type_ids == type_ids);
+			return it->second;
+		}
+
+		Archetype *result = new Archetype();
+		result->type_ids = type_ids;
+
+		layoutArchetype(result);
+
+		archetypes.push_back(result);
+		archetype_signatures[signature] = result;
+
+		for (auto it : cached_queries)
+			matchArchetype(it.second, result);
+
+		return result;
+	}
+
+	void World::layoutArchetype(Archetype *archetype) const
+	{
+		size_t num_types = archetype->type_ids.size();
+		archetype->columns.resize(num_types);
+
+		uint32_t row_size = sizeof(game::EntityID *);
+		uint32_t num_arrays = 1;
+
+		for (size_t i = 0; i < num_types; ++i)
+		{
+			const Component *component = findComponent(archetype->type_ids[i]);
+			assert(component);
+
+			archetype->columns[i].component = component;
+
+			row_size += component->type_size;
+			num_arrays++;
+
+			if (component->tracked)
+			{
+				row_size += sizeof(uint64_t);
+				num_arrays++;
+			}
+		}
+
+		// every array start is aligned, which wastes less than the alignment per array
+		uint32_t padding = num_arrays * CHUNK_ALIGNMENT;
+		uint32_t capacity = (CHUNK_SIZE > padding) ? (CHUNK_SIZE - padding) / row_size : 0;
+
+		// huge components get bigger chunks rather than no rows at all
+		archetype->capacity = std::max<uint32_t>(1, capacity);
+
+		uint32_t offset = archetype->capacity * sizeof(game::EntityID *);
+
+		for (Column &column : archetype->columns)
+		{
+			offset = alignOffset(offset);
+			column.offset = offset;
+			offset += archetype->capacity * column.component->type_size;
+
+			column.tick_offset = INVALID_OFFSET;
+			if (!column.component->tracked)
+				continue;
+
+			offset = alignOffset(offset);
+			column.tick_offset = offset;
+			offset += archetype->capacity * sizeof(uint64_t);
+		}
+
+		archetype->chunk_size = alignOffset(offset);
+	}
+
+	void World::relayoutArchetype(Archetype *archetype)
+	{
+		std::vector<Column> old_columns = archetype->columns;
+		uint32_t old_capacity = archetype->capacity;
+
+		std::vector<uint8_t *> old_chunks;
+		std::swap(old_chunks, archetype->chunks);
+
+		layoutArchetype(archetype);
+
+		uint32_t count = archetype->count;
+		archetype->count = 0;
+
+		allocateRows(archetype, count);
+
+		for (uint32_t row = 0; row < count; ++row)
+		{
+			uint8_t *src_chunk = old_chunks[row / old_capacity];
+			uint8_t *dst_chunk = getChunk(archetype, row);
+
+			uint32_t src_index = row % old_capacity;
+			uint32_t dst_index = row % archetype->capacity;
+
+			reinterpret_cast<game::EntityID **>(dst_chunk)[dst_index] = reinterpret_cast<game::EntityID **>(src_chunk)[src_index];
+
+			for (size_t i = 0; i < old_columns.size(); ++i)
+			{
+				const Column &src = old_columns[i];
+				const Column &dst = archetype->columns[i];
+				uint32_t size = dst.component->type_size;
+
+				memcpy(getElement(dst_chunk, dst.offset, size, dst_index), getElement(src_chunk, src.offset, size, src_index), size);
+
+				if (dst.tick_offset == INVALID_OFFSET)
+					continue;
+
+				uint64_t *tick = reinterpret_cast<uint64_t *>(getElement(dst_chunk, dst.tick_offset, sizeof(uint64_t), dst_index));
+
+				if (src.tick_offset != INVALID_OFFSET)
+					*tick = *reinterpret_cast<const uint64_t *>(getElement(src_chunk, src.tick_offset, sizeof(uint64_t), src_index));
+				else
+					*tick = change_tick;
+			}
+		}
+
+		for (uint8_t *chunk : old_chunks)
+			freeChunk(chunk);
+	}
+
+	void World::matchArchetype(CachedQuery *cached_query, const Archetype *archetype) const
+	{
+		QueryMatch match;
+		match.archetype = archetype;
+		match.columns.resize(cached_query->type_ids.size());
+
+		for (size_t i = 0; i < cached_query->type_ids.size(); ++i)
+		{
+			uint32_t column = findColumn(archetype, cached_query->type_ids[i]);
+			if (column == INVALID_OFFSET)
+				return;
+
+			match.columns[i] = column;
+		}
+
+		cached_query->matches.push_back(std::move(match));
+	}
+
+	const CachedQuery *World::fetchCachedQuery(uint32_t num_types, const uint64_t type_ids[], const char *type_names[], size_t type_sizes[], size_t type_alignments[])
+	{
+		// column order matters, so does the signature hash
+		uint64_t signature = getSignature(type_ids, num_types);
+
+		auto it = cached_queries.find(signature);
+		if (it != cached_queries.end())
+		{
+			assert(std::equal(type_ids, type_ids + num_types, it->second->type_ids.begin(), it->second->type_ids.end()));
+			return it->second;
+		}
+
+		for (uint32_t i = 0; i < num_types; ++i)
+			fetchComponent(type_ids[i], type_names[i], type_sizes[i], type_alignments[i]);
+
+		CachedQuery *result = new CachedQuery();
+		result->type_ids.assign(type_ids, type_ids + num_types);
+
+		for (const Archetype *archetype : archetypes)
+			matchArchetype(result, archetype);
+
+		cached_queries[signature] = result;
+
+		return result;
+	}
+
+	/*
+	 */
+	game::EntityID *World::allocateEntity(Archetype *archetype, uint32_t row)
+	{
+		uint32_t index = 0;
+
+		if (!free_records.empty())
+		{
+			index = free_records.back();
+			free_records.pop_back();
+		}
+		else
+		{
+			index = static_cast<uint32_t>(records.size());
+			records.emplace_back();
+		}
+
+		Record &record = records[index];
+		record.archetype = archetype;
+		record.row = row;
+
+		return makeEntity(index, record.generation);
+	}
+
+	World::Record *World::getRecord(game::EntityID *entity)
+	{
+		uint32_t index = getIndex(entity);
+		if (index >= records.size())
+			return nullptr;
+
+		Record &record = records[index];
+		if (record.archetype == nullptr || record.generation != getGeneration(entity))
+			return nullptr;
+
+		return &record;
+	}
+
+	const World::Record *World::getRecord(game::EntityID *entity) const
+	{
+		return const_cast<World *>(this)->getRecord(entity);
+	}
+
+	/*
+	 */
+	uint32_t World::allocateRows(Archetype *archetype, uint32_t count)
+	{
+		uint32_t first = archetype->count;
+		archetype->count += count;
+
+		uint32_t num_chunks = (archetype->count + archetype->capacity - 1) / archetype->capacity;
+		while (archetype->chunks.size() < num_chunks)
+			archetype->chunks.push_back(allocateChunk(archetype->chunk_size));
+
+		return first;
+	}
+
+	void World::removeRow(Archetype *archetype, uint32_t row)
+	{
+		assert(row < archetype->count);
+
+		// last row fills the gap, so rows stay dense
+		uint32_t last = archetype->count - 1;
+		if (row != last)
+		{
+			copyRow(archetype, row, last);
+
+			game::EntityID *moved_entity = reinterpret_cast<game::EntityID **>(getChunk(archetype, row))[row % archetype->capacity];
+			records[getIndex(moved_entity)].row = row;
+		}
+
+		archetype->count--;
+
+		// one spare chunk is kept, so an entity going back and forth doesn't allocate every time
+		uint32_t num_chunks = (archetype->count + archetype->capacity - 1) / archetype->capacity;
+		while (archetype->chunks.size() > num_chunks + 1)
+		{
+			freeChunk(archetype->chunks.back());
+			archetype->chunks.pop_back();
+		}
+	}
+
+	void World::moveEntity(Record *record, Archetype *archetype)
+	{
+		Archetype *source = record->archetype;
+		uint32_t source_row = record->row;
+
+		uint32_t row = allocateRows(archetype, 1);
+
+		uint8_t *src_chunk = getChunk(source, source_row);
+		uint8_t *dst_chunk = getChunk(archetype, row);
+
+		uint32_t src_index = source_row % source->capacity;
+		uint32_t dst_index = row % archetype->capacity;
+
+		reinterpret_cast<game::EntityID **>(dst_chunk)[dst_index] = reinterpret_cast<game::EntityID **>(src_chunk)[src_index];
+
+		// both type lists are sorted, so matching columns are found in one pass
+		size_t src_column = 0;
+		for (size_t i = 0; i < archetype->columns.size(); ++i)
+		{
+			const Column &dst = archetype->columns[i];
+			uint64_t type_id = archetype->type_ids[i];
+			uint32_t size = dst.component->type_size;
+
+			while (src_column < source->type_ids.size() && source->type_ids[src_column] < type_id)
+				src_column++;
+
+			uint8_t *dst_data = getElement(dst_chunk, dst.offset, size, dst_index);
+			uint64_t *dst_tick = (dst.tick_offset != INVALID_OFFSET) ? reinterpret_cast<uint64_t *>(getElement(dst_chunk, dst.tick_offset, sizeof(uint64_t), dst_index)) : nullptr;
+
+			if (src_column < source->type_ids.size() && source->type_ids[src_column] == type_id)
+			{
+				const Column &src = source->columns[src_column];
+				memcpy(dst_data, getElement(src_chunk, src.offset, size, src_index), size);
+
+				if (dst_tick)
+					*dst_tick = *reinterpret_cast<const uint64_t *>(getElement(src_chunk, src.tick_offset, sizeof(uint64_t), src_index));
+
+				continue;
+			}
+
+			memset(dst_data, 0, size);
+
+			if (dst_tick)
+				*dst_tick = change_tick;
+		}
+
+		removeRow(source, source_row);
+
+		record->archetype = archetype;
+		record->row = row;
+	}
+}
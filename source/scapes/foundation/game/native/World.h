@@ -0,0 +1,156 @@
+#pragma once
+
+#include <scapes/foundation/game/World.h>
+
+#include <unordered_map>
+#include <vector>
+
+namespace scapes::foundation::game::native
+{
+	enum : uint32_t
+	{
+		CHUNK_SIZE = 65536,
+		CHUNK_ALIGNMENT = 64,
+		INVALID_OFFSET = ~0u,
+	};
+
+	struct Component
+	{
+		uint64_t type_id {0};
+		const char *type_name {nullptr};
+		uint32_t type_size {0};
+		uint32_t type_alignment {0};
+		bool tracked {false};
+	};
+
+	struct Column
+	{
+		const Component *component {nullptr};
+
+		// byte offsets inside a chunk, ticks are INVALID_OFFSET if the component is not tracked
+		uint32_t offset {0};
+		uint32_t tick_offset {INVALID_OFFSET};
+	};
+
+	/* Entities with the same component set, rows are dense across chunks and every chunk
+	 * holds the entity ids followed by one 64 byte aligned array per component
+	 */
+	struct Archetype
+	{
+		// sorted by type id
+		std::vector<uint64_t> type_ids;
+		std::vector<Column> columns;
+
+		uint32_t capacity {0};
+		uint32_t chunk_size {0};
+		uint32_t count {0};
+		std::vector<uint8_t *> chunks;
+
+		// archetype with one more component, filled as entities move around
+		std::unordered_map<uint64_t, Archetype *> add_edges;
+	};
+
+	struct QueryMatch
+	{
+		const Archetype *archetype {nullptr};
+
+		// archetype column per query type
+		std::vector<uint32_t> columns;
+	};
+
+	// matched against every new archetype, so one per signature is kept for the world lifetime
+	struct CachedQuery
+	{
+		std::vector<uint64_t> type_ids;
+		std::vector<QueryMatch> matches;
+	};
+
+	struct QueryID : public game::QueryID
+	{
+		const CachedQuery *cached {nullptr};
+		uint32_t match_index {0};
+		uint32_t chunk_index {0};
+		uint32_t count {0};
+		const uint8_t *chunk {nullptr};
+	};
+
+	class World : public game::World
+	{
+	public:
+		World();
+		~World() final;
+
+		game::QueryID *createQuery(uint32_t num_types, const uint64_t type_ids[], const char *type_names[], size_t type_sizes[], size_t type_alignments[]) final;
+		void destroyQuery(game::QueryID *query) final;
+		bool begin(game::QueryID *query) const final;
+		bool next(game::QueryID *query) const final;
+		uint32_t getNumQueryComponents(game::QueryID *query) const final;
+		void *getQueryComponents(game::QueryID *query, uint32_t type_index) const final;
+		game::EntityID *const *getQueryEntities(game::QueryID *query) const final;
+		bool nextChunk(game::QueryID *query, uint32_t &count, void *columns[]) const final;
+
+		game::EntityID *createEntity() final;
+		void createEntities(uint32_t count, uint32_t num_types, const uint64_t type_ids[], const char *type_names[], const size_t type_sizes[], const size_t type_alignments[], const void *data[], game::EntityID *entities[]) final;
+		void destroyEntity(game::EntityID *entity) final;
+		void clear() final;
+
+		SCAPES_INLINE uint64_t getStructureVersion() const final { return structure_version; }
+
+		void *addComponent(game::EntityID *entity, uint64_t type_id, const char *type_name, size_t type_size, size_t type_alignment, const void *data) final;
+		void *getComponent(game::EntityID *entity, uint64_t type_id, const char *type_name, size_t type_size, size_t type_alignment) const final;
+
+		void enableChangeTracking(uint64_t type_id, const char *type_name, size_t type_size, size_t type_alignment) final;
+
+		SCAPES_INLINE uint64_t getChangeTick() const final { return change_tick; }
+		SCAPES_INLINE uint64_t advanceChangeTick() final { return change_tick++; }
+
+		void markChanged(game::EntityID *entity, uint64_t type_id, const char *type_name, size_t type_size, size_t type_alignment) final;
+		uint64_t *getQueryChangeTicks(game::QueryID *query, uint32_t type_index) const final;
+
+		bool saveSnapshot(io::Stream *stream, uint32_t num_components, const SnapshotComponent components[]) final;
+		bool loadSnapshot(io::Stream *stream, uint32_t num_components, const SnapshotComponent components[]) final;
+
+	private:
+		struct Record
+		{
+			Archetype *archetype {nullptr};
+			uint32_t row {0};
+			uint32_t generation {0};
+		};
+
+		const Component *fetchComponent(uint64_t type_id, const char *type_name, size_t type_size, size_t type_alignment);
+		const Component *findComponent(uint64_t type_id) const;
+
+		Archetype *fetchArchetype(const std::vector<uint64_t> &type_ids);
+		void layoutArchetype(Archetype *archetype) const;
+		void relayoutArchetype(Archetype *archetype);
+		void matchArchetype(CachedQuery *cached_query, const Archetype *archetype) const;
+
+		const CachedQuery *fetchCachedQuery(uint32_t num_types, const uint64_t type_ids[], const char *type_names[], size_t type_sizes[], size_t type_alignments[]);
+
+		game::EntityID *allocateEntity(Archetype *archetype, uint32_t row);
+		Record *getRecord(game::EntityID *entity);
+		const Record *getRecord(game::EntityID *entity) const;
+
+		uint32_t allocateRows(Archetype *archetype, uint32_t count);
+		void removeRow(Archetype *archetype, uint32_t row);
+		void moveEntity(Record *record, Archetype *archetype);
+
+	private:
+		std::unordered_map<uint64_t, Component> registered_components;
+
+		// creation order, so iteration doesn't depend on hashing
+		std::vector<Archetype *> archetypes;
+		std::unordered_map<uint64_t, Archetype *> archetype_signatures;
+		Archetype *root_archetype {nullptr};
+
+		std::unordered_map<uint64_t, CachedQuery *> cached_queries;
+
+		// entity ids are record indices plus one with the record generation on top
+		std::vector<Record> records;
+		std::vector<uint32_t> free_records;
+
+		uint64_t structure_version {0};
+		uint64_t change_tick {1};
+	};
+}
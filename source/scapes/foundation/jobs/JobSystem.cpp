@@ -0,0 +1,14 @@
+#include <jobs/impl/JobSystem.h>
+
+namespace scapes::foundation::jobs
+{
+	JobSystem *JobSystem::create(uint32_t num_workers)
+	{
+		return new impl::JobSystem(num_workers);
+	}
+
+	void JobSystem::destroy(JobSystem *job_system)
+	{
+		delete job_system;
+	}
+}
@@ -0,0 +1,445 @@
+#include "jobs/impl/JobSystem.h"
+
+#include <scapes/foundation/profiler/Profiler.h>
+
+#include <algorithm>
+#include <cassert>
+#include <string>
+
+namespace scapes::foundation::jobs::impl
+{
+	/*
+	 */
+	static thread_local const JobSystem *current_system = nullptr;
+	static thread_local uint32_t current_thread_index = ~0u;
+	static thread_local uint32_t current_random_state = 0;
+
+	static uint32_t nextRandom()
+	{
+		// xorshift, only used to spread thieves over victims
+		uint32_t x = current_random_state;
+		x ^= x << 13;
+		x ^= x >> 17;
+		x ^= x << 5;
+		current_random_state = x;
+
+		return x;
+	}
+
+	/*
+	 */
+	JobSystem::JobSystem(uint32_t num_workers)
+	{
+		if (num_workers == 0)
+			num_workers = std::max<uint32_t>(2, std::thread::hardware_concurrency()) - 1;
+
+		queues.reserve(num_workers + 1);
+		for (uint32_t i = 0; i <= num_workers; ++i)
+			queues.emplace_back(std::make_unique<Queue>());
+
+		current_system = this;
+		current_thread_index = MAIN_THREAD_INDEX;
+		current_random_state = 0x9e3779b9u;
+
+		workers.reserve(num_workers);
+		for (uint32_t i = 0; i < num_workers; ++i)
+			workers.emplace_back(&JobSystem::workerLoop, this, i + 1);
+	}
+
+	JobSystem::~JobSystem()
+	{
+		assert(getThreadIndex() == MAIN_THREAD_INDEX);
+
+		{
+			std::lock_guard<std::mutex> lock(sleep_mutex);
+			running = false;
+		}
+
+		wake_condition.notify_all();
+
+		for (std::thread &worker : workers)
+			worker.join();
+
+		workers.clear();
+
+		// nobody waits for the leftovers, drop them
+		auto release = [](Job *job)
+		{
+			if (job->owned)
+				delete job;
+		};
+
+		for (std::unique_ptr<Queue> &queue : queues)
+			while (Job *job = queue->pop())
+				release(job);
+
+		for (Job *job : injection_jobs)
+			release(job);
+
+		for (Job *job : main_jobs)
+			release(job);
+
+		queues.clear();
+		injection_jobs.clear();
+		main_jobs.clear();
+
+		current_system = nullptr;
+		current_thread_index = INVALID_THREAD_INDEX;
+	}
+
+	/*
+	 */
+	uint32_t JobSystem::getThreadIndex() const
+	{
+		return (current_system == this) ? current_thread_index : INVALID_THREAD_INDEX;
+	}
+
+	/*
+	 */
+	JobCounter *JobSystem::createCounter()
+	{
+		return new Counter();
+	}
+
+	void JobSystem::destroyCounter(JobCounter *counter)
+	{
+		assert(counter);
+		assert(isDone(counter));
+
+		Counter *impl = static_cast<Counter *>(counter);
+
+		// the thread that decremented it to zero may still hold the lock
+		{
+			std::lock_guard<std::mutex> lock(impl->mutex);
+			assert(impl->dependents.empty());
+		}
+
+		delete impl;
+	}
+
+	bool JobSystem::isDone(const JobCounter *counter) const
+	{
+		assert(counter);
+
+		const Counter *impl = static_cast<const Counter *>(counter);
+		return impl->value.load(std::memory_order_acquire) == 0;
+	}
+
+	/*
+	 */
+	void JobSystem::submit(std::function<void ()> function, JobCounter *counter, JobCounter *dependency, JobAffinity affinity)
+	{
+		assert(function);
+
+		Job *job = new Job();
+		job->function = std::move(function);
+		job->counter = static_cast<Counter *>(counter);
+		job->affinity = affinity;
+
+		if (job->counter)
+			job->counter->value.fetch_add(1, std::memory_order_relaxed);
+
+		if (dependency)
+		{
+			Counter *impl = static_cast<Counter *>(dependency);
+
+			std::lock_guard<std::mutex> lock(impl->mutex);
+			if (impl->value.load(std::memory_order_acquire) != 0)
+			{
+				impl->dependents.push_back(job);
+				return;
+			}
+		}
+
+		schedule(job);
+	}
+
+	void JobSystem::wait(JobCounter *counter)
+	{
+		SCAPES_PROFILER();
+
+		assert(counter);
+
+		Counter *impl = static_cast<Counter *>(counter);
+		uint32_t index = getThreadIndex();
+
+		while (impl->value.load(std::memory_order_acquire) != 0)
+		{
+			uint32_t epoch = work_epoch.load(std::memory_order_seq_cst);
+
+			Job *job = (index == MAIN_THREAD_INDEX) ? popMainJob() : nullptr;
+			if (!job)
+				job = findJob(index);
+
+			if (job)
+			{
+				run(job);
+				continue;
+			}
+
+			std::unique_lock<std::mutex> lock(sleep_mutex);
+			num_sleeping.fetch_add(1, std::memory_order_seq_cst);
+
+			wake_condition.wait(lock, [this, impl, epoch]()
+			{
+				return work_epoch.load(std::memory_order_seq_cst) != epoch || impl->value.load(std::memory_order_acquire) == 0;
+			});
+
+			num_sleeping.fetch_sub(1, std::memory_order_relaxed);
+		}
+
+		// make sure the finishing thread is done with the counter, callers may destroy it right away
+		std::lock_guard<std::mutex> lock(impl->mutex);
+	}
+
+	void JobSystem::update()
+	{
+		SCAPES_PROFILER();
+
+		assert(getThreadIndex() == MAIN_THREAD_INDEX);
+
+		std::deque<Job *> jobs;
+		{
+			std::lock_guard<std::mutex> lock(main_mutex);
+			std::swap(jobs, main_jobs);
+		}
+
+		// jobs queued from these will wait for the next update
+		for (Job *job : jobs)
+			run(job);
+	}
+
+	/*
+	 */
+	void JobSystem::parallelForRange(uint32_t begin, uint32_t end, uint32_t batch_size, RangeFuncPtr func, const void *data)
+	{
+		SCAPES_PROFILER();
+
+		assert(begin < end);
+		assert(func);
+
+		uint32_t count = end - begin;
+		uint32_t num_threads = getNumThreads();
+
+		// a few batches per thread leave room for stealing when batches are uneven
+		if (batch_size == 0)
+			batch_size = std::max<uint32_t>(1, (count + num_threads * 4 - 1) / (num_threads * 4));
+
+		uint32_t num_batches = (count + batch_size - 1) / batch_size;
+		if (num_batches == 1 || num_threads == 1)
+		{
+			func(data, begin, end);
+			return;
+		}
+
+		Counter counter;
+		counter.value.store(num_batches - 1, std::memory_order_relaxed);
+
+		std::vector<Job> batches(num_batches - 1);
+		for (uint32_t i = 0; i < num_batches - 1; ++i)
+		{
+			Job &batch = batches[i];
+
+			batch.range_function = func;
+			batch.range_data = data;
+			batch.range_begin = begin + (i + 1) * batch_size;
+			batch.range_end = std::min(end, batch.range_begin + batch_size);
+			batch.counter = &counter;
+			batch.owned = false;
+
+			enqueue(&batch);
+		}
+
+		signal(true);
+
+		// first batch runs right here, thieves take the rest from the top of the deque
+		func(data, begin, std::min(end, begin + batch_size));
+
+		wait(&counter);
+	}
+
+	/*
+	 */
+	void JobSystem::workerLoop(uint32_t index)
+	{
+		current_system = this;
+		current_thread_index = index;
+		current_random_state = 0x9e3779b9u * (index + 1);
+
+#ifdef SCAPES_PROFILER_ENABLED
+		std::string name = "Job Worker " + std::to_string(index);
+		profiler::SetThreadName(name.c_str());
+#endif
+
+		while (true)
+		{
+			uint32_t epoch = work_epoch.load(std::memory_order_seq_cst);
+
+			Job *job = findJob(index);
+			if (job)
+			{
+				run(job);
+				continue;
+			}
+
+			std::unique_lock<std::mutex> lock(sleep_mutex);
+			if (!running)
+				break;
+
+			num_sleeping.fetch_add(1, std::memory_order_seq_cst);
+
+			wake_condition.wait(lock, [this, epoch]()
+			{
+				return !running || work_epoch.load(std::memory_order_seq_cst) != epoch;
+			});
+
+			num_sleeping.fetch_sub(1, std::memory_order_relaxed);
+
+			if (!running)
+				break;
+		}
+
+		current_system = nullptr;
+		current_thread_index = INVALID_THREAD_INDEX;
+	}
+
+	/*
+	 */
+	void JobSystem::schedule(Job *job)
+	{
+		// job may be stolen and freed as soon as it's queued
+		bool main_thread = (job->affinity == JobAffinity::MAIN_THREAD);
+
+		enqueue(job);
+		signal(main_thread);
+	}
+
+	void JobSystem::enqueue(Job *job)
+	{
+		if (job->affinity == JobAffinity::MAIN_THREAD)
+		{
+			std::lock_guard<std::mutex> lock(main_mutex);
+			main_jobs.push_back(job);
+			return;
+		}
+
+		uint32_t index = getThreadIndex();
+		if (index != INVALID_THREAD_INDEX && queues[index]->push(job))
+			return;
+
+		std::lock_guard<std::mutex> lock(injection_mutex);
+		injection_jobs.push_back(job);
+		num_injection_jobs.fetch_add(1, std::memory_order_release);
+	}
+
+	void JobSystem::signal(bool all)
+	{
+		work_epoch.fetch_add(1, std::memory_order_seq_cst);
+
+		// sleepers register under the lock before checking the epoch, so either they see
+		// the new epoch or we see them and notify after they started waiting
+		if (num_sleeping.load(std::memory_order_seq_cst) == 0)
+			return;
+
+		{
+			std::lock_guard<std::mutex> lock(sleep_mutex);
+		}
+
+		if (all)
+			wake_condition.notify_all();
+		else
+			wake_condition.notify_one();
+	}
+
+	/*
+	 */
+	JobSystem::Job *JobSystem::findJob(uint32_t index)
+	{
+		uint32_t num_queues = static_cast<uint32_t>(queues.size());
+
+		if (index != INVALID_THREAD_INDEX)
+		{
+			Job *job = queues[index]->pop();
+			if (job)
+				return job;
+		}
+
+		if (num_injection_jobs.load(std::memory_order_acquire) > 0)
+		{
+			std::lock_guard<std::mutex> lock(injection_mutex);
+			if (!injection_jobs.empty())
+			{
+				Job *job = injection_jobs.front();
+				injection_jobs.pop_front();
+				num_injection_jobs.fetch_sub(1, std::memory_order_relaxed);
+
+				return job;
+			}
+		}
+
+		uint32_t start = nextRandom() % num_queues;
+		for (uint32_t i = 0; i < num_queues; ++i)
+		{
+			uint32_t victim = (start + i) % num_queues;
+			if (victim == index)
+				continue;
+
+			Job *job = queues[victim]->steal();
+			if (job)
+				return job;
+		}
+
+		return nullptr;
+	}
+
+	JobSystem::Job *JobSystem::popMainJob()
+	{
+		std::lock_guard<std::mutex> lock(main_mutex);
+		if (main_jobs.empty())
+			return nullptr;
+
+		Job *job = main_jobs.front();
+		main_jobs.pop_front();
+
+		return job;
+	}
+
+	void JobSystem::run(Job *job)
+	{
+		{
+			SCAPES_PROFILER_N("Job");
+
+			if (job->range_function)
+				job->range_function(job->range_data, job->range_begin, job->range_end);
+			else
+				job->function();
+		}
+
+		Counter *counter = job->counter;
+
+		if (job->owned)
+			delete job;
+
+		if (counter)
+			finish(counter);
+	}
+
+	void JobSystem::finish(Counter *counter)
+	{
+		std::vector<Job *> dependents;
+
+		{
+			std::lock_guard<std::mutex> lock(counter->mutex);
+			if (counter->value.fetch_sub(1, std::memory_order_acq_rel) != 1)
+				return;
+
+			std::swap(dependents, counter->dependents);
+		}
+
+		// counter may be gone past this point
+		for (Job *job : dependents)
+			enqueue(job);
+
+		signal(true);
+	}
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <scapes/foundation/jobs/JobSystem.h>
+#include "WorkStealingQueue.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace scapes::foundation::jobs::impl
+{
+	class JobSystem : public jobs::JobSystem
+	{
+	public:
+		JobSystem(uint32_t num_workers);
+		~JobSystem() final;
+
+		SCAPES_INLINE uint32_t getNumThreads() const final { return static_cast<uint32_t>(queues.size()); }
+		uint32_t getThreadIndex() const final;
+
+		JobCounter *createCounter() final;
+		void destroyCounter(JobCounter *counter) final;
+		bool isDone(const JobCounter *counter) const final;
+
+		void submit(std::function<void ()> job, JobCounter *counter, JobCounter *dependency, JobAffinity affinity) final;
+		void wait(JobCounter *counter) final;
+		void update() final;
+
+	private:
+		void parallelForRange(uint32_t begin, uint32_t end, uint32_t batch_size, RangeFuncPtr func, const void *data) final;
+
+	private:
+		struct Counter;
+
+		struct Job
+		{
+			std::function<void ()> function;
+
+			// parallel for batches don't allocate, they point to the caller's range function
+			RangeFuncPtr range_function {nullptr};
+			const void *range_data {nullptr};
+			uint32_t range_begin {0};
+			uint32_t range_end {0};
+
+			Counter *counter {nullptr};
+			JobAffinity affinity {JobAffinity::ANY};
+
+			// submitted jobs are owned by the system, batches live on the caller's stack
+			bool owned {true};
+		};
+
+		struct Counter : public JobCounter
+		{
+			std::atomic<uint32_t> value {0};
+
+			// guards dependents and the transition to zero
+			std::mutex mutex;
+			std::vector<Job *> dependents;
+		};
+
+		void workerLoop(uint32_t index);
+
+		void schedule(Job *job);
+		void enqueue(Job *job);
+		void signal(bool all);
+
+		Job *findJob(uint32_t index);
+		Job *popMainJob();
+		void run(Job *job);
+		void finish(Counter *counter);
+
+	private:
+		enum
+		{
+			MAIN_THREAD_INDEX = 0,
+			INVALID_THREAD_INDEX = ~0u,
+		};
+
+		using Queue = WorkStealingQueue<Job>;
+
+		// one per thread, main thread goes first
+		std::vector<std::unique_ptr<Queue>> queues;
+		std::vector<std::thread> workers;
+
+		// jobs from threads outside of the system and deque overflow
+		std::mutex injection_mutex;
+		std::deque<Job *> injection_jobs;
+		std::atomic<uint32_t> num_injection_jobs {0};
+
+		std::mutex main_mutex;
+		std::deque<Job *> main_jobs;
+
+		// bumped on every new job and finished counter, sleepers compare it to what they saw before looking for work
+		std::mutex sleep_mutex;
+		std::condition_variable wake_condition;
+		std::atomic<uint32_t> work_epoch {0};
+		std::atomic<uint32_t> num_sleeping {0};
+		bool running {true};
+	};
+}
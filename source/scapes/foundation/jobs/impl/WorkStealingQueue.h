@@ -0,0 +1,92 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+namespace scapes::foundation::jobs::impl
+{
+	/* Chase-Lev deque with fixed capacity, the owner thread pushes and pops at the bottom,
+	 * any other thread steals from the top
+	 */
+	template <typename T, uint32_t CAPACITY = 4096>
+	class WorkStealingQueue
+	{
+		static_assert((CAPACITY & (CAPACITY - 1)) == 0, "Capacity must be a power of two");
+
+	public:
+		// owner thread only, returns false if the queue is full
+		bool push(T *item)
+		{
+			int64_t b = bottom.load(std::memory_order_relaxed);
+			int64_t t = top.load(std::memory_order_acquire);
+
+			if (b - t >= static_cast<int64_t>(CAPACITY))
+				return false;
+
+			items[b & MASK].store(item, std::memory_order_relaxed);
+			bottom.store(b + 1, std::memory_order_release);
+
+			return true;
+		}
+
+		// owner thread only
+		T *pop()
+		{
+			int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+			bottom.store(b, std::memory_order_seq_cst);
+
+			int64_t t = top.load(std::memory_order_seq_cst);
+
+			if (t > b)
+			{
+				bottom.store(b + 1, std::memory_order_relaxed);
+				return nullptr;
+			}
+
+			T *item = items[b & MASK].load(std::memory_order_relaxed);
+			if (t == b)
+			{
+				// last item, race against thieves for it
+				if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+					item = nullptr;
+
+				bottom.store(b + 1, std::memory_order_relaxed);
+			}
+
+			return item;
+		}
+
+		// any thread, only gives up once the queue is empty
+		T *steal()
+		{
+			int64_t t = top.load(std::memory_order_seq_cst);
+
+			while (true)
+			{
+				int64_t b = bottom.load(std::memory_order_seq_cst);
+				if (t >= b)
+					return nullptr;
+
+				T *item = items[t & MASK].load(std::memory_order_relaxed);
+				if (top.compare_exchange_weak(t, t + 1, std::memory_order_seq_cst, std::memory_order_seq_cst))
+					return item;
+			}
+		}
+
+		bool empty() const
+		{
+			return top.load(std::memory_order_relaxed) >= bottom.load(std::memory_order_relaxed);
+		}
+
+	private:
+		enum : uint32_t
+		{
+			MASK = CAPACITY - 1,
+		};
+
+		// owner and thieves touch different ends, keep them on separate cache lines
+		alignas(64) std::atomic<int64_t> top {0};
+		alignas(64) std::atomic<int64_t> bottom {0};
+		alignas(64) std::atomic<T *> items[CAPACITY] {};
+	};
+}
@@ -0,0 +1,347 @@
+#include "resources/impl/ResourceLoader.h"
+
+#include <scapes/foundation/profiler/Profiler.h>
+
+#include <algorithm>
+#include <chrono>
+
+namespace scapes::foundation::resources::impl
+{
+	/*
+	 */
+	ResourceLoader::ResourceLoader(resources::ResourceManager *resource_manager, io::FileSystem *file_system, uint32_t num_workers)
+		: resource_manager(resource_manager), file_system(file_system)
+	{
+		assert(resource_manager);
+		assert(file_system);
+		assert(num_workers > 0);
+
+		workers.reserve(num_workers);
+		for (uint32_t i = 0; i < num_workers; ++i)
+			workers.emplace_back(&ResourceLoader::workerLoop, this);
+	}
+
+	ResourceLoader::~ResourceLoader()
+	{
+		// in-flight reads write into loader buffers and call back into the loader
+		std::unique_lock<std::mutex> read_lock(mutex);
+
+		while (num_reads > 0)
+		{
+			read_lock.unlock();
+			file_system->waitReads();
+			read_lock.lock();
+		}
+
+		read_lock.unlock();
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			running = false;
+
+			for (Request &request : queued_tasks)
+				delete[] request.read_data;
+
+			queued_tasks.clear();
+		}
+
+		task_added.notify_all();
+
+		for (std::thread &worker : workers)
+			worker.join();
+
+		workers.clear();
+
+		for (Result &result : finished_tasks)
+			release(result);
+
+		finished_tasks.clear();
+	}
+
+	/*
+	 */
+	void ResourceLoader::submit(const AsyncLoadTask &task)
+	{
+		assert(task.memory);
+		assert(task.commit);
+
+		// file systems without async reads are mapped on the worker
+		if (!task.data && submitRead(task))
+			return;
+
+		Request request;
+		request.task = task;
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			queued_tasks.push_back(request);
+		}
+
+		task_added.notify_one();
+	}
+
+	bool ResourceLoader::wait(void *memory, Result &result)
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+
+		// read callbacks queue the task, they may run on another thread that fetches reads too
+		while (reading_tasks.find(memory) != reading_tasks.end())
+		{
+			lock.unlock();
+
+			file_system->waitReads();
+			std::this_thread::yield();
+
+			lock.lock();
+		}
+
+		// not picked by workers yet, do the work on the calling thread
+		auto queued_it = std::find_if(queued_tasks.begin(), queued_tasks.end(), [memory](const Request &request) { return request.task.memory == memory; });
+		if (queued_it != queued_tasks.end())
+		{
+			Request request = *queued_it;
+			queued_tasks.erase(queued_it);
+
+			lock.unlock();
+
+			process(request, result);
+			return true;
+		}
+
+		task_finished.wait(lock, [this, memory]() { return running_tasks.find(memory) == running_tasks.end(); });
+
+		auto finished_it = std::find_if(finished_tasks.begin(), finished_tasks.end(), [memory](const Result &result) { return result.task.memory == memory; });
+		if (finished_it == finished_tasks.end())
+			return false;
+
+		result = *finished_it;
+		finished_tasks.erase(finished_it);
+
+		return true;
+	}
+
+	void ResourceLoader::cancel(void *memory)
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+
+			// the read can't be stopped, its callback drops the data
+			auto it = reading_tasks.find(memory);
+			if (it != reading_tasks.end())
+			{
+				it->second->cancelled = true;
+				reading_tasks.erase(it);
+				return;
+			}
+		}
+
+		Result result;
+		if (wait(memory, result))
+			release(result);
+	}
+
+	void ResourceLoader::fetchResults(std::vector<Result> &results)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+
+		results.insert(results.end(), finished_tasks.begin(), finished_tasks.end());
+		finished_tasks.clear();
+	}
+
+	bool ResourceLoader::hasPendingTasks() const
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+
+		return !reading_tasks.empty() || !queued_tasks.empty() || !running_tasks.empty() || !finished_tasks.empty();
+	}
+
+	void ResourceLoader::release(Result &result)
+	{
+		if (result.mapped_data)
+			file_system->unmap(result.mapped_data);
+
+		delete[] result.read_data;
+
+		result.mapped_data = nullptr;
+		result.mapped_size = 0;
+		result.read_data = nullptr;
+	}
+
+	/*
+	 */
+	bool ResourceLoader::submitRead(const AsyncLoadTask &task)
+	{
+		io::Stream *stream = file_system->open(task.uri, "rb");
+		if (!stream)
+			return false;
+
+		uint64_t size = stream->size();
+		file_system->close(stream);
+
+		if (size == 0)
+			return false;
+
+		PendingRead *read = new PendingRead();
+		read->loader = this;
+		read->request.task = task;
+		read->request.read_data = new uint8_t[size];
+		read->start_time = std::chrono::steady_clock::now();
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+
+			reading_tasks.insert({task.memory, read});
+			num_reads++;
+		}
+
+		if (file_system->readAsync(task.uri, 0, static_cast<size_t>(size), read->request.read_data, &ResourceLoader::onReadFinished, read))
+			return true;
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+
+			reading_tasks.erase(task.memory);
+			num_reads--;
+		}
+
+		delete[] read->request.read_data;
+		delete read;
+
+		return false;
+	}
+
+	void ResourceLoader::onReadFinished(void *, size_t size, bool success, void *user_data)
+	{
+		using Milliseconds = std::chrono::duration<float, std::milli>;
+
+		PendingRead *read = reinterpret_cast<PendingRead *>(user_data);
+		assert(read);
+
+		ResourceLoader *loader = read->loader;
+		assert(loader);
+
+		Request request = read->request;
+		request.task.data = request.read_data;
+		request.task.size = size;
+		request.io_time = Milliseconds(std::chrono::steady_clock::now() - read->start_time).count();
+
+		bool cancelled = false;
+
+		{
+			std::lock_guard<std::mutex> lock(loader->mutex);
+
+			cancelled = read->cancelled;
+			loader->num_reads--;
+
+			if (!cancelled)
+				loader->reading_tasks.erase(request.task.memory);
+
+			if (!cancelled && success)
+				loader->queued_tasks.push_back(request);
+
+			if (!cancelled && !success)
+			{
+				Log::error("ResourceLoader::onReadFinished(): can't read \"%s\" file\n", request.task.uri.c_str());
+
+				Result result;
+				result.task = request.task;
+				result.io_time = request.io_time;
+				result.read_data = request.read_data;
+
+				loader->finished_tasks.push_back(result);
+			}
+		}
+
+		delete read;
+
+		if (cancelled)
+			delete[] request.read_data;
+
+		if (!cancelled && success)
+			loader->task_added.notify_one();
+	}
+
+	/*
+	 */
+	void ResourceLoader::workerLoop()
+	{
+		while (true)
+		{
+			Request request;
+
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				task_added.wait(lock, [this]() { return !running || !queued_tasks.empty(); });
+
+				if (!running)
+					return;
+
+				request = queued_tasks.front();
+				queued_tasks.pop_front();
+
+				running_tasks.insert(request.task.memory);
+			}
+
+			Result result;
+			process(request, result);
+
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+
+				running_tasks.erase(request.task.memory);
+				finished_tasks.push_back(result);
+			}
+
+			task_finished.notify_all();
+		}
+	}
+
+	void ResourceLoader::process(const Request &request, Result &result)
+	{
+		SCAPES_PROFILER();
+
+		const AsyncLoadTask &task = request.task;
+
+		result = {};
+		result.task = task;
+		result.read_data = request.read_data;
+		result.io_time = request.io_time;
+
+		using Clock = std::chrono::steady_clock;
+		using Milliseconds = std::chrono::duration<float, std::milli>;
+
+		const uint8_t *data = task.data;
+		size_t size = task.size;
+
+		auto io_start = Clock::now();
+
+		if (!data)
+		{
+			result.mapped_data = file_system->map(task.uri, result.mapped_size);
+			if (!result.mapped_data)
+			{
+				Log::error("ResourceLoader::process(): can't open \"%s\" file\n", task.uri.c_str());
+				return;
+			}
+
+			data = reinterpret_cast<const uint8_t *>(result.mapped_data);
+			size = result.mapped_size;
+		}
+
+		auto decode_start = Clock::now();
+		result.io_time += Milliseconds(decode_start - io_start).count();
+
+		if (!task.decode)
+		{
+			// keep source data around, loading is done on commit
+			result.success = true;
+			return;
+		}
+
+		uint8_t *resource_ptr = reinterpret_cast<uint8_t *>(task.memory) + task.offset;
+		result.success = task.decode(resource_manager, resource_ptr, data, size);
+		result.decode_time = Milliseconds(Clock::now() - decode_start).count();
+
+		release(result);
+	}
+}
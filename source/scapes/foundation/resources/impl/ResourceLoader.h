@@ -0,0 +1,92 @@
+#pragma once
+
+#include <scapes/foundation/resources/ResourceManager.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace scapes::foundation::resources::impl
+{
+	class ResourceLoader
+	{
+	public:
+		struct Result
+		{
+			AsyncLoadTask task;
+			bool success {false};
+
+			// mapped file data, only kept for tasks without decode step
+			void *mapped_data {nullptr};
+			size_t mapped_size {0};
+
+			// file data read with io::FileSystem::readAsync(), task data points to it
+			uint8_t *read_data {nullptr};
+
+			// milliseconds spent on the worker
+			float io_time {0.0f};
+			float decode_time {0.0f};
+		};
+
+	public:
+		ResourceLoader(resources::ResourceManager *resource_manager, io::FileSystem *file_system, uint32_t num_workers);
+		~ResourceLoader();
+
+		void submit(const AsyncLoadTask &task);
+		bool wait(void *memory, Result &result);
+		void cancel(void *memory);
+
+		void fetchResults(std::vector<Result> &results);
+		bool hasPendingTasks() const;
+
+		void release(Result &result);
+
+	private:
+		struct Request
+		{
+			AsyncLoadTask task;
+			uint8_t *read_data {nullptr};
+			float io_time {0.0f};
+		};
+
+		struct PendingRead
+		{
+			ResourceLoader *loader {nullptr};
+			Request request;
+			std::chrono::steady_clock::time_point start_time;
+			bool cancelled {false};
+		};
+
+		bool submitRead(const AsyncLoadTask &task);
+		static void onReadFinished(void *data, size_t size, bool success, void *user_data);
+
+		void workerLoop();
+		void process(const Request &request, Result &result);
+
+	private:
+		resources::ResourceManager *resource_manager {nullptr};
+		io::FileSystem *file_system {nullptr};
+
+		std::vector<std::thread> workers;
+
+		mutable std::mutex mutex;
+		std::condition_variable task_added;
+		std::condition_variable task_finished;
+
+		std::deque<Request> queued_tasks;
+		std::unordered_set<void *> running_tasks;
+		std::vector<Result> finished_tasks;
+
+		// files are read without blocking workers, so decoding overlaps with I/O of the next tasks;
+		// cancelled reads are removed from the map but stay counted until their callback is called
+		std::unordered_map<void *, PendingRead *> reading_tasks;
+		uint32_t num_reads {0};
+
+		bool running {true};
+	};
+}
@@ -3,45 +3,114 @@
 
 #include <scapes/foundation/profiler/Profiler.h>
 
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <thread>
+
 namespace scapes::foundation::resources::impl
 {
+	/*
+	 */
+	static bool tryAddReference(ResourceMetadata *metadata)
+	{
+		// referenced resources are never evicted or destroyed by the manager, so no locks are needed
+		uint32_t count = metadata->ref_count.load(std::memory_order_relaxed);
+		while (count > 0)
+			if (metadata->ref_count.compare_exchange_weak(count, count + 1, std::memory_order_acq_rel))
+				return true;
+
+		return false;
+	}
+
+	static bool tryRemoveReference(ResourceMetadata *metadata)
+	{
+		// the last reference goes through the slow path, it may cache or destroy the resource
+		uint32_t count = metadata->ref_count.load(std::memory_order_relaxed);
+		while (count > 1)
+			if (metadata->ref_count.compare_exchange_weak(count, count - 1, std::memory_order_acq_rel))
+				return true;
+
+		return false;
+	}
+
+	static void bumpGeneration(std::atomic<generation_t> &generation)
+	{
+		// writers are serialized by the type shard lock, readers only compare
+		generation.store(generation.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+	}
+
 	/*
 	 */
 	ResourceManager::ResourceManager(io::FileSystem *file_system)
-		: file_system(file_system)
+		: file_system(file_system), owner_thread(std::this_thread::get_id()), start_time(std::chrono::steady_clock::now())
 	{
+		uint32_t num_workers = std::max<uint32_t>(1, std::thread::hardware_concurrency() / 2);
+		loader = new ResourceLoader(this, file_system, num_workers);
 
+		// fall back to mtime polling if the file system can't notify about changes
+		watching_files = file_system->watch(io::URI());
 	}
 
 	ResourceManager::~ResourceManager()
 	{
-		for (auto it : pools)
+		if (watching_files)
+			file_system->unwatch(io::URI());
+
+		delete loader;
+		loader = nullptr;
+
+		load_callbacks.clear();
+
+		destroying = true;
+
+		// destroy everything before freeing any pool, so releases from destructors still see valid metadata
+		for (uint32_t i = 0; i < MAX_TYPES; ++i)
 		{
-			auto vtable_it = vtables.find(it.first);
-			assert(vtable_it != vtables.end());
+			TypeShard *shard = shards[i].load();
+			if (!shard)
+				continue;
 
-			ResourceVTable *vtable = vtable_it->second;
-			assert(vtable);
+			const ResourceVTable &vtable = shard->vtable;
 
-			it.second->traverse(
-				[this, vtable](void *memory)
+			shard->pool->traverse(
+				[this, &vtable](void *memory)
 				{
-					uint8_t *resource_ptr = reinterpret_cast<uint8_t *>(memory) + vtable->offset;
-					vtable->destroy(this, resource_ptr);
+					uint8_t *resource_ptr = reinterpret_cast<uint8_t *>(memory) + vtable.offset;
+					vtable.destroy(this, resource_ptr);
 				}
 			);
-			it.second->clear();
-			delete it.second;
 		}
 
-		for (auto it : vtables)
-			delete it.second;
+		for (uint32_t i = 0; i < MAX_TYPES; ++i)
+		{
+			TypeShard *shard = shards[i].load();
+			if (!shard)
+				continue;
+
+			shard->pool->clear();
+			delete shard->pool;
 
-		pools.clear();
-		vtables.clear();
+			for (uint32_t i = 0; i < ResourceTable::MAX_PAGES; ++i)
+				delete[] shard->table.pages[i].load();
+
+			delete shard;
+			shards[i] = nullptr;
+		}
+
+		releaseRetiredPages(true);
 
 		uri_by_resource.clear();
 		resources_by_uri.clear();
+		loading_uris.clear();
+
+		evictable_resources.clear();
+		evictable_by_resource.clear();
+		memory_usage_by_type.clear();
+
+		async_start_times.clear();
+		load_timeline.clear();
+		pending_destroys.clear();
 	}
 
 	/*
@@ -50,51 +119,325 @@ namespace scapes::foundation::resources::impl
 	{
 		SCAPES_PROFILER();
 
-		// TODO: memory limit management
+		assert(std::this_thread::get_id() == owner_thread);
+
+		// resources destroyed by other threads since the last update
+		processPendingDestroys();
+
+		// async reads issued through the file system
+		file_system->fetchReads();
+
+		// async loads
+		loader->fetchResults(async_results);
+
+		for (ResourceLoader::Result &result : async_results)
+			commitAsync(result);
+
+		async_results.clear();
+
+		evictResources();
+		releaseRetiredPages(false);
 
 		// live reload
-		const uint32_t bucket = frame % max_check_frames;
+		if (watching_files)
+			processFileChanges();
+		else
+			pollFileChanges();
+
+		frame++;
+	}
+
+	void ResourceManager::waitPending()
+	{
+		SCAPES_PROFILER();
 
-		for (auto it : pools)
+		assert(std::this_thread::get_id() == owner_thread);
+
+		while (loader->hasPendingTasks())
 		{
-			auto vtable_it = vtables.find(it.first);
-			assert(vtable_it != vtables.end());
+			// loads wait for their file reads first
+			file_system->fetchReads();
+			loader->fetchResults(async_results);
 
-			ResourceVTable *vtable = vtable_it->second;
-			assert(vtable);
+			for (ResourceLoader::Result &result : async_results)
+				commitAsync(result);
 
-			int counter = 0;
+			async_results.clear();
 
-			it.second->traverse(
-				[this, vtable, bucket, &counter](void *memory)
-				{
-					uint64_t memory_hash = 0;
-					common::HashUtils::combine(memory_hash, memory);
+			std::this_thread::yield();
+		}
+	}
 
-					auto it = uri_by_resource.find(memory_hash);
-					if (it == uri_by_resource.end())
-						return;
+	void ResourceManager::processPendingDestroys()
+	{
+		std::vector<void *> destroys;
 
-					if (bucket != (counter++ % max_check_frames))
-						return;
+		{
+			std::lock_guard<std::mutex> lock(destroy_mutex);
+			destroys.swap(pending_destroys);
+		}
 
-					const io::URI &uri = it->second;
+		for (void *memory : destroys)
+			destroyResource(memory);
+	}
 
-					uint8_t *resource_ptr = reinterpret_cast<uint8_t *>(memory) + vtable->offset;
+	/*
+	 */
+	void ResourceManager::processFileChanges()
+	{
+		SCAPES_PROFILER();
 
-					hash_t resource_hash = ResourceManager::getHash(memory);
-					hash_t file_hash = vtable->fetchHash(this, file_system, resource_ptr, uri);
+		changed_uris.clear();
+		file_system->fetchChanges(&ResourceManager::onFileChanged, this);
+
+		if (changed_uris.empty())
+			return;
+
+		// reloads may link new resources, so iterate over a copy
+		std::vector<std::pair<io::URI, ResourceEntry>> changed_resources;
+
+		{
+			std::lock_guard<std::mutex> lock(uri_mutex);
 
-					if (file_hash == resource_hash)
-						return;
+			bool has_unknown_changes = false;
 
-					vtable->reload(this, file_system, resource_ptr, uri);
-					ResourceManager::setHash(memory, file_hash);
+			for (const io::URI &uri : changed_uris)
+			{
+				auto it = resources_by_uri.find(uri);
+				if (it == resources_by_uri.end())
+				{
+					has_unknown_changes = true;
+					break;
 				}
-			);
+
+				for (const ResourceEntry &entry : it->second)
+					changed_resources.push_back({uri, entry});
+			}
+
+			// changed file may be a dependency (i.e. shader include), so check all linked resources once
+			if (has_unknown_changes)
+			{
+				changed_resources.clear();
+
+				for (const auto &it : resources_by_uri)
+					for (const ResourceEntry &entry : it.second)
+						changed_resources.push_back({it.first, entry});
+			}
 		}
 
-		frame++;
+		for (const auto &[uri, entry] : changed_resources)
+			reloadIfChanged(entry.memory, entry.vtable, uri);
+	}
+
+	void ResourceManager::pollFileChanges()
+	{
+		SCAPES_PROFILER();
+
+		const uint32_t bucket = frame % max_check_frames;
+
+		std::vector<std::pair<io::URI, ResourceEntry>> bucket_resources;
+
+		{
+			std::lock_guard<std::mutex> lock(uri_mutex);
+
+			uint32_t counter = 0;
+
+			for (const auto &it : resources_by_uri)
+				for (const ResourceEntry &entry : it.second)
+					if (bucket == (counter++ % max_check_frames))
+						bucket_resources.push_back({it.first, entry});
+		}
+
+		for (const auto &[uri, entry] : bucket_resources)
+			reloadIfChanged(entry.memory, entry.vtable, uri);
+	}
+
+	void ResourceManager::reloadIfChanged(void *memory, const ResourceVTable *vtable, const io::URI &uri)
+	{
+		assert(memory);
+		assert(vtable);
+
+		if (ResourceManager::getState(memory) != ResourceState::READY)
+			return;
+
+		uint8_t *resource_ptr = reinterpret_cast<uint8_t *>(memory) + vtable->offset;
+
+		hash_t resource_hash = ResourceManager::getHash(memory);
+		hash_t file_hash = vtable->fetchHash(this, file_system, resource_ptr, uri);
+
+		if (file_hash == resource_hash)
+			return;
+
+		ResourceLoadEvent event;
+		event.start_time = getTime();
+		event.reload = true;
+
+		event.success = vtable->reload(this, file_system, resource_ptr, uri);
+		ResourceManager::setHash(memory, file_hash);
+
+		trackMemory(memory);
+
+		event.decode_time = getTime() - event.start_time;
+		trackLoad(memory, uri, event);
+	}
+
+	void ResourceManager::onFileChanged(const io::URI &uri, void *user_data)
+	{
+		ResourceManager *resource_manager = reinterpret_cast<ResourceManager *>(user_data);
+		assert(resource_manager);
+
+		resource_manager->changed_uris.push_back(uri);
+	}
+
+	/*
+	 */
+	void ResourceManager::submitAsync(const AsyncLoadTask &task)
+	{
+		uint64_t memory_hash = 0;
+		common::HashUtils::combine(memory_hash, task.memory);
+
+		{
+			std::lock_guard<std::mutex> lock(async_mutex);
+			async_start_times[memory_hash] = getTime();
+		}
+
+		loader->submit(task);
+	}
+
+	void ResourceManager::waitMemory(void *memory)
+	{
+		SCAPES_PROFILER();
+
+		ResourceLoader::Result result;
+		if (loader->wait(memory, result))
+		{
+			commitAsync(result);
+			return;
+		}
+
+		// result was already fetched by update(), the owner thread may be waiting from a load callback
+		if (std::this_thread::get_id() == owner_thread)
+			return;
+
+		while (ResourceManager::getState(memory) == ResourceState::PENDING)
+			std::this_thread::yield();
+	}
+
+	void ResourceManager::cancelMemory(void *memory)
+	{
+		loader->cancel(memory);
+
+		uint64_t memory_hash = 0;
+		common::HashUtils::combine(memory_hash, memory);
+
+		std::lock_guard<std::mutex> lock(async_mutex);
+
+		load_callbacks.erase(memory_hash);
+		async_start_times.erase(memory_hash);
+	}
+
+	void ResourceManager::addMemoryLoadCallback(void *memory, std::function<void (void *, bool)> callback)
+	{
+		assert(memory);
+
+		uint64_t memory_hash = 0;
+		common::HashUtils::combine(memory_hash, memory);
+
+		// commit changes the state under the same lock, so the callback can't be missed
+		std::unique_lock<std::mutex> lock(async_mutex);
+
+		ResourceState state = ResourceManager::getState(memory);
+		if (state != ResourceState::PENDING)
+		{
+			lock.unlock();
+
+			callback(memory, state == ResourceState::READY);
+			return;
+		}
+
+		load_callbacks[memory_hash].push_back(callback);
+	}
+
+	void ResourceManager::commitAsync(ResourceLoader::Result &result)
+	{
+		SCAPES_PROFILER();
+
+		void *memory = result.task.memory;
+		assert(memory);
+
+		uint64_t memory_hash = 0;
+		common::HashUtils::combine(memory_hash, memory);
+
+		ResourceLoadEvent event;
+		event.async = true;
+		event.io_time = result.io_time;
+		event.decode_time = result.decode_time;
+
+		float commit_start_time = getTime();
+		event.start_time = commit_start_time;
+
+		{
+			std::lock_guard<std::mutex> lock(async_mutex);
+
+			auto start_it = async_start_times.find(memory_hash);
+			if (start_it != async_start_times.end())
+			{
+				event.start_time = start_it->second;
+				async_start_times.erase(start_it);
+			}
+		}
+
+		uint8_t *resource_ptr = reinterpret_cast<uint8_t *>(memory) + result.task.offset;
+
+		const uint8_t *data = result.task.data;
+		size_t size = result.task.size;
+
+		if (result.mapped_data)
+		{
+			data = reinterpret_cast<const uint8_t *>(result.mapped_data);
+			size = result.mapped_size;
+		}
+
+		bool success = result.success && result.task.commit(this, resource_ptr, data, size);
+		loader->release(result);
+
+		if (success && !result.task.uri.empty())
+		{
+			TypeShard *shard = getShard(ResourceManager::getTypeID(memory));
+			assert(shard);
+
+			hash_t hash = shard->vtable.fetchHash(this, file_system, resource_ptr, result.task.uri);
+			ResourceManager::setHash(memory, hash);
+		}
+
+		if (success)
+			trackMemory(memory);
+
+		std::vector<std::function<void (void *, bool)>> callbacks;
+
+		{
+			std::lock_guard<std::mutex> lock(async_mutex);
+
+			ResourceManager::setState(memory, (success) ? ResourceState::READY : ResourceState::FAILED);
+
+			auto it = load_callbacks.find(memory_hash);
+			if (it != load_callbacks.end())
+			{
+				callbacks = std::move(it->second);
+				load_callbacks.erase(it);
+			}
+		}
+
+		float commit_end_time = getTime();
+
+		event.commit_time = commit_end_time - commit_start_time;
+		event.total_time = commit_end_time - event.start_time;
+		event.success = success;
+
+		trackLoad(memory, result.task.uri, event);
+
+		for (auto &callback : callbacks)
+			callback(memory, success);
 	}
 
 	/*
@@ -104,9 +447,14 @@ namespace scapes::foundation::resources::impl
 		if (memory == nullptr)
 			return false;
 
+		TypeShard *shard = getShard(ResourceManager::getTypeID(memory));
+		assert(shard);
+
 		uint64_t memory_hash = 0;
 		common::HashUtils::combine(memory_hash, memory);
 
+		std::lock_guard<std::mutex> lock(uri_mutex);
+
 		auto it = uri_by_resource.find(memory_hash);
 		if (it != uri_by_resource.end())
 		{
@@ -114,14 +462,12 @@ namespace scapes::foundation::resources::impl
 			if (uri == current_uri)
 				return false;
 
-			unlinkMemory(memory);
+			unlinkMemoryLocked(memory);
 		}
 
-		const char *type_name = ResourceManager::getTypeName(memory);
-
 		ResourceEntry entry = {};
 		entry.memory = memory;
-		entry.vtable = getVTable(type_name);
+		entry.vtable = &shard->vtable;
 
 		assert(entry.memory);
 		assert(entry.vtable);
@@ -129,6 +475,9 @@ namespace scapes::foundation::resources::impl
 		resources_by_uri[uri].push_back(entry);
 		uri_by_resource[memory_hash] = uri;
 
+		ResourceMetadata *metadata = reinterpret_cast<ResourceMetadata *>(memory);
+		metadata->linked = true;
+
 		return true;
 	}
 
@@ -137,11 +486,19 @@ namespace scapes::foundation::resources::impl
 		if (memory == nullptr)
 			return false;
 
+		if (!isLinked(memory))
+			return false;
+
+		std::lock_guard<std::mutex> lock(uri_mutex);
+		return unlinkMemoryLocked(memory);
+	}
+
+	bool ResourceManager::unlinkMemoryLocked(void *memory)
+	{
 		uint64_t memory_hash = 0;
 		common::HashUtils::combine(memory_hash, memory);
 
 		auto uri_it = uri_by_resource.find(memory_hash);
-
 		if (uri_it == uri_by_resource.end())
 			return false;
 
@@ -166,11 +523,33 @@ namespace scapes::foundation::resources::impl
 
 		uri_by_resource.erase(memory_hash);
 
+		ResourceMetadata *metadata = reinterpret_cast<ResourceMetadata *>(memory);
+		metadata->linked = false;
+
 		return true;
 	}
 
+	bool ResourceManager::isLinked(void *memory) const
+	{
+		// only changes under uri_mutex, unlinking on eviction also holds memory_mutex
+		const ResourceMetadata *metadata = reinterpret_cast<const ResourceMetadata *>(memory);
+		assert(metadata);
+
+		return metadata->linked.load(std::memory_order_acquire);
+	}
+
+	bool ResourceManager::isRelocating(void *memory) const
+	{
+		TypeShard *shard = getShard(ResourceManager::getTypeID(memory));
+		assert(shard);
+
+		return shard->table.relocating.load(std::memory_order_acquire);
+	}
+
 	void *ResourceManager::getLinkedMemory(const io::URI &uri) const
 	{
+		std::lock_guard<std::mutex> lock(uri_mutex);
+
 		auto it = resources_by_uri.find(uri);
 		if (it == resources_by_uri.end())
 			return nullptr;
@@ -178,11 +557,74 @@ namespace scapes::foundation::resources::impl
 		return it->second.front().memory;
 	}
 
+	void *ResourceManager::retainLinkedMemory(const io::URI &uri)
+	{
+		{
+			std::lock_guard<std::mutex> lock(uri_mutex);
+
+			auto it = resources_by_uri.find(uri);
+			if (it == resources_by_uri.end())
+				return nullptr;
+
+			void *memory = it->second.front().memory;
+			if (tryAddReference(reinterpret_cast<ResourceMetadata *>(memory)))
+				return memory;
+		}
+
+		// cached resource, must not be evicted between the lookup and the retain
+		std::lock_guard<std::mutex> memory_lock(memory_mutex);
+		std::lock_guard<std::mutex> lock(uri_mutex);
+
+		auto it = resources_by_uri.find(uri);
+		if (it == resources_by_uri.end())
+			return nullptr;
+
+		void *memory = it->second.front().memory;
+		retainMemoryLocked(memory);
+
+		return memory;
+	}
+
+	void *ResourceManager::reserveLinkedMemory(const io::URI &uri)
+	{
+		while (true)
+		{
+			if (void *memory = retainLinkedMemory(uri); memory)
+				return memory;
+
+			std::unique_lock<std::mutex> lock(uri_mutex);
+
+			// linked by another thread since the lookup
+			if (resources_by_uri.find(uri) != resources_by_uri.end())
+				continue;
+
+			if (loading_uris.insert(uri).second)
+				return nullptr;
+
+			// the load may fail, in which case the next waiter tries on its own
+			linked_loads_finished.wait(lock, [this, &uri]() { return loading_uris.find(uri) == loading_uris.end(); });
+		}
+	}
+
+	void ResourceManager::finishLinkedLoad(const io::URI &uri)
+	{
+		{
+			std::lock_guard<std::mutex> lock(uri_mutex);
+
+			[[maybe_unused]] size_t num_erased = loading_uris.erase(uri);
+			assert(num_erased == 1);
+		}
+
+		linked_loads_finished.notify_all();
+	}
+
 	io::URI ResourceManager::getLinkedUri(void *memory) const
 	{
 		uint64_t memory_hash = 0;
 		common::HashUtils::combine(memory_hash, memory);
 
+		std::lock_guard<std::mutex> lock(uri_mutex);
+
 		auto it = uri_by_resource.find(memory_hash);
 		if (it == uri_by_resource.end())
 			return nullptr;
@@ -192,86 +634,709 @@ namespace scapes::foundation::resources::impl
 
 	/*
 	 */
-	void *ResourceManager::allocate(const char *type_name, size_t type_size)
+	void *ResourceManager::allocate(type_id_t type_id, const char *type_name, size_t type_size, const ResourceVTable &vtable)
+	{
+		TypeShard *shard = fetchShard(type_id, type_name, type_size, vtable);
+		assert(shard);
+		assert(!shard->table.relocating.load(std::memory_order_relaxed));
+
+		{
+			std::lock_guard<std::mutex> lock(memory_mutex);
+
+			memory_usage.num_resources++;
+			fetchTypeMemoryUsage(type_id).num_resources++;
+		}
+
+		std::lock_guard<std::mutex> lock(shard->mutex);
+
+		void *memory = shard->pool->allocate();
+		assert(memory);
+
+		ResourceTable &table = shard->table;
+
+		uint32_t index = table.free_head;
+		if (index == ResourceTable::INVALID_INDEX)
+		{
+			index = table.num_slots.load(std::memory_order_relaxed);
+
+			uint32_t page = index / ResourceTable::SLOTS_IN_PAGE;
+			assert(page < ResourceTable::MAX_PAGES);
+
+			if (!table.pages[page].load(std::memory_order_relaxed))
+				table.pages[page].store(new ResourceTable::Slot[ResourceTable::SLOTS_IN_PAGE], std::memory_order_release);
+
+			table.num_slots.store(index + 1, std::memory_order_release);
+		}
+		else
+			table.free_head = table.getSlot(index).next_free;
+
+		ResourceTable::Slot &slot = table.getSlot(index);
+		slot.memory.store(memory, std::memory_order_release);
+		slot.next_free = ResourceTable::INVALID_INDEX;
+
+		ResourceMetadata *metadata = reinterpret_cast<ResourceMetadata *>(memory);
+		metadata->index = index;
+
+		return memory;
+	}
+
+	void ResourceManager::destroyMemory(void *memory)
+	{
+		assert(memory);
+		assert(!isRelocating(memory));
+
+		if (std::this_thread::get_id() == owner_thread)
+		{
+			destroyResource(memory);
+			return;
+		}
+
+		// destroy callbacks may touch GPU and pending loads are committed on the owner thread,
+		// so only invalidate the resource here and leave the rest to the next update()
+		ResourceMetadata *metadata = reinterpret_cast<ResourceMetadata *>(memory);
+		assert(metadata);
+
+		TypeShard *shard = getShard(metadata->type_id);
+		assert(shard);
+
+		unlinkMemory(memory);
+
+		{
+			std::lock_guard<std::mutex> lock(memory_mutex);
+			removeEvictableLocked(memory);
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(shard->mutex);
+
+			bumpGeneration(metadata->generation);
+			bumpGeneration(shard->table.getSlot(metadata->index).generation);
+		}
+
+		std::lock_guard<std::mutex> lock(destroy_mutex);
+		pending_destroys.push_back(memory);
+	}
+
+	void ResourceManager::destroyResource(void *memory)
 	{
-		ResourcePool *pool = fetchPool(type_name, type_size);
-		assert(pool);
+		ResourceMetadata *metadata = reinterpret_cast<ResourceMetadata *>(memory);
+		assert(metadata);
+
+		TypeShard *shard = getShard(metadata->type_id);
+		assert(shard);
+
+		if (metadata->state == ResourceState::PENDING)
+			cancelMemory(memory);
+
+		const ResourceVTable &vtable = shard->vtable;
+		vtable.destroy(this, reinterpret_cast<uint8_t *>(memory) + vtable.offset);
 
-		return pool->allocate();
+		deallocate(memory);
 	}
 
-	void ResourceManager::deallocate(void *memory, const char *type_name)
+	void ResourceManager::deallocate(void *memory)
 	{
-		ResourcePool *pool = getPool(type_name);
-		assert(pool);
+		ResourceMetadata *metadata = reinterpret_cast<ResourceMetadata *>(memory);
+		assert(metadata);
+
+		TypeShard *shard = getShard(metadata->type_id);
+		assert(shard);
 
-		pool->deallocate(memory);
 		unlinkMemory(memory);
+
+		{
+			std::lock_guard<std::mutex> lock(memory_mutex);
+
+			MemoryUsage &type_usage = fetchTypeMemoryUsage(metadata->type_id);
+
+			type_usage.cpu_bytes -= metadata->cpu_memory;
+			type_usage.gpu_bytes -= metadata->gpu_memory;
+			type_usage.num_resources--;
+
+			memory_usage.cpu_bytes -= metadata->cpu_memory;
+			memory_usage.gpu_bytes -= metadata->gpu_memory;
+			memory_usage.num_resources--;
+
+			removeEvictableLocked(memory);
+
+			metadata->ref_count.store(0, std::memory_order_relaxed);
+			metadata->cpu_memory = 0;
+			metadata->gpu_memory = 0;
+		}
+
+		std::lock_guard<std::mutex> lock(shard->mutex);
+
+		ResourceTable &table = shard->table;
+		assert(metadata->index < table.num_slots.load(std::memory_order_relaxed));
+
+		ResourceTable::Slot &slot = table.getSlot(metadata->index);
+		assert(slot.memory.load(std::memory_order_relaxed) == memory);
+
+		// bump generation first, lock-free lookups check it after reading memory
+		bumpGeneration(slot.generation);
+		slot.memory.store(nullptr, std::memory_order_release);
+		slot.next_free = table.free_head;
+		table.free_head = metadata->index;
+
+		// invalidate outstanding handles right away
+		bumpGeneration(metadata->generation);
+
+		shard->pool->deallocate(memory);
 	}
 
 	/*
 	 */
-	ResourceManager::ResourceVTable *ResourceManager::fetchVTable(const char *type_name)
+	const ResourceTable *ResourceManager::getTable(type_id_t type_id) const
 	{
-		ResourceVTable *result = nullptr;
+		TypeShard *shard = getShard(type_id);
+		if (!shard)
+			return nullptr;
+
+		return &shard->table;
+	}
+
+	size_t ResourceManager::compactMemory(type_id_t type_id)
+	{
+		SCAPES_PROFILER();
+
+		assert(std::this_thread::get_id() == owner_thread);
+
+		TypeShard *shard = getShard(type_id);
+		if (!shard)
+			return 0;
+
+		// workers and callbacks hold raw pointers to pending resources
+		if (loader->hasPendingTasks())
+			return 0;
+
+		processPendingDestroys();
+
+		std::lock_guard<std::mutex> memory_lock(memory_mutex);
+		std::lock_guard<std::mutex> uri_lock(uri_mutex);
+		std::lock_guard<std::mutex> shard_lock(shard->mutex);
+
+		// lock-free lookups don't take any of the locks above, catch callers that break the compact<T>() contract
+		shard->table.relocating.store(true, std::memory_order_release);
+
+		size_t num_moved = shard->pool->compact(
+			[this, shard](void *src_memory, void *dst_memory)
+			{
+				relocateMemory(shard, src_memory, dst_memory);
+			},
+			empty_pages
+		);
+
+		shard->table.relocating.store(false, std::memory_order_release);
+
+		for (void *page : empty_pages)
+			retired_pages.push_back({page, frame});
+
+		empty_pages.clear();
+
+		return num_moved;
+	}
+
+	void ResourceManager::relocateMemory(TypeShard *shard, void *src_memory, void *dst_memory)
+	{
+		ResourceMetadata *src_metadata = reinterpret_cast<ResourceMetadata *>(src_memory);
+		ResourceMetadata *dst_metadata = reinterpret_cast<ResourceMetadata *>(dst_memory);
+
+		// destination may still be checked by stale handles to the resource destroyed there,
+		// so the moved resource gets a generation newer than both
+		generation_t src_generation = src_metadata->generation.load(std::memory_order_relaxed);
+		generation_t dst_generation = dst_metadata->generation.load(std::memory_order_relaxed);
+
+		// metadata has atomics and is moved field by field, resources themselves are relocated bitwise
+		dst_metadata->hash.store(src_metadata->hash.load(std::memory_order_relaxed), std::memory_order_relaxed);
+		dst_metadata->type_id = src_metadata->type_id;
+		dst_metadata->type_name = src_metadata->type_name;
+		dst_metadata->state.store(src_metadata->state.load(std::memory_order_relaxed), std::memory_order_relaxed);
+		dst_metadata->linked.store(src_metadata->linked.load(std::memory_order_relaxed), std::memory_order_relaxed);
+		dst_metadata->ref_count.store(src_metadata->ref_count.load(std::memory_order_relaxed), std::memory_order_relaxed);
+		dst_metadata->cpu_memory = src_metadata->cpu_memory;
+		dst_metadata->gpu_memory = src_metadata->gpu_memory;
+		dst_metadata->index = src_metadata->index;
+
+		size_t offset = shard->vtable.offset;
+		memcpy(reinterpret_cast<uint8_t *>(dst_memory) + offset, reinterpret_cast<const uint8_t *>(src_memory) + offset, shard->pool->getElementSize() - offset);
+
+		// publishes everything above to handles that pass the generation check
+		dst_metadata->generation.store(std::max(src_generation, dst_generation) + 1, std::memory_order_release);
+
+		// stale pointer handles to the old location must not resolve, its page is retired rather than freed
+		src_metadata->generation.store(src_generation + 1, std::memory_order_release);
+
+		ResourceTable &table = shard->table;
+		assert(dst_metadata->index < table.num_slots.load(std::memory_order_relaxed));
+
+		ResourceTable::Slot &slot = table.getSlot(dst_metadata->index);
+		assert(slot.memory.load(std::memory_order_relaxed) == src_memory);
+
+		slot.memory.store(dst_memory, std::memory_order_release);
+
+		uint64_t src_hash = 0;
+		common::HashUtils::combine(src_hash, src_memory);
+
+		uint64_t dst_hash = 0;
+		common::HashUtils::combine(dst_hash, dst_memory);
 
-		uint64_t hash = 0;
-		common::HashUtils::combine(hash, std::string_view(type_name));
+		auto uri_it = uri_by_resource.find(src_hash);
+		if (uri_it != uri_by_resource.end())
+		{
+			io::URI uri = uri_it->second;
+
+			uri_by_resource.erase(uri_it);
+			uri_by_resource.insert({dst_hash, uri});
+
+			auto resources_it = resources_by_uri.find(uri);
+			assert(resources_it != resources_by_uri.end());
+
+			for (ResourceEntry &entry : resources_it->second)
+				if (entry.memory == src_memory)
+					entry.memory = dst_memory;
+		}
 
-		auto it = vtables.find(hash);
-		if (it == vtables.end())
+		auto evictable_it = evictable_by_resource.find(src_hash);
+		if (evictable_it != evictable_by_resource.end())
 		{
-			result = new ResourceVTable();
-			vtables.insert({hash, result});
+			std::list<void *>::iterator it = evictable_it->second;
+			*it = dst_memory;
+
+			evictable_by_resource.erase(evictable_it);
+			evictable_by_resource.insert({dst_hash, it});
 		}
-		else
-			result = it->second;
+	}
 
-		return result;
+	void ResourceManager::releaseRetiredPages(bool force)
+	{
+		// owner thread is the only one that compacts, and handles must not survive that many updates
+		auto it = std::remove_if(retired_pages.begin(), retired_pages.end(),
+			[this, force](const RetiredPage &page)
+			{
+				if (!force && frame - page.frame < RETIRED_PAGE_FRAMES)
+					return false;
+
+				ResourcePool::releasePage(page.memory);
+				return true;
+			}
+		);
+
+		retired_pages.erase(it, retired_pages.end());
 	}
 
-	ResourceManager::ResourceVTable *ResourceManager::getVTable(const char *type_name)
+	/*
+	 */
+	void ResourceManager::setMemoryBudget(size_t cpu_bytes, size_t gpu_bytes)
 	{
-		uint64_t hash = 0;
-		common::HashUtils::combine(hash, std::string_view(type_name));
+		std::lock_guard<std::mutex> lock(memory_mutex);
 
-		auto it = vtables.find(hash);
-		if (it == vtables.end())
-			return nullptr;
+		memory_usage.cpu_budget = cpu_bytes;
+		memory_usage.gpu_budget = gpu_bytes;
+	}
+
+	MemoryUsage ResourceManager::getMemoryUsage() const
+	{
+		std::lock_guard<std::mutex> lock(memory_mutex);
+		return memory_usage;
+	}
+
+	void ResourceManager::setTypeMemoryBudget(type_id_t type_id, size_t cpu_bytes, size_t gpu_bytes)
+	{
+		std::lock_guard<std::mutex> lock(memory_mutex);
+
+		MemoryUsage &usage = fetchTypeMemoryUsage(type_id);
+
+		usage.cpu_budget = cpu_bytes;
+		usage.gpu_budget = gpu_bytes;
+	}
+
+	MemoryUsage ResourceManager::getTypeMemoryUsage(type_id_t type_id) const
+	{
+		std::lock_guard<std::mutex> lock(memory_mutex);
+
+		auto it = memory_usage_by_type.find(type_id);
+		if (it == memory_usage_by_type.end())
+			return MemoryUsage();
 
 		return it->second;
 	}
 
+	MemoryUsage &ResourceManager::fetchTypeMemoryUsage(type_id_t type_id)
+	{
+		return memory_usage_by_type[type_id];
+	}
+
 	/*
 	 */
-	ResourcePool *ResourceManager::fetchPool(const char *type_name, size_t type_size)
+	void ResourceManager::trackLoad(void *memory, const io::URI &uri, ResourceLoadEvent &event)
 	{
-		ResourcePool *resource_pool = nullptr;
+		TypeShard *shard = getShard(ResourceManager::getTypeID(memory));
+		assert(shard);
 
-		uint64_t hash = 0;
-		common::HashUtils::combine(hash, std::string_view(type_name));
+		float work_time = event.io_time + event.decode_time + event.commit_time;
+
+		if (event.total_time == 0.0f)
+			event.total_time = work_time;
 
-		auto it = pools.find(hash);
-		if (it == pools.end())
 		{
-			resource_pool = new ResourcePool(type_size);
-			pools.insert({hash, resource_pool});
+			std::lock_guard<std::mutex> lock(shard->mutex);
+
+			ResourceTypeStats &stats = shard->stats;
+
+			if (event.reload)
+				stats.num_reloads++;
+			else
+				stats.num_loads++;
+
+			if (!event.success)
+				stats.num_failed_loads++;
+
+			stats.total_load_time += work_time;
+			stats.max_load_time = std::max(stats.max_load_time, work_time);
 		}
-		else
-			resource_pool = it->second;
 
-		return resource_pool;
+		event.type_name = ResourceManager::getTypeName(memory);
+		event.uri = uri.c_str();
+
+		std::lock_guard<std::mutex> lock(timeline_mutex);
+
+		load_timeline.push_back(std::move(event));
+
+		while (load_timeline.size() > MAX_LOAD_EVENTS)
+			load_timeline.pop_front();
+	}
+
+	float ResourceManager::getTime() const
+	{
+		std::chrono::duration<float, std::milli> time = std::chrono::steady_clock::now() - start_time;
+		return time.count();
 	}
 
-	ResourcePool *ResourceManager::getPool(const char *type_name) const
+	void ResourceManager::getResourceStats(std::vector<ResourceTypeStats> &stats) const
 	{
-		uint64_t hash = 0;
-		common::HashUtils::combine(hash, std::string_view(type_name));
+		for (uint32_t i = 0; i < MAX_TYPES; ++i)
+		{
+			TypeShard *shard = shards[i].load(std::memory_order_acquire);
+			if (!shard)
+				continue;
+
+			ResourceTypeStats type_stats;
+
+			{
+				std::lock_guard<std::mutex> lock(shard->mutex);
+				type_stats = shard->stats;
+			}
+
+			fillTypeStats(shard->type_id, type_stats);
+
+			stats.push_back(type_stats);
+		}
+	}
+
+	ResourceTypeStats ResourceManager::getTypeStats(type_id_t type_id) const
+	{
+		ResourceTypeStats stats;
+
+		if (TypeShard *shard = getShard(type_id); shard)
+		{
+			std::lock_guard<std::mutex> lock(shard->mutex);
+			stats = shard->stats;
+		}
+
+		fillTypeStats(type_id, stats);
+		return stats;
+	}
+
+	void ResourceManager::getLoadTimeline(std::vector<ResourceLoadEvent> &events) const
+	{
+		std::lock_guard<std::mutex> lock(timeline_mutex);
+		events.insert(events.end(), load_timeline.begin(), load_timeline.end());
+	}
 
-		auto it = pools.find(hash);
-		if (it == pools.end())
+	void ResourceManager::clearLoadTimeline()
+	{
+		std::lock_guard<std::mutex> lock(timeline_mutex);
+		load_timeline.clear();
+	}
+
+	void ResourceManager::fillTypeStats(type_id_t type_id, ResourceTypeStats &stats) const
+	{
+		// live counters are owned by memory tracking and pools
+		{
+			std::lock_guard<std::mutex> lock(memory_mutex);
+
+			auto usage_it = memory_usage_by_type.find(type_id);
+			if (usage_it != memory_usage_by_type.end())
+			{
+				stats.num_resources = usage_it->second.num_resources;
+				stats.cpu_bytes = usage_it->second.cpu_bytes;
+				stats.gpu_bytes = usage_it->second.gpu_bytes;
+			}
+		}
+
+		if (TypeShard *shard = getShard(type_id); shard)
+		{
+			std::lock_guard<std::mutex> lock(shard->mutex);
+
+			stats.num_pool_pages = static_cast<uint32_t>(shard->pool->getNumPages());
+			stats.pool_bytes = shard->pool->getNumAllocatedBytes();
+		}
+	}
+
+	bool ResourceManager::isOverBudget(const MemoryUsage &usage) const
+	{
+		if (usage.cpu_budget > 0 && usage.cpu_bytes > usage.cpu_budget)
+			return true;
+
+		if (usage.gpu_budget > 0 && usage.gpu_bytes > usage.gpu_budget)
+			return true;
+
+		return false;
+	}
+
+	/*
+	 */
+	void ResourceManager::trackMemory(void *memory)
+	{
+		ResourceMetadata *metadata = reinterpret_cast<ResourceMetadata *>(memory);
+		assert(metadata);
+
+		TypeShard *shard = getShard(metadata->type_id);
+		assert(shard);
+
+		const ResourceVTable &vtable = shard->vtable;
+		uint8_t *resource_ptr = reinterpret_cast<uint8_t *>(memory) + vtable.offset;
+
+		size_t cpu_memory = (vtable.getCPUMemory) ? vtable.getCPUMemory(this, resource_ptr) : 0;
+		size_t gpu_memory = (vtable.getGPUMemory) ? vtable.getGPUMemory(this, resource_ptr) : 0;
+
+		std::lock_guard<std::mutex> lock(memory_mutex);
+
+		MemoryUsage &type_usage = fetchTypeMemoryUsage(metadata->type_id);
+
+		type_usage.cpu_bytes += cpu_memory - metadata->cpu_memory;
+		type_usage.gpu_bytes += gpu_memory - metadata->gpu_memory;
+
+		memory_usage.cpu_bytes += cpu_memory - metadata->cpu_memory;
+		memory_usage.gpu_bytes += gpu_memory - metadata->gpu_memory;
+
+		metadata->cpu_memory = cpu_memory;
+		metadata->gpu_memory = gpu_memory;
+	}
+
+	void ResourceManager::retainMemory(void *memory)
+	{
+		ResourceMetadata *metadata = reinterpret_cast<ResourceMetadata *>(memory);
+		assert(metadata);
+		assert(!isRelocating(memory));
+
+		if (tryAddReference(metadata))
+			return;
+
+		std::lock_guard<std::mutex> lock(memory_mutex);
+		retainMemoryLocked(memory);
+	}
+
+	void ResourceManager::retainMemoryLocked(void *memory)
+	{
+		ResourceMetadata *metadata = reinterpret_cast<ResourceMetadata *>(memory);
+		assert(metadata);
+
+		if (metadata->ref_count++ > 0)
+			return;
+
+		removeEvictableLocked(memory);
+	}
+
+	void ResourceManager::removeEvictableLocked(void *memory)
+	{
+		uint64_t memory_hash = 0;
+		common::HashUtils::combine(memory_hash, memory);
+
+		auto it = evictable_by_resource.find(memory_hash);
+		if (it == evictable_by_resource.end())
+			return;
+
+		evictable_resources.erase(it->second);
+		evictable_by_resource.erase(it);
+
+		ResourceMetadata *metadata = reinterpret_cast<ResourceMetadata *>(memory);
+		assert(metadata);
+
+		fetchTypeMemoryUsage(metadata->type_id).num_evictable--;
+		memory_usage.num_evictable--;
+	}
+
+	void ResourceManager::releaseMemory(void *memory)
+	{
+		ResourceMetadata *metadata = reinterpret_cast<ResourceMetadata *>(memory);
+		assert(metadata);
+		assert(metadata->ref_count > 0);
+		assert(!isRelocating(memory));
+
+		// every resource gets destroyed by the teardown loop anyway
+		if (destroying)
+		{
+			metadata->ref_count--;
+			return;
+		}
+
+		if (tryRemoveReference(metadata))
+			return;
+
+		// likely the last reference, measure cached resources while they are still held;
+		// pending ones are still written by loader workers and get measured on commit
+		if (metadata->state != ResourceState::PENDING && isLinked(memory))
+			trackMemory(memory);
+
+		{
+			std::lock_guard<std::mutex> lock(memory_mutex);
+
+			// retained by another thread in the meantime
+			if (metadata->ref_count-- > 1)
+				return;
+
+			if (isLinked(memory))
+			{
+				uint64_t memory_hash = 0;
+				common::HashUtils::combine(memory_hash, memory);
+
+				evictable_resources.push_front(memory);
+				evictable_by_resource.insert({memory_hash, evictable_resources.begin()});
+
+				fetchTypeMemoryUsage(metadata->type_id).num_evictable++;
+				memory_usage.num_evictable++;
+				return;
+			}
+		}
+
+		// nothing to reload from, so there's no point in caching
+		destroyMemory(memory);
+	}
+
+	void ResourceManager::evictResources()
+	{
+		std::vector<void *> candidates;
+
+		{
+			std::lock_guard<std::mutex> lock(memory_mutex);
+
+			if (evictable_resources.empty())
+				return;
+
+			bool over_budget = isOverBudget(memory_usage);
+
+			for (auto it = memory_usage_by_type.begin(); !over_budget && it != memory_usage_by_type.end(); ++it)
+				over_budget = isOverBudget(it->second);
+
+			if (!over_budget)
+				return;
+
+			// destroying resources modifies the list, so iterate over a copy
+			candidates.assign(evictable_resources.rbegin(), evictable_resources.rend());
+		}
+
+		SCAPES_PROFILER();
+
+		for (void *memory : candidates)
+		{
+			ResourceMetadata *metadata = reinterpret_cast<ResourceMetadata *>(memory);
+			assert(metadata);
+
+			io::URI uri;
+			size_t cpu_memory = 0;
+			size_t gpu_memory = 0;
+
+			{
+				std::lock_guard<std::mutex> lock(memory_mutex);
+
+				uint64_t memory_hash = 0;
+				common::HashUtils::combine(memory_hash, memory);
+
+				// destroying previous candidates or other threads may have changed the list
+				if (evictable_by_resource.find(memory_hash) == evictable_by_resource.end())
+					continue;
+
+				if (metadata->state == ResourceState::PENDING)
+					continue;
+
+				const MemoryUsage &type_usage = fetchTypeMemoryUsage(metadata->type_id);
+				if (!isOverBudget(memory_usage) && !isOverBudget(type_usage))
+					continue;
+
+				// unlink while still holding the lock so fetches from other threads can't pick it up
+				removeEvictableLocked(memory);
+
+				uri = getLinkedUri(memory);
+				unlinkMemory(memory);
+
+				cpu_memory = metadata->cpu_memory;
+				gpu_memory = metadata->gpu_memory;
+			}
+
+			Log::message("ResourceManager::update(): evicting \"%s\" (%zu CPU bytes, %zu GPU bytes)\n", uri.c_str(), cpu_memory, gpu_memory);
+
+			destroyResource(memory);
+		}
+	}
+
+	/*
+	 */
+	ResourceManager::TypeShard *ResourceManager::fetchShard(type_id_t type_id, const char *type_name, size_t type_size, const ResourceVTable &vtable)
+	{
+		if (TypeShard *shard = getShard(type_id); shard)
+			return shard;
+
+		std::lock_guard<std::mutex> lock(shards_mutex);
+
+		// another thread may have registered the type while the lock was released
+		uint32_t index = static_cast<uint32_t>(type_id) & (MAX_TYPES - 1);
+		for (uint32_t i = 0; i < MAX_TYPES; ++i, index = (index + 1) & (MAX_TYPES - 1))
+		{
+			TypeShard *shard = shards[index].load(std::memory_order_acquire);
+			if (!shard)
+				break;
+
+			if (shard->type_id == type_id)
+				return shard;
+		}
+
+		if (shards[index].load(std::memory_order_relaxed))
+		{
+			Log::fatal("ResourceManager::fetchShard(): can't register \"%s\" type, too many resource types\n", type_name);
 			return nullptr;
+		}
 
-		return it->second;
+		// keep metadata headers aligned for every element in the page
+		constexpr size_t alignment = alignof(std::max_align_t);
+		size_t element_size = (type_size + alignment - 1) & ~(alignment - 1);
+
+		TypeShard *shard = new TypeShard();
+		shard->type_id = type_id;
+		shard->pool = new ResourcePool(element_size);
+		shard->vtable = vtable;
+
+		// register the type so it shows up in stats before the first load
+		shard->stats.type_name = type_name;
+
+		shards[index].store(shard, std::memory_order_release);
+
+		return shard;
+	}
+
+	ResourceManager::TypeShard *ResourceManager::getShard(type_id_t type_id) const
+	{
+		uint32_t index = static_cast<uint32_t>(type_id) & (MAX_TYPES - 1);
+		for (uint32_t i = 0; i < MAX_TYPES; ++i, index = (index + 1) & (MAX_TYPES - 1))
+		{
+			TypeShard *shard = shards[index].load(std::memory_order_acquire);
+			if (!shard)
+				return nullptr;
+
+			if (shard->type_id == type_id)
+				return shard;
+		}
+
+		return nullptr;
 	}
 }
@@ -1,9 +1,17 @@
 #pragma once
 
 #include <scapes/foundation/resources/ResourceManager.h>
+#include "ResourceLoader.h"
 #include "HashUtils.h"
 
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <list>
+#include <mutex>
+#include <thread>
 #include <unordered_map>
+#include <unordered_set>
 
 namespace scapes::foundation::resources::impl
 {
@@ -17,28 +25,110 @@ namespace scapes::foundation::resources::impl
 
 		SCAPES_INLINE io::FileSystem *getFileSystem() const final { return file_system; }
 		void update(float dt) final;
+		void waitPending() final;
+
+		void setMemoryBudget(size_t cpu_bytes, size_t gpu_bytes) final;
+		MemoryUsage getMemoryUsage() const final;
+
+		void getResourceStats(std::vector<ResourceTypeStats> &stats) const final;
+		void getLoadTimeline(std::vector<ResourceLoadEvent> &events) const final;
+		void clearLoadTimeline() final;
+		float getTime() const final;
 
 	private:
 		bool linkMemory(void *memory, const io::URI &uri) final;
 		bool unlinkMemory(void *memory) final;
 		void *getLinkedMemory(const io::URI &uri) const final;
+		void *retainLinkedMemory(const io::URI &uri) final;
 		io::URI getLinkedUri(void *memory) const final;
 
-		void *allocate(const char *type_name, size_t size) final;
-		void deallocate(void *memory, const char *type_name) final;
+		void *reserveLinkedMemory(const io::URI &uri) final;
+		void finishLinkedLoad(const io::URI &uri) final;
+
+		void *allocate(type_id_t type_id, const char *type_name, size_t size, const ResourceVTable &vtable) final;
+		void destroyMemory(void *memory) final;
+
+		void submitAsync(const AsyncLoadTask &task) final;
+		void waitMemory(void *memory) final;
+		void cancelMemory(void *memory) final;
+		void addMemoryLoadCallback(void *memory, std::function<void (void *, bool)> callback) final;
+
+		void trackMemory(void *memory) final;
+		void trackLoad(void *memory, const io::URI &uri, ResourceLoadEvent &event) final;
+		void retainMemory(void *memory) final;
+		void releaseMemory(void *memory) final;
+		void setTypeMemoryBudget(type_id_t type_id, size_t cpu_bytes, size_t gpu_bytes) final;
+		MemoryUsage getTypeMemoryUsage(type_id_t type_id) const final;
+		ResourceTypeStats getTypeStats(type_id_t type_id) const final;
+
+		const ResourceTable *getTable(type_id_t type_id) const final;
+		size_t compactMemory(type_id_t type_id) final;
 
 	private:
-		ResourceVTable *fetchVTable(const char *type_name) final;
-		ResourceVTable *getVTable(const char *type_name);
+		struct TypeShard;
+
+		void commitAsync(ResourceLoader::Result &result);
+		void processPendingDestroys();
+
+		void destroyResource(void *memory);
+		void deallocate(void *memory);
+
+		bool isLinked(void *memory) const;
+		bool isRelocating(void *memory) const;
+		bool unlinkMemoryLocked(void *memory);
+		void retainMemoryLocked(void *memory);
+		void removeEvictableLocked(void *memory);
+
+		void processFileChanges();
+		void pollFileChanges();
+		void reloadIfChanged(void *memory, const ResourceVTable *vtable, const io::URI &uri);
 
-		ResourcePool *fetchPool(const char *type_name, size_t size);
-		ResourcePool *getPool(const char *type_name) const;
+		static void onFileChanged(const io::URI &uri, void *user_data);
+
+		void evictResources();
+		bool isOverBudget(const MemoryUsage &usage) const;
+		MemoryUsage &fetchTypeMemoryUsage(type_id_t type_id);
+
+		void fillTypeStats(type_id_t type_id, ResourceTypeStats &stats) const;
+
+		TypeShard *fetchShard(type_id_t type_id, const char *type_name, size_t size, const ResourceVTable &vtable);
+		TypeShard *getShard(type_id_t type_id) const;
+
+		void relocateMemory(TypeShard *shard, void *src_memory, void *dst_memory);
+		void releaseRetiredPages(bool force);
 
 	private:
+		enum
+		{
+			MAX_LOAD_EVENTS = 4096,
+			MAX_TYPES = 1024,
+			RETIRED_PAGE_FRAMES = 16,
+		};
+
 		struct ResourceEntry
 		{
 			void *memory {nullptr};
-			ResourceVTable *vtable {nullptr};
+			const ResourceVTable *vtable {nullptr};
+		};
+
+		// everything owned by a single resource type, guarded by its own mutex so
+		// allocations of different types don't contend; shards live until destruction
+		struct TypeShard
+		{
+			mutable std::mutex mutex;
+			type_id_t type_id {0};
+
+			ResourcePool *pool {nullptr};
+			ResourceTable table;
+			ResourceVTable vtable;
+			ResourceTypeStats stats;
+		};
+
+		// pool page emptied by compaction, kept readable for a while so stale handles to it fail their generation check
+		struct RetiredPage
+		{
+			void *memory {nullptr};
+			uint32_t frame {0};
 		};
 
 		struct URIHasher
@@ -57,10 +147,60 @@ namespace scapes::foundation::resources::impl
 		uint32_t max_check_frames {300};
 
 		io::FileSystem *file_system {nullptr};
-		std::unordered_map<size_t, ResourcePool *> pools;
-		std::unordered_map<size_t, ResourceVTable *> vtables;
+		ResourceLoader *loader {nullptr};
+
+		// update(), compaction and deferred destruction happen on this thread
+		std::thread::id owner_thread;
+		std::chrono::steady_clock::time_point start_time;
+
+		// resources destroyed during teardown may still release handles they hold
+		bool destroying {false};
+
+		bool watching_files {false};
+		std::vector<io::URI> changed_uris;
+
+		std::vector<ResourceLoader::Result> async_results;
 
+		// lock order: memory_mutex, uri_mutex, TypeShard::mutex; the rest are never held while taking another lock
+		std::mutex shards_mutex;
+		mutable std::mutex memory_mutex;
+		mutable std::mutex uri_mutex;
+		mutable std::mutex async_mutex;
+		mutable std::mutex timeline_mutex;
+		std::mutex destroy_mutex;
+
+		// open addressing by type id, already a well mixed hash; shards are only ever added,
+		// so lookups don't lock and registration is serialized by shards_mutex
+		std::atomic<TypeShard *> shards[MAX_TYPES] {};
+
+		// guarded by memory_mutex, as well as ref count transitions from and to zero
+		MemoryUsage memory_usage;
+		std::unordered_map<type_id_t, MemoryUsage> memory_usage_by_type;
+
+		// unreferenced resources, least recently released at the back
+		std::list<void *> evictable_resources;
+		std::unordered_map<size_t, std::list<void *>::iterator> evictable_by_resource;
+
+		// guarded by async_mutex
+		std::unordered_map<size_t, std::vector<std::function<void (void *, bool)>>> load_callbacks;
+		std::unordered_map<size_t, float> async_start_times;
+
+		// guarded by timeline_mutex
+		std::deque<ResourceLoadEvent> load_timeline;
+
+		// guarded by uri_mutex
 		std::unordered_map<size_t, io::URI> uri_by_resource;
 		std::unordered_map<io::URI, std::vector<ResourceEntry>, URIHasher> resources_by_uri;
+
+		// uris being loaded by fetch(), other fetches of them wait for linked_loads_finished
+		std::unordered_set<io::URI, URIHasher> loading_uris;
+		std::condition_variable linked_loads_finished;
+
+		// guarded by destroy_mutex, destroyed from other threads and waiting for the next update()
+		std::vector<void *> pending_destroys;
+
+		// owner thread only
+		std::vector<void *> empty_pages;
+		std::vector<RetiredPage> retired_pages;
 	};
 }
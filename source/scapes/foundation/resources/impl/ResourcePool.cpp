@@ -1,4 +1,5 @@
 #include "resources/impl/ResourcePool.h"
+#include "BitUtils.h"
 
 #include <scapes/foundation/resources/ResourceManager.h>
 
@@ -21,90 +22,80 @@ namespace scapes::foundation::resources::impl
 		}
 
 		pages.clear();
+		page_by_address.clear();
+		free_pages_head = INVALID_PAGE;
 
 		element_size = 0;
+		num_elements = 0;
 	}
 
 	/*
 	 */
 	void *ResourcePool::allocate()
 	{
-		size_t last_page = pages.size() - 1;
+		if (free_pages_head == INVALID_PAGE)
+			pushFreePage(createPage());
 
-		// TODO: optimize this by adding free list for non-full pages
-		//       and iterate over them instead of doing full linear search
-		Page *page = nullptr;
-		for (size_t i = 0; i < pages.size(); ++i)
-		{
-			if (!pages[i].isFull())
-			{
-				page = &pages[i];
-				break;
-			}
-		}
+		assert(free_pages_head != INVALID_PAGE);
+		Page &page = pages[free_pages_head];
 
-		if (page == nullptr)
-		{
-			Page new_page;
-			new_page.memory = ::malloc(element_size * ELEMENTS_IN_PAGE);
-			memset(new_page.memory, 0, element_size * ELEMENTS_IN_PAGE);
-			new_page.free_elements_mask = INITIAL_FREE_MASK;
-
-			pages.push_back(new_page);
-			page = &pages[pages.size() - 1];
-		}
+		assert(page.memory);
+		assert(!page.isFull());
 
-		assert(page->memory);
-		assert(!page->isFull());
+		uint32_t element_index = common::BitUtils::countTrailingZeros(page.free_elements_mask);
+		page.free_elements_mask &= ~(static_cast<uint64_t>(1) << element_index);
 
-		void *memory = nullptr;
+		if (page.isFull())
+			removeFreePage(free_pages_head);
 
-		for (int i = 0; i < ELEMENTS_IN_PAGE; ++i)
-		{
-			uint64_t mask = static_cast<uint64_t>(1) << i;
-			if (mask & page->free_elements_mask)
-			{
-				memory = reinterpret_cast<uint8_t*>(page->memory) + element_size * i;
-				page->free_elements_mask &= ~mask;
-				break;
-			}
-		}
+		num_elements++;
 
-		assert(memory);
-		return memory;
+		return reinterpret_cast<uint8_t*>(page.memory) + element_size * element_index;
 	}
 
 	void ResourcePool::deallocate(const void *memory)
 	{
+		uint32_t page_index = findPage(memory);
+		if (page_index == INVALID_PAGE)
+			return;
+
+		Page &page = pages[page_index];
+
 		size_t page_memory = reinterpret_cast<size_t>(memory);
+		size_t page_start = reinterpret_cast<size_t>(page.memory);
 
-		// TODO: optimize this by adding binary search tree for all pages
-		//       and search in that binary tree instead of doing full linear search
-		for (size_t i = 0; i < pages.size(); ++i)
-		{
-			Page &page = pages[i];
+		assert((page_memory - page_start) % element_size == 0);
+		size_t element_index = (page_memory - page_start) / element_size;
 
-			size_t page_start = reinterpret_cast<size_t>(page.memory);
-			size_t page_end = page_start + ELEMENTS_IN_PAGE * element_size;
+		uint64_t mask = static_cast<uint64_t>(1) << element_index;
+		assert((page.free_elements_mask & mask) == 0);
 
-			if (page_memory >= page_start && page_memory < page_end)
-			{
-				assert((page_memory - page_start) % element_size == 0);
-				size_t element_index = (page_memory - page_start) / element_size;
+		bool was_full = page.isFull();
+		page.free_elements_mask |= mask;
 
-				page.free_elements_mask |= static_cast<uint64_t>(1) << element_index;
-				break;
-			}
-		}
+		if (was_full)
+			pushFreePage(page_index);
+
+		assert(num_elements > 0);
+		num_elements--;
 	}
 
 	void ResourcePool::clear()
 	{
+		free_pages_head = INVALID_PAGE;
+
 		for (size_t i = 0; i < pages.size(); ++i)
 		{
 			Page &page = pages[i];
 			page.free_elements_mask = INITIAL_FREE_MASK;
+			page.next_free = INVALID_PAGE;
+			page.prev_free = INVALID_PAGE;
 		}
+
+		for (size_t i = pages.size(); i > 0; --i)
+			pushFreePage(static_cast<uint32_t>(i - 1));
+
+		num_elements = 0;
 	}
 
 	void ResourcePool::traverse(std::function<void (void *)> func)
@@ -112,16 +103,167 @@ namespace scapes::foundation::resources::impl
 		for (size_t i = 0; i < pages.size(); ++i)
 		{
 			Page &page = pages[i];
+			uint64_t used_elements_mask = ~page.free_elements_mask;
 
-			for (int j = 0; j < ELEMENTS_IN_PAGE; ++j)
+			while (used_elements_mask)
 			{
-				uint64_t mask = static_cast<uint64_t>(1) << j;
-				if (mask & page.free_elements_mask)
-					continue;
+				uint32_t j = common::BitUtils::countTrailingZeros(used_elements_mask);
+				used_elements_mask &= used_elements_mask - 1;
 
 				void *memory = reinterpret_cast<uint8_t*>(page.memory) + element_size * j;
 				func(memory);
 			}
 		}
 	}
+
+	size_t ResourcePool::compact(std::function<void (void *, void *)> on_move, std::vector<void *> &empty_pages)
+	{
+		if (pages.empty())
+			return 0;
+
+		size_t num_moved = 0;
+
+		uint32_t dst_page_index = 0;
+		uint32_t src_page_index = static_cast<uint32_t>(pages.size() - 1);
+
+		while (true)
+		{
+			while (dst_page_index < src_page_index && pages[dst_page_index].isFull())
+				dst_page_index++;
+
+			while (src_page_index > dst_page_index && pages[src_page_index].free_elements_mask == INITIAL_FREE_MASK)
+				src_page_index--;
+
+			if (dst_page_index >= src_page_index)
+				break;
+
+			Page &src_page = pages[src_page_index];
+			Page &dst_page = pages[dst_page_index];
+
+			uint32_t src_element_index = common::BitUtils::countTrailingZeros(~src_page.free_elements_mask);
+			uint32_t dst_element_index = common::BitUtils::countTrailingZeros(dst_page.free_elements_mask);
+
+			void *src_memory = reinterpret_cast<uint8_t*>(src_page.memory) + element_size * src_element_index;
+			void *dst_memory = reinterpret_cast<uint8_t*>(dst_page.memory) + element_size * dst_element_index;
+
+			on_move(src_memory, dst_memory);
+
+			src_page.free_elements_mask |= static_cast<uint64_t>(1) << src_element_index;
+			dst_page.free_elements_mask &= ~(static_cast<uint64_t>(1) << dst_element_index);
+
+			num_moved++;
+		}
+
+		rebuildPages(empty_pages);
+
+		return num_moved;
+	}
+
+	/*
+	 */
+	uint32_t ResourcePool::createPage()
+	{
+		Page new_page;
+		new_page.memory = ::malloc(element_size * ELEMENTS_IN_PAGE);
+		memset(new_page.memory, 0, element_size * ELEMENTS_IN_PAGE);
+		new_page.free_elements_mask = INITIAL_FREE_MASK;
+
+		uint32_t index = static_cast<uint32_t>(pages.size());
+
+		pages.push_back(new_page);
+		page_by_address.insert({reinterpret_cast<size_t>(new_page.memory), index});
+
+		return index;
+	}
+
+	uint32_t ResourcePool::findPage(const void *memory) const
+	{
+		size_t address = reinterpret_cast<size_t>(memory);
+
+		// find the last page which starts at or before the address
+		auto it = page_by_address.upper_bound(address);
+		if (it == page_by_address.begin())
+			return INVALID_PAGE;
+
+		--it;
+
+		size_t page_start = it->first;
+		size_t page_end = page_start + ELEMENTS_IN_PAGE * element_size;
+
+		if (address >= page_end)
+			return INVALID_PAGE;
+
+		return it->second;
+	}
+
+	void ResourcePool::releasePage(void *memory)
+	{
+		::free(memory);
+	}
+
+	void ResourcePool::rebuildPages(std::vector<void *> &empty_pages)
+	{
+		std::vector<Page> used_pages;
+		used_pages.reserve(pages.size());
+
+		for (Page &page : pages)
+		{
+			if (page.free_elements_mask == INITIAL_FREE_MASK)
+			{
+				empty_pages.push_back(page.memory);
+				continue;
+			}
+
+			used_pages.push_back(page);
+		}
+
+		pages = std::move(used_pages);
+		page_by_address.clear();
+		free_pages_head = INVALID_PAGE;
+
+		for (size_t i = pages.size(); i > 0; --i)
+		{
+			uint32_t index = static_cast<uint32_t>(i - 1);
+			Page &page = pages[index];
+
+			page_by_address.insert({reinterpret_cast<size_t>(page.memory), index});
+
+			page.next_free = INVALID_PAGE;
+			page.prev_free = INVALID_PAGE;
+
+			if (!page.isFull())
+				pushFreePage(index);
+		}
+	}
+
+	/*
+	 */
+	void ResourcePool::pushFreePage(uint32_t index)
+	{
+		Page &page = pages[index];
+
+		page.prev_free = INVALID_PAGE;
+		page.next_free = free_pages_head;
+
+		if (free_pages_head != INVALID_PAGE)
+			pages[free_pages_head].prev_free = index;
+
+		free_pages_head = index;
+	}
+
+	void ResourcePool::removeFreePage(uint32_t index)
+	{
+		Page &page = pages[index];
+
+		if (page.prev_free != INVALID_PAGE)
+			pages[page.prev_free].next_free = page.next_free;
+		else
+			free_pages_head = page.next_free;
+
+		if (page.next_free != INVALID_PAGE)
+			pages[page.next_free].prev_free = page.prev_free;
+
+		page.next_free = INVALID_PAGE;
+		page.prev_free = INVALID_PAGE;
+	}
 }
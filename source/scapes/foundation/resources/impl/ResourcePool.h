@@ -2,6 +2,7 @@
 
 #include <scapes/Common.h>
 #include <vector>
+#include <map>
 #include <functional>
 
 namespace scapes::foundation::resources::impl
@@ -17,6 +18,16 @@ namespace scapes::foundation::resources::impl
 		void clear();
 		void traverse(std::function<void (void *)> func);
 
+		// moves elements from the last pages into holes of the first ones, callback must copy every moved element;
+		// empty pages are handed over instead of being freed, so stale pointers stay readable until releasePage()
+		size_t compact(std::function<void (void *, void *)> on_move, std::vector<void *> &empty_pages);
+		static void releasePage(void *memory);
+
+		SCAPES_INLINE size_t getElementSize() const { return element_size; }
+		SCAPES_INLINE size_t getNumPages() const { return pages.size(); }
+		SCAPES_INLINE size_t getNumElements() const { return num_elements; }
+		SCAPES_INLINE size_t getNumAllocatedBytes() const { return pages.size() * ELEMENTS_IN_PAGE * element_size; }
+
 	private:
 		enum : uint64_t
 		{
@@ -24,16 +35,36 @@ namespace scapes::foundation::resources::impl
 			ELEMENTS_IN_PAGE = 64,
 		};
 
+		enum : uint32_t
+		{
+			INVALID_PAGE = 0xFFFFFFFF,
+		};
+
 		struct Page
 		{
 			void *memory {nullptr};
 			uint64_t free_elements_mask {INITIAL_FREE_MASK};
 
+			// intrusive list of non-full pages
+			uint32_t next_free {INVALID_PAGE};
+			uint32_t prev_free {INVALID_PAGE};
+
 			SCAPES_INLINE bool isFull() const { return free_elements_mask == 0; }
 		};
 
+		uint32_t createPage();
+		uint32_t findPage(const void *memory) const;
+
+		void pushFreePage(uint32_t index);
+		void removeFreePage(uint32_t index);
+		void rebuildPages(std::vector<void *> &empty_pages);
+
+	private:
 		std::vector<Page> pages;
+		std::map<size_t, uint32_t> page_by_address;
+		uint32_t free_pages_head {INVALID_PAGE};
 
 		size_t element_size {0};
+		size_t num_elements {0};
 	};
 }
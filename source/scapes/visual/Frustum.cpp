@@ -0,0 +1,148 @@
+#include <scapes/visual/Frustum.h>
+
+#if defined(__AVX__)
+	#include <immintrin.h>
+	#define SCAPES_CULLING_AVX
+#elif defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+	#include <xmmintrin.h>
+	#define SCAPES_CULLING_SSE
+#endif
+
+namespace scapes::visual
+{
+	/*
+	 */
+	static SCAPES_INLINE bool isSphereVisible(const foundation::math::vec4 *planes, float x, float y, float z, float radius)
+	{
+		for (uint32_t i = 0; i < Frustum::MAX_PLANES; ++i)
+		{
+			const foundation::math::vec4 &plane = planes[i];
+			if (plane.x * x + plane.y * y + plane.z * z + plane.w < -radius)
+				return false;
+		}
+
+		return true;
+	}
+
+	/*
+	 */
+	Frustum Frustum::fromViewProjection(const foundation::math::mat4 &view_projection)
+	{
+		// Gribb & Hartmann, glm matrices are column major so rows are gathered by hand
+		foundation::math::vec4 rows[4];
+		for (int i = 0; i < 4; ++i)
+			rows[i] = foundation::math::vec4(view_projection[0][i], view_projection[1][i], view_projection[2][i], view_projection[3][i]);
+
+		Frustum result;
+		result.planes[PLANE_LEFT] = rows[3] + rows[0];
+		result.planes[PLANE_RIGHT] = rows[3] - rows[0];
+		result.planes[PLANE_BOTTOM] = rows[3] + rows[1];
+		result.planes[PLANE_TOP] = rows[3] - rows[1];
+		result.planes[PLANE_NEAR] = rows[3] + rows[2];
+		result.planes[PLANE_FAR] = rows[3] - rows[2];
+
+		// sphere tests compare distances against radii, so normals must be unit length
+		for (foundation::math::vec4 &plane : result.planes)
+			plane /= foundation::math::length(foundation::math::vec3(plane));
+
+		return result;
+	}
+
+	/*
+	 */
+	uint32_t Frustum::cullSpheres(
+		uint32_t count,
+		const float *centers_x,
+		const float *centers_y,
+		const float *centers_z,
+		const float *radii,
+		uint32_t *visible_indices
+	) const
+	{
+		uint32_t num_visible = 0;
+		uint32_t i = 0;
+
+#if defined(SCAPES_CULLING_AVX)
+		__m256 plane_x[MAX_PLANES];
+		__m256 plane_y[MAX_PLANES];
+		__m256 plane_z[MAX_PLANES];
+		__m256 plane_w[MAX_PLANES];
+
+		for (uint32_t j = 0; j < MAX_PLANES; ++j)
+		{
+			plane_x[j] = _mm256_set1_ps(planes[j].x);
+			plane_y[j] = _mm256_set1_ps(planes[j].y);
+			plane_z[j] = _mm256_set1_ps(planes[j].z);
+			plane_w[j] = _mm256_set1_ps(planes[j].w);
+		}
+
+		for (; i + 8 <= count; i += 8)
+		{
+			__m256 x = _mm256_loadu_ps(centers_x + i);
+			__m256 y = _mm256_loadu_ps(centers_y + i);
+			__m256 z = _mm256_loadu_ps(centers_z + i);
+			__m256 negative_radius = _mm256_sub_ps(_mm256_setzero_ps(), _mm256_loadu_ps(radii + i));
+
+			__m256 inside;
+			for (uint32_t j = 0; j < MAX_PLANES; ++j)
+			{
+				__m256 distance = _mm256_add_ps(_mm256_mul_ps(plane_x[j], x), plane_w[j]);
+				distance = _mm256_add_ps(distance, _mm256_mul_ps(plane_y[j], y));
+				distance = _mm256_add_ps(distance, _mm256_mul_ps(plane_z[j], z));
+
+				__m256 plane_inside = _mm256_cmp_ps(distance, negative_radius, _CMP_NLT_UQ);
+				inside = (j == 0) ? plane_inside : _mm256_and_ps(inside, plane_inside);
+			}
+
+			uint32_t mask = static_cast<uint32_t>(_mm256_movemask_ps(inside));
+			for (uint32_t k = 0; mask != 0; ++k, mask >>= 1)
+				if (mask & 1)
+					visible_indices[num_visible++] = i + k;
+		}
+#elif defined(SCAPES_CULLING_SSE)
+		__m128 plane_x[MAX_PLANES];
+		__m128 plane_y[MAX_PLANES];
+		__m128 plane_z[MAX_PLANES];
+		__m128 plane_w[MAX_PLANES];
+
+		for (uint32_t j = 0; j < MAX_PLANES; ++j)
+		{
+			plane_x[j] = _mm_set1_ps(planes[j].x);
+			plane_y[j] = _mm_set1_ps(planes[j].y);
+			plane_z[j] = _mm_set1_ps(planes[j].z);
+			plane_w[j] = _mm_set1_ps(planes[j].w);
+		}
+
+		for (; i + 4 <= count; i += 4)
+		{
+			__m128 x = _mm_loadu_ps(centers_x + i);
+			__m128 y = _mm_loadu_ps(centers_y + i);
+			__m128 z = _mm_loadu_ps(centers_z + i);
+			__m128 negative_radius = _mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(radii + i));
+
+			__m128 inside;
+			for (uint32_t j = 0; j < MAX_PLANES; ++j)
+			{
+				__m128 distance = _mm_add_ps(_mm_mul_ps(plane_x[j], x), plane_w[j]);
+				distance = _mm_add_ps(distance, _mm_mul_ps(plane_y[j], y));
+				distance = _mm_add_ps(distance, _mm_mul_ps(plane_z[j], z));
+
+				__m128 plane_inside = _mm_cmpnlt_ps(distance, negative_radius);
+				inside = (j == 0) ? plane_inside : _mm_and_ps(inside, plane_inside);
+			}
+
+			uint32_t mask = static_cast<uint32_t>(_mm_movemask_ps(inside));
+			for (uint32_t k = 0; mask != 0; ++k, mask >>= 1)
+				if (mask & 1)
+					visible_indices[num_visible++] = i + k;
+		}
+#endif
+
+		// leftovers that don't fill a whole register
+		for (; i < count; ++i)
+			if (isSphereVisible(planes, centers_x[i], centers_y[i], centers_z[i], radii[i]))
+				visible_indices[num_visible++] = i;
+
+		return num_visible;
+	}
+}
@@ -0,0 +1,18 @@
+#include <impl/GeometryArena.h>
+
+namespace scapes::visual
+{
+	GeometryArena *GeometryArena::create(
+		hardware::Device *device,
+		uint32_t page_vertices,
+		uint32_t page_indices
+	)
+	{
+		return new impl::GeometryArena(device, page_vertices, page_indices);
+	}
+
+	void GeometryArena::destroy(GeometryArena *arena)
+	{
+		delete arena;
+	}
+}
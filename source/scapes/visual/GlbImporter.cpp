@@ -5,10 +5,12 @@ namespace scapes::visual
 	GlbImporter *GlbImporter::create(
 		foundation::resources::ResourceManager *resource_manager,
 		foundation::game::World *world,
-		scapes::visual::hardware::Device *device
+		scapes::visual::hardware::Device *device,
+		GeometryArena *geometry_arena,
+		const char *cache_path
 	)
 	{
-		return new impl::GlbImporter(resource_manager, world, device);
+		return new impl::GlbImporter(resource_manager, world, device, geometry_arena, cache_path);
 	}
 
 	void GlbImporter::destroy(GlbImporter *importer)
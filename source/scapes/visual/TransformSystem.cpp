@@ -0,0 +1,17 @@
+#include <impl/TransformSystem.h>
+
+namespace scapes::visual
+{
+	TransformSystem *TransformSystem::create(
+		foundation::game::World *world,
+		foundation::jobs::JobSystem *job_system
+	)
+	{
+		return new impl::TransformSystem(world, job_system);
+	}
+
+	void TransformSystem::destroy(TransformSystem *system)
+	{
+		delete system;
+	}
+}
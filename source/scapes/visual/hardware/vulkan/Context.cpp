@@ -188,12 +188,25 @@ namespace scapes::visual::hardware::vulkan
 		graphics_queue_info.queueCount = 1;
 		graphics_queue_info.pQueuePriorities = &queue_priority;
 
+		VkPhysicalDeviceVulkan12Features supported_features12 = {};
+		supported_features12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+
+		VkPhysicalDeviceFeatures2 supported_features = {};
+		supported_features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+		supported_features.pNext = &supported_features12;
+
+		vkGetPhysicalDeviceFeatures2(physical_device, &supported_features);
+
+		has_multi_draw_indirect = (supported_features.features.multiDrawIndirect == VK_TRUE);
+		has_draw_indirect_count = (supported_features12.drawIndirectCount == VK_TRUE);
+
 		VkPhysicalDeviceFeatures2 device_features = {};
 		device_features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
 		device_features.features.samplerAnisotropy = VK_TRUE;
 		device_features.features.sampleRateShading = VK_TRUE;
 		device_features.features.geometryShader = VK_TRUE;
 		device_features.features.tessellationShader = VK_TRUE;
+		device_features.features.multiDrawIndirect = has_multi_draw_indirect;
 
 		VkDeviceCreateInfo device_info = {};
 		device_info.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
@@ -203,9 +216,11 @@ namespace scapes::visual::hardware::vulkan
 		device_info.ppEnabledExtensionNames = device_extensions.data();
 		device_info.pNext = &device_features;
 
-		VkPhysicalDeviceBufferDeviceAddressFeatures buffer_device_address_info = {};
-		buffer_device_address_info.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_BUFFER_DEVICE_ADDRESS_FEATURES;
-		buffer_device_address_info.bufferDeviceAddress = VK_TRUE;
+		// core 1.2 features can't be chained alongside their old per-extension structs, so they all go here
+		VkPhysicalDeviceVulkan12Features features12_info = {};
+		features12_info.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+		features12_info.bufferDeviceAddress = VK_TRUE;
+		features12_info.drawIndirectCount = has_draw_indirect_count;
 		
 		VkPhysicalDeviceAccelerationStructureFeaturesKHR acceleration_structure_info = {};
 		acceleration_structure_info.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_ACCELERATION_STRUCTURE_FEATURES_KHR;
@@ -219,8 +234,8 @@ namespace scapes::visual::hardware::vulkan
 		rayquery_info.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_RAY_QUERY_FEATURES_KHR;
 		rayquery_info.rayQuery = has_ray_query;
 
-		device_features.pNext = &buffer_device_address_info;
-		buffer_device_address_info.pNext = &acceleration_structure_info;
+		device_features.pNext = &features12_info;
+		features12_info.pNext = &acceleration_structure_info;
 
 		if (has_ray_tracing)
 			acceleration_structure_info.pNext = &raytracing_pipeline_info;
@@ -255,13 +270,17 @@ namespace scapes::visual::hardware::vulkan
 			throw std::runtime_error("Can't create command pool");
 
 		// Create descriptor pools
-		std::array<VkDescriptorPoolSize, 3> descriptor_pool_sizes = {};
+		std::array<VkDescriptorPoolSize, 5> descriptor_pool_sizes = {};
 		descriptor_pool_sizes[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
 		descriptor_pool_sizes[0].descriptorCount = MAX_UNIFORM_BUFFERS;
 		descriptor_pool_sizes[1].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
 		descriptor_pool_sizes[1].descriptorCount = MAX_COMBINED_IMAGE_SAMPLERS;
 		descriptor_pool_sizes[2].type = VK_DESCRIPTOR_TYPE_ACCELERATION_STRUCTURE_KHR;
 		descriptor_pool_sizes[2].descriptorCount = MAX_ACCELERATION_STRUCTURES;
+		descriptor_pool_sizes[3].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+		descriptor_pool_sizes[3].descriptorCount = MAX_STORAGE_BUFFERS;
+		descriptor_pool_sizes[4].type = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+		descriptor_pool_sizes[4].descriptorCount = MAX_STORAGE_IMAGES;
 
 		VkDescriptorPoolCreateInfo descriptor_pool_info = {};
 		descriptor_pool_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
@@ -24,6 +24,8 @@ namespace scapes::visual::hardware::vulkan
 		SCAPES_INLINE bool hasAccelerationStructure() const { return has_acceleration_structure; }
 		SCAPES_INLINE bool hasRayTracing() const { return has_ray_tracing; }
 		SCAPES_INLINE bool hasRayQuery() const { return has_ray_query; }
+		SCAPES_INLINE bool hasMultiDrawIndirect() const { return has_multi_draw_indirect; }
+		SCAPES_INLINE bool hasDrawIndirectCount() const { return has_draw_indirect_count; }
 
 		SCAPES_INLINE uint32_t getSBTHandleAlignment() const { return ray_tracing_properties.shaderGroupHandleAlignment; }
 		SCAPES_INLINE uint32_t getSBTHandleSize() const { return ray_tracing_properties.shaderGroupHandleSize; }
@@ -55,12 +57,16 @@ namespace scapes::visual::hardware::vulkan
 			MAX_COMBINED_IMAGE_SAMPLERS = 32,
 			MAX_UNIFORM_BUFFERS = 32,
 			MAX_ACCELERATION_STRUCTURES = 32,
+			MAX_STORAGE_BUFFERS = 32,
+			MAX_STORAGE_IMAGES = 32,
 			MAX_DESCRIPTOR_SETS = 512,
 		};
 
 		bool has_acceleration_structure {false};
 		bool has_ray_tracing {false};
 		bool has_ray_query {false};
+		bool has_multi_draw_indirect {false};
+		bool has_draw_indirect_count {false};
 
 		VkPhysicalDeviceRayTracingPipelinePropertiesKHR ray_tracing_properties;
 
@@ -8,6 +8,7 @@
 #include <hardware/vulkan/RenderPassBuilder.h>
 #include <hardware/vulkan/Utils.h>
 
+#include <scapes/foundation/Log.h>
 #include <scapes/foundation/profiler/Profiler.h>
 
 #include <algorithm>
@@ -20,10 +21,82 @@ namespace scapes::visual::hardware::vulkan
 {
 	namespace helpers
 	{
+		static void pipelineBarrier(
+			VkCommandBuffer command_buffer,
+			VkPipelineStageFlags src_stages,
+			VkAccessFlags src_access,
+			VkPipelineStageFlags dst_stages,
+			VkAccessFlags dst_access,
+			uint32_t num_image_barriers = 0,
+			const VkImageMemoryBarrier *image_barriers = nullptr
+		)
+		{
+			VkMemoryBarrier barrier = {};
+			barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+			barrier.srcAccessMask = src_access;
+			barrier.dstAccessMask = dst_access;
+
+			vkCmdPipelineBarrier(command_buffer, src_stages, dst_stages, 0, 1, &barrier, 0, nullptr, num_image_barriers, image_barriers);
+		}
+
+		static uint32_t getStorageImageTransitions(const ComputePipeline *compute_pipeline, bool to_general, VkImageMemoryBarrier *barriers)
+		{
+			uint32_t num_barriers = 0;
+
+			for (uint32_t i = 0; i < compute_pipeline->num_bind_sets; ++i)
+			{
+				const BindSet *bind_set = compute_pipeline->bind_sets[i];
+
+				for (uint32_t j = 0; j < BindSet::MAX_BINDINGS; ++j)
+				{
+					if (!bind_set->binding_used[j] || bind_set->bindings[j].descriptorType != VK_DESCRIPTOR_TYPE_STORAGE_IMAGE)
+						continue;
+
+					const Texture *texture = bind_set->storage_images[j];
+					if (texture == nullptr || texture->layout == VK_IMAGE_LAYOUT_GENERAL)
+						continue;
+
+					assert(num_barriers < ComputePipeline::MAX_LAYOUT_TRANSITIONS);
+
+					VkImageMemoryBarrier &barrier = barriers[num_barriers++];
+					barrier = {};
+					barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+					barrier.oldLayout = (to_general) ? texture->layout : VK_IMAGE_LAYOUT_GENERAL;
+					barrier.newLayout = (to_general) ? VK_IMAGE_LAYOUT_GENERAL : texture->layout;
+					barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+					barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+					barrier.image = texture->image;
+					barrier.subresourceRange.aspectMask = Utils::getImageAspectFlags(texture->format);
+					barrier.subresourceRange.baseMipLevel = 0;
+					barrier.subresourceRange.levelCount = texture->num_mipmaps;
+					barrier.subresourceRange.baseArrayLayer = 0;
+					barrier.subresourceRange.layerCount = texture->num_layers;
+				}
+			}
+
+			return num_barriers;
+		}
+
+		static VkImageUsageFlags getStorageUsageFlags(const Context *context, VkFormat format)
+		{
+			VkFormatProperties properties;
+			vkGetPhysicalDeviceFormatProperties(context->getPhysicalDevice(), format, &properties);
+
+			if ((properties.optimalTilingFeatures & VK_FORMAT_FEATURE_STORAGE_IMAGE_BIT) == 0)
+				return 0;
+
+			return VK_IMAGE_USAGE_STORAGE_BIT;
+		}
+
 		static void createTextureData(const Context *context, Texture *texture, Format format, const void *data, int num_data_mipmaps, int num_data_layers)
 		{
 			VkImageUsageFlags usage_flags = Utils::getImageUsageFlags(texture->format);
 
+			// empty color textures are render targets, they can be written by compute shaders as well
+			bool is_color = (usage_flags & VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT) != 0;
+			if (data == nullptr && is_color && texture->samples == VK_SAMPLE_COUNT_1_BIT)
+				usage_flags |= getStorageUsageFlags(context, texture->format);
+
 			Utils::createImage(
 				context,
 				texture->type,
@@ -882,6 +955,42 @@ namespace scapes::visual::hardware::vulkan
 		return reinterpret_cast<hardware::UniformBuffer>(result);
 	}
 
+	hardware::StorageBuffer Device::createStorageBuffer(
+		BufferType type,
+		uint32_t size,
+		const void *data
+	)
+	{
+		assert(size != 0 && "Invalid size");
+
+		StorageBuffer *result = new StorageBuffer();
+		result->type = type;
+		result->size = size;
+
+		VkBufferUsageFlags usage_flags = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT;
+		VmaMemoryUsage memory_usage = VMA_MEMORY_USAGE_UNKNOWN;
+
+		if (type == BufferType::STATIC)
+		{
+			usage_flags |= VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+			memory_usage = VMA_MEMORY_USAGE_GPU_ONLY;
+		}
+		else if (type == BufferType::DYNAMIC)
+			memory_usage = VMA_MEMORY_USAGE_CPU_TO_GPU;
+
+		Utils::createBuffer(context, size, usage_flags, memory_usage, result->buffer, result->memory);
+
+		if (data)
+		{
+			if (type == BufferType::STATIC)
+				Utils::fillDeviceLocalBuffer(context, result->buffer, size, data);
+			else if (type == BufferType::DYNAMIC)
+				Utils::fillHostVisibleBuffer(context, result->memory, size, data);
+		}
+
+		return reinterpret_cast<hardware::StorageBuffer>(result);
+	}
+
 	hardware::Shader Device::createShaderFromSource(
 		ShaderType type,
 		uint32_t size,
@@ -931,6 +1040,14 @@ namespace scapes::visual::hardware::vulkan
 		return reinterpret_cast<hardware::GraphicsPipeline>(result);
 	}
 
+	hardware::ComputePipeline Device::createComputePipeline()
+	{
+		ComputePipeline *result = new ComputePipeline();
+		memset(result, 0, sizeof(ComputePipeline));
+
+		return reinterpret_cast<hardware::ComputePipeline>(result);
+	}
+
 	hardware::BottomLevelAccelerationStructure Device::createBottomLevelAccelerationStructure(
 		uint32_t num_geometries,
 		const AccelerationStructureGeometry *geometries
@@ -1299,6 +1416,22 @@ namespace scapes::visual::hardware::vulkan
 		vk_uniform_buffer = nullptr;
 	}
 
+	void Device::destroyStorageBuffer(hardware::StorageBuffer storage_buffer)
+	{
+		if (storage_buffer == SCAPES_NULL_HANDLE)
+			return;
+
+		StorageBuffer *vk_storage_buffer = reinterpret_cast<StorageBuffer *>(storage_buffer);
+
+		vmaDestroyBuffer(context->getVRAMAllocator(), vk_storage_buffer->buffer, vk_storage_buffer->memory);
+
+		vk_storage_buffer->buffer = VK_NULL_HANDLE;
+		vk_storage_buffer->memory = VK_NULL_HANDLE;
+
+		delete vk_storage_buffer;
+		vk_storage_buffer = nullptr;
+	}
+
 	void Device::destroyShader(hardware::Shader shader)
 	{
 		if (shader == SCAPES_NULL_HANDLE)
@@ -1350,6 +1483,17 @@ namespace scapes::visual::hardware::vulkan
 		vk_graphics_pipeline = nullptr;
 	}
 
+	void Device::destroyComputePipeline(hardware::ComputePipeline pipeline)
+	{
+		if (pipeline == SCAPES_NULL_HANDLE)
+			return;
+
+		ComputePipeline *vk_compute_pipeline = reinterpret_cast<ComputePipeline *>(pipeline);
+
+		delete vk_compute_pipeline;
+		vk_compute_pipeline = nullptr;
+	}
+
 	void Device::destroyBottomLevelAccelerationStructure(hardware::BottomLevelAccelerationStructure acceleration_structure)
 	{
 		if (acceleration_structure == SCAPES_NULL_HANDLE)
@@ -1547,6 +1691,41 @@ namespace scapes::visual::hardware::vulkan
 		vmaUnmapMemory(context->getVRAMAllocator(), vk_index_buffer->memory);
 	}
 
+	void Device::update(hardware::VertexBuffer vertex_buffer, uint32_t first_vertex, uint32_t num_vertices, const void *data)
+	{
+		assert(vertex_buffer != SCAPES_NULL_HANDLE && "Invalid buffer");
+		assert(data);
+
+		VertexBuffer *vk_vertex_buffer = reinterpret_cast<VertexBuffer *>(vertex_buffer);
+		assert(first_vertex + num_vertices <= vk_vertex_buffer->num_vertices && "Range is out of buffer bounds");
+
+		VkDeviceSize size = static_cast<VkDeviceSize>(vk_vertex_buffer->vertex_size) * num_vertices;
+		VkDeviceSize offset = static_cast<VkDeviceSize>(vk_vertex_buffer->vertex_size) * first_vertex;
+
+		if (vk_vertex_buffer->type == BufferType::STATIC)
+			Utils::fillDeviceLocalBuffer(context, vk_vertex_buffer->buffer, size, data, offset);
+		else if (vk_vertex_buffer->type == BufferType::DYNAMIC)
+			Utils::fillHostVisibleBuffer(context, vk_vertex_buffer->memory, size, data, offset);
+	}
+
+	void Device::update(hardware::IndexBuffer index_buffer, uint32_t first_index, uint32_t num_indices, const void *data)
+	{
+		assert(index_buffer != SCAPES_NULL_HANDLE && "Invalid buffer");
+		assert(data);
+
+		IndexBuffer *vk_index_buffer = reinterpret_cast<IndexBuffer *>(index_buffer);
+		assert(first_index + num_indices <= vk_index_buffer->num_indices && "Range is out of buffer bounds");
+
+		VkDeviceSize index_size = (vk_index_buffer->index_type == VK_INDEX_TYPE_UINT16) ? sizeof(uint16_t) : sizeof(uint32_t);
+		VkDeviceSize size = index_size * num_indices;
+		VkDeviceSize offset = index_size * first_index;
+
+		if (vk_index_buffer->type == BufferType::STATIC)
+			Utils::fillDeviceLocalBuffer(context, vk_index_buffer->buffer, size, data, offset);
+		else if (vk_index_buffer->type == BufferType::DYNAMIC)
+			Utils::fillHostVisibleBuffer(context, vk_index_buffer->memory, size, data, offset);
+	}
+
 	void *Device::map(hardware::UniformBuffer uniform_buffer)
 	{
 		assert(uniform_buffer != SCAPES_NULL_HANDLE && "Invalid uniform buffer");
@@ -1573,6 +1752,32 @@ namespace scapes::visual::hardware::vulkan
 		vmaUnmapMemory(context->getVRAMAllocator(), vk_uniform_buffer->memory);
 	}
 
+	void *Device::map(hardware::StorageBuffer storage_buffer)
+	{
+		assert(storage_buffer != SCAPES_NULL_HANDLE && "Invalid storage buffer");
+
+		StorageBuffer *vk_storage_buffer = reinterpret_cast<StorageBuffer *>(storage_buffer);
+		assert(vk_storage_buffer->type == BufferType::DYNAMIC && "Mapped buffer must have BufferType::DYNAMIC type");
+
+		void *result = nullptr;
+		if (vmaMapMemory(context->getVRAMAllocator(), vk_storage_buffer->memory, &result) != VK_SUCCESS)
+		{
+			// TODO: log error
+		}
+
+		return result;
+	}
+
+	void Device::unmap(hardware::StorageBuffer storage_buffer)
+	{
+		assert(storage_buffer != SCAPES_NULL_HANDLE && "Invalid buffer");
+
+		StorageBuffer *vk_storage_buffer = reinterpret_cast<StorageBuffer *>(storage_buffer);
+		assert(vk_storage_buffer->type == BufferType::DYNAMIC && "Mapped buffer must have BufferType::DYNAMIC type");
+
+		vmaUnmapMemory(context->getVRAMAllocator(), vk_storage_buffer->memory);
+	}
+
 	/*
 	 */
 	void Device::flush(hardware::BindSet bind_set)
@@ -1637,6 +1842,17 @@ namespace scapes::visual::hardware::vulkan
 					write_set.pBufferInfo = &buffer_infos[buffer_size - 1];
 				}
 				break;
+				case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER:
+				{
+					VkDescriptorBufferInfo info = {};
+					info.buffer = data.ssbo.buffer;
+					info.offset = data.ssbo.offset;
+					info.range = data.ssbo.size;
+
+					buffer_infos[buffer_size++] = info;
+					write_set.pBufferInfo = &buffer_infos[buffer_size - 1];
+				}
+				break;
 				case VK_DESCRIPTOR_TYPE_ACCELERATION_STRUCTURE_KHR:
 				{
 					VkWriteDescriptorSetAccelerationStructureKHR info = {};
@@ -1687,6 +1903,26 @@ namespace scapes::visual::hardware::vulkan
 			vk_graphics_pipeline->pipeline = pipeline_cache->fetch(vk_graphics_pipeline->pipeline_layout, vk_graphics_pipeline);
 	}
 
+	void Device::flush(hardware::ComputePipeline compute_pipeline)
+	{
+		if (compute_pipeline == SCAPES_NULL_HANDLE)
+			return;
+
+		ComputePipeline *vk_compute_pipeline = reinterpret_cast<ComputePipeline *>(compute_pipeline);
+
+		for (uint32_t i = 0; i < vk_compute_pipeline->num_bind_sets; ++i)
+			flush(reinterpret_cast<hardware::BindSet>(vk_compute_pipeline->bind_sets[i]));
+
+		if (vk_compute_pipeline->pipeline_layout == VK_NULL_HANDLE)
+		{
+			vk_compute_pipeline->pipeline_layout = pipeline_layout_cache->fetch(vk_compute_pipeline);
+			vk_compute_pipeline->pipeline = VK_NULL_HANDLE;
+		}
+
+		if (vk_compute_pipeline->pipeline == VK_NULL_HANDLE)
+			vk_compute_pipeline->pipeline = pipeline_cache->fetch(vk_compute_pipeline->pipeline_layout, vk_compute_pipeline);
+	}
+
 	void Device::flush(hardware::RayTracePipeline raytrace_pipeline)
 	{
 		if (raytrace_pipeline == SCAPES_NULL_HANDLE)
@@ -1952,6 +2188,46 @@ namespace scapes::visual::hardware::vulkan
 		info.pImmutableSamplers = nullptr;
 	}
 
+	void Device::bindStorageBuffer(
+		hardware::BindSet bind_set,
+		uint32_t binding,
+		hardware::StorageBuffer storage_buffer
+	)
+	{
+		assert(binding < BindSet::MAX_BINDINGS);
+
+		if (bind_set == SCAPES_NULL_HANDLE)
+			return;
+
+		BindSet *vk_bind_set = reinterpret_cast<BindSet *>(bind_set);
+		StorageBuffer *vk_storage_buffer = reinterpret_cast<StorageBuffer *>(storage_buffer);
+
+		VkDescriptorSetLayoutBinding &info = vk_bind_set->bindings[binding];
+		BindSet::Data &data = vk_bind_set->binding_data[binding];
+
+		VkBuffer buffer = (vk_storage_buffer) ? vk_storage_buffer->buffer : VK_NULL_HANDLE;
+		uint32_t size = (vk_storage_buffer) ? vk_storage_buffer->size : 0;
+
+		bool buffer_changed = (data.ssbo.buffer != buffer) || (data.ssbo.size != size);
+		bool type_changed = (info.descriptorType != VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
+
+		vk_bind_set->binding_used[binding] = (vk_storage_buffer != nullptr);
+		vk_bind_set->binding_dirty[binding] = type_changed || buffer_changed;
+
+		if (vk_storage_buffer == nullptr)
+			return;
+
+		data.ssbo.buffer = buffer;
+		data.ssbo.size = size;
+		data.ssbo.offset = 0;
+
+		info.binding = binding;
+		info.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+		info.descriptorCount = 1;
+		info.stageFlags = VK_SHADER_STAGE_ALL; // TODO: allow for different shader stages
+		info.pImmutableSamplers = nullptr;
+	}
+
 	void Device::bindTexture(
 		hardware::BindSet bind_set,
 		uint32_t binding,
@@ -2084,7 +2360,7 @@ namespace scapes::visual::hardware::vulkan
 		if (vk_texture)
 		{
 			view = vk_texture->image_view_cache->fetch(vk_texture);
-			layout = vk_texture->layout;
+			layout = VK_IMAGE_LAYOUT_GENERAL; // only layout valid for shader writes
 		}
 
 		bool texture_changed = (data.texture.view != view);
@@ -2092,7 +2368,8 @@ namespace scapes::visual::hardware::vulkan
 		bool layout_changed = (data.texture.layout != layout);
 
 		vk_bind_set->binding_used[binding] = (vk_texture != nullptr);
-		vk_bind_set->binding_dirty[binding] = type_changed || texture_changed;
+		vk_bind_set->binding_dirty[binding] = type_changed || texture_changed || layout_changed;
+		vk_bind_set->storage_images[binding] = vk_texture;
 
 		data.texture.view = view;
 		data.texture.sampler = VK_NULL_HANDLE;
@@ -2105,6 +2382,87 @@ namespace scapes::visual::hardware::vulkan
 		info.pImmutableSamplers = nullptr;
 	}
 
+	/*
+	 */
+	// compute pipeline state
+	void Device::clearPushConstants(hardware::ComputePipeline compute_pipeline)
+	{
+		if (compute_pipeline == SCAPES_NULL_HANDLE)
+			return;
+
+		ComputePipeline *vk_compute_pipeline = reinterpret_cast<ComputePipeline *>(compute_pipeline);
+
+		vk_compute_pipeline->push_constants_size = 0;
+		memset(vk_compute_pipeline->push_constants, 0, ComputePipeline::MAX_PUSH_CONSTANT_SIZE);
+
+		// TODO: better invalidation (there might be case where we only need to invalidate pipeline but keep pipeline layout)
+		vk_compute_pipeline->pipeline_layout = VK_NULL_HANDLE;
+	}
+
+	void Device::setPushConstants(hardware::ComputePipeline compute_pipeline, uint8_t size, const void *data)
+	{
+		assert(size <= ComputePipeline::MAX_PUSH_CONSTANT_SIZE);
+
+		if (compute_pipeline == SCAPES_NULL_HANDLE)
+			return;
+
+		ComputePipeline *vk_compute_pipeline = reinterpret_cast<ComputePipeline *>(compute_pipeline);
+
+		// only the layout depends on the size, new values alone don't need a new pipeline
+		if (vk_compute_pipeline->push_constants_size != size)
+			vk_compute_pipeline->pipeline_layout = VK_NULL_HANDLE;
+
+		vk_compute_pipeline->push_constants_size = size;
+		memcpy(vk_compute_pipeline->push_constants, data, size);
+	}
+
+	void Device::clearBindSets(hardware::ComputePipeline compute_pipeline)
+	{
+		if (compute_pipeline == SCAPES_NULL_HANDLE)
+			return;
+
+		ComputePipeline *vk_compute_pipeline = reinterpret_cast<ComputePipeline *>(compute_pipeline);
+
+		for (uint32_t i = 0; i < ComputePipeline::MAX_BIND_SETS; ++i)
+			vk_compute_pipeline->bind_sets[i] = nullptr;
+
+		vk_compute_pipeline->num_bind_sets = 0;
+
+		// TODO: better invalidation (there might be case where we only need to invalidate pipeline but keep pipeline layout)
+		vk_compute_pipeline->pipeline_layout = VK_NULL_HANDLE;
+	}
+
+	void Device::setBindSet(hardware::ComputePipeline compute_pipeline, uint8_t binding, hardware::BindSet bind_set)
+	{
+		assert(binding < ComputePipeline::MAX_BIND_SETS);
+
+		if (compute_pipeline == SCAPES_NULL_HANDLE)
+			return;
+
+		ComputePipeline *vk_compute_pipeline = reinterpret_cast<ComputePipeline *>(compute_pipeline);
+		BindSet *vk_bind_set = reinterpret_cast<BindSet *>(bind_set);
+
+		vk_compute_pipeline->bind_sets[binding] = vk_bind_set;
+		vk_compute_pipeline->num_bind_sets = std::max<uint32_t>(vk_compute_pipeline->num_bind_sets, binding + 1);
+
+		// TODO: better invalidation (there might be case where we only need to invalidate pipeline but keep pipeline layout)
+		vk_compute_pipeline->pipeline_layout = VK_NULL_HANDLE;
+	}
+
+	void Device::setShader(hardware::ComputePipeline compute_pipeline, hardware::Shader shader)
+	{
+		if (compute_pipeline == SCAPES_NULL_HANDLE)
+			return;
+
+		ComputePipeline *vk_compute_pipeline = reinterpret_cast<ComputePipeline *>(compute_pipeline);
+		Shader *vk_shader = reinterpret_cast<Shader *>(shader);
+
+		assert(vk_shader == nullptr || vk_shader->type == ShaderType::COMPUTE);
+
+		vk_compute_pipeline->shader = (vk_shader) ? vk_shader->module : VK_NULL_HANDLE;
+		vk_compute_pipeline->pipeline = VK_NULL_HANDLE;
+	}
+
 	/*
 	 */
 	// raytrace pipeline state
@@ -2363,7 +2721,10 @@ namespace scapes::visual::hardware::vulkan
 		GraphicsPipeline *vk_graphics_pipeline = reinterpret_cast<GraphicsPipeline *>(graphics_pipeline);
 
 		for (uint32_t i = 0; i < GraphicsPipeline::MAX_VERTEX_STREAMS; ++i)
+		{
 			vk_graphics_pipeline->vertex_streams[i] = nullptr;
+			vk_graphics_pipeline->vertex_stream_rates[i] = VK_VERTEX_INPUT_RATE_VERTEX;
+		}
 
 		vk_graphics_pipeline->num_vertex_streams = 0;
 
@@ -2371,7 +2732,7 @@ namespace scapes::visual::hardware::vulkan
 		vk_graphics_pipeline->pipeline_layout = VK_NULL_HANDLE;
 	}
 
-	void Device::setVertexStream(hardware::GraphicsPipeline graphics_pipeline, uint8_t binding, hardware::VertexBuffer vertex_buffer)
+	void Device::setVertexStream(hardware::GraphicsPipeline graphics_pipeline, uint8_t binding, hardware::VertexBuffer vertex_buffer, VertexInputRate input_rate)
 	{
 		assert(binding < GraphicsPipeline::MAX_VERTEX_STREAMS);
 
@@ -2382,6 +2743,7 @@ namespace scapes::visual::hardware::vulkan
 		VertexBuffer *vk_vertex_buffer = reinterpret_cast<VertexBuffer *>(vertex_buffer);
 
 		vk_graphics_pipeline->vertex_streams[binding] = vk_vertex_buffer;
+		vk_graphics_pipeline->vertex_stream_rates[binding] = Utils::getVertexInputRate(input_rate);
 		vk_graphics_pipeline->num_vertex_streams = std::max<uint32_t>(vk_graphics_pipeline->num_vertex_streams, binding + 1);
 
 		// TODO: better invalidation (there might be case where we only need to invalidate pipeline but keep pipeline layout)
@@ -2677,6 +3039,8 @@ namespace scapes::visual::hardware::vulkan
 		vk_command_buffer->render_pass = vk_render_pass->render_pass;
 		vk_command_buffer->max_samples = vk_render_pass->max_samples;
 		vk_command_buffer->num_color_attachments = vk_render_pass->num_color_attachments;
+		vk_command_buffer->num_vertex_streams = 0;
+		vk_command_buffer->index_buffer = VK_NULL_HANDLE;
 
 		VkRenderPassBeginInfo render_pass_info = {};
 		render_pass_info.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
@@ -2708,6 +3072,8 @@ namespace scapes::visual::hardware::vulkan
 		vk_command_buffer->render_pass = vk_render_pass->render_pass;
 		vk_command_buffer->max_samples = vk_render_pass->max_samples;
 		vk_command_buffer->num_color_attachments = vk_render_pass->num_color_attachments;
+		vk_command_buffer->num_vertex_streams = 0;
+		vk_command_buffer->index_buffer = VK_NULL_HANDLE;
 
 		VkRenderPassBeginInfo render_pass_info = {};
 		render_pass_info.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
@@ -2751,13 +3117,151 @@ namespace scapes::visual::hardware::vulkan
 		GraphicsPipeline *vk_graphics_pipeline = reinterpret_cast<GraphicsPipeline *>(graphics_pipeline);
 		IndexBuffer *vk_index_buffer = reinterpret_cast<IndexBuffer *>(index_buffer);
 
+		bindGraphicsState(vk_command_buffer, vk_graphics_pipeline, vk_index_buffer);
+
+		vkCmdDrawIndexed(vk_command_buffer->command_buffer, num_indices, num_instances, base_index, base_vertex, base_instance);
+	}
+
+	void Device::drawIndexedIndirect(
+		hardware::CommandBuffer command_buffer,
+		hardware::GraphicsPipeline graphics_pipeline,
+		hardware::IndexBuffer index_buffer,
+		hardware::StorageBuffer commands,
+		uint32_t offset,
+		uint32_t num_draws
+	)
+	{
+		SCAPES_PROFILER();
+
+		if (command_buffer == SCAPES_NULL_HANDLE)
+			return;
+
+		CommandBuffer *vk_command_buffer = reinterpret_cast<CommandBuffer *>(command_buffer);
+		GraphicsPipeline *vk_graphics_pipeline = reinterpret_cast<GraphicsPipeline *>(graphics_pipeline);
+		IndexBuffer *vk_index_buffer = reinterpret_cast<IndexBuffer *>(index_buffer);
+		StorageBuffer *vk_commands = reinterpret_cast<StorageBuffer *>(commands);
+
+		assert(vk_commands);
+		assert(offset + num_draws * sizeof(VkDrawIndexedIndirectCommand) <= vk_commands->size);
+
+		bindGraphicsState(vk_command_buffer, vk_graphics_pipeline, vk_index_buffer);
+
+		constexpr uint32_t stride = sizeof(VkDrawIndexedIndirectCommand);
+
+		if (context->hasMultiDrawIndirect())
+		{
+			vkCmdDrawIndexedIndirect(vk_command_buffer->command_buffer, vk_commands->buffer, offset, num_draws, stride);
+			return;
+		}
+
+		for (uint32_t i = 0; i < num_draws; ++i)
+			vkCmdDrawIndexedIndirect(vk_command_buffer->command_buffer, vk_commands->buffer, offset + i * stride, 1, stride);
+	}
+
+	void Device::drawIndexedIndirectCount(
+		hardware::CommandBuffer command_buffer,
+		hardware::GraphicsPipeline graphics_pipeline,
+		hardware::IndexBuffer index_buffer,
+		hardware::StorageBuffer commands,
+		uint32_t offset,
+		hardware::StorageBuffer count_buffer,
+		uint32_t count_offset,
+		uint32_t max_draws
+	)
+	{
+		SCAPES_PROFILER();
+
+		if (command_buffer == SCAPES_NULL_HANDLE)
+			return;
+
+		if (!context->hasDrawIndirectCount())
+		{
+			foundation::Log::error("Device::drawIndexedIndirectCount(): drawIndirectCount feature is not supported\n");
+			return;
+		}
+
+		CommandBuffer *vk_command_buffer = reinterpret_cast<CommandBuffer *>(command_buffer);
+		GraphicsPipeline *vk_graphics_pipeline = reinterpret_cast<GraphicsPipeline *>(graphics_pipeline);
+		IndexBuffer *vk_index_buffer = reinterpret_cast<IndexBuffer *>(index_buffer);
+		StorageBuffer *vk_commands = reinterpret_cast<StorageBuffer *>(commands);
+		StorageBuffer *vk_count_buffer = reinterpret_cast<StorageBuffer *>(count_buffer);
+
+		assert(vk_commands);
+		assert(vk_count_buffer);
+		assert(offset + max_draws * sizeof(VkDrawIndexedIndirectCommand) <= vk_commands->size);
+		assert(count_offset + sizeof(uint32_t) <= vk_count_buffer->size);
+
+		bindGraphicsState(vk_command_buffer, vk_graphics_pipeline, vk_index_buffer);
+
+		vkCmdDrawIndexedIndirectCount(
+			vk_command_buffer->command_buffer,
+			vk_commands->buffer,
+			offset,
+			vk_count_buffer->buffer,
+			count_offset,
+			max_draws,
+			sizeof(VkDrawIndexedIndirectCommand)
+		);
+	}
+
+	void Device::dispatch(
+		hardware::CommandBuffer command_buffer,
+		hardware::ComputePipeline compute_pipeline,
+		uint32_t num_groups_x,
+		uint32_t num_groups_y,
+		uint32_t num_groups_z
+	)
+	{
+		SCAPES_PROFILER();
+
+		if (command_buffer == SCAPES_NULL_HANDLE)
+			return;
+
+		CommandBuffer *vk_command_buffer = reinterpret_cast<CommandBuffer *>(command_buffer);
+		ComputePipeline *vk_compute_pipeline = reinterpret_cast<ComputePipeline *>(compute_pipeline);
+
+		bindComputeState(vk_command_buffer, vk_compute_pipeline);
+
+		vkCmdDispatch(vk_command_buffer->command_buffer, num_groups_x, num_groups_y, num_groups_z);
+
+		releaseComputeState(vk_command_buffer, vk_compute_pipeline);
+	}
+
+	void Device::dispatchIndirect(
+		hardware::CommandBuffer command_buffer,
+		hardware::ComputePipeline compute_pipeline,
+		hardware::StorageBuffer commands,
+		uint32_t offset
+	)
+	{
+		SCAPES_PROFILER();
+
+		if (command_buffer == SCAPES_NULL_HANDLE)
+			return;
+
+		CommandBuffer *vk_command_buffer = reinterpret_cast<CommandBuffer *>(command_buffer);
+		ComputePipeline *vk_compute_pipeline = reinterpret_cast<ComputePipeline *>(compute_pipeline);
+		StorageBuffer *vk_commands = reinterpret_cast<StorageBuffer *>(commands);
+
+		assert(vk_commands);
+		assert(offset + sizeof(VkDispatchIndirectCommand) <= vk_commands->size);
+
+		bindComputeState(vk_command_buffer, vk_compute_pipeline);
+
+		vkCmdDispatchIndirect(vk_command_buffer->command_buffer, vk_commands->buffer, offset);
+
+		releaseComputeState(vk_command_buffer, vk_compute_pipeline);
+	}
+
+	void Device::bindGraphicsState(CommandBuffer *vk_command_buffer, GraphicsPipeline *vk_graphics_pipeline, IndexBuffer *vk_index_buffer)
+	{
 		assert(vk_command_buffer->render_pass != VK_NULL_HANDLE);
 
 		vk_graphics_pipeline->render_pass = vk_command_buffer->render_pass;
 		vk_graphics_pipeline->num_color_attachments = vk_command_buffer->num_color_attachments;
 		vk_graphics_pipeline->max_samples = vk_command_buffer->max_samples;
 
-		flush(graphics_pipeline);
+		flush(reinterpret_cast<hardware::GraphicsPipeline>(vk_graphics_pipeline));
 
 		SCAPES_PROFILER_N("Actual draw call");
 
@@ -2785,22 +3289,112 @@ namespace scapes::visual::hardware::vulkan
 
 		if (vk_graphics_pipeline->num_vertex_streams > 0)
 		{
-			VkBuffer vertex_buffers[GraphicsPipeline::MAX_VERTEX_STREAMS];
-			VkDeviceSize offsets[GraphicsPipeline::MAX_VERTEX_STREAMS];
+			uint32_t num_vertex_streams = vk_graphics_pipeline->num_vertex_streams;
+			bool bound = (num_vertex_streams <= vk_command_buffer->num_vertex_streams);
 
-			for (uint32_t i = 0; i < vk_graphics_pipeline->num_vertex_streams; ++i)
+			for (uint32_t i = 0; bound && i < num_vertex_streams; ++i)
+				bound = (vk_command_buffer->vertex_streams[i] == vk_graphics_pipeline->vertex_streams[i]->buffer);
+
+			if (!bound)
 			{
-				vertex_buffers[i] = vk_graphics_pipeline->vertex_streams[i]->buffer;
-				offsets[i] = 0;
-			}
+				VkBuffer vertex_buffers[GraphicsPipeline::MAX_VERTEX_STREAMS];
+				VkDeviceSize offsets[GraphicsPipeline::MAX_VERTEX_STREAMS];
 
-			vkCmdBindVertexBuffers(vk_command_buffer->command_buffer, 0, vk_graphics_pipeline->num_vertex_streams, vertex_buffers, offsets);
+				for (uint32_t i = 0; i < num_vertex_streams; ++i)
+				{
+					vertex_buffers[i] = vk_graphics_pipeline->vertex_streams[i]->buffer;
+					offsets[i] = 0;
+
+					vk_command_buffer->vertex_streams[i] = vertex_buffers[i];
+				}
+
+				vk_command_buffer->num_vertex_streams = std::max(vk_command_buffer->num_vertex_streams, num_vertex_streams);
+
+				vkCmdBindVertexBuffers(vk_command_buffer->command_buffer, 0, num_vertex_streams, vertex_buffers, offsets);
+			}
 		}
 
 		if (vk_index_buffer)
-			vkCmdBindIndexBuffer(vk_command_buffer->command_buffer, vk_index_buffer->buffer, 0, vk_index_buffer->index_type);
+		{
+			bool bound = (vk_command_buffer->index_buffer == vk_index_buffer->buffer) && (vk_command_buffer->index_type == vk_index_buffer->index_type);
 
-		vkCmdDrawIndexed(vk_command_buffer->command_buffer, num_indices, num_instances, base_index, base_vertex, base_instance);
+			if (!bound)
+			{
+				vk_command_buffer->index_buffer = vk_index_buffer->buffer;
+				vk_command_buffer->index_type = vk_index_buffer->index_type;
+
+				vkCmdBindIndexBuffer(vk_command_buffer->command_buffer, vk_index_buffer->buffer, 0, vk_index_buffer->index_type);
+			}
+		}
+	}
+
+	void Device::bindComputeState(CommandBuffer *vk_command_buffer, ComputePipeline *vk_compute_pipeline)
+	{
+		assert(vk_command_buffer->render_pass == VK_NULL_HANDLE);
+		assert(vk_compute_pipeline->shader != VK_NULL_HANDLE);
+
+		flush(reinterpret_cast<hardware::ComputePipeline>(vk_compute_pipeline));
+
+		VkPipeline pipeline = vk_compute_pipeline->pipeline;
+		VkPipelineLayout pipeline_layout = vk_compute_pipeline->pipeline_layout;
+
+		vkCmdBindPipeline(vk_command_buffer->command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline);
+
+		if (vk_compute_pipeline->push_constants_size > 0)
+			vkCmdPushConstants(vk_command_buffer->command_buffer, pipeline_layout, VK_SHADER_STAGE_ALL, 0, vk_compute_pipeline->push_constants_size, vk_compute_pipeline->push_constants);
+
+		if (vk_compute_pipeline->num_bind_sets > 0)
+		{
+			VkDescriptorSet sets[ComputePipeline::MAX_BIND_SETS];
+			for (uint32_t i = 0; i < vk_compute_pipeline->num_bind_sets; ++i)
+				sets[i] = vk_compute_pipeline->bind_sets[i]->set;
+
+			vkCmdBindDescriptorSets(vk_command_buffer->command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline_layout, 0, vk_compute_pipeline->num_bind_sets, sets, 0, nullptr);
+		}
+
+		VkImageMemoryBarrier image_barriers[ComputePipeline::MAX_LAYOUT_TRANSITIONS];
+		uint32_t num_image_barriers = helpers::getStorageImageTransitions(vk_compute_pipeline, true, image_barriers);
+
+		for (uint32_t i = 0; i < num_image_barriers; ++i)
+		{
+			image_barriers[i].srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+			image_barriers[i].dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+		}
+
+		// previous passes may still write what this dispatch reads, or read what it is about to overwrite
+		helpers::pipelineBarrier(
+			vk_command_buffer->command_buffer,
+			VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT |
+			VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+			VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+			VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+			VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT,
+			num_image_barriers,
+			image_barriers
+		);
+	}
+
+	void Device::releaseComputeState(CommandBuffer *vk_command_buffer, ComputePipeline *vk_compute_pipeline)
+	{
+		VkImageMemoryBarrier image_barriers[ComputePipeline::MAX_LAYOUT_TRANSITIONS];
+		uint32_t num_image_barriers = helpers::getStorageImageTransitions(vk_compute_pipeline, false, image_barriers);
+
+		for (uint32_t i = 0; i < num_image_barriers; ++i)
+		{
+			image_barriers[i].srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+			image_barriers[i].dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+		}
+
+		helpers::pipelineBarrier(
+			vk_command_buffer->command_buffer,
+			VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+			VK_ACCESS_SHADER_WRITE_BIT,
+			VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT |
+			VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+			VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT,
+			num_image_barriers,
+			image_barriers
+		);
 	}
 
 	void Device::traceRays(
@@ -108,6 +108,17 @@ namespace scapes::visual::hardware::vulkan
 		VkRenderPass render_pass {VK_NULL_HANDLE};
 		VkSampleCountFlagBits max_samples {VK_SAMPLE_COUNT_1_BIT};
 		uint32_t num_color_attachments {0};
+
+		// geometry bound in the current render pass, draws sharing the same buffers skip rebinding them
+		enum
+		{
+			MAX_VERTEX_STREAMS = 16,
+		};
+
+		VkBuffer vertex_streams[MAX_VERTEX_STREAMS];
+		uint32_t num_vertex_streams {0};
+		VkBuffer index_buffer {VK_NULL_HANDLE};
+		VkIndexType index_type {VK_INDEX_TYPE_UINT16};
 	};
 
 	struct UniformBuffer
@@ -119,6 +130,18 @@ namespace scapes::visual::hardware::vulkan
 		// TODO: static / dynamic fields
 	};
 
+	struct StorageBuffer
+	{
+		BufferType type {BufferType::STATIC};
+		VkBuffer buffer {VK_NULL_HANDLE};
+		VmaAllocation memory {VK_NULL_HANDLE};
+		uint32_t size {0};
+	};
+
+	// TODO: move to sanity check
+	static_assert(sizeof(VkDrawIndexedIndirectCommand) == sizeof(DrawIndexedIndirectCommand));
+	static_assert(sizeof(VkDispatchIndirectCommand) == sizeof(DispatchIndirectCommand));
+
 	struct Shader
 	{
 		ShaderType type {ShaderType::FRAGMENT};
@@ -146,6 +169,12 @@ namespace scapes::visual::hardware::vulkan
 				uint32_t offset;
 				uint32_t size;
 			} ubo;
+			struct SSBO
+			{
+				VkBuffer buffer;
+				uint32_t offset;
+				uint32_t size;
+			} ssbo;
 			struct TLAS
 			{
 				VkAccelerationStructureKHR acceleration_structure;
@@ -159,6 +188,9 @@ namespace scapes::visual::hardware::vulkan
 		Data binding_data[MAX_BINDINGS];
 		bool binding_used[MAX_BINDINGS];
 		bool binding_dirty[MAX_BINDINGS];
+
+		// storage images are accessed in GENERAL layout, dispatches move them there and back
+		Texture *storage_images[MAX_BINDINGS];
 	};
 
 	struct GraphicsPipeline
@@ -194,6 +226,7 @@ namespace scapes::visual::hardware::vulkan
 		uint8_t num_bind_sets {0};
 
 		VertexBuffer *vertex_streams[MAX_VERTEX_STREAMS]; // TODO: make this safer
+		VkVertexInputRate vertex_stream_rates[MAX_VERTEX_STREAMS];
 		uint8_t num_vertex_streams {0};
 
 		VkShaderModule shaders[MAX_SHADERS];
@@ -209,7 +242,30 @@ namespace scapes::visual::hardware::vulkan
 		// TODO: pipeline caches here
 		// IDEA: get rid of pipeline layout cache, recreate layout if needed and be happy
 	};
-	
+
+	struct ComputePipeline
+	{
+		enum
+		{
+			MAX_BIND_SETS = 16,
+			MAX_PUSH_CONSTANT_SIZE = 128, // TODO: use HW device capabilities for upper limit
+			MAX_LAYOUT_TRANSITIONS = 32,
+		};
+
+		// resources
+		uint8_t push_constants[MAX_PUSH_CONSTANT_SIZE];
+		uint8_t push_constants_size {0};
+
+		BindSet *bind_sets[MAX_BIND_SETS]; // TODO: make this safer
+		uint8_t num_bind_sets {0};
+
+		VkShaderModule shader {VK_NULL_HANDLE};
+
+		// internal mutable state
+		VkPipeline pipeline {VK_NULL_HANDLE};
+		VkPipelineLayout pipeline_layout {VK_NULL_HANDLE};
+	};
+
 	struct AccelerationStructure
 	{
 		enum
@@ -401,6 +457,12 @@ namespace scapes::visual::hardware::vulkan
 			const void *data = nullptr
 		) final;
 
+		hardware::StorageBuffer createStorageBuffer(
+			BufferType type,
+			uint32_t size,
+			const void *data = nullptr
+		) final;
+
 		hardware::Shader createShaderFromSource(
 			ShaderType type,
 			uint32_t size,
@@ -421,6 +483,9 @@ namespace scapes::visual::hardware::vulkan
 		hardware::GraphicsPipeline createGraphicsPipeline(
 		) final;
 
+		hardware::ComputePipeline createComputePipeline(
+		) final;
+
 		hardware::BottomLevelAccelerationStructure createBottomLevelAccelerationStructure(
 			uint32_t num_geometries,
 			const AccelerationStructureGeometry *geometries
@@ -446,9 +511,11 @@ namespace scapes::visual::hardware::vulkan
 		void destroyRenderPass(hardware::RenderPass render_pass) final;
 		void destroyCommandBuffer(hardware::CommandBuffer command_buffer) final;
 		void destroyUniformBuffer(hardware::UniformBuffer uniform_buffer) final;
+		void destroyStorageBuffer(hardware::StorageBuffer storage_buffer) final;
 		void destroyShader(hardware::Shader shader) final;
 		void destroyBindSet(hardware::BindSet bind_set) final;
 		void destroyGraphicsPipeline(hardware::GraphicsPipeline pipeline) final;
+		void destroyComputePipeline(hardware::ComputePipeline pipeline) final;
 		void destroyBottomLevelAccelerationStructure(hardware::BottomLevelAccelerationStructure acceleration_structure) final;
 		void destroyTopLevelAccelerationStructure(hardware::TopLevelAccelerationStructure acceleration_structure) final;
 		void destroyRayTracePipeline(hardware::RayTracePipeline pipeline) final;
@@ -471,11 +538,18 @@ namespace scapes::visual::hardware::vulkan
 		void *map(hardware::IndexBuffer index_buffer) final;
 		void unmap(hardware::IndexBuffer index_buffer) final;
 
+		void update(hardware::VertexBuffer vertex_buffer, uint32_t first_vertex, uint32_t num_vertices, const void *data) final;
+		void update(hardware::IndexBuffer index_buffer, uint32_t first_index, uint32_t num_indices, const void *data) final;
+
 		void *map(hardware::UniformBuffer uniform_buffer) final;
 		void unmap(hardware::UniformBuffer uniform_buffer) final;
 
+		void *map(hardware::StorageBuffer storage_buffer) final;
+		void unmap(hardware::StorageBuffer storage_buffer) final;
+
 		void flush(hardware::BindSet bind_set) final;
 		void flush(hardware::GraphicsPipeline pipeline) final;
+		void flush(hardware::ComputePipeline pipeline) final;
 		void flush(hardware::RayTracePipeline pipeline) final;
 
 	public:
@@ -504,6 +578,12 @@ namespace scapes::visual::hardware::vulkan
 			hardware::UniformBuffer uniform_buffer
 		) final;
 
+		void bindStorageBuffer(
+			hardware::BindSet bind_set,
+			uint32_t binding,
+			hardware::StorageBuffer storage_buffer
+		) final;
+
 		void bindTexture(
 			hardware::BindSet bind_set,
 			uint32_t binding,
@@ -532,6 +612,33 @@ namespace scapes::visual::hardware::vulkan
 			hardware::Texture texture
 		) final;
 
+	public:
+		// compute pipeline state
+		void clearPushConstants(
+			hardware::ComputePipeline pipeline
+		) final;
+
+		void setPushConstants(
+			hardware::ComputePipeline pipeline,
+			uint8_t size,
+			const void *data
+		) final;
+
+		void clearBindSets(
+			hardware::ComputePipeline pipeline
+		) final;
+
+		void setBindSet(
+			hardware::ComputePipeline pipeline,
+			uint8_t binding,
+			hardware::BindSet bind_set
+		) final;
+
+		void setShader(
+			hardware::ComputePipeline pipeline,
+			hardware::Shader shader
+		) final;
+
 	public:
 		// raytrace pipeline state
 		void clearBindSets(
@@ -612,7 +719,8 @@ namespace scapes::visual::hardware::vulkan
 		void setVertexStream(
 			hardware::GraphicsPipeline pipeline,
 			uint8_t binding,
-			hardware::VertexBuffer vertex_buffer
+			hardware::VertexBuffer vertex_buffer,
+			VertexInputRate input_rate
 		) final;
 
 		void setViewport(
@@ -725,6 +833,41 @@ namespace scapes::visual::hardware::vulkan
 			uint32_t base_instance
 		) final;
 
+		void drawIndexedIndirect(
+			hardware::CommandBuffer command_buffer,
+			hardware::GraphicsPipeline pipeline,
+			hardware::IndexBuffer index_buffer,
+			hardware::StorageBuffer commands,
+			uint32_t offset,
+			uint32_t num_draws
+		) final;
+
+		void drawIndexedIndirectCount(
+			hardware::CommandBuffer command_buffer,
+			hardware::GraphicsPipeline pipeline,
+			hardware::IndexBuffer index_buffer,
+			hardware::StorageBuffer commands,
+			uint32_t offset,
+			hardware::StorageBuffer count_buffer,
+			uint32_t count_offset,
+			uint32_t max_draws
+		) final;
+
+		void dispatch(
+			hardware::CommandBuffer command_buffer,
+			hardware::ComputePipeline pipeline,
+			uint32_t num_groups_x,
+			uint32_t num_groups_y,
+			uint32_t num_groups_z
+		) final;
+
+		void dispatchIndirect(
+			hardware::CommandBuffer command_buffer,
+			hardware::ComputePipeline pipeline,
+			hardware::StorageBuffer commands,
+			uint32_t offset
+		) final;
+
 		void traceRays(
 			hardware::CommandBuffer command_buffer,
 			hardware::RayTracePipeline pipeline,
@@ -734,6 +877,11 @@ namespace scapes::visual::hardware::vulkan
 			uint32_t raygen_shader_index
 		) final;
 
+	private:
+		void bindGraphicsState(CommandBuffer *command_buffer, GraphicsPipeline *graphics_pipeline, IndexBuffer *index_buffer);
+		void bindComputeState(CommandBuffer *command_buffer, ComputePipeline *compute_pipeline);
+		void releaseComputeState(CommandBuffer *command_buffer, ComputePipeline *compute_pipeline);
+
 	private:
 		enum
 		{
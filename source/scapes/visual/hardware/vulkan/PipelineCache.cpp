@@ -79,7 +79,7 @@ namespace scapes::visual::hardware::vulkan
 		{
 			const VertexBuffer *vertex_buffer = graphics_pipeline->vertex_streams[i];
 
-			VkVertexInputBindingDescription input_binding = { i, vertex_buffer->vertex_size, VK_VERTEX_INPUT_RATE_VERTEX };
+			VkVertexInputBindingDescription input_binding = { i, vertex_buffer->vertex_size, graphics_pipeline->vertex_stream_rates[i] };
 			std::vector<VkVertexInputAttributeDescription> attributes(vertex_buffer->num_attributes);
 
 			for (uint8_t j = 0; j < vertex_buffer->num_attributes; ++j)
@@ -261,6 +261,36 @@ namespace scapes::visual::hardware::vulkan
 		return result;
 	}
 
+	VkPipeline PipelineCache::fetch(VkPipelineLayout layout, const ComputePipeline *compute_pipeline)
+	{
+		assert(layout != VK_NULL_HANDLE);
+		assert(compute_pipeline);
+		assert(compute_pipeline->shader != VK_NULL_HANDLE);
+
+		uint64_t hash = getHash(layout, compute_pipeline);
+
+		auto it = compute_pipeline_cache.find(hash);
+		if (it != compute_pipeline_cache.end())
+			return it->second;
+
+		VkComputePipelineCreateInfo create_info = {};
+		create_info.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+		create_info.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+		create_info.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+		create_info.stage.module = compute_pipeline->shader;
+		create_info.stage.pName = "main";
+		create_info.layout = layout;
+
+		VkPipeline result = VK_NULL_HANDLE;
+		if (vkCreateComputePipelines(context->getDevice(), VK_NULL_HANDLE, 1, &create_info, nullptr, &result) != VK_SUCCESS)
+		{
+			// TODO: log error
+		}
+
+		compute_pipeline_cache[hash] = result;
+		return result;
+	}
+
 	void PipelineCache::clear()
 	{
 		for (auto it = graphics_pipeline_cache.begin(); it != graphics_pipeline_cache.end(); ++it)
@@ -269,8 +299,12 @@ namespace scapes::visual::hardware::vulkan
 		for (auto it = raytrace_pipeline_cache.begin(); it != raytrace_pipeline_cache.end(); ++it)
 			vkDestroyPipeline(context->getDevice(), it->second, nullptr);
 
+		for (auto it = compute_pipeline_cache.begin(); it != compute_pipeline_cache.end(); ++it)
+			vkDestroyPipeline(context->getDevice(), it->second, nullptr);
+
 		graphics_pipeline_cache.clear();
 		raytrace_pipeline_cache.clear();
+		compute_pipeline_cache.clear();
 	}
 
 	uint64_t PipelineCache::getHash(VkPipelineLayout layout, const GraphicsPipeline *graphics_pipeline) const
@@ -285,6 +319,9 @@ namespace scapes::visual::hardware::vulkan
 		{
 			const VertexBuffer *vertex_buffer = graphics_pipeline->vertex_streams[i];
 
+			common::HashUtils::combine(hash, vertex_buffer->vertex_size);
+			common::HashUtils::combine(hash, graphics_pipeline->vertex_stream_rates[i]);
+
 			for (uint8_t j = 0; j < vertex_buffer->num_attributes; ++j)
 			{
 				common::HashUtils::combine(hash, vertex_buffer->attribute_formats[j]);
@@ -339,4 +376,15 @@ namespace scapes::visual::hardware::vulkan
 
 		return hash;
 	}
+
+	uint64_t PipelineCache::getHash(VkPipelineLayout layout, const ComputePipeline *compute_pipeline) const
+	{
+		assert(compute_pipeline);
+
+		uint64_t hash = 0;
+		common::HashUtils::combine(hash, layout);
+		common::HashUtils::combine(hash, compute_pipeline->shader);
+
+		return hash;
+	}
 }
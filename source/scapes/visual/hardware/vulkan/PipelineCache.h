@@ -21,11 +21,13 @@ namespace scapes::visual::hardware::vulkan
 
 		VkPipeline fetch(VkPipelineLayout layout, const GraphicsPipeline *graphics_pipeline);
 		VkPipeline fetch(VkPipelineLayout layout, const RayTracePipeline *raytrace_pipeline);
+		VkPipeline fetch(VkPipelineLayout layout, const ComputePipeline *compute_pipeline);
 		void clear();
 
 	private:
 		uint64_t getHash(VkPipelineLayout layout, const RayTracePipeline *raytrace_pipeline) const;
 		uint64_t getHash(VkPipelineLayout layout, const GraphicsPipeline *graphics_pipeline) const;
+		uint64_t getHash(VkPipelineLayout layout, const ComputePipeline *compute_pipeline) const;
 
 	private:
 		const Context *context {nullptr};
@@ -33,5 +35,6 @@ namespace scapes::visual::hardware::vulkan
 
 		std::unordered_map<uint64_t, VkPipeline> graphics_pipeline_cache;
 		std::unordered_map<uint64_t, VkPipeline> raytrace_pipeline_cache;
+		std::unordered_map<uint64_t, VkPipeline> compute_pipeline_cache;
 	};
 }
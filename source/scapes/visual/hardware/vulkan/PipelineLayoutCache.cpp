@@ -51,6 +51,23 @@ namespace scapes::visual::hardware::vulkan
 		return fetch(num_bind_sets, layouts, push_constants_size);
 	}
 
+	VkPipelineLayout PipelineLayoutCache::fetch(const ComputePipeline *compute_pipeline)
+	{
+		uint8_t push_constants_size = compute_pipeline->push_constants_size;
+		uint8_t num_bind_sets = compute_pipeline->num_bind_sets;
+
+		VkDescriptorSetLayout layouts[ComputePipeline::MAX_BIND_SETS];
+		for (uint8_t i = 0; i < num_bind_sets; ++i)
+		{
+			BindSet *bind_set = compute_pipeline->bind_sets[i];
+			assert(bind_set);
+
+			layouts[i] = bind_set->set_layout;
+		}
+
+		return fetch(num_bind_sets, layouts, push_constants_size);
+	}
+
 	void PipelineLayoutCache::clear()
 	{
 		for (auto it = cache.begin(); it != cache.end(); ++it)
@@ -21,6 +21,7 @@ namespace scapes::visual::hardware::vulkan
 
 		VkPipelineLayout fetch(const RayTracePipeline *raytrace_pipeline);
 		VkPipelineLayout fetch(const GraphicsPipeline *graphics_pipeline);
+		VkPipelineLayout fetch(const ComputePipeline *compute_pipeline);
 		void clear();
 
 	private:
@@ -373,6 +373,19 @@ namespace scapes::visual::hardware::vulkan
 		}
 	}
 
+	/*
+	 */
+	VkVertexInputRate Utils::getVertexInputRate(VertexInputRate rate)
+	{
+		static VkVertexInputRate supported_rates[static_cast<int>(VertexInputRate::MAX)] =
+		{
+			VK_VERTEX_INPUT_RATE_VERTEX,
+			VK_VERTEX_INPUT_RATE_INSTANCE,
+		};
+
+		return supported_rates[static_cast<int>(rate)];
+	}
+
 	/*
 	 */
 	VkCullModeFlags Utils::getCullMode(CullMode mode)
@@ -745,7 +758,8 @@ namespace scapes::visual::hardware::vulkan
 		const Context *context,
 		VkBuffer buffer,
 		VkDeviceSize size,
-		const void *data
+		const void *data,
+		VkDeviceSize offset
 	)
 	{
 		// Create staging buffer
@@ -776,6 +790,7 @@ namespace scapes::visual::hardware::vulkan
 		VkCommandBuffer commandBuffer = beginSingleTimeCommands(context);
 
 		VkBufferCopy copyRegion = {};
+		copyRegion.dstOffset = offset;
 		copyRegion.size = size;
 		vkCmdCopyBuffer(commandBuffer, staging_buffer, buffer, 1, &copyRegion);
 
@@ -789,13 +804,14 @@ namespace scapes::visual::hardware::vulkan
 		const Context *context,
 		VmaAllocation memory,
 		VkDeviceSize size,
-		const void *data
+		const void *data,
+		VkDeviceSize offset
 	)
 	{
 		// Fill buffer
 		void *buffer_data = nullptr;
 		vmaMapMemory(context->getVRAMAllocator(), memory, &buffer_data);
-		memcpy(buffer_data, data, static_cast<size_t>(size));
+		memcpy(reinterpret_cast<uint8_t *>(buffer_data) + offset, data, static_cast<size_t>(size));
 		vmaUnmapMemory(context->getVRAMAllocator(), memory);
 	}
 
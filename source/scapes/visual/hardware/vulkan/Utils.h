@@ -73,6 +73,10 @@ namespace scapes::visual::hardware::vulkan
 			CommandBufferType type
 		);
 
+		static VkVertexInputRate getVertexInputRate(
+			VertexInputRate rate
+		);
+
 		static VkCullModeFlags getCullMode(
 			CullMode mode
 		);
@@ -156,14 +160,16 @@ namespace scapes::visual::hardware::vulkan
 			const Context *context,
 			VkBuffer buffer,
 			VkDeviceSize size,
-			const void *data
+			const void *data,
+			VkDeviceSize offset = 0
 		);
 
 		static void fillHostVisibleBuffer(
 			const Context *context,
 			VmaAllocation memory,
 			VkDeviceSize size,
-			const void *data
+			const void *data,
+			VkDeviceSize offset = 0
 		);
 
 		static VkShaderModule createShaderModule(
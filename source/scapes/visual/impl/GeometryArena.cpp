@@ -0,0 +1,273 @@
+#include "GeometryArena.h"
+
+#include <scapes/visual/Mesh.h>
+#include <scapes/visual/hardware/Device.h>
+
+#include <scapes/foundation/Log.h>
+
+#include <algorithm>
+#include <cassert>
+
+namespace scapes::visual::impl
+{
+	/*
+	 */
+	RangeAllocator::RangeAllocator(uint32_t capacity)
+		: capacity(capacity)
+	{
+		if (capacity > 0)
+			insertFreeRange(0, capacity);
+	}
+
+	/*
+	 */
+	bool RangeAllocator::allocate(uint32_t size, uint32_t &offset)
+	{
+		assert(size > 0);
+
+		auto it = free_sizes.lower_bound(size);
+		if (it == free_sizes.end())
+			return false;
+
+		uint32_t free_size = it->first;
+		offset = it->second;
+
+		eraseFreeRange(offset, free_size);
+
+		if (free_size > size)
+			insertFreeRange(offset + size, free_size - size);
+
+		used += size;
+		return true;
+	}
+
+	void RangeAllocator::release(uint32_t offset, uint32_t size)
+	{
+		assert(size > 0);
+		assert(offset + size <= capacity);
+		assert(used >= size);
+
+		used -= size;
+
+		auto next = free_offsets.find(offset + size);
+		if (next != free_offsets.end())
+		{
+			size += next->second;
+			eraseFreeRange(next->first, next->second);
+		}
+
+		auto prev = free_offsets.lower_bound(offset);
+		if (prev != free_offsets.begin())
+		{
+			--prev;
+			assert(prev->first + prev->second <= offset && "Range is released twice");
+
+			if (prev->first + prev->second == offset)
+			{
+				offset = prev->first;
+				size += prev->second;
+				eraseFreeRange(prev->first, prev->second);
+			}
+		}
+
+		insertFreeRange(offset, size);
+	}
+
+	/*
+	 */
+	void RangeAllocator::insertFreeRange(uint32_t offset, uint32_t size)
+	{
+		free_offsets.emplace(offset, size);
+		free_sizes.emplace(size, offset);
+	}
+
+	void RangeAllocator::eraseFreeRange(uint32_t offset, uint32_t size)
+	{
+		free_offsets.erase(offset);
+
+		auto range = free_sizes.equal_range(size);
+		for (auto it = range.first; it != range.second; ++it)
+		{
+			if (it->second != offset)
+				continue;
+
+			free_sizes.erase(it);
+			return;
+		}
+
+		assert(false && "Free range is missing from the size index");
+	}
+
+	/*
+	 */
+	GeometryArena::GeometryArena(
+		hardware::Device *device,
+		uint32_t page_vertices,
+		uint32_t page_indices
+	)
+		: device(device), page_vertices(page_vertices), page_indices(page_indices)
+	{
+		assert(device);
+		assert(page_vertices > 0);
+		assert(page_indices > 0);
+	}
+
+	GeometryArena::~GeometryArena()
+	{
+		if (num_allocations > 0)
+			foundation::Log::warning("GeometryArena::~GeometryArena(): %u ranges are still allocated\n", num_allocations);
+
+		for (Page *page : pages)
+			destroyPage(page);
+
+		pages.clear();
+	}
+
+	/*
+	 */
+	bool GeometryArena::allocate(uint32_t num_vertices, uint32_t num_indices, GeometryRange &range)
+	{
+		assert(num_vertices > 0);
+		assert(num_indices > 0);
+
+		for (Page *page : pages)
+			if (allocate(page, num_vertices, num_indices, range))
+				return true;
+
+		Page *page = createPage(std::max(page_vertices, num_vertices), std::max(page_indices, num_indices));
+		if (page == nullptr)
+			return false;
+
+		pages.push_back(page);
+
+		bool result = allocate(page, num_vertices, num_indices, range);
+		assert(result);
+
+		return result;
+	}
+
+	void GeometryArena::free(const GeometryRange &range)
+	{
+		auto it = std::find_if(pages.begin(), pages.end(), [&range](const Page *page)
+		{
+			return page->vertex_buffer == range.vertex_buffer;
+		});
+
+		if (it == pages.end())
+		{
+			foundation::Log::error("GeometryArena::free(): range doesn't belong to this arena\n");
+			return;
+		}
+
+		Page *page = *it;
+		assert(page->index_buffer == range.index_buffer);
+
+		page->vertices.release(range.base_vertex, range.num_vertices);
+		page->indices.release(range.base_index, range.num_indices);
+
+		assert(num_allocations > 0);
+		--num_allocations;
+
+		// keep the first page around, oversized and overflow pages go away once empty
+		if (page->vertices.getUsed() == 0 && it != pages.begin())
+		{
+			destroyPage(page);
+			pages.erase(it);
+		}
+	}
+
+	/*
+	 */
+	size_t GeometryArena::getGPUMemory() const
+	{
+		size_t result = 0;
+
+		for (const Page *page : pages)
+		{
+			result += sizeof(Mesh::Vertex) * page->vertices.getCapacity();
+			result += sizeof(uint32_t) * page->indices.getCapacity();
+		}
+
+		return result;
+	}
+
+	size_t GeometryArena::getUsedGPUMemory() const
+	{
+		size_t result = 0;
+
+		for (const Page *page : pages)
+		{
+			result += sizeof(Mesh::Vertex) * page->vertices.getUsed();
+			result += sizeof(uint32_t) * page->indices.getUsed();
+		}
+
+		return result;
+	}
+
+	/*
+	 */
+	GeometryArena::Page *GeometryArena::createPage(uint32_t num_vertices, uint32_t num_indices)
+	{
+		hardware::VertexBuffer vertex_buffer = device->createVertexBuffer(
+			hardware::BufferType::STATIC,
+			sizeof(Mesh::Vertex), num_vertices,
+			Mesh::NUM_VERTEX_ATTRIBUTES, Mesh::getVertexAttributes(),
+			nullptr
+		);
+
+		hardware::IndexBuffer index_buffer = device->createIndexBuffer(
+			hardware::BufferType::STATIC,
+			hardware::IndexFormat::UINT32,
+			num_indices,
+			nullptr
+		);
+
+		if (vertex_buffer == SCAPES_NULL_HANDLE || index_buffer == SCAPES_NULL_HANDLE)
+		{
+			foundation::Log::error("GeometryArena::createPage(): can't create page buffers for %u vertices and %u indices\n", num_vertices, num_indices);
+
+			device->destroyVertexBuffer(vertex_buffer);
+			device->destroyIndexBuffer(index_buffer);
+			return nullptr;
+		}
+
+		Page *page = new Page(num_vertices, num_indices);
+		page->vertex_buffer = vertex_buffer;
+		page->index_buffer = index_buffer;
+
+		return page;
+	}
+
+	void GeometryArena::destroyPage(Page *page)
+	{
+		device->destroyVertexBuffer(page->vertex_buffer);
+		device->destroyIndexBuffer(page->index_buffer);
+
+		delete page;
+	}
+
+	bool GeometryArena::allocate(Page *page, uint32_t num_vertices, uint32_t num_indices, GeometryRange &range)
+	{
+		uint32_t base_vertex = 0;
+		uint32_t base_index = 0;
+
+		if (!page->vertices.allocate(num_vertices, base_vertex))
+			return false;
+
+		if (!page->indices.allocate(num_indices, base_index))
+		{
+			page->vertices.release(base_vertex, num_vertices);
+			return false;
+		}
+
+		range.vertex_buffer = page->vertex_buffer;
+		range.index_buffer = page->index_buffer;
+		range.base_vertex = base_vertex;
+		range.base_index = base_index;
+		range.num_vertices = num_vertices;
+		range.num_indices = num_indices;
+
+		++num_allocations;
+		return true;
+	}
+}
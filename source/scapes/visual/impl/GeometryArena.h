@@ -0,0 +1,84 @@
+#pragma once
+
+#include <scapes/visual/GeometryArena.h>
+
+#include <map>
+#include <vector>
+
+namespace scapes::visual::impl
+{
+	/* Best fit free list over [0, capacity), free ranges are indexed both by size for lookups
+	 * and by offset so released ranges merge with their neighbours
+	 */
+	class RangeAllocator
+	{
+	public:
+		RangeAllocator(uint32_t capacity);
+
+		bool allocate(uint32_t size, uint32_t &offset);
+		void release(uint32_t offset, uint32_t size);
+
+		SCAPES_INLINE uint32_t getCapacity() const { return capacity; }
+		SCAPES_INLINE uint32_t getUsed() const { return used; }
+
+	private:
+		void insertFreeRange(uint32_t offset, uint32_t size);
+		void eraseFreeRange(uint32_t offset, uint32_t size);
+
+	private:
+		uint32_t capacity {0};
+		uint32_t used {0};
+
+		std::map<uint32_t, uint32_t> free_offsets;
+		std::multimap<uint32_t, uint32_t> free_sizes;
+	};
+
+	/*
+	 */
+	class GeometryArena : public visual::GeometryArena
+	{
+	public:
+		GeometryArena(
+			hardware::Device *device,
+			uint32_t page_vertices,
+			uint32_t page_indices
+		);
+		~GeometryArena() final;
+
+		SCAPES_INLINE hardware::Device *getDevice() const final { return device; }
+
+		bool allocate(uint32_t num_vertices, uint32_t num_indices, GeometryRange &range) final;
+		void free(const GeometryRange &range) final;
+
+		SCAPES_INLINE uint32_t getNumPages() const final { return static_cast<uint32_t>(pages.size()); }
+		SCAPES_INLINE uint32_t getNumAllocations() const final { return num_allocations; }
+		size_t getGPUMemory() const final;
+		size_t getUsedGPUMemory() const final;
+
+	private:
+		struct Page
+		{
+			hardware::VertexBuffer vertex_buffer {SCAPES_NULL_HANDLE};
+			hardware::IndexBuffer index_buffer {SCAPES_NULL_HANDLE};
+			RangeAllocator vertices;
+			RangeAllocator indices;
+
+			Page(uint32_t num_vertices, uint32_t num_indices)
+				: vertices(num_vertices), indices(num_indices) { }
+		};
+
+		Page *createPage(uint32_t num_vertices, uint32_t num_indices);
+		void destroyPage(Page *page);
+
+		bool allocate(Page *page, uint32_t num_vertices, uint32_t num_indices, GeometryRange &range);
+
+	private:
+		hardware::Device *device {nullptr};
+
+		uint32_t page_vertices {0};
+		uint32_t page_indices {0};
+		uint32_t num_allocations {0};
+
+		std::vector<Page *> pages;
+	};
+}
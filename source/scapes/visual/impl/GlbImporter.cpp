@@ -3,16 +3,23 @@
 #include <scapes/visual/components/Components.h>
 
 #include <scapes/foundation/game/World.h>
-#include <scapes/foundation/game/Entity.h>
+#include <scapes/foundation/Hash.h>
+#include <scapes/foundation/io/FileSystem.h>
 #include <scapes/foundation/math/Math.h>
 
 #define CGLTF_IMPLEMENTATION
 #include <cgltf.h>
 
+#include <algorithm>
+#include <cstdio>
 #include <iostream>
 #include <sstream>
 #include <functional>
 #include <map>
+#include <new>
+#include <string>
+#include <unordered_map>
+#include <vector>
 
 namespace scapes::visual::impl
 {
@@ -93,18 +100,217 @@ namespace scapes::visual::impl
 		}
 	}
 
+	namespace snapshot
+	{
+		enum : uint32_t
+		{
+			MAGIC = 0x424C4753, // SGLB
+			VERSION = 2,
+			NUM_COMPONENTS = 4,
+		};
+
+		// renderables are saved as indices into scene resources
+		struct Renderable
+		{
+			uint32_t mesh {GlbScene::INVALID_INDEX};
+			uint32_t material {GlbScene::INVALID_INDEX};
+		};
+
+		static_assert(sizeof(Renderable) <= sizeof(components::Renderable));
+
+		struct Context
+		{
+			const GlbScene *scene {nullptr};
+			std::unordered_map<const void *, uint32_t> mesh_indices;
+			std::unordered_map<const void *, uint32_t> material_indices;
+		};
+
+		// snapshot contents are parsed into these first, resources are created once the whole file checks out
+		struct TextureData
+		{
+			uint32_t format {0};
+			uint32_t width {0};
+			uint32_t height {0};
+			uint32_t mip_levels {0};
+			uint32_t layers {0};
+			std::vector<uint8_t> pixels;
+		};
+
+		struct MeshData
+		{
+			std::vector<Mesh::Vertex> vertices;
+			std::vector<uint32_t> indices;
+		};
+
+		/*
+		 */
+		template <typename T>
+		static bool writeValue(foundation::io::Stream *stream, const T &value)
+		{
+			return stream->write(&value, sizeof(T), 1) == 1;
+		}
+
+		template <typename T>
+		static bool readValue(foundation::io::Stream *stream, T &value)
+		{
+			return stream->read(&value, sizeof(T), 1) == 1;
+		}
+
+		static bool hasBytes(foundation::io::Stream *stream, uint64_t element_size, uint64_t count)
+		{
+			// counts come from the file, check them before they turn into allocations
+			uint64_t size = stream->size();
+			uint64_t remaining = size - std::min(stream->tell(), size);
+
+			return element_size == 0 || count <= remaining / element_size;
+		}
+
+		/*
+		 */
+		static void saveRenderables(void *user_data, void *data, uint32_t count)
+		{
+			const Context *context = reinterpret_cast<const Context *>(user_data);
+			uint8_t *bytes = reinterpret_cast<uint8_t *>(data);
+
+			for (uint32_t i = 0; i < count; ++i)
+			{
+				uint8_t *element = bytes + i * sizeof(components::Renderable);
+				const components::Renderable *renderable = reinterpret_cast<const components::Renderable *>(element);
+
+				Renderable saved;
+
+				auto mesh_it = context->mesh_indices.find(renderable->mesh.getRaw());
+				if (mesh_it != context->mesh_indices.end())
+					saved.mesh = mesh_it->second;
+
+				auto material_it = context->material_indices.find(renderable->material.getRaw());
+				if (material_it != context->material_indices.end())
+					saved.material = material_it->second;
+
+				memset(element, 0, sizeof(components::Renderable));
+				memcpy(element, &saved, sizeof(Renderable));
+			}
+		}
+
+		static void loadRenderables(void *user_data, const foundation::game::SnapshotEntityMap &entities, void *data, uint32_t count)
+		{
+			const Context *context = reinterpret_cast<const Context *>(user_data);
+			const GlbScene *scene = context->scene;
+			uint8_t *bytes = reinterpret_cast<uint8_t *>(data);
+
+			for (uint32_t i = 0; i < count; ++i)
+			{
+				uint8_t *element = bytes + i * sizeof(components::Renderable);
+
+				Renderable saved;
+				memcpy(&saved, element, sizeof(Renderable));
+
+				MeshHandle mesh = (saved.mesh < scene->meshes.size()) ? scene->meshes[saved.mesh] : MeshHandle();
+				MaterialHandle material = (saved.material < scene->materials.size()) ? scene->materials[saved.material] : scene->default_material;
+
+				// column holds saved indices, not handles
+				new (element) components::Renderable{mesh, material};
+			}
+		}
+
+		static void loadParents(void *user_data, const foundation::game::SnapshotEntityMap &entities, void *data, uint32_t count)
+		{
+			components::Parent *parents = reinterpret_cast<components::Parent *>(data);
+
+			for (uint32_t i = 0; i < count; ++i)
+				parents[i].entity = entities.getEntity(parents[i].entity);
+		}
+
+		static void getComponents(Context *context, foundation::game::SnapshotComponent snapshot_components[NUM_COMPONENTS])
+		{
+			using foundation::game::SnapshotComponent;
+
+			snapshot_components[0] = SnapshotComponent::create<components::LocalTransform>();
+			snapshot_components[1] = SnapshotComponent::create<components::Transform>();
+			snapshot_components[2] = SnapshotComponent::create<components::Renderable>(saveRenderables, loadRenderables, context);
+			snapshot_components[3] = SnapshotComponent::create<components::Parent>(nullptr, loadParents, context);
+		}
+
+		/*
+		 */
+		class MemoryStream : public foundation::io::Stream
+		{
+		public:
+			size_t read(void *data, size_t element_size, size_t element_count) final
+			{
+				if (element_size == 0)
+					return 0;
+
+				size_t count = std::min(element_count, (buffer.size() - position) / element_size);
+				memcpy(data, buffer.data() + position, count * element_size);
+
+				position += count * element_size;
+				return count;
+			}
+
+			size_t write(const void *data, size_t element_size, size_t element_count) final
+			{
+				size_t size = element_size * element_count;
+				if (position + size > buffer.size())
+					buffer.resize(position + size);
+
+				memcpy(buffer.data() + position, data, size);
+
+				position += size;
+				return element_count;
+			}
+
+			bool seek(uint64_t offset, foundation::io::SeekOrigin origin) final
+			{
+				uint64_t base = 0;
+				if (origin == foundation::io::SeekOrigin::CUR)
+					base = position;
+				else if (origin == foundation::io::SeekOrigin::END)
+					base = buffer.size();
+
+				if (base + offset > buffer.size())
+					return false;
+
+				position = static_cast<size_t>(base + offset);
+				return true;
+			}
+
+			uint64_t tell() const final { return position; }
+			uint64_t size() const final { return buffer.size(); }
+
+			bool readFrom(foundation::io::Stream *stream, size_t size)
+			{
+				buffer.resize(size);
+				position = 0;
+
+				return stream->read(buffer.data(), 1, size) == size;
+			}
+
+			SCAPES_INLINE const uint8_t *getData() const { return buffer.data(); }
+
+		private:
+			std::vector<uint8_t> buffer;
+			size_t position {0};
+		};
+	}
+
 	/*
 	 */
 	GlbImporter::GlbImporter(
 		foundation::resources::ResourceManager *resource_manager,
 		foundation::game::World *world,
-		hardware::Device *device
+		hardware::Device *device,
+		GeometryArena *geometry_arena,
+		const char *cache_path
 	)
-		: resource_manager(resource_manager), world(world), device(device)
+		: resource_manager(resource_manager), world(world), device(device), geometry_arena(geometry_arena)
 	{
 		assert(resource_manager);
 		assert(world);
 		assert(device);
+
+		if (cache_path)
+			this->cache_path = cache_path;
 	}
 
 	GlbImporter::~GlbImporter()
@@ -115,6 +321,69 @@ namespace scapes::visual::impl
 	/*
 	 */
 	bool GlbImporter::import(const foundation::io::URI &uri, MaterialHandle default_material)
+	{
+		// decoded scene is cached outside of the assets and rebuilt once the source changes
+		GlbSourceKey key;
+		bool use_cache = !cache_path.empty() && get_source_key(uri, key);
+
+		char snapshot_name[32];
+		snprintf(snapshot_name, sizeof(snapshot_name), "/%016llx.snapshot", static_cast<unsigned long long>(foundation::hash::compute(key.path)));
+
+		std::string snapshot_path = cache_path + snapshot_name;
+		foundation::io::URI snapshot_uri(snapshot_path.c_str());
+
+		if (use_cache && load_snapshot(snapshot_uri, key, default_material))
+			return true;
+
+		// entities go to a scratch world first, so the snapshot has nothing but the scene
+		GlbScene scene;
+		scene.default_material = default_material;
+
+		foundation::game::World *scene_world = foundation::game::World::create();
+
+		bool success = import_gltf(uri, scene, scene_world);
+
+		snapshot::Context context;
+		context.scene = &scene;
+
+		for (uint32_t i = 0; i < static_cast<uint32_t>(scene.meshes.size()); ++i)
+			context.mesh_indices.insert({scene.meshes[i].getRaw(), i});
+
+		for (uint32_t i = 0; i < static_cast<uint32_t>(scene.materials.size()); ++i)
+			context.material_indices.insert({scene.materials[i].getRaw(), i});
+
+		foundation::game::SnapshotComponent snapshot_components[snapshot::NUM_COMPONENTS];
+		snapshot::getComponents(&context, snapshot_components);
+
+		snapshot::MemoryStream world_stream;
+		success = success && scene_world->saveSnapshot(&world_stream, snapshot::NUM_COMPONENTS, snapshot_components);
+
+		foundation::game::World::destroy(scene_world);
+
+		if (!success)
+		{
+			destroy_scene(scene);
+			return false;
+		}
+
+		// not being able to write the snapshot only costs the next start
+		if (use_cache)
+			save_snapshot(snapshot_uri, key, scene, world_stream.getData(), world_stream.size());
+
+		// a failed snapshot load leaves the world untouched, so nothing is left behind but the resources
+		world_stream.seek(0, foundation::io::SeekOrigin::SET);
+		if (!world->loadSnapshot(&world_stream, snapshot::NUM_COMPONENTS, snapshot_components))
+		{
+			destroy_scene(scene);
+			return false;
+		}
+
+		return true;
+	}
+
+	/*
+	 */
+	bool GlbImporter::import_gltf(const foundation::io::URI &uri, GlbScene &scene, foundation::game::World *scene_world)
 	{
 		cgltf_options parse_options = {};
 		parse_options.file.read = cgltf::read;
@@ -137,17 +406,9 @@ namespace scapes::visual::impl
 			return false;
 		}
 
-		// import meshes
-		std::map<const cgltf_mesh *, MeshHandle> mapped_meshes;
-
-		for (cgltf_size i = 0; i < data->meshes_count; ++i)
-		{
-			MeshHandle mesh = import_mesh(&data->meshes[i]);
-			mapped_meshes.insert({&data->meshes[i], mesh});
-		}
+		// import images, decoding runs on loader threads while meshes are imported
+		scene.textures.reserve(data->images_count);
 
-		// import images
-		std::map<const cgltf_image *, TextureHandle> mapped_textures;
 		for (cgltf_size i = 0; i < data->images_count; ++i)
 		{
 			const cgltf_image &image = data->images[i];
@@ -158,11 +419,26 @@ namespace scapes::visual::impl
 			assert(data);
 			assert(size);
 
-			TextureHandle texture = resource_manager->loadFromMemory<Texture>(data, size, device);
+			TextureHandle texture = resource_manager->loadFromMemoryAsync<Texture>(data, size, device);
 
-			mapped_textures.insert({&image, texture});
+			scene.textures.push_back(texture);
 		}
 
+		// import meshes
+		std::map<const cgltf_mesh *, MeshHandle> mapped_meshes;
+
+		for (cgltf_size i = 0; i < data->meshes_count; ++i)
+		{
+			MeshHandle mesh = import_mesh(&data->meshes[i]);
+			mapped_meshes.insert({&data->meshes[i], mesh});
+
+			scene.meshes.push_back(mesh);
+		}
+
+		// wait for image decoding
+		for (TextureHandle texture : scene.textures)
+			resource_manager->wait(texture);
+
 		// import materials
 		std::map<const cgltf_material *, MaterialHandle> mapped_materials;
 
@@ -173,62 +449,115 @@ namespace scapes::visual::impl
 			const cgltf_texture *base_color_texture = material.pbr_metallic_roughness.base_color_texture.texture;
 			const cgltf_texture *normal_texture = material.normal_texture.texture;
 
-			// TODO: metalness / roughness maps
-
-			TextureHandle base_color = default_material->getGroupTexture("PBR", "BaseColor");
-			TextureHandle normal = default_material->getGroupTexture("PBR", "Normal");
-			TextureHandle roughness = default_material->getGroupTexture("PBR", "Roughness");
-			TextureHandle metalness = default_material->getGroupTexture("PBR", "Metalness");
+			uint32_t base_color = GlbScene::INVALID_INDEX;
+			uint32_t normal = GlbScene::INVALID_INDEX;
 
 			if (base_color_texture)
-				base_color = mapped_textures[base_color_texture->image];
+				base_color = static_cast<uint32_t>(base_color_texture->image - data->images);
 
 			if (normal_texture)
-				normal = mapped_textures[normal_texture->image];
+				normal = static_cast<uint32_t>(normal_texture->image - data->images);
 
-			MaterialHandle render_material = default_material->clone();
+			MaterialHandle render_material = create_material(scene, base_color, normal);
 
-			render_material->setGroupTexture("PBR", "BaseColor", base_color);
-			render_material->setGroupTexture("PBR", "Normal", normal);
-			render_material->setGroupTexture("PBR", "Roughness", roughness);
-			render_material->setGroupTexture("PBR", "Metalness", metalness);
-			render_material->flush();
+			scene.materials.push_back(render_material);
+			scene.material_textures.push_back(base_color);
+			scene.material_textures.push_back(normal);
 
 			mapped_materials.insert({&material, render_material});
 		}
 
-		// import nodes
-		std::function<void(const cgltf_node *, const foundation::math::mat4 &)> import_node;
-		import_node = [&import_node, &mapped_materials, &mapped_meshes, this, default_material](const cgltf_node *node, const foundation::math::mat4 &transform) -> void
+		// import nodes level by level, parents have to exist before their children can reference them;
+		// every batch goes to its final table at once
+		std::unordered_map<const cgltf_node *, foundation::game::EntityID *> node_entities;
+		std::unordered_map<const cgltf_node *, foundation::math::mat4> node_transforms;
+
+		std::vector<const cgltf_node *> level_nodes;
+		std::vector<const cgltf_node *> next_level_nodes;
+
+		for (cgltf_size i = 0; i < data->nodes_count; ++i)
+			if (data->nodes[i].parent == nullptr)
+				level_nodes.push_back(&data->nodes[i]);
+
+		std::vector<const cgltf_node *> batch_nodes;
+		std::vector<foundation::game::EntityID *> batch_entities;
+		std::vector<components::LocalTransform> local_transforms;
+		std::vector<components::Transform> transforms;
+		std::vector<components::Renderable> renderables;
+		std::vector<components::Parent> parents;
+
+		auto import_nodes = [&](bool with_mesh, bool with_parent)
 		{
-			if (node->mesh)
+			batch_nodes.clear();
+			local_transforms.clear();
+			transforms.clear();
+			renderables.clear();
+			parents.clear();
+
+			for (const cgltf_node *node : level_nodes)
 			{
-				auto it = mapped_meshes.find(node->mesh);
-				assert(it != mapped_meshes.end());
+				if ((node->mesh != nullptr) != with_mesh)
+					continue;
+
+				foundation::math::mat4 local_transform = cgltf::getNodeTransform(node);
+				foundation::math::mat4 transform = (with_parent) ? node_transforms[node->parent] * local_transform : local_transform;
 
-				MeshHandle mesh = it->second;
+				node_transforms[node] = transform;
 
-				foundation::game::Entity entity = foundation::game::Entity(world);
+				batch_nodes.push_back(node);
 
-				auto mat_it = mapped_materials.find(node->mesh->primitives[0].material);
+				// world transform is already known here, nothing to propagate until something moves
+				local_transforms.push_back({local_transform, false});
+				transforms.push_back({transform});
 
-				MaterialHandle material = (mat_it != mapped_materials.end()) ? mat_it->second : default_material;
+				if (with_parent)
+					parents.push_back({node_entities[node->parent]});
 
-				entity.addComponent<components::Transform>(transform);
-				entity.addComponent<components::Renderable>(mesh, material);
+				if (with_mesh)
+				{
+					auto it = mapped_meshes.find(node->mesh);
+					assert(it != mapped_meshes.end());
+
+					auto mat_it = mapped_materials.find(node->mesh->primitives[0].material);
+
+					MaterialHandle material = (mat_it != mapped_materials.end()) ? mat_it->second : scene.default_material;
+
+					renderables.push_back({it->second, material});
+				}
 			}
 
-			for (cgltf_size i = 0; i < node->children_count; ++i)
-				import_node(node->children[i], transform * cgltf::getNodeTransform(node->children[i]));
+			uint32_t count = static_cast<uint32_t>(batch_nodes.size());
+			if (count == 0)
+				return;
+
+			batch_entities.resize(count);
+			foundation::game::EntityID **entities = batch_entities.data();
+
+			if (with_mesh && with_parent)
+				scene_world->createEntities(count, entities, local_transforms.data(), transforms.data(), renderables.data(), parents.data());
+			else if (with_mesh)
+				scene_world->createEntities(count, entities, local_transforms.data(), transforms.data(), renderables.data());
+			else if (with_parent)
+				scene_world->createEntities(count, entities, local_transforms.data(), transforms.data(), parents.data());
+			else
+				scene_world->createEntities(count, entities, local_transforms.data(), transforms.data());
+
+			for (uint32_t i = 0; i < count; ++i)
+				node_entities[batch_nodes[i]] = batch_entities[i];
 		};
 
-		for (cgltf_size i = 0; i < data->nodes_count; ++i)
+		bool with_parent = false;
+		while (!level_nodes.empty())
 		{
-			const cgltf_node &node = data->nodes[i];
-			if (node.parent != nullptr)
-				continue;
+			import_nodes(true, with_parent);
+			import_nodes(false, with_parent);
 
-			import_node(&node, cgltf::getNodeTransform(&node));
+			next_level_nodes.clear();
+			for (const cgltf_node *node : level_nodes)
+				next_level_nodes.insert(next_level_nodes.end(), node->children, node->children + node->children_count);
+
+			std::swap(level_nodes, next_level_nodes);
+			with_parent = true;
 		}
 
 		cgltf_free(data);
@@ -236,6 +565,307 @@ namespace scapes::visual::impl
 		return true;
 	}
 
+	/*
+	 */
+	MeshHandle GlbImporter::create_mesh(uint32_t num_vertices, Mesh::Vertex *vertices, uint32_t num_indices, uint32_t *indices)
+	{
+		if (geometry_arena)
+			return resource_manager->create<Mesh>(geometry_arena, num_vertices, vertices, num_indices, indices);
+
+		return resource_manager->create<Mesh>(device, num_vertices, vertices, num_indices, indices);
+	}
+
+	/*
+	 */
+	MaterialHandle GlbImporter::create_material(const GlbScene &scene, uint32_t base_color, uint32_t normal)
+	{
+		const MaterialHandle &default_material = scene.default_material;
+
+		// TODO: metalness / roughness maps
+		TextureHandle base_color_texture = default_material->getGroupTexture("PBR", "BaseColor");
+		TextureHandle normal_texture = default_material->getGroupTexture("PBR", "Normal");
+		TextureHandle roughness_texture = default_material->getGroupTexture("PBR", "Roughness");
+		TextureHandle metalness_texture = default_material->getGroupTexture("PBR", "Metalness");
+
+		if (base_color < scene.textures.size() && scene.textures[base_color].isValid())
+			base_color_texture = scene.textures[base_color];
+
+		if (normal < scene.textures.size() && scene.textures[normal].isValid())
+			normal_texture = scene.textures[normal];
+
+		MaterialHandle render_material = default_material->clone();
+
+		render_material->setGroupTexture("PBR", "BaseColor", base_color_texture);
+		render_material->setGroupTexture("PBR", "Normal", normal_texture);
+		render_material->setGroupTexture("PBR", "Roughness", roughness_texture);
+		render_material->setGroupTexture("PBR", "Metalness", metalness_texture);
+		render_material->flush();
+
+		return render_material;
+	}
+
+	void GlbImporter::destroy_scene(GlbScene &scene)
+	{
+		// default material belongs to the caller
+		for (MaterialHandle material : scene.materials)
+			if (material.isValid())
+				resource_manager->destroy(material);
+
+		for (MeshHandle mesh : scene.meshes)
+			if (mesh.isValid())
+				resource_manager->destroy(mesh);
+
+		for (TextureHandle texture : scene.textures)
+			if (texture.isValid())
+				resource_manager->destroy(texture);
+
+		scene.materials.clear();
+		scene.meshes.clear();
+		scene.textures.clear();
+		scene.material_textures.clear();
+	}
+
+	/*
+	 */
+	bool GlbImporter::get_source_key(const foundation::io::URI &uri, GlbSourceKey &key) const
+	{
+		foundation::io::FileSystem *file_system = resource_manager->getFileSystem();
+
+		foundation::io::Stream *stream = file_system->open(uri, "rb");
+		if (!stream)
+			return false;
+
+		key.path = uri.c_str();
+		key.size = stream->size();
+		key.mtime = file_system->mtime(uri);
+
+		file_system->close(stream);
+		return true;
+	}
+
+	/*
+	 */
+	bool GlbImporter::load_snapshot(const foundation::io::URI &uri, const GlbSourceKey &key, MaterialHandle default_material)
+	{
+		foundation::io::FileSystem *file_system = resource_manager->getFileSystem();
+
+		foundation::io::Stream *stream = file_system->open(uri, "rb");
+		if (!stream)
+			return false;
+
+		uint32_t magic = 0;
+		uint32_t version = 0;
+		uint32_t path_size = 0;
+		uint64_t size = 0;
+		uint64_t mtime = 0;
+		uint32_t num_textures = 0;
+		uint32_t num_meshes = 0;
+		uint32_t num_materials = 0;
+
+		bool valid = snapshot::readValue(stream, magic) && snapshot::readValue(stream, version);
+		valid = valid && magic == snapshot::MAGIC && version == snapshot::VERSION;
+
+		// file name is a hash of the path, the path itself tells collisions apart
+		valid = valid && snapshot::readValue(stream, path_size) && path_size == key.path.size();
+
+		std::string path(path_size, '\0');
+		valid = valid && stream->read(path.data(), 1, path_size) == path_size && path == key.path;
+
+		valid = valid && snapshot::readValue(stream, size) && snapshot::readValue(stream, mtime);
+		valid = valid && size == key.size && mtime == key.mtime;
+
+		valid = valid && snapshot::readValue(stream, num_textures) && snapshot::readValue(stream, num_meshes) && snapshot::readValue(stream, num_materials);
+
+		if (!valid)
+		{
+			file_system->close(stream);
+			return false;
+		}
+
+		constexpr uint64_t texture_header_size = sizeof(uint32_t) * 5 + sizeof(uint64_t);
+		constexpr uint64_t mesh_header_size = sizeof(uint32_t) * 2;
+		constexpr uint64_t material_size = sizeof(uint32_t) * 2;
+
+		bool success = snapshot::hasBytes(stream, texture_header_size, num_textures);
+
+		// textures are stored decoded, only GPU upload is left
+		std::vector<snapshot::TextureData> textures;
+		if (success)
+			textures.resize(num_textures);
+
+		for (snapshot::TextureData &texture : textures)
+		{
+			uint64_t size = 0;
+
+			success = snapshot::readValue(stream, texture.format) && snapshot::readValue(stream, texture.width) && snapshot::readValue(stream, texture.height);
+			success = success && snapshot::readValue(stream, texture.mip_levels) && snapshot::readValue(stream, texture.layers) && snapshot::readValue(stream, size);
+			success = success && snapshot::hasBytes(stream, 1, size);
+
+			if (!success)
+				break;
+
+			texture.pixels.resize(size);
+			success = stream->read(texture.pixels.data(), 1, size) == size;
+
+			if (!success)
+				break;
+		}
+
+		success = success && snapshot::hasBytes(stream, mesh_header_size, num_meshes);
+
+		std::vector<snapshot::MeshData> meshes;
+		if (success)
+			meshes.resize(num_meshes);
+
+		for (snapshot::MeshData &mesh : meshes)
+		{
+			uint32_t num_vertices = 0;
+			uint32_t num_indices = 0;
+
+			success = snapshot::readValue(stream, num_vertices) && snapshot::readValue(stream, num_indices);
+			success = success && snapshot::hasBytes(stream, sizeof(Mesh::Vertex), num_vertices);
+			success = success && snapshot::hasBytes(stream, sizeof(uint32_t), num_indices);
+
+			if (!success)
+				break;
+
+			mesh.vertices.resize(num_vertices);
+			mesh.indices.resize(num_indices);
+
+			success = stream->read(mesh.vertices.data(), sizeof(Mesh::Vertex), num_vertices) == num_vertices;
+			success = success && stream->read(mesh.indices.data(), sizeof(uint32_t), num_indices) == num_indices;
+
+			// out of range indices would only show up on the GPU
+			success = success && std::all_of(mesh.indices.begin(), mesh.indices.end(), [num_vertices](uint32_t index) { return index < num_vertices; });
+
+			if (!success)
+				break;
+		}
+
+		success = success && snapshot::hasBytes(stream, material_size, num_materials);
+
+		std::vector<uint32_t> material_textures;
+		if (success)
+		{
+			material_textures.resize(num_materials * 2);
+			success = stream->read(material_textures.data(), sizeof(uint32_t), material_textures.size()) == material_textures.size();
+		}
+
+		// the rest is the world snapshot, it is checked by World::loadSnapshot() before creating anything
+		snapshot::MemoryStream world_stream;
+		success = success && world_stream.readFrom(stream, static_cast<size_t>(stream->size() - stream->tell()));
+
+		file_system->close(stream);
+
+		if (!success)
+		{
+			foundation::Log::error("GlbImporter::load_snapshot(): \"%s\" is corrupted, importing the source\n", uri.c_str());
+			return false;
+		}
+
+		GlbScene scene;
+		scene.default_material = default_material;
+
+		scene.textures.reserve(textures.size());
+		for (const snapshot::TextureData &texture : textures)
+		{
+			if (texture.pixels.empty())
+			{
+				scene.textures.push_back(TextureHandle());
+				continue;
+			}
+
+			scene.textures.push_back(resource_manager->create<Texture>(device, static_cast<hardware::Format>(texture.format), texture.width, texture.height, texture.mip_levels, texture.layers, texture.pixels.data()));
+		}
+
+		scene.meshes.reserve(meshes.size());
+		for (snapshot::MeshData &mesh : meshes)
+			scene.meshes.push_back(create_mesh(static_cast<uint32_t>(mesh.vertices.size()), mesh.vertices.data(), static_cast<uint32_t>(mesh.indices.size()), mesh.indices.data()));
+
+		scene.material_textures = std::move(material_textures);
+
+		scene.materials.reserve(num_materials);
+		for (uint32_t i = 0; i < num_materials; ++i)
+			scene.materials.push_back(create_material(scene, scene.material_textures[i * 2], scene.material_textures[i * 2 + 1]));
+
+		snapshot::Context context;
+		context.scene = &scene;
+
+		foundation::game::SnapshotComponent snapshot_components[snapshot::NUM_COMPONENTS];
+		snapshot::getComponents(&context, snapshot_components);
+
+		if (!world->loadSnapshot(&world_stream, snapshot::NUM_COMPONENTS, snapshot_components))
+		{
+			foundation::Log::error("GlbImporter::load_snapshot(): \"%s\" is corrupted, importing the source\n", uri.c_str());
+
+			destroy_scene(scene);
+			return false;
+		}
+
+		return true;
+	}
+
+		bool GlbImporter::save_snapshot(const foundation::io::URI &uri, const GlbSourceKey &key, const GlbScene &scene, const void *world_data, size_t world_size)
+	{
+		foundation::io::FileSystem *file_system = resource_manager->getFileSystem();
+
+		foundation::io::Stream *stream = file_system->open(uri, "wb");
+		if (!stream)
+		{
+			foundation::Log::warning("GlbImporter::save_snapshot(): can't open \"%s\" file\n", uri.c_str());
+			return false;
+		}
+
+		bool success = snapshot::writeValue<uint32_t>(stream, snapshot::MAGIC) && snapshot::writeValue<uint32_t>(stream, snapshot::VERSION);
+		success = success && snapshot::writeValue(stream, static_cast<uint32_t>(key.path.size()));
+		success = success && stream->write(key.path.data(), 1, key.path.size()) == key.path.size();
+		success = success && snapshot::writeValue(stream, key.size) && snapshot::writeValue(stream, key.mtime);
+		success = success && snapshot::writeValue(stream, static_cast<uint32_t>(scene.textures.size()));
+		success = success && snapshot::writeValue(stream, static_cast<uint32_t>(scene.meshes.size()));
+		success = success && snapshot::writeValue(stream, static_cast<uint32_t>(scene.materials.size()));
+
+		for (const TextureHandle &handle : scene.textures)
+		{
+			Texture *texture = handle.get();
+
+			uint64_t size = 0;
+			if (texture && texture->cpu_data)
+				size = ::ResourceTraits<Texture>::getCPUMemory(resource_manager, texture);
+
+			Texture empty = {};
+			if (size == 0)
+				texture = &empty;
+
+			success = success && snapshot::writeValue(stream, static_cast<uint32_t>(texture->format));
+			success = success && snapshot::writeValue(stream, texture->width) && snapshot::writeValue(stream, texture->height);
+			success = success && snapshot::writeValue(stream, texture->mip_levels) && snapshot::writeValue(stream, texture->layers);
+			success = success && snapshot::writeValue(stream, size);
+			success = success && stream->write(texture->cpu_data, 1, size) == size;
+		}
+
+		for (const MeshHandle &handle : scene.meshes)
+		{
+			const Mesh *mesh = handle.get();
+			assert(mesh);
+
+			success = success && snapshot::writeValue(stream, mesh->num_vertices) && snapshot::writeValue(stream, mesh->num_indices);
+			success = success && stream->write(mesh->vertices, sizeof(Mesh::Vertex), mesh->num_vertices) == mesh->num_vertices;
+			success = success && stream->write(mesh->indices, sizeof(uint32_t), mesh->num_indices) == mesh->num_indices;
+		}
+
+		for (uint32_t texture_index : scene.material_textures)
+			success = success && snapshot::writeValue(stream, texture_index);
+
+		success = success && stream->write(world_data, 1, world_size) == world_size;
+
+		file_system->close(stream);
+
+		if (!success)
+			foundation::Log::warning("GlbImporter::save_snapshot(): can't write \"%s\" file\n", uri.c_str());
+
+		return success;
+	}
+
 	/*
 	 */
 	MeshHandle GlbImporter::import_mesh(const cgltf_mesh *mesh)
@@ -334,7 +964,7 @@ namespace scapes::visual::impl
 			assert(success);
 		}
 
-		MeshHandle result = resource_manager->create<Mesh>(device, num_vertices, vertices, num_indices, indices);
+		MeshHandle result = create_mesh(num_vertices, vertices, num_indices, indices);
 
 		delete[] vertices;
 		delete[] indices;
@@ -1,11 +1,43 @@
 #pragma once
 
 #include <scapes/visual/GlbImporter.h>
+#include <scapes/visual/Mesh.h>
+
+#include <string>
+#include <vector>
 
 struct cgltf_mesh;
 
 namespace scapes::visual::impl
 {
+	/* Everything imported scene entities reference, snapshots store indices into these
+	 */
+	struct GlbScene
+	{
+		enum
+		{
+			INVALID_INDEX = ~0u,
+		};
+
+		MaterialHandle default_material;
+
+		std::vector<TextureHandle> textures;
+		std::vector<MeshHandle> meshes;
+		std::vector<MaterialHandle> materials;
+
+		// base color and normal texture per material, INVALID_INDEX keeps the default material one
+		std::vector<uint32_t> material_textures;
+	};
+
+	/* Identifies the source a snapshot was made from, mtime alone misses edits within its resolution
+	 */
+	struct GlbSourceKey
+	{
+		std::string path;
+		uint64_t size {0};
+		uint64_t mtime {0};
+	};
+
 	/*
 	 */
 	class GlbImporter : public visual::GlbImporter
@@ -14,18 +46,35 @@ namespace scapes::visual::impl
 		GlbImporter(
 			foundation::resources::ResourceManager *resource_manager,
 			foundation::game::World *world,
-			hardware::Device *device
+			hardware::Device *device,
+			GeometryArena *geometry_arena,
+			const char *cache_path
 		);
 		~GlbImporter() final;
 
 		bool import(const foundation::io::URI &uri, MaterialHandle default_material) final;
 
 	private:
+		bool import_gltf(const foundation::io::URI &uri, GlbScene &scene, foundation::game::World *scene_world);
 		MeshHandle import_mesh(const cgltf_mesh *mesh);
+		MeshHandle create_mesh(uint32_t num_vertices, Mesh::Vertex *vertices, uint32_t num_indices, uint32_t *indices);
+		MaterialHandle create_material(const GlbScene &scene, uint32_t base_color, uint32_t normal);
+		void destroy_scene(GlbScene &scene);
+
+		bool get_source_key(const foundation::io::URI &uri, GlbSourceKey &key) const;
+
+		bool load_snapshot(const foundation::io::URI &uri, const GlbSourceKey &key, MaterialHandle default_material);
+		bool save_snapshot(const foundation::io::URI &uri, const GlbSourceKey &key, const GlbScene &scene, const void *world_data, size_t world_size);
 
 	private:
 		foundation::resources::ResourceManager *resource_manager {nullptr};
 		foundation::game::World *world {nullptr};
 		hardware::Device *device {nullptr};
+
+		// meshes own their buffers when there is no arena
+		GeometryArena *geometry_arena {nullptr};
+
+		// empty disables snapshots
+		std::string cache_path;
 	};
 }
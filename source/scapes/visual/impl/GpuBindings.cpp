@@ -1,5 +1,4 @@
 #include "GpuBindings.h"
-#include <HashUtils.h>
 
 #include <scapes/foundation/io/FileSystem.h>
 
@@ -70,8 +69,7 @@ namespace scapes::visual::impl
 
 			for (const GroupParameter *parameter : group->parameters)
 			{
-				uint64_t parameter_hash = hash;
-				common::HashUtils::combine(parameter_hash, std::string_view(parameter->name));
+				uint64_t parameter_hash = getGroupItemKey(foundation::StringID(hash), parameter->name.c_str());
 
 				GroupParameter *new_parameter = new GroupParameter();
 				new_parameter->group = new_group;
@@ -88,14 +86,21 @@ namespace scapes::visual::impl
 
 			for (const GroupTexture *texture : group->textures)
 			{
-				uint64_t texture_hash = hash;
-				common::HashUtils::combine(texture_hash, std::string_view(texture->name));
+				uint64_t texture_hash = getGroupItemKey(foundation::StringID(hash), texture->name.c_str());
 
 				GroupTexture *new_texture = new GroupTexture();
 				new_texture->group = new_group;
 				new_texture->name = texture->name;
 				new_texture->texture = texture->texture;
 
+				// the copy holds its own reference so both bindings can drop theirs independently
+				if (texture->owned)
+				{
+					foundation::io::URI uri = resource_manager->getUri(texture->texture);
+					new_texture->texture = target.resource_manager->fetch<Texture>(uri, target.device);
+					new_texture->owned = true;
+				}
+
 				new_group->textures.push_back(new_texture);
 				target.group_texture_lookup.insert({texture_hash, new_texture});
 			}
@@ -267,8 +272,7 @@ namespace scapes::visual::impl
 	 */
 	bool GpuBindings::addGroup(const char *name)
 	{
-		uint64_t hash = 0;
-		common::HashUtils::combine(hash, std::string_view(name));
+		uint64_t hash = getGroupKey(name);
 
 		if (group_lookup.find(hash) != group_lookup.end())
 			return false;
@@ -281,10 +285,9 @@ namespace scapes::visual::impl
 		return true;
 	}
 
-	bool GpuBindings::removeGroup(const char *name)
+	bool GpuBindings::removeGroup(foundation::StringID name)
 	{
-		uint64_t hash = 0;
-		common::HashUtils::combine(hash, std::string_view(name));
+		uint64_t hash = getGroupKey(name);
 
 		auto it = group_lookup.find(hash);
 		if (it == group_lookup.end())
@@ -299,10 +302,9 @@ namespace scapes::visual::impl
 		return true;
 	}
 
-	bool GpuBindings::clearGroup(const char *name)
+	bool GpuBindings::clearGroup(foundation::StringID name)
 	{
-		uint64_t hash = 0;
-		common::HashUtils::combine(hash, std::string_view(name));
+		uint64_t hash = getGroupKey(name);
 
 		auto it = group_lookup.find(hash);
 		if (it == group_lookup.end())
@@ -317,10 +319,9 @@ namespace scapes::visual::impl
 
 	/*
 	 */
-	hardware::BindSet GpuBindings::getGroupBindings(const char *name) const
+	hardware::BindSet GpuBindings::getGroupBindings(foundation::StringID name) const
 	{
-		uint64_t hash = 0;
-		common::HashUtils::combine(hash, std::string_view(name));
+		uint64_t hash = getGroupKey(name);
 
 		auto it = group_lookup.find(hash);
 		if (it == group_lookup.end())
@@ -343,17 +344,15 @@ namespace scapes::visual::impl
 		return addGroupParameterInternal(group_name, parameter_name, type, element_size, num_elements);
 	}
 
-	bool GpuBindings::removeGroupParameter(const char *group_name, const char *parameter_name)
+	bool GpuBindings::removeGroupParameter(foundation::StringID group_name, foundation::StringID parameter_name)
 	{
-		uint64_t group_hash = 0;
-		common::HashUtils::combine(group_hash, std::string_view(group_name));
+		uint64_t group_hash = getGroupKey(group_name);
 
 		auto group_it = group_lookup.find(group_hash);
 		if (group_it == group_lookup.end())
 			return false;
 
-		uint64_t parameter_hash = group_hash;
-		common::HashUtils::combine(parameter_hash, std::string_view(parameter_name));
+		uint64_t parameter_hash = getGroupItemKey(group_name, parameter_name);
 
 		auto parameter_it = group_parameter_lookup.find(parameter_hash);
 		if (parameter_it == group_parameter_lookup.end())
@@ -381,15 +380,13 @@ namespace scapes::visual::impl
 	 */
 	bool GpuBindings::addGroupTexture(const char *group_name, const char *texture_name)
 	{
-		uint64_t group_hash = 0;
-		common::HashUtils::combine(group_hash, std::string_view(group_name));
+		uint64_t group_hash = getGroupKey(group_name);
 
 		auto it = group_lookup.find(group_hash);
 		if (it == group_lookup.end())
 			return false;
 
-		uint64_t texture_hash = group_hash;
-		common::HashUtils::combine(texture_hash, std::string_view(texture_name));
+		uint64_t texture_hash = getGroupItemKey(group_name, texture_name);
 
 		if (group_texture_lookup.find(texture_hash) != group_texture_lookup.end())
 			return false;
@@ -408,17 +405,15 @@ namespace scapes::visual::impl
 		return true;
 	}
 
-	bool GpuBindings::removeGroupTexture(const char *group_name, const char *texture_name)
+	bool GpuBindings::removeGroupTexture(foundation::StringID group_name, foundation::StringID texture_name)
 	{
-		uint64_t group_hash = 0;
-		common::HashUtils::combine(group_hash, std::string_view(group_name));
+		uint64_t group_hash = getGroupKey(group_name);
 
 		auto group_it = group_lookup.find(group_hash);
 		if (group_it == group_lookup.end())
 			return false;
 
-		uint64_t texture_hash = group_hash;
-		common::HashUtils::combine(texture_hash, std::string_view(texture_name));
+		uint64_t texture_hash = getGroupItemKey(group_name, texture_name);
 
 		auto texture_it = group_texture_lookup.find(texture_hash);
 		if (texture_it == group_texture_lookup.end())
@@ -435,6 +430,7 @@ namespace scapes::visual::impl
 		group->textures.erase(it);
 
 		invalidateGroup(group);
+		releaseGroupTexture(texture);
 		delete texture;
 
 		return true;
@@ -442,11 +438,9 @@ namespace scapes::visual::impl
 
 	/*
 	 */
-	size_t GpuBindings::getGroupParameterElementSize(const char *group_name, const char *parameter_name) const
+	size_t GpuBindings::getGroupParameterElementSize(foundation::StringID group_name, foundation::StringID parameter_name) const
 	{
-		uint64_t hash = 0;
-		common::HashUtils::combine(hash, std::string_view(group_name));
-		common::HashUtils::combine(hash, std::string_view(parameter_name));
+		uint64_t hash = getGroupItemKey(group_name, parameter_name);
 
 		auto it = group_parameter_lookup.find(hash);
 		if (it == group_parameter_lookup.end())
@@ -456,11 +450,9 @@ namespace scapes::visual::impl
 		return parameter->element_size;
 	}
 
-	size_t GpuBindings::getGroupParameterNumElements(const char *group_name, const char *parameter_name) const
+	size_t GpuBindings::getGroupParameterNumElements(foundation::StringID group_name, foundation::StringID parameter_name) const
 	{
-		uint64_t hash = 0;
-		common::HashUtils::combine(hash, std::string_view(group_name));
-		common::HashUtils::combine(hash, std::string_view(parameter_name));
+		uint64_t hash = getGroupItemKey(group_name, parameter_name);
 
 		auto it = group_parameter_lookup.find(hash);
 		if (it == group_parameter_lookup.end())
@@ -470,11 +462,9 @@ namespace scapes::visual::impl
 		return parameter->num_elements;
 	}
 
-	const void *GpuBindings::getGroupParameter(const char *group_name, const char *parameter_name, size_t index) const
+	const void *GpuBindings::getGroupParameter(foundation::StringID group_name, foundation::StringID parameter_name, size_t index) const
 	{
-		uint64_t hash = 0;
-		common::HashUtils::combine(hash, std::string_view(group_name));
-		common::HashUtils::combine(hash, std::string_view(parameter_name));
+		uint64_t hash = getGroupItemKey(group_name, parameter_name);
 
 		auto it = group_parameter_lookup.find(hash);
 		if (it == group_parameter_lookup.end())
@@ -489,17 +479,15 @@ namespace scapes::visual::impl
 		return data + index * parameter->element_size;
 	}
 
-	bool GpuBindings::setGroupParameter(const char *group_name, const char *parameter_name, size_t dst_index, size_t num_src_elements, const void *src_data)
+	bool GpuBindings::setGroupParameter(foundation::StringID group_name, foundation::StringID parameter_name, size_t dst_index, size_t num_src_elements, const void *src_data)
 	{
-		uint64_t group_hash = 0;
-		common::HashUtils::combine(group_hash, std::string_view(group_name));
+		uint64_t group_hash = getGroupKey(group_name);
 
 		auto group_it = group_lookup.find(group_hash);
 		if (group_it == group_lookup.end())
 			return false;
 
-		uint64_t parameter_hash = group_hash;
-		common::HashUtils::combine(parameter_hash, std::string_view(parameter_name));
+		uint64_t parameter_hash = getGroupItemKey(group_name, parameter_name);
 
 		auto parameter_it = group_parameter_lookup.find(parameter_hash);
 		if (parameter_it == group_parameter_lookup.end())
@@ -524,17 +512,15 @@ namespace scapes::visual::impl
 
 	/*
 	 */
-	TextureHandle GpuBindings::getGroupTexture(const char *group_name, const char *texture_name) const
+	TextureHandle GpuBindings::getGroupTexture(foundation::StringID group_name, foundation::StringID texture_name) const
 	{
-		uint64_t group_hash = 0;
-		common::HashUtils::combine(group_hash, std::string_view(group_name));
+		uint64_t group_hash = getGroupKey(group_name);
 
 		auto group_it = group_lookup.find(group_hash);
 		if (group_it == group_lookup.end())
 			return TextureHandle();
 
-		uint64_t texture_hash = group_hash;
-		common::HashUtils::combine(texture_hash, std::string_view(texture_name));
+		uint64_t texture_hash = getGroupItemKey(group_name, texture_name);
 
 		auto texture_it = group_texture_lookup.find(texture_hash);
 		if (texture_it == group_texture_lookup.end())
@@ -545,17 +531,15 @@ namespace scapes::visual::impl
 		return texture->texture;
 	}
 
-	bool GpuBindings::setGroupTexture(const char *group_name, const char *texture_name, TextureHandle handle)
+	bool GpuBindings::setGroupTexture(foundation::StringID group_name, foundation::StringID texture_name, TextureHandle handle)
 	{
-		uint64_t group_hash = 0;
-		common::HashUtils::combine(group_hash, std::string_view(group_name));
+		uint64_t group_hash = getGroupKey(group_name);
 
 		auto group_it = group_lookup.find(group_hash);
 		if (group_it == group_lookup.end())
 			return false;
 
-		uint64_t texture_hash = group_hash;
-		common::HashUtils::combine(texture_hash, std::string_view(texture_name));
+		uint64_t texture_hash = getGroupItemKey(group_name, texture_name);
 
 		auto texture_it = group_texture_lookup.find(texture_hash);
 		if (texture_it == group_texture_lookup.end())
@@ -563,6 +547,7 @@ namespace scapes::visual::impl
 
 		GroupTexture *texture = texture_it->second;
 
+		releaseGroupTexture(texture);
 		texture->texture = handle;
 		return true;
 	}
@@ -571,15 +556,13 @@ namespace scapes::visual::impl
 	 */
 	bool GpuBindings::addGroupParameterInternal(const char *group_name, const char *parameter_name, GroupParameterType type, size_t element_size, size_t num_elements)
 	{
-		uint64_t group_hash = 0;
-		common::HashUtils::combine(group_hash, std::string_view(group_name));
+		uint64_t group_hash = getGroupKey(group_name);
 
 		auto it = group_lookup.find(group_hash);
 		if (it == group_lookup.end())
 			return false;
 
-		uint64_t parameter_hash = group_hash;
-		common::HashUtils::combine(parameter_hash, std::string_view(parameter_name));
+		uint64_t parameter_hash = getGroupItemKey(group_name, parameter_name);
 
 		if (group_parameter_lookup.find(parameter_hash) != group_parameter_lookup.end())
 			return false;
@@ -610,13 +593,11 @@ namespace scapes::visual::impl
 
 		invalidateGroup(group);
 
-		uint64_t group_hash = 0;
-		common::HashUtils::combine(group_hash, std::string_view(group->name));
+		foundation::StringID group_name = group->name.c_str();
 
 		for (GroupParameter *parameter : group->parameters)
 		{
-			uint64_t parameter_hash = group_hash;
-			common::HashUtils::combine(parameter_hash, std::string_view(parameter->name));
+			uint64_t parameter_hash = getGroupItemKey(group_name, parameter->name.c_str());
 
 			assert(group_parameter_lookup.find(parameter_hash) != group_parameter_lookup.end());
 			group_parameter_lookup.erase(parameter_hash);
@@ -628,12 +609,12 @@ namespace scapes::visual::impl
 
 		for (GroupTexture *texture : group->textures)
 		{
-			uint64_t texture_hash = group_hash;
-			common::HashUtils::combine(texture_hash, std::string_view(texture->name));
+			uint64_t texture_hash = getGroupItemKey(group_name, texture->name.c_str());
 
 			assert(group_texture_lookup.find(texture_hash) != group_texture_lookup.end());
 			group_texture_lookup.erase(texture_hash);
 
+			releaseGroupTexture(texture);
 			delete texture;
 		}
 
@@ -641,6 +622,17 @@ namespace scapes::visual::impl
 		group->textures.clear();
 	}
 
+	void GpuBindings::releaseGroupTexture(GroupTexture *texture)
+	{
+		assert(texture);
+
+		if (texture->owned)
+			resource_manager->release(texture->texture);
+
+		texture->texture = TextureHandle();
+		texture->owned = false;
+	}
+
 	void GpuBindings::invalidateGroup(Group *group)
 	{
 		assert(group);
@@ -912,6 +904,13 @@ namespace scapes::visual::impl
 			return;
 
 		TextureHandle handle = resource_manager->fetch<Texture>(texture_path.c_str(), device);
-		setGroupTexture(group_name, texture_name.c_str(), handle);
+		if (!setGroupTexture(group_name, texture_name.c_str(), handle))
+		{
+			resource_manager->release(handle);
+			return;
+		}
+
+		uint64_t texture_hash = getGroupItemKey(group_name, texture_name.c_str());
+		group_texture_lookup[texture_hash]->owned = true;
 	}
 }
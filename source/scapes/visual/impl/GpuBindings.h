@@ -1,6 +1,7 @@
 #pragma once
 
 #include <scapes/Common.h>
+#include <scapes/foundation/Hash.h>
 #include <scapes/visual/serde/Yaml.h>
 
 #include <scapes/visual/Texture.h>
@@ -37,25 +38,25 @@ namespace scapes::visual::impl
 		bool serialize(foundation::serde::yaml::NodeRef root);
 
 		bool addGroup(const char *name);
-		bool removeGroup(const char *name);
-		bool clearGroup(const char *name);
+		bool removeGroup(foundation::StringID name);
+		bool clearGroup(foundation::StringID name);
 
-		hardware::BindSet getGroupBindings(const char *name) const;
+		hardware::BindSet getGroupBindings(foundation::StringID name) const;
 
 		bool addGroupParameter(const char *group_name, const char *parameter_name, size_t element_size, size_t num_elements);
 		bool addGroupParameter(const char *group_name, const char *parameter_name, GroupParameterType type, size_t num_elements);
-		bool removeGroupParameter(const char *group_name, const char *parameter_name);
+		bool removeGroupParameter(foundation::StringID group_name, foundation::StringID parameter_name);
 
 		bool addGroupTexture(const char *group_name, const char *texture_name);
-		bool removeGroupTexture(const char *group_name, const char *texture_name);
+		bool removeGroupTexture(foundation::StringID group_name, foundation::StringID texture_name);
 
-		size_t getGroupParameterElementSize(const char *group_name, const char *parameter_name) const;
-		size_t getGroupParameterNumElements(const char *group_name, const char *parameter_name) const;
-		const void *getGroupParameter(const char *group_name, const char *parameter_name, size_t index) const;
-		bool setGroupParameter(const char *group_name, const char *parameter_name, size_t dst_index, size_t num_src_elements, const void *src_data);
+		size_t getGroupParameterElementSize(foundation::StringID group_name, foundation::StringID parameter_name) const;
+		size_t getGroupParameterNumElements(foundation::StringID group_name, foundation::StringID parameter_name) const;
+		const void *getGroupParameter(foundation::StringID group_name, foundation::StringID parameter_name, size_t index) const;
+		bool setGroupParameter(foundation::StringID group_name, foundation::StringID parameter_name, size_t dst_index, size_t num_src_elements, const void *src_data);
 
-		TextureHandle getGroupTexture(const char *group_name, const char *texture_name) const;
-		bool setGroupTexture(const char *group_name, const char *texture_name, TextureHandle handle);
+		TextureHandle getGroupTexture(foundation::StringID group_name, foundation::StringID texture_name) const;
+		bool setGroupTexture(foundation::StringID group_name, foundation::StringID texture_name, TextureHandle handle);
 
 	private:
 		struct Group;
@@ -78,6 +79,9 @@ namespace scapes::visual::impl
 			std::string name;
 			TextureHandle texture;
 
+			// reference taken by deserialize(), dropped when the texture is replaced or removed
+			bool owned {false};
+
 			Group *group {nullptr};
 		};
 
@@ -94,9 +98,20 @@ namespace scapes::visual::impl
 		};
 
 	private:
+		SCAPES_INLINE static uint64_t getGroupKey(foundation::StringID group_name)
+		{
+			return group_name.value;
+		}
+
+		SCAPES_INLINE static uint64_t getGroupItemKey(foundation::StringID group_name, foundation::StringID item_name)
+		{
+			return foundation::hash::combine(group_name.value, item_name.value);
+		}
+
 		bool addGroupParameterInternal(const char *group_name, const char *parameter_name, GroupParameterType type, size_t element_size, size_t num_elements);
 
 		void clearGroup(Group *group);
+		void releaseGroupTexture(GroupTexture *texture);
 		void invalidateGroup(Group *group);
 		bool flushGroup(Group *group);
 
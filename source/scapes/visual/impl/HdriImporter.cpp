@@ -98,7 +98,8 @@ namespace scapes::visual::impl
 		);
 		renderer.shutdown();
 
-		resource_manager->destroy(hdri_texture);
+		// source image stays cached until texture memory budget is exceeded
+		resource_manager->release(hdri_texture);
 
 		for (uint32_t mip = 0; mip < prefiltered_specular.mip_levels; ++mip)
 		{
@@ -138,7 +138,7 @@ namespace scapes::visual::impl
 		return gpu_bindings.addGroup(name);
 	}
 
-	bool Material::removeGroup(const char *name)
+	bool Material::removeGroup(foundation::StringID name)
 	{
 		return gpu_bindings.removeGroup(name);
 	}
@@ -148,7 +148,7 @@ namespace scapes::visual::impl
 		gpu_bindings.clear();
 	}
 
-	hardware::BindSet Material::getGroupBindings(const char *name) const
+	hardware::BindSet Material::getGroupBindings(foundation::StringID name) const
 	{
 		return gpu_bindings.getGroupBindings(name);
 	}
@@ -165,7 +165,7 @@ namespace scapes::visual::impl
 		return gpu_bindings.addGroupParameter(group_name, parameter_name, element_size, num_elements);
 	}
 
-	bool Material::removeGroupParameter(const char *group_name, const char *parameter_name)
+	bool Material::removeGroupParameter(foundation::StringID group_name, foundation::StringID parameter_name)
 	{
 		return gpu_bindings.removeGroupParameter(group_name, parameter_name);
 	}
@@ -177,41 +177,41 @@ namespace scapes::visual::impl
 		return gpu_bindings.addGroupTexture(group_name, texture_name);
 	}
 
-	bool Material::removeGroupTexture(const char *group_name, const char *texture_name)
+	bool Material::removeGroupTexture(foundation::StringID group_name, foundation::StringID texture_name)
 	{
 		return gpu_bindings.removeGroupTexture(group_name, texture_name);
 	}
 
 	/*
 	 */
-	TextureHandle Material::getGroupTexture(const char *group_name, const char *texture_name) const
+	TextureHandle Material::getGroupTexture(foundation::StringID group_name, foundation::StringID texture_name) const
 	{
 		return gpu_bindings.getGroupTexture(group_name, texture_name);
 	}
 
-	bool Material::setGroupTexture(const char *group_name, const char *texture_name, TextureHandle handle)
+	bool Material::setGroupTexture(foundation::StringID group_name, foundation::StringID texture_name, TextureHandle handle)
 	{
 		return gpu_bindings.setGroupTexture(group_name, texture_name, handle);
 	}
 
 	/*
 	 */
-	size_t Material::getGroupParameterElementSize(const char *group_name, const char *parameter_name) const
+	size_t Material::getGroupParameterElementSize(foundation::StringID group_name, foundation::StringID parameter_name) const
 	{
 		return gpu_bindings.getGroupParameterElementSize(group_name, parameter_name);
 	}
 
-	size_t Material::getGroupParameterNumElements(const char *group_name, const char *parameter_name) const
+	size_t Material::getGroupParameterNumElements(foundation::StringID group_name, foundation::StringID parameter_name) const
 	{
 		return gpu_bindings.getGroupParameterNumElements(group_name, parameter_name);
 	}
 
-	const void *Material::getGroupParameter(const char *group_name, const char *parameter_name, size_t index) const
+	const void *Material::getGroupParameter(foundation::StringID group_name, foundation::StringID parameter_name, size_t index) const
 	{
 		return gpu_bindings.getGroupParameter(group_name, parameter_name, index);
 	}
 
-	bool Material::setGroupParameter(const char *group_name, const char *parameter_name, size_t dst_index, size_t num_src_elements, const void *src_data)
+	bool Material::setGroupParameter(foundation::StringID group_name, foundation::StringID parameter_name, size_t dst_index, size_t num_src_elements, const void *src_data)
 	{
 		return gpu_bindings.setGroupParameter(group_name, parameter_name, dst_index, num_src_elements, src_data);
 	}
@@ -32,26 +32,26 @@ namespace scapes::visual::impl
 		foundation::serde::yaml::Tree serialize() final;
 
 		bool addGroup(const char *name) final;
-		bool removeGroup(const char *name) final;
+		bool removeGroup(foundation::StringID name) final;
 		void removeAllGroups() final;
 
-		hardware::BindSet getGroupBindings(const char *name) const final;
+		hardware::BindSet getGroupBindings(foundation::StringID name) const final;
 
 		bool addGroupParameter(const char *group_name, const char *parameter_name, size_t element_size, size_t num_elements) final;
 		bool addGroupParameter(const char *group_name, const char *parameter_name, GroupParameterType type, size_t num_elements) final;
-		bool removeGroupParameter(const char *group_name, const char *parameter_name) final;
+		bool removeGroupParameter(foundation::StringID group_name, foundation::StringID parameter_name) final;
 
 		bool addGroupTexture(const char *group_name, const char *texture_name) final;
-		bool removeGroupTexture(const char *group_name, const char *texture_name) final;
+		bool removeGroupTexture(foundation::StringID group_name, foundation::StringID texture_name) final;
 
-		TextureHandle getGroupTexture(const char *group_name, const char *texture_name) const final;
-		bool setGroupTexture(const char *group_name, const char *texture_name, TextureHandle handle) final;
+		TextureHandle getGroupTexture(foundation::StringID group_name, foundation::StringID texture_name) const final;
+		bool setGroupTexture(foundation::StringID group_name, foundation::StringID texture_name, TextureHandle handle) final;
 
 	private:
-		size_t getGroupParameterElementSize(const char *group_name, const char *parameter_name) const final;
-		size_t getGroupParameterNumElements(const char *group_name, const char *parameter_name) const final;
-		const void *getGroupParameter(const char *group_name, const char *parameter_name, size_t index) const final;
-		bool setGroupParameter(const char *group_name, const char *parameter_name, size_t dst_index, size_t num_src_elements, const void *src_data) final;
+		size_t getGroupParameterElementSize(foundation::StringID group_name, foundation::StringID parameter_name) const final;
+		size_t getGroupParameterNumElements(foundation::StringID group_name, foundation::StringID parameter_name) const final;
+		const void *getGroupParameter(foundation::StringID group_name, foundation::StringID parameter_name, size_t index) const final;
+		bool setGroupParameter(foundation::StringID group_name, foundation::StringID parameter_name, size_t dst_index, size_t num_src_elements, const void *src_data) final;
 
 	private:
 		foundation::resources::ResourceManager *resource_manager {nullptr};
@@ -21,10 +21,11 @@ void ResourceTraits<scapes::visual::RenderGraph>::create(
 	scapes::visual::hardware::Device *device,
 	scapes::visual::shaders::Compiler *compiler,
 	scapes::foundation::game::World *world,
+	scapes::foundation::jobs::JobSystem *job_system,
 	scapes::visual::MeshHandle unit_quad
 )
 {
-	new (memory) scapes::visual::impl::RenderGraph(resource_manager, device, compiler, world, unit_quad);
+	new (memory) scapes::visual::impl::RenderGraph(resource_manager, device, compiler, world, job_system, unit_quad);
 }
 
 void ResourceTraits<scapes::visual::RenderGraph>::destroy(
@@ -142,9 +143,10 @@ namespace scapes::visual::impl
 		hardware::Device *device,
 		shaders::Compiler *compiler,
 		foundation::game::World *world,
+		foundation::jobs::JobSystem *job_system,
 		MeshHandle unit_quad
 	)
-		: resource_manager(resource_manager), device(device), compiler(compiler), world(world), unit_quad(unit_quad), gpu_bindings(resource_manager, device)
+		: resource_manager(resource_manager), device(device), compiler(compiler), world(world), job_system(job_system), unit_quad(unit_quad), gpu_bindings(resource_manager, device)
 	{
 
 	}
@@ -355,7 +357,7 @@ namespace scapes::visual::impl
 		return gpu_bindings.addGroup(name);
 	}
 
-	bool RenderGraph::removeGroup(const char *name)
+	bool RenderGraph::removeGroup(foundation::StringID name)
 	{
 		return gpu_bindings.removeGroup(name);
 	}
@@ -365,7 +367,7 @@ namespace scapes::visual::impl
 		gpu_bindings.clear();
 	}
 
-	hardware::BindSet RenderGraph::getGroupBindings(const char *name) const
+	hardware::BindSet RenderGraph::getGroupBindings(foundation::StringID name) const
 	{
 		return gpu_bindings.getGroupBindings(name);
 	}
@@ -382,7 +384,7 @@ namespace scapes::visual::impl
 		return gpu_bindings.addGroupParameter(group_name, parameter_name, element_size, num_elements);
 	}
 
-	bool RenderGraph::removeGroupParameter(const char *group_name, const char *parameter_name)
+	bool RenderGraph::removeGroupParameter(foundation::StringID group_name, foundation::StringID parameter_name)
 	{
 		return gpu_bindings.removeGroupParameter(group_name, parameter_name);
 	}
@@ -394,19 +396,19 @@ namespace scapes::visual::impl
 		return gpu_bindings.addGroupTexture(group_name, texture_name);
 	}
 
-	bool RenderGraph::removeGroupTexture(const char *group_name, const char *texture_name)
+	bool RenderGraph::removeGroupTexture(foundation::StringID group_name, foundation::StringID texture_name)
 	{
 		return gpu_bindings.removeGroupTexture(group_name, texture_name);
 	}
 
 	/*
 	 */
-	TextureHandle RenderGraph::getGroupTexture(const char *group_name, const char *texture_name) const
+	TextureHandle RenderGraph::getGroupTexture(foundation::StringID group_name, foundation::StringID texture_name) const
 	{
 		return gpu_bindings.getGroupTexture(group_name, texture_name);
 	}
 
-	bool RenderGraph::setGroupTexture(const char *group_name, const char *texture_name, TextureHandle handle)
+	bool RenderGraph::setGroupTexture(foundation::StringID group_name, foundation::StringID texture_name, TextureHandle handle)
 	{
 		return gpu_bindings.setGroupTexture(group_name, texture_name, handle);
 	}
@@ -415,8 +417,7 @@ namespace scapes::visual::impl
 	 */
 	bool RenderGraph::addRenderBuffer(const char *name, hardware::Format format, uint32_t downscale)
 	{
-		uint64_t hash = 0;
-		common::HashUtils::combine(hash, std::string_view(name));
+		uint64_t hash = foundation::StringID(name).value;
 
 		if (render_buffer_lookup.find(hash) != render_buffer_lookup.end())
 			return false;
@@ -433,10 +434,9 @@ namespace scapes::visual::impl
 		return true;
 	}
 
-	bool RenderGraph::removeRenderBuffer(const char *name)
+	bool RenderGraph::removeRenderBuffer(foundation::StringID name)
 	{
-		uint64_t hash = 0;
-		common::HashUtils::combine(hash, std::string_view(name));
+		uint64_t hash = name.value;
 
 		auto it = render_buffer_lookup.find(hash);
 		if (it == render_buffer_lookup.end())
@@ -457,10 +457,9 @@ namespace scapes::visual::impl
 		render_buffer_lookup.clear();
 	}
 
-	bool RenderGraph::swapRenderBuffers(const char *name0, const char *name1)
+	bool RenderGraph::swapRenderBuffers(foundation::StringID name0, foundation::StringID name1)
 	{
-		uint64_t hash = 0;
-		common::HashUtils::combine(hash, std::string_view(name0));
+		uint64_t hash = name0.value;
 
 		auto it = render_buffer_lookup.find(hash);
 		if (it == render_buffer_lookup.end())
@@ -468,8 +467,7 @@ namespace scapes::visual::impl
 
 		RenderBuffer *render_buffer0 = it->second;
 
-		hash = 0;
-		common::HashUtils::combine(hash, std::string_view(name1));
+		hash = name1.value;
 
 		it = render_buffer_lookup.find(hash);
 		if (it == render_buffer_lookup.end())
@@ -491,10 +489,9 @@ namespace scapes::visual::impl
 
 	/*
 	 */
-	hardware::Texture RenderGraph::getRenderBufferTexture(const char *name) const
+	hardware::Texture RenderGraph::getRenderBufferTexture(foundation::StringID name) const
 	{
-		uint64_t hash = 0;
-		common::HashUtils::combine(hash, std::string_view(name));
+		uint64_t hash = name.value;
 
 		auto it = render_buffer_lookup.find(hash);
 		if (it == render_buffer_lookup.end())
@@ -504,10 +501,9 @@ namespace scapes::visual::impl
 		return render_buffer->texture;
 	}
 
-	hardware::BindSet RenderGraph::getRenderBufferBindings(const char *name) const
+	hardware::BindSet RenderGraph::getRenderBufferBindings(foundation::StringID name) const
 	{
-		uint64_t hash = 0;
-		common::HashUtils::combine(hash, std::string_view(name));
+		uint64_t hash = name.value;
 
 		auto it = render_buffer_lookup.find(hash);
 		if (it == render_buffer_lookup.end())
@@ -517,10 +513,9 @@ namespace scapes::visual::impl
 		return render_buffer->bindings;
 	}
 
-	hardware::Format RenderGraph::getRenderBufferFormat(const char *name) const
+	hardware::Format RenderGraph::getRenderBufferFormat(foundation::StringID name) const
 	{
-		uint64_t hash = 0;
-		common::HashUtils::combine(hash, std::string_view(name));
+		uint64_t hash = name.value;
 
 		auto it = render_buffer_lookup.find(hash);
 		if (it == render_buffer_lookup.end())
@@ -530,10 +525,9 @@ namespace scapes::visual::impl
 		return render_buffer->format;
 	}
 
-	uint32_t RenderGraph::getRenderBufferDownscale(const char *name) const
+	uint32_t RenderGraph::getRenderBufferDownscale(foundation::StringID name) const
 	{
-		uint64_t hash = 0;
-		common::HashUtils::combine(hash, std::string_view(name));
+		uint64_t hash = name.value;
 
 		auto it = render_buffer_lookup.find(hash);
 		if (it == render_buffer_lookup.end())
@@ -634,22 +628,22 @@ namespace scapes::visual::impl
 
 	/*
 	 */
-	size_t RenderGraph::getGroupParameterElementSize(const char *group_name, const char *parameter_name) const
+	size_t RenderGraph::getGroupParameterElementSize(foundation::StringID group_name, foundation::StringID parameter_name) const
 	{
 		return gpu_bindings.getGroupParameterElementSize(group_name, parameter_name);
 	}
 
-	size_t RenderGraph::getGroupParameterNumElements(const char *group_name, const char *parameter_name) const
+	size_t RenderGraph::getGroupParameterNumElements(foundation::StringID group_name, foundation::StringID parameter_name) const
 	{
 		return gpu_bindings.getGroupParameterNumElements(group_name, parameter_name);
 	}
 
-	const void *RenderGraph::getGroupParameter(const char *group_name, const char *parameter_name, size_t index) const
+	const void *RenderGraph::getGroupParameter(foundation::StringID group_name, foundation::StringID parameter_name, size_t index) const
 	{
 		return gpu_bindings.getGroupParameter(group_name, parameter_name, index);
 	}
 
-	bool RenderGraph::setGroupParameter(const char *group_name, const char *parameter_name, size_t dst_index, size_t num_src_elements, const void *src_data)
+	bool RenderGraph::setGroupParameter(foundation::StringID group_name, foundation::StringID parameter_name, size_t dst_index, size_t num_src_elements, const void *src_data)
 	{
 		return gpu_bindings.setGroupParameter(group_name, parameter_name, dst_index, num_src_elements, src_data);
 	}
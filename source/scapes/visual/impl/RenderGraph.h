@@ -19,6 +19,7 @@ namespace scapes::visual::impl
 			hardware::Device *device,
 			shaders::Compiler *compiler,
 			foundation::game::World *world,
+			foundation::jobs::JobSystem *job_system,
 			MeshHandle unit_quad
 		);
 		~RenderGraph() final;
@@ -27,6 +28,7 @@ namespace scapes::visual::impl
 		SCAPES_INLINE hardware::Device *getDevice() const final { return device; }
 		SCAPES_INLINE shaders::Compiler *getCompiler() const final { return compiler; }
 		SCAPES_INLINE foundation::game::World *getWorld() const final { return world; }
+		SCAPES_INLINE foundation::jobs::JobSystem *getJobSystem() const final { return job_system; }
 		SCAPES_INLINE MeshHandle getUnitQuad() const final { return unit_quad; }
 
 		SCAPES_INLINE uint32_t getWidth() const final { return width; }
@@ -46,30 +48,30 @@ namespace scapes::visual::impl
 		SCAPES_INLINE const hardware::SwapChain getSwapChain() const final { return swap_chain; }
 
 		bool addGroup(const char *name) final;
-		bool removeGroup(const char *name) final;
+		bool removeGroup(foundation::StringID name) final;
 		void removeAllGroups() final;
 
-		hardware::BindSet getGroupBindings(const char *name) const final;
+		hardware::BindSet getGroupBindings(foundation::StringID name) const final;
 
 		bool addGroupParameter(const char *group_name, const char *parameter_name, size_t element_size, size_t num_elements) final;
 		bool addGroupParameter(const char *group_name, const char *parameter_name, GroupParameterType type, size_t num_elements) final;
-		bool removeGroupParameter(const char *group_name, const char *parameter_name) final;
+		bool removeGroupParameter(foundation::StringID group_name, foundation::StringID parameter_name) final;
 
 		bool addGroupTexture(const char *group_name, const char *texture_name) final;
-		bool removeGroupTexture(const char *group_name, const char *texture_name) final;
+		bool removeGroupTexture(foundation::StringID group_name, foundation::StringID texture_name) final;
 
-		TextureHandle getGroupTexture(const char *group_name, const char *texture_name) const final;
-		bool setGroupTexture(const char *group_name, const char *texture_name, TextureHandle handle) final;
+		TextureHandle getGroupTexture(foundation::StringID group_name, foundation::StringID texture_name) const final;
+		bool setGroupTexture(foundation::StringID group_name, foundation::StringID texture_name, TextureHandle handle) final;
 
 		bool addRenderBuffer(const char *name, hardware::Format format, uint32_t downscale) final;
-		bool removeRenderBuffer(const char *name) final;
+		bool removeRenderBuffer(foundation::StringID name) final;
 		void removeAllRenderBuffers() final;
-		bool swapRenderBuffers(const char *name0, const char *name1) final;
+		bool swapRenderBuffers(foundation::StringID name0, foundation::StringID name1) final;
 
-		hardware::Texture getRenderBufferTexture(const char *name) const final;
-		hardware::BindSet getRenderBufferBindings(const char *name) const final;
-		hardware::Format getRenderBufferFormat(const char *name) const final;
-		uint32_t getRenderBufferDownscale(const char *name) const final;
+		hardware::Texture getRenderBufferTexture(foundation::StringID name) const final;
+		hardware::BindSet getRenderBufferBindings(foundation::StringID name) const final;
+		hardware::Format getRenderBufferFormat(foundation::StringID name) const final;
+		uint32_t getRenderBufferDownscale(foundation::StringID name) const final;
 
 		hardware::FrameBuffer fetchFrameBuffer(uint32_t num_attachments, const char *render_buffer_names[]) final;
 
@@ -101,10 +103,10 @@ namespace scapes::visual::impl
 		};
 
 	private:
-		size_t getGroupParameterElementSize(const char *group_name, const char *parameter_name) const final;
-		size_t getGroupParameterNumElements(const char *group_name, const char *parameter_name) const final;
-		const void *getGroupParameter(const char *group_name, const char *parameter_name, size_t index) const final;
-		bool setGroupParameter(const char *group_name, const char *parameter_name, size_t dst_index, size_t num_src_elements, const void *src_data) final;
+		size_t getGroupParameterElementSize(foundation::StringID group_name, foundation::StringID parameter_name) const final;
+		size_t getGroupParameterNumElements(foundation::StringID group_name, foundation::StringID parameter_name) const final;
+		const void *getGroupParameter(foundation::StringID group_name, foundation::StringID parameter_name, size_t index) const final;
+		bool setGroupParameter(foundation::StringID group_name, foundation::StringID parameter_name, size_t dst_index, size_t num_src_elements, const void *src_data) final;
 
 		IRenderPass *createRenderPass(const char *type_name, const char *name) final;
 		int32_t findRenderPass(const char *name);
@@ -125,6 +127,7 @@ namespace scapes::visual::impl
 		hardware::Device *device {nullptr};
 		shaders::Compiler *compiler {nullptr};
 		foundation::game::World *world {nullptr};
+		foundation::jobs::JobSystem *job_system {nullptr};
 
 		MeshHandle unit_quad;
 
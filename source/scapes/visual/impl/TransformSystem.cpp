@@ -0,0 +1,262 @@
+#include "TransformSystem.h"
+
+#include <scapes/foundation/jobs/JobSystem.h>
+#include <scapes/foundation/profiler/Profiler.h>
+#include <scapes/foundation/Log.h>
+
+#include <algorithm>
+#include <unordered_map>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+	#include <xmmintrin.h>
+	#define SCAPES_TRANSFORM_SSE
+#endif
+
+namespace scapes::visual::impl
+{
+	/*
+	 */
+	static SCAPES_INLINE void multiply(const foundation::math::mat4 &a, const foundation::math::mat4 &b, foundation::math::mat4 &result)
+	{
+#if defined(SCAPES_TRANSFORM_SSE)
+		// every result column is a linear combination of a's columns
+		const float *pa = &a[0][0];
+		const float *pb = &b[0][0];
+		float *pr = &result[0][0];
+
+		__m128 a0 = _mm_loadu_ps(pa + 0);
+		__m128 a1 = _mm_loadu_ps(pa + 4);
+		__m128 a2 = _mm_loadu_ps(pa + 8);
+		__m128 a3 = _mm_loadu_ps(pa + 12);
+
+		for (int i = 0; i < 4; ++i)
+		{
+			__m128 column = _mm_mul_ps(a0, _mm_set1_ps(pb[i * 4 + 0]));
+			column = _mm_add_ps(column, _mm_mul_ps(a1, _mm_set1_ps(pb[i * 4 + 1])));
+			column = _mm_add_ps(column, _mm_mul_ps(a2, _mm_set1_ps(pb[i * 4 + 2])));
+			column = _mm_add_ps(column, _mm_mul_ps(a3, _mm_set1_ps(pb[i * 4 + 3])));
+
+			_mm_storeu_ps(pr + i * 4, column);
+		}
+#else
+		result = a * b;
+#endif
+	}
+
+	/*
+	 */
+	TransformSystem::TransformSystem(
+		foundation::game::World *world,
+		foundation::jobs::JobSystem *job_system
+	)
+		: world(world), job_system(job_system)
+	{
+		assert(world);
+		assert(job_system);
+
+		// reparenting writes Parent in place, without changing the world structure
+		world->enableChangeTracking<components::Parent>();
+
+		nodes_query = new foundation::game::Query<components::LocalTransform, components::Transform>(world);
+		children_query = new foundation::game::Query<const components::Parent>(world);
+	}
+
+	TransformSystem::~TransformSystem()
+	{
+		delete nodes_query;
+		nodes_query = nullptr;
+
+		delete children_query;
+		children_query = nullptr;
+	}
+
+	/*
+	 */
+	void TransformSystem::update()
+	{
+		SCAPES_PROFILER();
+
+		uint64_t since_tick = parent_change_tick;
+		parent_change_tick = world->advanceChangeTick();
+
+		uint64_t version = world->getStructureVersion();
+		if (version != structure_version || hasParentChanges(since_tick))
+		{
+			rebuild(since_tick);
+			structure_version = version;
+		}
+
+		// recomputed transforms count as changed if someone tracks them
+		uint64_t change_tick = world->getChangeTick();
+
+		uint32_t num_levels = static_cast<uint32_t>(level_offsets.size()) - 1;
+		for (uint32_t level = 0; level < num_levels; ++level)
+		{
+			uint32_t begin = level_offsets[level];
+			uint32_t end = level_offsets[level + 1];
+
+			job_system->parallelFor(begin, end, BATCH_SIZE, [this, change_tick](uint32_t index)
+			{
+				const Node &node = nodes[index];
+
+				bool parent_changed = (node.parent != INVALID_NODE) && changed[node.parent];
+				if (!node.local->dirty && !parent_changed)
+				{
+					changed[index] = 0;
+					return;
+				}
+
+				if (node.parent == INVALID_NODE)
+					node.transform->transform = node.local->transform;
+				else
+					multiply(nodes[node.parent].transform->transform, node.local->transform, node.transform->transform);
+
+				if (node.change_tick)
+					*node.change_tick = change_tick;
+
+				node.local->dirty = false;
+				changed[index] = 1;
+			});
+		}
+	}
+
+	/*
+	 */
+	bool TransformSystem::hasParentChanges(uint64_t since_tick)
+	{
+		SCAPES_PROFILER();
+
+		children_query->begin();
+
+		while (children_query->next())
+		{
+			uint32_t num_items = children_query->getNumComponents();
+			const uint64_t *change_ticks = children_query->getChangeTicks(0);
+
+			if (!change_ticks)
+				continue;
+
+			for (uint32_t i = 0; i < num_items; ++i)
+				if (change_ticks[i] > since_tick)
+					return true;
+		}
+
+		return false;
+	}
+
+	void TransformSystem::rebuild(uint64_t since_tick)
+	{
+		SCAPES_PROFILER();
+
+		std::vector<Node> unsorted;
+		std::unordered_map<foundation::game::EntityID *, uint32_t> index_by_entity;
+
+		nodes_query->begin();
+
+		while (nodes_query->next())
+		{
+			uint32_t num_items = nodes_query->getNumComponents();
+			foundation::game::EntityID *const *entities = nodes_query->getEntities();
+			components::LocalTransform *locals = nodes_query->getComponents<components::LocalTransform>(0);
+			components::Transform *transforms = nodes_query->getComponents<components::Transform>(1);
+			uint64_t *change_ticks = nodes_query->getChangeTicks(1);
+
+			for (uint32_t i = 0; i < num_items; ++i)
+			{
+				index_by_entity.insert({entities[i], static_cast<uint32_t>(unsorted.size())});
+				unsorted.push_back({&locals[i], &transforms[i], (change_ticks) ? &change_ticks[i] : nullptr, INVALID_NODE});
+			}
+		}
+
+		children_query->begin();
+
+		while (children_query->next())
+		{
+			uint32_t num_items = children_query->getNumComponents();
+			foundation::game::EntityID *const *entities = children_query->getEntities();
+			const components::Parent *parents = children_query->getComponents<const components::Parent>(0);
+			const uint64_t *change_ticks = children_query->getChangeTicks(0);
+
+			for (uint32_t i = 0; i < num_items; ++i)
+			{
+				auto child_it = index_by_entity.find(entities[i]);
+				if (child_it == index_by_entity.end())
+					continue;
+
+				// moved nodes have to be recomputed against their new parent
+				if (change_ticks && change_ticks[i] > since_tick)
+					unsorted[child_it->second].local->dirty = true;
+
+				// parents without transforms don't affect their children
+				auto parent_it = index_by_entity.find(parents[i].entity);
+				if (parent_it == index_by_entity.end())
+					continue;
+
+				unsorted[child_it->second].parent = parent_it->second;
+			}
+		}
+
+		uint32_t num_nodes = static_cast<uint32_t>(unsorted.size());
+
+		// walk up until a node with known depth or a root, then assign depths on the way back
+		std::vector<uint32_t> depths(num_nodes, INVALID_NODE);
+		std::vector<uint32_t> path;
+		uint32_t max_depth = 0;
+
+		for (uint32_t i = 0; i < num_nodes; ++i)
+		{
+			uint32_t node = i;
+			while (depths[node] == INVALID_NODE && unsorted[node].parent != INVALID_NODE)
+			{
+				path.push_back(node);
+				node = unsorted[node].parent;
+
+				// longer than the whole hierarchy, so node is inside a cycle; make it a root and walk again
+				if (path.size() > num_nodes)
+				{
+					foundation::Log::error("TransformSystem::rebuild(): cycle in the hierarchy, breaking it\n");
+					unsorted[node].parent = INVALID_NODE;
+					path.clear();
+					node = i;
+				}
+			}
+
+			uint32_t depth = (depths[node] == INVALID_NODE) ? 0 : depths[node];
+			depths[node] = depth;
+
+			while (!path.empty())
+			{
+				depths[path.back()] = ++depth;
+				path.pop_back();
+			}
+
+			max_depth = std::max(max_depth, depth);
+		}
+
+		// counting sort by depth, parents land before their children
+		level_offsets.assign(max_depth + 2, 0);
+		for (uint32_t i = 0; i < num_nodes; ++i)
+			level_offsets[depths[i] + 1]++;
+
+		for (uint32_t level = 1; level < level_offsets.size(); ++level)
+			level_offsets[level] += level_offsets[level - 1];
+
+		std::vector<uint32_t> cursors(level_offsets.begin(), level_offsets.end() - 1);
+		std::vector<uint32_t> sorted_index(num_nodes);
+
+		for (uint32_t i = 0; i < num_nodes; ++i)
+			sorted_index[i] = cursors[depths[i]]++;
+
+		nodes.resize(num_nodes);
+		for (uint32_t i = 0; i < num_nodes; ++i)
+		{
+			Node node = unsorted[i];
+			if (node.parent != INVALID_NODE)
+				node.parent = sorted_index[node.parent];
+
+			nodes[sorted_index[i]] = node;
+		}
+
+		changed.assign(num_nodes, 0);
+	}
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <scapes/visual/TransformSystem.h>
+#include <scapes/visual/components/Components.h>
+
+#include <scapes/foundation/game/Query.h>
+
+#include <vector>
+
+namespace scapes::visual::impl
+{
+	/*
+	 */
+	class TransformSystem : public visual::TransformSystem
+	{
+	public:
+		TransformSystem(
+			foundation::game::World *world,
+			foundation::jobs::JobSystem *job_system
+		);
+		~TransformSystem() final;
+
+		void update() final;
+
+	private:
+		bool hasParentChanges(uint64_t since_tick);
+		void rebuild(uint64_t since_tick);
+
+	private:
+		enum
+		{
+			INVALID_NODE = ~0u,
+			BATCH_SIZE = 256,
+		};
+
+		struct Node
+		{
+			components::LocalTransform *local {nullptr};
+			components::Transform *transform {nullptr};
+			uint64_t *change_tick {nullptr};
+			uint32_t parent {INVALID_NODE};
+		};
+
+	private:
+		foundation::game::World *world {nullptr};
+		foundation::jobs::JobSystem *job_system {nullptr};
+
+		foundation::game::Query<components::LocalTransform, components::Transform> *nodes_query {nullptr};
+		foundation::game::Query<const components::Parent> *children_query {nullptr};
+
+		// sorted by depth, level i spans [level_offsets[i], level_offsets[i + 1])
+		std::vector<Node> nodes;
+		std::vector<uint32_t> level_offsets;
+
+		// written for one level and read by the next one, so levels never race
+		std::vector<uint8_t> changed;
+
+		// component pointers in nodes are valid until the world structure changes
+		uint64_t structure_version {~0ull};
+
+		// Parent changes stamped after this tick haven't been seen yet
+		uint64_t parent_change_tick {0};
+	};
+}
@@ -1,12 +1,113 @@
 #include <scapes/visual/Mesh.h>
 #include <scapes/visual/hardware/Device.h>
 
-#include <iostream>
+#include <scapes/foundation/Log.h>
+
+#include <algorithm>
 #include <cassert>
+#include <cmath>
+#include <iostream>
 
 using namespace scapes;
 using namespace scapes::visual;
 
+/* Sphere is centered on the box, its radius is the distance to the farthest vertex
+ * which is usually tighter than half of the box diagonal
+ */
+static void updateBounds(Mesh *mesh)
+{
+	assert(mesh->num_vertices);
+
+	mesh->aabb_min = mesh->vertices[0].position;
+	mesh->aabb_max = mesh->vertices[0].position;
+
+	for (uint32_t i = 1; i < mesh->num_vertices; ++i)
+	{
+		mesh->aabb_min = foundation::math::min(mesh->aabb_min, mesh->vertices[i].position);
+		mesh->aabb_max = foundation::math::max(mesh->aabb_max, mesh->vertices[i].position);
+	}
+
+	mesh->sphere_center = (mesh->aabb_min + mesh->aabb_max) * 0.5f;
+
+	float radius_squared = 0.0f;
+	for (uint32_t i = 0; i < mesh->num_vertices; ++i)
+	{
+		foundation::math::vec3 offset = mesh->vertices[i].position - mesh->sphere_center;
+		radius_squared = std::max(radius_squared, foundation::math::dot(offset, offset));
+	}
+
+	mesh->sphere_radius = sqrtf(radius_squared);
+}
+
+static void copyData(Mesh *mesh, uint32_t num_vertices, const Mesh::Vertex *vertices, uint32_t num_indices, const uint32_t *indices)
+{
+	mesh->num_vertices = num_vertices;
+	mesh->num_indices = num_indices;
+
+	// TODO: use subresource pools
+	mesh->vertices = new Mesh::Vertex[mesh->num_vertices];
+	mesh->indices = new uint32_t[mesh->num_indices];
+
+	memcpy(mesh->vertices, vertices, sizeof(Mesh::Vertex) * mesh->num_vertices);
+	memcpy(mesh->indices, indices, sizeof(uint32_t) * mesh->num_indices);
+}
+
+/* Ranges are reused while they fit, so flushing updated vertices doesn't touch the arena
+ */
+static void flushToArena(Mesh *mesh)
+{
+	scapes::visual::GeometryArena *arena = mesh->arena;
+	scapes::visual::GeometryRange &range = mesh->arena_range;
+
+	bool fits = (range.vertex_buffer != SCAPES_NULL_HANDLE)
+		&& (range.num_vertices == mesh->num_vertices)
+		&& (range.num_indices == mesh->num_indices);
+
+	if (!fits)
+	{
+		if (range.vertex_buffer != SCAPES_NULL_HANDLE)
+			arena->free(range);
+
+		range = {};
+
+		if (!arena->allocate(mesh->num_vertices, mesh->num_indices, range))
+		{
+			foundation::Log::error("Mesh::flushToGPU(): can't allocate %u vertices and %u indices in geometry arena\n", mesh->num_vertices, mesh->num_indices);
+
+			mesh->vertex_buffer = SCAPES_NULL_HANDLE;
+			mesh->index_buffer = SCAPES_NULL_HANDLE;
+			mesh->base_vertex = 0;
+			mesh->base_index = 0;
+			return;
+		}
+	}
+
+	mesh->vertex_buffer = range.vertex_buffer;
+	mesh->index_buffer = range.index_buffer;
+	mesh->base_vertex = range.base_vertex;
+	mesh->base_index = range.base_index;
+
+	mesh->device->update(mesh->vertex_buffer, mesh->base_vertex, mesh->num_vertices, mesh->vertices);
+	mesh->device->update(mesh->index_buffer, mesh->base_index, mesh->num_indices, mesh->indices);
+}
+
+/*
+ */
+const hardware::VertexAttribute *Mesh::getVertexAttributes()
+{
+	static hardware::VertexAttribute attributes[NUM_VERTEX_ATTRIBUTES] =
+	{
+		{ hardware::Format::R32G32B32_SFLOAT, offsetof(Mesh::Vertex, position) },
+		{ hardware::Format::R32G32_SFLOAT, offsetof(Mesh::Vertex, uv) },
+		{ hardware::Format::R32G32B32A32_SFLOAT, offsetof(Mesh::Vertex, tangent) },
+		{ hardware::Format::R32G32B32_SFLOAT, offsetof(Mesh::Vertex, binormal) },
+		{ hardware::Format::R32G32B32_SFLOAT, offsetof(Mesh::Vertex, normal) },
+		{ hardware::Format::R32G32B32A32_SFLOAT, offsetof(Mesh::Vertex, color) },
+	};
+
+	return attributes;
+}
+
 /*
  */
 size_t ResourceTraits<Mesh>::size()
@@ -40,16 +141,30 @@ void ResourceTraits<Mesh>::create(
 
 	*mesh = {};
 	mesh->device = device;
-	mesh->num_vertices = num_vertices;
-	mesh->num_indices = num_indices;
 
-	// TODO: use subresource pools
-	mesh->vertices = new Mesh::Vertex[mesh->num_vertices];
-	mesh->indices = new uint32_t[mesh->num_indices];
+	copyData(mesh, num_vertices, vertices, num_indices, indices);
+	flushToGPU(resource_manager, memory);
+}
 
-	memcpy(mesh->vertices, vertices, sizeof(Mesh::Vertex) * mesh->num_vertices);
-	memcpy(mesh->indices, indices, sizeof(uint32_t) * mesh->num_indices);
+void ResourceTraits<Mesh>::create(
+	foundation::resources::ResourceManager *resource_manager,
+	void *memory,
+	scapes::visual::GeometryArena *arena,
+	uint32_t num_vertices,
+	Mesh::Vertex *vertices,
+	uint32_t num_indices,
+	uint32_t *indices
+)
+{
+	assert(arena);
 
+	Mesh *mesh = reinterpret_cast<Mesh *>(memory);
+
+	*mesh = {};
+	mesh->device = arena->getDevice();
+	mesh->arena = arena;
+
+	copyData(mesh, num_vertices, vertices, num_indices, indices);
 	flushToGPU(resource_manager, memory);
 }
 
@@ -63,8 +178,16 @@ void ResourceTraits<Mesh>::destroy(
 
 	assert(device);
 
-	device->destroyVertexBuffer(mesh->vertex_buffer);
-	device->destroyIndexBuffer(mesh->index_buffer);
+	if (mesh->arena)
+	{
+		if (mesh->arena_range.vertex_buffer != SCAPES_NULL_HANDLE)
+			mesh->arena->free(mesh->arena_range);
+	}
+	else
+	{
+		device->destroyVertexBuffer(mesh->vertex_buffer);
+		device->destroyIndexBuffer(mesh->index_buffer);
+	}
 
 	// TODO: use subresource pools
 	delete[] mesh->vertices;
@@ -97,21 +220,19 @@ void ResourceTraits<Mesh>::flushToGPU(
 	assert(mesh->vertices);
 	assert(mesh->indices);
 
-	static scapes::visual::hardware::VertexAttribute mesh_attributes[6] =
+	updateBounds(mesh);
+
+	if (mesh->arena)
 	{
-		{ scapes::visual::hardware::Format::R32G32B32_SFLOAT, offsetof(Mesh::Vertex, position) },
-		{ scapes::visual::hardware::Format::R32G32_SFLOAT, offsetof(Mesh::Vertex, uv) },
-		{ scapes::visual::hardware::Format::R32G32B32A32_SFLOAT, offsetof(Mesh::Vertex, tangent) },
-		{ scapes::visual::hardware::Format::R32G32B32_SFLOAT, offsetof(Mesh::Vertex, binormal) },
-		{ scapes::visual::hardware::Format::R32G32B32_SFLOAT, offsetof(Mesh::Vertex, normal) },
-		{ scapes::visual::hardware::Format::R32G32B32A32_SFLOAT, offsetof(Mesh::Vertex, color) },
-	};
+		flushToArena(mesh);
+		return;
+	}
 
 	device->destroyVertexBuffer(mesh->vertex_buffer);
 	mesh->vertex_buffer = device->createVertexBuffer(
 		scapes::visual::hardware::BufferType::STATIC,
 		sizeof(Mesh::Vertex), mesh->num_vertices,
-		6, mesh_attributes,
+		Mesh::NUM_VERTEX_ATTRIBUTES, Mesh::getVertexAttributes(),
 		mesh->vertices
 	);
 
@@ -134,3 +255,29 @@ bool ResourceTraits<Mesh>::reload(
 {
 	return false;
 }
+
+size_t ResourceTraits<Mesh>::getCPUMemory(
+	foundation::resources::ResourceManager *resource_manager,
+	void *memory
+)
+{
+	Mesh *mesh = reinterpret_cast<Mesh *>(memory);
+
+	size_t vertices_size = (mesh->vertices) ? sizeof(Mesh::Vertex) * mesh->num_vertices : 0;
+	size_t indices_size = (mesh->indices) ? sizeof(uint32_t) * mesh->num_indices : 0;
+
+	return vertices_size + indices_size;
+}
+
+size_t ResourceTraits<Mesh>::getGPUMemory(
+	foundation::resources::ResourceManager *resource_manager,
+	void *memory
+)
+{
+	Mesh *mesh = reinterpret_cast<Mesh *>(memory);
+
+	size_t vertices_size = (mesh->vertex_buffer != SCAPES_NULL_HANDLE) ? sizeof(Mesh::Vertex) * mesh->num_vertices : 0;
+	size_t indices_size = (mesh->index_buffer != SCAPES_NULL_HANDLE) ? sizeof(uint32_t) * mesh->num_indices : 0;
+
+	return vertices_size + indices_size;
+}
@@ -5,7 +5,9 @@
 
 #include <scapes/foundation/profiler/Profiler.h>
 
+#include <algorithm>
 #include <cassert>
+#include <cstring>
 #include <iostream>
 
 using namespace scapes;
@@ -42,6 +44,39 @@ static scapes::visual::hardware::Format deduceFormat(size_t pixel_size, int chan
 	return scapes::visual::hardware::Format::UNDEFINED;
 }
 
+static size_t getPixelSize(scapes::visual::hardware::Format format)
+{
+	static uint8_t pixel_sizes[static_cast<int>(scapes::visual::hardware::Format::MAX)] =
+	{
+		0,
+
+		// 8-bit formats
+		1, 1, 1, 1,
+		2, 2, 2, 2,
+		3, 3, 3, 3,
+		3, 3, 3, 3,
+		4, 4, 4, 4,
+		4, 4, 4, 4,
+
+		// 16-bit formats
+		2, 2, 2, 2, 2,
+		4, 4, 4, 4, 4,
+		6, 6, 6, 6, 6,
+		8, 8, 8, 8, 8,
+
+		// 32-bit formats
+		4, 4, 4,
+		8, 8, 8,
+		12, 12, 12,
+		16, 16, 16,
+
+		// depth formats
+		2, 3, 4, 4, 4, 5,
+	};
+
+	return pixel_sizes[static_cast<int>(format)];
+}
+
 /*
  */
 size_t ResourceTraits<Texture>::size()
@@ -84,6 +119,32 @@ void ResourceTraits<Texture>::create(
 	texture->layers = layers;
 }
 
+void ResourceTraits<Texture>::create(
+	foundation::resources::ResourceManager *resource_manager,
+	void *memory,
+	scapes::visual::hardware::Device *device,
+	scapes::visual::hardware::Format format,
+	uint32_t width,
+	uint32_t height,
+	uint32_t mip_levels,
+	uint32_t layers,
+	const void *pixels
+)
+{
+	assert(pixels);
+
+	create(resource_manager, memory, device, format, width, height, mip_levels, layers);
+
+	Texture *texture = reinterpret_cast<Texture *>(memory);
+	size_t size = width * height * getPixelSize(format);
+
+	// owned the same way as decoded images
+	texture->cpu_data = reinterpret_cast<unsigned char *>(STBI_MALLOC(size));
+	memcpy(texture->cpu_data, pixels, size);
+
+	flushToGPU(resource_manager, memory);
+}
+
 void ResourceTraits<Texture>::destroy(
 	foundation::resources::ResourceManager *resource_manager,
 	void *memory
@@ -163,13 +224,29 @@ bool ResourceTraits<Texture>::loadFromMemory(
 {
 	SCAPES_PROFILER();
 
+	if (!decodeFromMemory(resource_manager, memory, data, size))
+		return false;
+
+	flushToGPU(resource_manager, memory);
+	return true;
+}
+
+bool ResourceTraits<Texture>::decodeFromMemory(
+	foundation::resources::ResourceManager *resource_manager,
+	void *memory,
+	const uint8_t *data,
+	size_t size
+)
+{
+	SCAPES_PROFILER();
+
 	int width = 0;
 	int height = 0;
 	int channels = 0;
 
 	if (stbi_info_from_memory(data, static_cast<int>(size), &width, &height, &channels) == 0)
 	{
-		std::cerr << "ResourcePipeline<Texture>::loadFromMemory(): unsupported image format" << std::endl;
+		std::cerr << "ResourcePipeline<Texture>::decodeFromMemory(): unsupported image format" << std::endl;
 		return false;
 	}
 
@@ -180,14 +257,14 @@ bool ResourceTraits<Texture>::loadFromMemory(
 	
 	if (stbi_is_hdr_from_memory(data, static_cast<int>(size)))
 	{
-		SCAPES_PROFILER_N("ResourcePipeline<Texture>::loadFromMemory(): import_stb_hdr_image");
+		SCAPES_PROFILER_N("ResourcePipeline<Texture>::decodeFromMemory(): import_stb_hdr_image");
 
 		stb_pixels = stbi_loadf_from_memory(data, static_cast<int>(size), &width, &height, &channels, desired_components);
 		pixel_size = sizeof(float);
 	}
 	else
 	{
-		SCAPES_PROFILER_N("ResourcePipeline<Texture>::loadFromMemory(): import_stb_regular_image");
+		SCAPES_PROFILER_N("ResourcePipeline<Texture>::decodeFromMemory(): import_stb_regular_image");
 
 		stb_pixels = stbi_load_from_memory(data, static_cast<int>(size), &width, &height, &channels, desired_components);
 		pixel_size = sizeof(stbi_uc);
@@ -195,7 +272,7 @@ bool ResourceTraits<Texture>::loadFromMemory(
 
 	if (!stb_pixels)
 	{
-		std::cerr << "ResourcePipeline<Texture>::loadFromMemory(): " << stbi_failure_reason() << std::endl;
+		std::cerr << "ResourcePipeline<Texture>::decodeFromMemory(): " << stbi_failure_reason() << std::endl;
 		return false;
 	}
 
@@ -204,8 +281,6 @@ bool ResourceTraits<Texture>::loadFromMemory(
 	if (channels == 3)
 		channels = 4;
 
-	size_t image_size = width * height * channels * pixel_size;
-
 	Texture *texture = reinterpret_cast<Texture *>(memory);
 	texture->width = width;
 	texture->height = height;
@@ -213,20 +288,69 @@ bool ResourceTraits<Texture>::loadFromMemory(
 	texture->mip_levels = static_cast<int>(std::floor(std::log2(std::max(width, height))) + 1);
 	texture->layers = 1;
 	texture->format = deduceFormat(pixel_size, channels);
+	texture->cpu_data = reinterpret_cast<unsigned char*>(stb_pixels);
+
+	return true;
+}
+
+void ResourceTraits<Texture>::flushToGPU(
+	foundation::resources::ResourceManager *resource_manager,
+	void *memory
+)
+{
+	SCAPES_PROFILER();
+
+	Texture *texture = reinterpret_cast<Texture *>(memory);
+	assert(texture->cpu_data);
 
 	scapes::visual::hardware::Device *device = texture->device;
 	assert(device);
 
 	{
-		SCAPES_PROFILER_N("ResourcePipeline<Texture>::loadFromMemory(): upload_to_gpu");
-		texture->cpu_data = reinterpret_cast<unsigned char*>(stb_pixels);
+		SCAPES_PROFILER_N("ResourcePipeline<Texture>::flushToGPU(): upload_to_gpu");
 		texture->gpu_data = device->createTexture2D(texture->width, texture->height, texture->mip_levels, texture->format, texture->cpu_data);
 	}
 
 	{
-		SCAPES_PROFILER_N("ResourcePipeline<Texture>::loadFromMemory(): generate_2d_mipmaps");
+		SCAPES_PROFILER_N("ResourcePipeline<Texture>::flushToGPU(): generate_2d_mipmaps");
 		device->generateTexture2DMipmaps(texture->gpu_data);
 	}
+}
 
-	return true;
+size_t ResourceTraits<Texture>::getCPUMemory(
+	foundation::resources::ResourceManager *resource_manager,
+	void *memory
+)
+{
+	Texture *texture = reinterpret_cast<Texture *>(memory);
+
+	if (!texture->cpu_data)
+		return 0;
+
+	return texture->width * texture->height * texture->depth * getPixelSize(texture->format);
+}
+
+size_t ResourceTraits<Texture>::getGPUMemory(
+	foundation::resources::ResourceManager *resource_manager,
+	void *memory
+)
+{
+	Texture *texture = reinterpret_cast<Texture *>(memory);
+
+	if (texture->gpu_data == SCAPES_NULL_HANDLE)
+		return 0;
+
+	size_t pixel_size = getPixelSize(texture->format);
+	size_t result = 0;
+
+	for (uint32_t mip = 0; mip < texture->mip_levels; ++mip)
+	{
+		size_t width = std::max<size_t>(1, texture->width >> mip);
+		size_t height = std::max<size_t>(1, texture->height >> mip);
+		size_t depth = std::max<size_t>(1, texture->depth >> mip);
+
+		result += width * height * depth * pixel_size;
+	}
+
+	return result * std::max<uint32_t>(1, texture->layers);
 }
@@ -92,7 +92,7 @@ namespace scapes::visual::utils
 
 		device->setCullMode(graphics_pipeline,hardware::CullMode::NONE);
 
-		device->drawIndexedPrimitiveInstanced(command_buffer, graphics_pipeline, mesh->index_buffer, mesh->num_indices);
+		device->drawIndexedPrimitiveInstanced(command_buffer, graphics_pipeline, mesh->index_buffer, mesh->num_indices, mesh->base_index, static_cast<int32_t>(mesh->base_vertex));
 
 		device->endRenderPass(command_buffer);
 
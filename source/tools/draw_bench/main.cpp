@@ -0,0 +1,336 @@
+#include "IO.h"
+#include "RenderPasses.h"
+
+#include <scapes/foundation/game/Entity.h>
+#include <scapes/foundation/game/World.h>
+#include <scapes/foundation/jobs/JobSystem.h>
+#include <scapes/foundation/resources/ResourceManager.h>
+
+#include <scapes/visual/components/Components.h>
+#include <scapes/visual/hardware/Device.h>
+#include <scapes/visual/shaders/Compiler.h>
+#include <scapes/visual/GeometryArena.h>
+#include <scapes/visual/Material.h>
+#include <scapes/visual/Mesh.h>
+#include <scapes/visual/RenderGraph.h>
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+using namespace scapes;
+
+namespace config
+{
+	// relative to the assets folder, GBuffer pass only so nothing else shows up in the timings
+	static const char *render_graph_path = "shaders/render_graph/geometry_bench.yaml";
+	static const char *material_path = "materials/default.mat";
+
+	static constexpr uint32_t geometry_page_vertices = 256 * 1024;
+	static constexpr uint32_t geometry_page_indices = 1024 * 1024;
+
+	static constexpr uint32_t width = 1920;
+	static constexpr uint32_t height = 1080;
+}
+
+namespace ids
+{
+	static constexpr foundation::StringID camera = "Camera";
+	static constexpr foundation::StringID camera_view = "View";
+	static constexpr foundation::StringID camera_iview = "IView";
+	static constexpr foundation::StringID camera_projection = "Projection";
+	static constexpr foundation::StringID camera_iprojection = "IProjection";
+	static constexpr foundation::StringID camera_parameters = "Parameters";
+	static constexpr foundation::StringID camera_position = "PositionWS";
+	static constexpr foundation::StringID camera_view_old = "ViewOld";
+}
+
+/*
+ */
+struct BenchOptions
+{
+	uint32_t num_entities {10000};
+	uint32_t num_frames {100};
+	uint32_t num_warmup_frames {10};
+	bool unique_meshes {false};
+};
+
+struct BenchResult
+{
+	double record_time {0.0};
+	double frame_time {0.0};
+	uint32_t num_draw_calls {0};
+	uint32_t num_instances {0};
+	uint32_t num_culled {0};
+	uint32_t num_uploaded {0};
+	bool gpu_driven {false};
+};
+
+using Clock = std::chrono::steady_clock;
+
+/*
+ */
+static void printUsage()
+{
+	printf("Usage: draw_bench [--entities N] [--frames N] [--unique]\n");
+}
+
+static bool parseOptions(int argc, char **argv, BenchOptions &options)
+{
+	for (int i = 1; i < argc; ++i)
+	{
+		std::string argument = argv[i];
+
+		if (argument == "--unique")
+			options.unique_meshes = true;
+		else if (argument == "--entities" && i + 1 < argc)
+			options.num_entities = static_cast<uint32_t>(strtoul(argv[++i], nullptr, 10));
+		else if (argument == "--frames" && i + 1 < argc)
+			options.num_frames = static_cast<uint32_t>(strtoul(argv[++i], nullptr, 10));
+		else
+			return false;
+	}
+
+	return options.num_entities > 0 && options.num_frames > 0;
+}
+
+/*
+ */
+static visual::MeshHandle generateMeshCube(foundation::resources::ResourceManager *resource_manager, visual::GeometryArena *geometry_arena, float size)
+{
+	constexpr uint32_t num_vertices = 8;
+	constexpr uint32_t num_indices = 36;
+
+	visual::Mesh::Vertex vertices[num_vertices];
+	memset(vertices, 0, sizeof(visual::Mesh::Vertex) * num_vertices);
+
+	float half_size = size * 0.5f;
+
+	vertices[0].position = foundation::math::vec3(-half_size, -half_size, -half_size);
+	vertices[1].position = foundation::math::vec3( half_size, -half_size, -half_size);
+	vertices[2].position = foundation::math::vec3( half_size,  half_size, -half_size);
+	vertices[3].position = foundation::math::vec3(-half_size,  half_size, -half_size);
+	vertices[4].position = foundation::math::vec3(-half_size, -half_size,  half_size);
+	vertices[5].position = foundation::math::vec3( half_size, -half_size,  half_size);
+	vertices[6].position = foundation::math::vec3( half_size,  half_size,  half_size);
+	vertices[7].position = foundation::math::vec3(-half_size,  half_size,  half_size);
+
+	for (uint32_t i = 0; i < num_vertices; ++i)
+	{
+		vertices[i].normal = foundation::math::normalize(vertices[i].position);
+		vertices[i].color = foundation::math::vec4(1.0f);
+	}
+
+	static uint32_t indices[num_indices] =
+	{
+		1, 5, 6, 6, 2, 1, // +x
+		0, 1, 2, 2, 3, 0, // -x
+		3, 2, 6, 6, 7, 3, // +y
+		1, 0, 4, 4, 5, 1, // -y
+		5, 4, 6, 4, 7, 6, // +z
+		4, 0, 3, 3, 7, 4, // -z
+	};
+
+	return resource_manager->create<visual::Mesh>(geometry_arena, num_vertices, vertices, num_indices, indices);
+}
+
+static void setupCamera(visual::hardware::Device *device, visual::RenderGraph *render_graph, float extent)
+{
+	// looking down at the whole grid, so nothing gets frustum culled and every instance is drawn
+	const float zNear = 0.1f;
+	const float zFar = extent * 4.0f;
+	const float aspect = static_cast<float>(config::width) / config::height;
+
+	foundation::math::vec3 camera_position(0.0f, -extent * 0.5f, extent);
+	foundation::math::vec3 zero(0.0f);
+	foundation::math::vec3 up(0.0f, 0.0f, 1.0f);
+
+	foundation::math::vec4 camera_parameters;
+	camera_parameters.x = zNear;
+	camera_parameters.y = zFar;
+	camera_parameters.z = 1.0f / zNear;
+	camera_parameters.w = 1.0f / zFar;
+
+	foundation::math::mat4 view = foundation::math::lookAt(camera_position, zero, up);
+	foundation::math::mat4 projection = foundation::math::perspective(foundation::math::radians(90.0f), aspect, zNear, zFar);
+
+	if (!device->isFlipped())
+		projection[1][1] *= -1;
+
+	render_graph->setGroupParameter(ids::camera, ids::camera_view, view);
+	render_graph->setGroupParameter(ids::camera, ids::camera_iview, foundation::math::inverse(view));
+	render_graph->setGroupParameter(ids::camera, ids::camera_projection, projection);
+	render_graph->setGroupParameter(ids::camera, ids::camera_iprojection, foundation::math::inverse(projection));
+	render_graph->setGroupParameter(ids::camera, ids::camera_parameters, camera_parameters);
+	render_graph->setGroupParameter(ids::camera, ids::camera_position, camera_position);
+	render_graph->setGroupParameter(ids::camera, ids::camera_view_old, view);
+}
+
+/*
+ */
+static BenchResult runFrames(
+	visual::hardware::Device *device,
+	foundation::jobs::JobSystem *job_system,
+	visual::RenderGraph *render_graph,
+	RenderPassGeometry *geometry_pass,
+	const BenchOptions &options
+)
+{
+	visual::hardware::CommandBuffer command_buffer = device->createCommandBuffer(visual::hardware::CommandBufferType::PRIMARY);
+
+	BenchResult result;
+	result.gpu_driven = geometry_pass->isGPUDriven();
+
+	for (uint32_t frame = 0; frame < options.num_warmup_frames + options.num_frames; ++frame)
+	{
+		job_system->update();
+
+		Clock::time_point frame_start = Clock::now();
+
+		device->resetCommandBuffer(command_buffer);
+		device->beginCommandBuffer(command_buffer);
+
+		Clock::time_point record_start = Clock::now();
+		render_graph->render(command_buffer);
+		double record_time = std::chrono::duration<double>(Clock::now() - record_start).count();
+
+		device->endCommandBuffer(command_buffer);
+		device->submit(command_buffer);
+		device->wait(1, &command_buffer);
+
+		double frame_time = std::chrono::duration<double>(Clock::now() - frame_start).count();
+
+		// first frames upload instance data and warm pipeline caches
+		if (frame < options.num_warmup_frames)
+			continue;
+
+		result.record_time += record_time;
+		result.frame_time += frame_time;
+	}
+
+	result.record_time /= options.num_frames;
+	result.frame_time /= options.num_frames;
+	result.num_draw_calls = geometry_pass->getNumDrawCalls();
+	result.num_instances = geometry_pass->getNumInstances();
+	result.num_culled = geometry_pass->getNumCulled();
+	result.num_uploaded = geometry_pass->getNumUploadedInstances();
+
+	device->destroyCommandBuffer(command_buffer);
+
+	return result;
+}
+
+/*
+ */
+int main(int argc, char **argv)
+{
+	BenchOptions options;
+	if (!parseOptions(argc, argv, options))
+	{
+		printUsage();
+		return EXIT_FAILURE;
+	}
+
+	ApplicationFileSystem *file_system = new ApplicationFileSystem("assets/");
+
+	visual::hardware::Device *device = visual::hardware::Device::create("Draw Bench", "Scape", visual::hardware::Api::VULKAN);
+	visual::shaders::Compiler *compiler = visual::shaders::Compiler::create(visual::shaders::ShaderILType::SPIRV, file_system);
+
+	foundation::jobs::JobSystem *job_system = foundation::jobs::JobSystem::create();
+	foundation::resources::ResourceManager *resource_manager = foundation::resources::ResourceManager::create(file_system);
+	foundation::game::World *world = foundation::game::World::create();
+	visual::GeometryArena *geometry_arena = visual::GeometryArena::create(device, config::geometry_page_vertices, config::geometry_page_indices);
+
+	visual::RenderGraph::registerRenderPassType<RenderPassGeometry>();
+
+	visual::RenderGraphHandle render_graph = resource_manager->load<visual::RenderGraph>(
+		config::render_graph_path,
+		device,
+		compiler,
+		world,
+		job_system,
+		visual::MeshHandle()
+	);
+
+	RenderPassGeometry *geometry_pass = render_graph->getRenderPass<RenderPassGeometry>("GBuffer");
+	if (!geometry_pass)
+	{
+		fprintf(stderr, "draw_bench: can't find GBuffer pass in \"%s\"\n", config::render_graph_path);
+		return EXIT_FAILURE;
+	}
+
+	render_graph->init(config::width, config::height);
+
+	visual::MaterialHandle material = resource_manager->load<visual::Material>(config::material_path, device, compiler);
+	material->flush();
+
+	// a square grid of cubes, either all sharing one mesh or each with its own
+	uint32_t grid_size = static_cast<uint32_t>(std::ceil(std::sqrt(static_cast<float>(options.num_entities))));
+	float spacing = 3.0f;
+	float extent = grid_size * spacing;
+
+	visual::MeshHandle shared_mesh = generateMeshCube(resource_manager, geometry_arena, 2.0f);
+
+	for (uint32_t i = 0; i < options.num_entities; ++i)
+	{
+		float x = (i % grid_size) * spacing - extent * 0.5f;
+		float y = (i / grid_size) * spacing - extent * 0.5f;
+
+		visual::MeshHandle mesh = (options.unique_meshes) ? generateMeshCube(resource_manager, geometry_arena, 2.0f) : shared_mesh;
+
+		foundation::game::Entity entity(world);
+		entity.addComponent<visual::components::Transform>(foundation::math::translate(foundation::math::mat4(1.0f), foundation::math::vec3(x, y, 0.0f)));
+		entity.addComponent<visual::components::Renderable>(mesh, material);
+	}
+
+	setupCamera(device, render_graph.get(), extent);
+
+	printf("draw_bench: %u entities, %s meshes, %u frames at %ux%u\n",
+		options.num_entities,
+		(options.unique_meshes) ? "unique" : "shared",
+		options.num_frames,
+		config::width,
+		config::height
+	);
+
+	for (bool gpu_driven : {false, true})
+	{
+		geometry_pass->setGPUDriven(gpu_driven);
+
+		if (gpu_driven && !geometry_pass->isGPUDriven())
+		{
+			printf("draw_bench: GPU driven path is not available, culling or indirect shader failed to compile\n");
+			continue;
+		}
+
+		BenchResult result = runFrames(device, job_system, render_graph.get(), geometry_pass, options);
+
+		printf("draw_bench: %-10s %6u draw calls, %6u instances, %6u culled, %6u uploaded, record %7.3f ms, frame %7.3f ms\n",
+			(result.gpu_driven) ? "gpu driven" : "cpu",
+			result.num_draw_calls,
+			result.num_instances,
+			result.num_culled,
+			result.num_uploaded,
+			result.record_time * 1000.0,
+			result.frame_time * 1000.0
+		);
+	}
+
+	device->wait();
+
+	// render graph passes keep world queries, it goes away with the resource manager
+	foundation::resources::ResourceManager::destroy(resource_manager);
+	visual::GeometryArena::destroy(geometry_arena);
+	foundation::game::World::destroy(world);
+	foundation::jobs::JobSystem::destroy(job_system);
+
+	visual::shaders::Compiler::destroy(compiler);
+	visual::hardware::Device::destroy(device);
+
+	delete file_system;
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,480 @@
+#include <scapes/foundation/game/World.h>
+#include <scapes/foundation/game/Entity.h>
+#include <scapes/foundation/game/Query.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+namespace game = scapes::foundation::game;
+
+/*
+ */
+struct BenchTransform
+{
+	float matrix[16] {};
+};
+
+template <>
+struct TypeTraits<BenchTransform>
+{
+	static constexpr const char *name = "tools::BenchTransform";
+};
+
+// same layout as components::Renderable, two resource handles
+struct BenchRenderable
+{
+	void *mesh {nullptr};
+	uint64_t mesh_generation {0};
+	void *material {nullptr};
+	uint64_t material_generation {0};
+};
+
+template <>
+struct TypeTraits<BenchRenderable>
+{
+	static constexpr const char *name = "tools::BenchRenderable";
+};
+
+/*
+ */
+struct BenchOptions
+{
+	std::vector<game::WorldBackend> backends {game::WorldBackend::FLECS, game::WorldBackend::NATIVE};
+	std::vector<std::string> sections;
+	uint32_t num_entities {10000};
+	uint32_t num_frames {1000};
+	uint32_t num_passes {5};
+
+	bool runs(const char *section) const
+	{
+		return sections.empty() || std::find(sections.begin(), sections.end(), section) != sections.end();
+	}
+};
+
+struct LifecycleResult
+{
+	double create_ns {0.0};
+	double add_ns {0.0};
+	double query_ns {0.0};
+	double destroy_ns {0.0};
+};
+
+using Clock = std::chrono::steady_clock;
+
+static const char *getBackendName(game::WorldBackend backend)
+{
+	switch (backend)
+	{
+		case game::WorldBackend::FLECS: return "flecs";
+		case game::WorldBackend::NATIVE: return "native";
+	}
+
+	return "unknown";
+}
+
+static double getMicroseconds(Clock::time_point start, uint32_t count)
+{
+	return std::chrono::duration<double, std::micro>(Clock::now() - start).count() / std::max<uint32_t>(count, 1);
+}
+
+static double getNanoseconds(Clock::time_point start, uint32_t count)
+{
+	return std::chrono::duration<double, std::nano>(Clock::now() - start).count() / std::max<uint32_t>(count, 1);
+}
+
+/*
+ */
+static void printUsage()
+{
+	printf("Usage: ecs_bench [--backend flecs|native]... [--section query|iterate|create|lifecycle]... [--entities N] [--frames N] [--passes N]\n");
+}
+
+static bool parseOptions(int argc, char **argv, BenchOptions &options)
+{
+	std::vector<game::WorldBackend> backends;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		std::string argument = argv[i];
+
+		if (i + 1 >= argc)
+			return false;
+
+		std::string value = argv[++i];
+
+		if (argument == "--backend" && value == "flecs")
+			backends.push_back(game::WorldBackend::FLECS);
+		else if (argument == "--backend" && value == "native")
+			backends.push_back(game::WorldBackend::NATIVE);
+		else if (argument == "--section")
+			options.sections.push_back(value);
+		else if (argument == "--entities")
+			options.num_entities = static_cast<uint32_t>(strtoul(value.c_str(), nullptr, 10));
+		else if (argument == "--frames")
+			options.num_frames = static_cast<uint32_t>(strtoul(value.c_str(), nullptr, 10));
+		else if (argument == "--passes")
+			options.num_passes = static_cast<uint32_t>(strtoul(value.c_str(), nullptr, 10));
+		else
+			return false;
+	}
+
+	if (!backends.empty())
+		options.backends = backends;
+
+	return options.num_entities > 0 && options.num_frames > 0 && options.num_passes > 0;
+}
+
+/*
+ */
+static void populate(game::World *world, uint32_t num_entities)
+{
+	for (uint32_t i = 0; i < num_entities; ++i)
+	{
+		game::Entity entity(world);
+
+		BenchTransform &transform = entity.addComponent<BenchTransform>();
+		transform.matrix[0] = transform.matrix[5] = transform.matrix[10] = transform.matrix[15] = 1.0f;
+		transform.matrix[12] = static_cast<float>(i);
+
+		entity.addComponent<BenchRenderable>();
+	}
+}
+
+static void populateBatched(game::World *world, uint32_t num_entities)
+{
+	std::vector<BenchTransform> transforms(num_entities);
+	std::vector<BenchRenderable> renderables(num_entities);
+
+	for (uint32_t i = 0; i < num_entities; ++i)
+	{
+		BenchTransform &transform = transforms[i];
+		transform.matrix[0] = transform.matrix[5] = transform.matrix[10] = transform.matrix[15] = 1.0f;
+		transform.matrix[12] = static_cast<float>(i);
+	}
+
+	world->createEntities<BenchTransform, BenchRenderable>(num_entities, nullptr, transforms.data(), renderables.data());
+}
+
+static float visitChunks(game::Query<BenchTransform, BenchRenderable> &query)
+{
+	// the begin/next loop render passes run
+	float sum = 0.0f;
+
+	query.begin();
+
+	while (query.next())
+	{
+		uint32_t count = query.getNumComponents();
+		BenchTransform *transforms = query.getComponents<BenchTransform>(0);
+
+		for (uint32_t i = 0; i < count; ++i)
+			sum += transforms[i].matrix[12];
+	}
+
+	return sum;
+}
+
+/*
+ */
+static void runQuerySetup(game::WorldBackend backend, const BenchOptions &options)
+{
+	// what a render pass pays per frame to get at its renderables, with and without setting the query up again
+	game::World *world = game::World::create(backend);
+	populate(world, options.num_entities);
+
+	volatile float sink = 0.0f;
+
+	Clock::time_point start = Clock::now();
+
+	for (uint32_t frame = 0; frame < options.num_frames; ++frame)
+		game::Query<BenchTransform, BenchRenderable> query(world);
+
+	double setup_us = getMicroseconds(start, options.num_frames);
+
+	start = Clock::now();
+
+	for (uint32_t frame = 0; frame < options.num_frames; ++frame)
+	{
+		game::Query<BenchTransform, BenchRenderable> query(world);
+		sink = sink + visitChunks(query);
+	}
+
+	double per_frame_us = getMicroseconds(start, options.num_frames);
+
+	double persistent_us = 0.0;
+
+	{
+		game::Query<BenchTransform, BenchRenderable> query(world);
+
+		start = Clock::now();
+
+		for (uint32_t frame = 0; frame < options.num_frames; ++frame)
+			sink = sink + visitChunks(query);
+
+		persistent_us = getMicroseconds(start, options.num_frames);
+	}
+
+	printf("ecs_bench: %-6s query setup %8.3f us, frame with a new query %8.3f us, frame with a kept query %8.3f us\n",
+		getBackendName(backend),
+		setup_us,
+		per_frame_us,
+		persistent_us
+	);
+
+	game::World::destroy(world);
+}
+
+static void runIteration(game::WorldBackend backend, const BenchOptions &options)
+{
+	// the per-entity loop of RenderPassGeometry: read the transform, skip renderables without a mesh
+	game::World *world = game::World::create(backend);
+	populate(world, options.num_entities);
+
+	volatile float sink = 0.0f;
+	double next_ns = 0.0;
+	double chunk_ns = 0.0;
+	double each_ns = 0.0;
+
+	// queries have to be gone before the world is
+	{
+		game::Query<BenchTransform, BenchRenderable> query(world);
+
+		Clock::time_point start = Clock::now();
+
+		for (uint32_t frame = 0; frame < options.num_frames; ++frame)
+		{
+			float sum = 0.0f;
+
+			query.begin();
+
+			while (query.next())
+			{
+				uint32_t count = query.getNumComponents();
+				BenchTransform *transforms = query.getComponents<BenchTransform>(0);
+				BenchRenderable *renderables = query.getComponents<BenchRenderable>(1);
+
+				for (uint32_t i = 0; i < count; ++i)
+					if (renderables[i].mesh == nullptr)
+						sum += transforms[i].matrix[12];
+			}
+
+			sink = sink + sum;
+		}
+
+		next_ns = getMicroseconds(start, options.num_frames) * 1000.0 / options.num_entities;
+
+		start = Clock::now();
+
+		for (uint32_t frame = 0; frame < options.num_frames; ++frame)
+		{
+			float sum = 0.0f;
+
+			query.forEachChunk([&sum](uint32_t count, BenchTransform *transforms, BenchRenderable *renderables)
+			{
+				for (uint32_t i = 0; i < count; ++i)
+					if (renderables[i].mesh == nullptr)
+						sum += transforms[i].matrix[12];
+			});
+
+			sink = sink + sum;
+		}
+
+		chunk_ns = getMicroseconds(start, options.num_frames) * 1000.0 / options.num_entities;
+
+		start = Clock::now();
+
+		for (uint32_t frame = 0; frame < options.num_frames; ++frame)
+		{
+			float sum = 0.0f;
+
+			query.forEach([&sum](BenchTransform &transform, BenchRenderable &renderable)
+			{
+				if (renderable.mesh == nullptr)
+					sum += transform.matrix[12];
+			});
+
+			sink = sink + sum;
+		}
+
+		each_ns = getMicroseconds(start, options.num_frames) * 1000.0 / options.num_entities;
+	}
+
+	printf("ecs_bench: %-6s iterate begin/next %6.3f ns, forEachChunk %6.3f ns, forEach %6.3f ns per entity\n",
+		getBackendName(backend),
+		next_ns,
+		chunk_ns,
+		each_ns
+	);
+
+	game::World::destroy(world);
+}
+
+static void runCreation(game::WorldBackend backend, const BenchOptions &options)
+{
+	// what GlbImporter pays for a scene of num_entities nodes, one entity at a time and in one batch
+	double single_ms = 0.0;
+	double batched_ms = 0.0;
+	float single_sum = 0.0f;
+	float batched_sum = 0.0f;
+
+	for (uint32_t pass = 0; pass < options.num_passes; ++pass)
+	{
+		game::World *world = game::World::create(backend);
+
+		Clock::time_point start = Clock::now();
+		populate(world, options.num_entities);
+		double ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+		if (pass == 0 || ms < single_ms)
+			single_ms = ms;
+
+		{
+			game::Query<BenchTransform, BenchRenderable> query(world);
+			single_sum = visitChunks(query);
+		}
+
+		game::World::destroy(world);
+
+		world = game::World::create(backend);
+
+		start = Clock::now();
+		populateBatched(world, options.num_entities);
+		ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+		if (pass == 0 || ms < batched_ms)
+			batched_ms = ms;
+
+		{
+			game::Query<BenchTransform, BenchRenderable> query(world);
+			batched_sum = visitChunks(query);
+		}
+
+		game::World::destroy(world);
+	}
+
+	printf("ecs_bench: %-6s create one by one %8.2f ms, createEntities %8.2f ms\n",
+		getBackendName(backend),
+		single_ms,
+		batched_ms
+	);
+
+	// both paths have to end up with the same component data
+	if (single_sum != batched_sum)
+		fprintf(stderr, "ecs_bench: %s createEntities data mismatch\n", getBackendName(backend));
+}
+
+static LifecycleResult runLifecyclePass(game::WorldBackend backend, const BenchOptions &options)
+{
+	LifecycleResult result;
+
+	game::World *world = game::World::create(backend);
+	std::vector<game::EntityID *> entities(options.num_entities);
+
+	Clock::time_point start = Clock::now();
+
+	for (game::EntityID *&entity : entities)
+		entity = world->createEntity();
+
+	result.create_ns = getNanoseconds(start, options.num_entities);
+
+	BenchTransform transform;
+	BenchRenderable renderable;
+
+	// two archetype moves per entity, same as adding components one by one in game code
+	start = Clock::now();
+
+	for (game::EntityID *entity : entities)
+	{
+		world->addComponent(entity, TypeID<BenchTransform>::value, TypeTraits<BenchTransform>::name, sizeof(BenchTransform), alignof(BenchTransform), &transform);
+		world->addComponent(entity, TypeID<BenchRenderable>::value, TypeTraits<BenchRenderable>::name, sizeof(BenchRenderable), alignof(BenchRenderable), &renderable);
+	}
+
+	result.add_ns = getNanoseconds(start, options.num_entities * 2);
+
+	volatile float sink = 0.0f;
+
+	{
+		start = Clock::now();
+
+		game::Query<BenchTransform, BenchRenderable> query(world);
+		sink = sink + visitChunks(query);
+
+		result.query_ns = getNanoseconds(start, options.num_entities);
+	}
+
+	start = Clock::now();
+
+	for (game::EntityID *entity : entities)
+		world->destroyEntity(entity);
+
+	result.destroy_ns = getNanoseconds(start, options.num_entities);
+
+	game::World::destroy(world);
+
+	return result;
+}
+
+static void runLifecycle(game::WorldBackend backend, const BenchOptions &options)
+{
+	// entity churn, every step is the best of all passes on its own
+	LifecycleResult best;
+
+	for (uint32_t pass = 0; pass < options.num_passes; ++pass)
+	{
+		LifecycleResult result = runLifecyclePass(backend, options);
+
+		if (pass == 0)
+		{
+			best = result;
+			continue;
+		}
+
+		best.create_ns = std::min(best.create_ns, result.create_ns);
+		best.add_ns = std::min(best.add_ns, result.add_ns);
+		best.query_ns = std::min(best.query_ns, result.query_ns);
+		best.destroy_ns = std::min(best.destroy_ns, result.destroy_ns);
+	}
+
+	printf("ecs_bench: %-6s create %8.1f ns, add component %8.1f ns, first query %8.1f ns, destroy %8.1f ns per entity\n",
+		getBackendName(backend),
+		best.create_ns,
+		best.add_ns,
+		best.query_ns,
+		best.destroy_ns
+	);
+}
+
+/*
+ */
+int main(int argc, char **argv)
+{
+	BenchOptions options;
+	if (!parseOptions(argc, argv, options))
+	{
+		printUsage();
+		return EXIT_FAILURE;
+	}
+
+	printf("ecs_bench: %u entities, %u frames\n", options.num_entities, options.num_frames);
+
+	for (game::WorldBackend backend : options.backends)
+	{
+		if (options.runs("query"))
+			runQuerySetup(backend, options);
+
+		if (options.runs("iterate"))
+			runIteration(backend, options);
+
+		if (options.runs("create"))
+			runCreation(backend, options);
+
+		if (options.runs("lifecycle"))
+			runLifecycle(backend, options);
+	}
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,255 @@
+#include <scapes/foundation/Hash.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <random>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace foundation = scapes::foundation;
+
+/*
+ */
+struct BenchOptions
+{
+	uint32_t num_lookups {1000000};
+	uint32_t num_passes {5};
+	uint32_t seed {1};
+};
+
+struct BenchKey
+{
+	std::string group;
+	std::string item;
+
+	foundation::StringID group_id;
+	foundation::StringID item_id;
+};
+
+using Clock = std::chrono::steady_clock;
+
+// group and parameter names from the shipped render graph and materials
+static const char *group_names[] =
+{
+	"Application", "Camera", "Material", "LBuffer", "GBuffer", "SSAO", "SSR", "TAA",
+};
+
+static const char *item_names[] =
+{
+	"View", "IView", "Projection", "IProjection", "ViewOld", "CameraParams", "Time", "FrameIndex",
+	"BaseColor", "Normal", "Shading", "Emission", "Radius", "Intensity", "NumSamples", "FeedbackMin",
+};
+
+/*
+ */
+static void printUsage()
+{
+	printf("Usage: hash_bench [--lookups N] [--passes N] [--seed N]\n");
+}
+
+static bool parseOptions(int argc, char **argv, BenchOptions &options)
+{
+	for (int i = 1; i < argc; ++i)
+	{
+		std::string argument = argv[i];
+
+		if (i + 1 >= argc)
+			return false;
+
+		uint32_t value = static_cast<uint32_t>(strtoul(argv[++i], nullptr, 10));
+
+		if (argument == "--lookups")
+			options.num_lookups = value;
+		else if (argument == "--passes")
+			options.num_passes = value;
+		else if (argument == "--seed")
+			options.seed = value;
+		else
+			return false;
+	}
+
+	return options.num_lookups > 0 && options.num_passes > 0;
+}
+
+/*
+ */
+static uint64_t legacyCombine(uint64_t s, std::string_view v)
+{
+	// HashUtils::combine before wyhash, std::hash with a boost-style mix
+	std::hash<std::string_view> h;
+	s ^= h(v) + 0x9e3779b9 + (s << 6) + (s >> 2);
+
+	return s;
+}
+
+static uint64_t legacyKey(const char *group, const char *item)
+{
+	return legacyCombine(legacyCombine(0, group), item);
+}
+
+static uint64_t runtimeKey(const char *group, const char *item)
+{
+	return foundation::hash::combine(foundation::StringID(group).value, foundation::StringID(item).value);
+}
+
+static uint64_t precomputedKey(foundation::StringID group, foundation::StringID item)
+{
+	return foundation::hash::combine(group.value, item.value);
+}
+
+/*
+ */
+template <typename Func>
+static double measure(const BenchOptions &options, Func &&func)
+{
+	double best_ns = 0.0;
+
+	for (uint32_t pass = 0; pass < options.num_passes; ++pass)
+	{
+		Clock::time_point start = Clock::now();
+		func();
+		double ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / options.num_lookups;
+
+		if (pass == 0 || ns < best_ns)
+			best_ns = ns;
+	}
+
+	return best_ns;
+}
+
+static double measureHash(const BenchOptions &options, size_t length)
+{
+	std::string data(length, 'a');
+	for (size_t i = 0; i < length; ++i)
+		data[i] = static_cast<char>('a' + i % 26);
+
+	volatile uint64_t sink = 0;
+
+	return measure(options, [&]()
+	{
+		uint64_t seed = 0;
+
+		// chained, so every hash waits for the previous one like a real key build does
+		for (uint32_t i = 0; i < options.num_lookups; ++i)
+			seed = foundation::hash::compute(data.data(), data.size(), seed);
+
+		sink = seed;
+	});
+}
+
+static double measureLegacyHash(const BenchOptions &options, size_t length)
+{
+	std::string data(length, 'a');
+	for (size_t i = 0; i < length; ++i)
+		data[i] = static_cast<char>('a' + i % 26);
+
+	volatile uint64_t sink = 0;
+
+	return measure(options, [&]()
+	{
+		uint64_t seed = 0;
+
+		for (uint32_t i = 0; i < options.num_lookups; ++i)
+			seed = legacyCombine(seed, data);
+
+		sink = seed;
+	});
+}
+
+/*
+ */
+int main(int argc, char **argv)
+{
+	BenchOptions options;
+	if (!parseOptions(argc, argv, options))
+	{
+		printUsage();
+		return EXIT_FAILURE;
+	}
+
+	std::vector<BenchKey> keys;
+
+	for (const char *group : group_names)
+	{
+		for (const char *item : item_names)
+		{
+			BenchKey key;
+			key.group = group;
+			key.item = item;
+			key.group_id = foundation::StringID(group);
+			key.item_id = foundation::StringID(item);
+
+			keys.push_back(key);
+		}
+	}
+
+	// GpuBindings keeps one map for all groups, keyed by the group and item names combined
+	std::unordered_map<uint64_t, uint32_t> legacy_lookup;
+	std::unordered_map<uint64_t, uint32_t> lookup;
+
+	for (uint32_t i = 0; i < keys.size(); ++i)
+	{
+		legacy_lookup.insert({legacyKey(keys[i].group.c_str(), keys[i].item.c_str()), i});
+		lookup.insert({precomputedKey(keys[i].group_id, keys[i].item_id), i});
+	}
+
+	if (legacy_lookup.size() != keys.size() || lookup.size() != keys.size())
+	{
+		fprintf(stderr, "hash_bench: key collision\n");
+		return EXIT_FAILURE;
+	}
+
+	std::mt19937 random(options.seed);
+	std::uniform_int_distribution<uint32_t> distribution(0, static_cast<uint32_t>(keys.size()) - 1);
+
+	std::vector<uint32_t> order(options.num_lookups);
+	for (uint32_t &index : order)
+		index = distribution(random);
+
+	volatile uint32_t sink = 0;
+
+	printf("hash_bench: %zu keys, %u lookups, best of %u passes\n", keys.size(), options.num_lookups, options.num_passes);
+
+	double legacy_ns = measure(options, [&]()
+	{
+		uint32_t sum = 0;
+		for (uint32_t index : order)
+			sum += legacy_lookup.find(legacyKey(keys[index].group.c_str(), keys[index].item.c_str()))->second;
+
+		sink = sum;
+	});
+
+	double runtime_ns = measure(options, [&]()
+	{
+		uint32_t sum = 0;
+		for (uint32_t index : order)
+			sum += lookup.find(runtimeKey(keys[index].group.c_str(), keys[index].item.c_str()))->second;
+
+		sink = sum;
+	});
+
+	double precomputed_ns = measure(options, [&]()
+	{
+		uint32_t sum = 0;
+		for (uint32_t index : order)
+			sum += lookup.find(precomputedKey(keys[index].group_id, keys[index].item_id))->second;
+
+		sink = sum;
+	});
+
+	printf("hash_bench: lookup, std::hash + combine  %8.2f ns\n", legacy_ns);
+	printf("hash_bench: lookup, wyhash at runtime    %8.2f ns\n", runtime_ns);
+	printf("hash_bench: lookup, precomputed StringID %8.2f ns\n", precomputed_ns);
+
+	printf("hash_bench: %8s %14s %14s\n", "bytes", "std::hash ns", "wyhash ns");
+
+	for (size_t length : {4, 8, 16, 32, 64, 256})
+		printf("hash_bench: %8zu %14.2f %14.2f\n", length, measureLegacyHash(options, length), measureHash(options, length));
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,248 @@
+#include "AsyncReader.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__)
+	#include <fcntl.h>
+	#include <unistd.h>
+#endif
+
+/*
+ */
+struct BenchOptions
+{
+	std::filesystem::path input {"assets/scenes/pbr_sponza"};
+	std::vector<uint32_t> queue_depths {1, 32};
+	uint32_t chunk_size {256 * 1024};
+	uint32_t num_passes {3};
+	bool cold {true};
+};
+
+struct BenchChunk
+{
+	const std::filesystem::path *path {nullptr};
+	uint64_t offset {0};
+	size_t size {0};
+};
+
+struct BenchContext
+{
+	std::vector<uint8_t *> free_buffers;
+	uint64_t bytes_read {0};
+	uint32_t num_in_flight {0};
+	uint32_t num_failed {0};
+};
+
+using Clock = std::chrono::steady_clock;
+
+/*
+ */
+static void printUsage()
+{
+	printf("Usage: io_bench [directory] [--depth N]... [--chunk KB] [--passes N] [--warm]\n");
+}
+
+static bool parseOptions(int argc, char **argv, BenchOptions &options)
+{
+	std::vector<uint32_t> queue_depths;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		std::string argument = argv[i];
+
+		if (argument == "--warm")
+			options.cold = false;
+		else if (argument == "--depth" && i + 1 < argc)
+			queue_depths.push_back(static_cast<uint32_t>(strtoul(argv[++i], nullptr, 10)));
+		else if (argument == "--chunk" && i + 1 < argc)
+			options.chunk_size = static_cast<uint32_t>(strtoul(argv[++i], nullptr, 10)) * 1024;
+		else if (argument == "--passes" && i + 1 < argc)
+			options.num_passes = static_cast<uint32_t>(strtoul(argv[++i], nullptr, 10));
+		else if (argument.rfind("--", 0) == 0)
+			return false;
+		else
+			options.input = std::filesystem::u8path(argument);
+	}
+
+	if (!queue_depths.empty())
+		options.queue_depths = queue_depths;
+
+	for (uint32_t queue_depth : options.queue_depths)
+		if (queue_depth == 0)
+			return false;
+
+	return options.chunk_size > 0 && options.num_passes > 0;
+}
+
+static void dropCache(const std::vector<std::filesystem::path> &files)
+{
+	// clean pages only, good enough for assets that are never written by the benchmark
+#if defined(__linux__)
+	for (const std::filesystem::path &path : files)
+	{
+		int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+		if (fd == -1)
+			continue;
+
+		posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+		::close(fd);
+	}
+#endif
+}
+
+/*
+ */
+static void onChunkRead(void *data, size_t size, bool success, void *user_data)
+{
+	BenchContext *context = reinterpret_cast<BenchContext *>(user_data);
+
+	context->free_buffers.push_back(reinterpret_cast<uint8_t *>(data));
+	context->bytes_read += size;
+	context->num_in_flight--;
+
+	if (!success)
+		context->num_failed++;
+}
+
+static double runPass(const std::vector<BenchChunk> &chunks, uint32_t queue_depth, uint32_t chunk_size, BenchContext &context, bool &native)
+{
+	AsyncReader reader(queue_depth);
+	native = reader.isNative();
+
+	std::vector<uint8_t> memory(static_cast<size_t>(queue_depth) * chunk_size);
+
+	context = {};
+	for (uint32_t i = 0; i < queue_depth; ++i)
+		context.free_buffers.push_back(memory.data() + static_cast<size_t>(i) * chunk_size);
+
+	Clock::time_point start = Clock::now();
+
+	size_t next_chunk = 0;
+
+	while (next_chunk < chunks.size() || context.num_in_flight > 0)
+	{
+		// keep exactly queue depth reads in flight, the reader may allow more
+		while (next_chunk < chunks.size() && !context.free_buffers.empty())
+		{
+			const BenchChunk &chunk = chunks[next_chunk++];
+
+			uint8_t *buffer = context.free_buffers.back();
+			context.free_buffers.pop_back();
+			context.num_in_flight++;
+
+			if (!reader.submit(*chunk.path, chunk.offset, chunk.size, buffer, &onChunkRead, &context))
+				onChunkRead(buffer, 0, false, &context);
+		}
+
+		if (reader.fetch() == 0)
+			std::this_thread::yield();
+	}
+
+	return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+/*
+ */
+int main(int argc, char **argv)
+{
+	BenchOptions options;
+	if (!parseOptions(argc, argv, options))
+	{
+		printUsage();
+		return EXIT_FAILURE;
+	}
+
+	std::error_code error;
+	if (!std::filesystem::is_directory(options.input, error))
+	{
+		fprintf(stderr, "io_bench: \"%s\" is not a directory\n", options.input.u8string().c_str());
+		return EXIT_FAILURE;
+	}
+
+	std::vector<std::filesystem::path> files;
+	uint64_t total_size = 0;
+
+	for (const std::filesystem::directory_entry &entry : std::filesystem::recursive_directory_iterator(options.input, error))
+	{
+		if (!entry.is_regular_file())
+			continue;
+
+		files.push_back(entry.path());
+		total_size += entry.file_size();
+	}
+
+	std::sort(files.begin(), files.end());
+
+	// same order as a loader walking the scene, every file split into chunk sized reads
+	std::vector<BenchChunk> chunks;
+
+	for (const std::filesystem::path &path : files)
+	{
+		uint64_t size = std::filesystem::file_size(path, error);
+
+		for (uint64_t offset = 0; offset < size; offset += options.chunk_size)
+		{
+			BenchChunk chunk;
+			chunk.path = &path;
+			chunk.offset = offset;
+			chunk.size = static_cast<size_t>(std::min<uint64_t>(options.chunk_size, size - offset));
+
+			chunks.push_back(chunk);
+		}
+	}
+
+	printf("io_bench: %zu files, %.1f MB in %zu reads of %u KB, %s cache\n",
+		files.size(),
+		total_size / (1024.0 * 1024.0),
+		chunks.size(),
+		options.chunk_size / 1024,
+		(options.cold) ? "cold" : "warm"
+	);
+
+	bool success = true;
+
+	for (uint32_t queue_depth : options.queue_depths)
+	{
+		double best_time = 0.0;
+		bool native = false;
+
+		for (uint32_t pass = 0; pass < options.num_passes; ++pass)
+		{
+			if (options.cold)
+				dropCache(files);
+
+			BenchContext context;
+			double time = runPass(chunks, queue_depth, options.chunk_size, context, native);
+
+			if (context.num_failed > 0 || context.bytes_read != total_size)
+			{
+				fprintf(stderr, "io_bench: %u reads failed, %llu of %llu bytes read\n",
+					context.num_failed,
+					static_cast<unsigned long long>(context.bytes_read),
+					static_cast<unsigned long long>(total_size)
+				);
+
+				success = false;
+			}
+
+			if (pass == 0 || time < best_time)
+				best_time = time;
+		}
+
+		printf("io_bench: queue depth %2u: %8.2f ms, %8.1f MB/s (%s)\n",
+			queue_depth,
+			best_time * 1000.0,
+			total_size / (1024.0 * 1024.0) / best_time,
+			(native) ? "io_uring" : "thread pool"
+		);
+	}
+
+	return (success) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
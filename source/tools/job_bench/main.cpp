@@ -0,0 +1,188 @@
+#include <scapes/foundation/jobs/JobSystem.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace jobs = scapes::foundation::jobs;
+
+/*
+ */
+struct BenchOptions
+{
+	std::vector<uint32_t> thread_counts;
+	std::vector<uint32_t> work_amounts {1, 16, 256};
+	uint32_t num_elements {1000000};
+	uint32_t batch_size {0};
+	uint32_t num_passes {5};
+};
+
+struct BenchResult
+{
+	double serial_ms {0.0};
+	double parallel_ms {0.0};
+};
+
+using Clock = std::chrono::steady_clock;
+
+/*
+ */
+static void printUsage()
+{
+	printf("Usage: job_bench [--threads N]... [--work N]... [--elements N] [--batch N] [--passes N]\n");
+}
+
+static bool parseOptions(int argc, char **argv, BenchOptions &options)
+{
+	std::vector<uint32_t> work_amounts;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		std::string argument = argv[i];
+
+		if (i + 1 >= argc)
+			return false;
+
+		uint32_t value = static_cast<uint32_t>(strtoul(argv[++i], nullptr, 10));
+
+		if (argument == "--threads")
+			options.thread_counts.push_back(value);
+		else if (argument == "--work")
+			work_amounts.push_back(value);
+		else if (argument == "--elements")
+			options.num_elements = value;
+		else if (argument == "--batch")
+			options.batch_size = value;
+		else if (argument == "--passes")
+			options.num_passes = value;
+		else
+			return false;
+	}
+
+	if (!work_amounts.empty())
+		options.work_amounts = work_amounts;
+
+	// 2, 4, ... up to every hardware thread, one worker plus the caller is the smallest job system
+	if (options.thread_counts.empty())
+	{
+		uint32_t num_hardware_threads = std::max(2U, std::thread::hardware_concurrency());
+
+		for (uint32_t count = 2; count < num_hardware_threads; count *= 2)
+			options.thread_counts.push_back(count);
+
+		options.thread_counts.push_back(num_hardware_threads);
+	}
+
+	for (uint32_t thread_count : options.thread_counts)
+		if (thread_count < 2)
+			return false;
+
+	return options.num_elements > 0 && options.num_passes > 0;
+}
+
+/*
+ */
+static float processElement(float value, uint32_t work)
+{
+	// dependent math chain, stands in for per-entity work like transform updates
+	for (uint32_t i = 0; i < work; ++i)
+		value = value * 0.999f + std::sqrt(value + 1.0f);
+
+	return value;
+}
+
+template <typename Func>
+static double measure(uint32_t num_passes, Func &&func)
+{
+	double best_ms = 0.0;
+
+	for (uint32_t pass = 0; pass < num_passes; ++pass)
+	{
+		Clock::time_point start = Clock::now();
+		func();
+		double ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+		if (pass == 0 || ms < best_ms)
+			best_ms = ms;
+	}
+
+	return best_ms;
+}
+
+static BenchResult runPass(uint32_t num_threads, uint32_t work, const BenchOptions &options)
+{
+	BenchResult result;
+
+	std::vector<float> values(options.num_elements);
+
+	auto reset = [&values]()
+	{
+		for (size_t i = 0; i < values.size(); ++i)
+			values[i] = static_cast<float>(i % 1024);
+	};
+
+	reset();
+	result.serial_ms = measure(options.num_passes, [&]()
+	{
+		for (uint32_t i = 0; i < options.num_elements; ++i)
+			values[i] = processElement(values[i], work);
+	});
+
+	// the calling thread counts as one of the threads
+	jobs::JobSystem *job_system = jobs::JobSystem::create(num_threads - 1);
+
+	reset();
+	result.parallel_ms = measure(options.num_passes, [&]()
+	{
+		job_system->parallelFor(0, options.num_elements, options.batch_size,
+			[&values, work](uint32_t i)
+			{
+				values[i] = processElement(values[i], work);
+			}
+		);
+	});
+
+	jobs::JobSystem::destroy(job_system);
+
+	return result;
+}
+
+/*
+ */
+int main(int argc, char **argv)
+{
+	BenchOptions options;
+	if (!parseOptions(argc, argv, options))
+	{
+		printUsage();
+		return EXIT_FAILURE;
+	}
+
+	printf("job_bench: %u elements, %u hardware threads, best of %u passes\n", options.num_elements, std::thread::hardware_concurrency(), options.num_passes);
+	printf("job_bench: %6s %8s %12s %12s %10s %10s\n", "work", "threads", "serial ms", "parallel ms", "speedup", "per core");
+
+	for (uint32_t work : options.work_amounts)
+	{
+		for (uint32_t num_threads : options.thread_counts)
+		{
+			BenchResult result = runPass(num_threads, work, options);
+			double speedup = result.serial_ms / std::max(result.parallel_ms, 1e-9);
+
+			printf("job_bench: %6u %8u %12.2f %12.2f %9.2fx %9.0f%%\n",
+				work,
+				num_threads,
+				result.serial_ms,
+				result.parallel_ms,
+				speedup,
+				speedup / num_threads * 100.0
+			);
+		}
+	}
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,252 @@
+#include "IO.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#if defined(__linux__)
+	#include <fcntl.h>
+	#include <unistd.h>
+	#include <sys/resource.h>
+#endif
+
+namespace io = scapes::foundation::io;
+
+/*
+ */
+struct BenchOptions
+{
+	std::filesystem::path input {"assets/scenes/pbr_sponza"};
+	uint32_t num_passes {3};
+	bool copy {false};
+	bool cold {true};
+	bool hold {false};
+};
+
+struct BenchFile
+{
+	std::filesystem::path path;
+	std::string uri;
+	uint64_t size {0};
+};
+
+using Clock = std::chrono::steady_clock;
+
+/*
+ */
+static void printUsage()
+{
+	printf("Usage: map_bench [directory] [--copy] [--passes N] [--warm] [--hold]\n");
+}
+
+static bool parseOptions(int argc, char **argv, BenchOptions &options)
+{
+	for (int i = 1; i < argc; ++i)
+	{
+		std::string argument = argv[i];
+
+		if (argument == "--copy")
+			options.copy = true;
+		else if (argument == "--warm")
+			options.cold = false;
+		else if (argument == "--hold")
+			options.hold = true;
+		else if (argument == "--passes" && i + 1 < argc)
+			options.num_passes = static_cast<uint32_t>(strtoul(argv[++i], nullptr, 10));
+		else if (argument.rfind("--", 0) == 0)
+			return false;
+		else
+			options.input = std::filesystem::u8path(argument);
+	}
+
+	return options.num_passes > 0;
+}
+
+static void dropCache(const std::vector<BenchFile> &files)
+{
+	// clean pages only, good enough for assets that are never written by the benchmark
+#if defined(__linux__)
+	for (const BenchFile &file : files)
+	{
+		int fd = ::open(file.path.c_str(), O_RDONLY | O_CLOEXEC);
+		if (fd == -1)
+			continue;
+
+		posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+		::close(fd);
+	}
+#endif
+}
+
+static double getPeakRSS()
+{
+	// peak resident set of the whole process in megabytes, 0 where it's not available
+#if defined(__linux__)
+	struct rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) == 0)
+		return static_cast<double>(usage.ru_maxrss) / 1024.0;
+#endif
+
+	return 0.0;
+}
+
+/*
+ */
+static void *loadCopy(io::FileSystem *file_system, const io::URI &uri, size_t &size)
+{
+	// same as the fallback path of ApplicationFileSystem::map()
+	size = 0;
+
+	io::Stream *stream = file_system->open(uri, "rb");
+	if (!stream)
+		return nullptr;
+
+	size = static_cast<size_t>(stream->size());
+
+	uint8_t *data = new uint8_t[size];
+	size = stream->read(data, sizeof(uint8_t), size);
+
+	file_system->close(stream);
+	return data;
+}
+
+static uint64_t consume(const void *data, size_t size)
+{
+	// decoders read every byte once, front to back
+	const uint8_t *bytes = reinterpret_cast<const uint8_t *>(data);
+	uint64_t checksum = 0;
+
+	for (size_t i = 0; i < size; ++i)
+		checksum += bytes[i];
+
+	return checksum;
+}
+
+static double runPass(io::FileSystem *file_system, const std::vector<BenchFile> &files, const BenchOptions &options, uint64_t &checksum, uint32_t &num_failed)
+{
+	std::vector<void *> held;
+	held.reserve(files.size());
+
+	Clock::time_point start = Clock::now();
+
+	for (const BenchFile &file : files)
+	{
+		size_t size = 0;
+		void *data = (options.copy) ? loadCopy(file_system, file.uri.c_str(), size) : file_system->map(file.uri.c_str(), size);
+
+		if (!data)
+		{
+			num_failed++;
+			continue;
+		}
+
+		checksum += consume(data, size);
+
+		// a scene keeps its inputs alive until every resource is uploaded
+		if (options.hold)
+		{
+			held.push_back(data);
+			continue;
+		}
+
+		if (options.copy)
+			delete[] reinterpret_cast<uint8_t *>(data);
+		else
+			file_system->unmap(data);
+	}
+
+	double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+	for (void *data : held)
+	{
+		if (options.copy)
+			delete[] reinterpret_cast<uint8_t *>(data);
+		else
+			file_system->unmap(data);
+	}
+
+	return seconds;
+}
+
+/*
+ */
+int main(int argc, char **argv)
+{
+	BenchOptions options;
+	if (!parseOptions(argc, argv, options))
+	{
+		printUsage();
+		return EXIT_FAILURE;
+	}
+
+	std::error_code error;
+	if (!std::filesystem::is_directory(options.input, error))
+	{
+		fprintf(stderr, "map_bench: \"%s\" is not a directory\n", options.input.u8string().c_str());
+		return EXIT_FAILURE;
+	}
+
+	std::vector<BenchFile> files;
+	uint64_t total_size = 0;
+
+	for (const std::filesystem::directory_entry &entry : std::filesystem::recursive_directory_iterator(options.input, error))
+	{
+		if (!entry.is_regular_file())
+			continue;
+
+		BenchFile file;
+		file.path = entry.path();
+		file.uri = std::filesystem::relative(entry.path(), options.input, error).generic_u8string();
+		file.size = entry.file_size();
+
+		total_size += file.size;
+		files.push_back(file);
+	}
+
+	std::sort(files.begin(), files.end(), [](const BenchFile &l, const BenchFile &r) { return l.path < r.path; });
+
+	// peak RSS only ever grows, so copy and map have to be compared across separate runs
+	ApplicationFileSystem file_system(options.input.u8string().c_str());
+
+	printf("map_bench: %zu files, %.1f MB, %s, %s cache%s\n",
+		files.size(),
+		static_cast<double>(total_size) / (1024.0 * 1024.0),
+		(options.copy) ? "copy" : "map",
+		(options.cold) ? "cold" : "warm",
+		(options.hold) ? ", holding all files" : ""
+	);
+
+	double start_rss = getPeakRSS();
+	double best_seconds = 0.0;
+	uint64_t checksum = 0;
+	uint32_t num_failed = 0;
+
+	for (uint32_t pass = 0; pass < options.num_passes; ++pass)
+	{
+		if (options.cold)
+			dropCache(files);
+
+		double seconds = runPass(&file_system, files, options, checksum, num_failed);
+
+		if (pass == 0 || seconds < best_seconds)
+			best_seconds = seconds;
+	}
+
+	double peak_rss = getPeakRSS();
+	double mb = static_cast<double>(total_size) / (1024.0 * 1024.0);
+
+	printf("map_bench: best of %u passes %8.2f ms %8.1f MB/s\n", options.num_passes, best_seconds * 1000.0, mb / std::max(best_seconds, 1e-9));
+	printf("map_bench: peak RSS %.1f MB, %.1f MB above startup\n", peak_rss, peak_rss - start_rss);
+
+	if (num_failed > 0)
+		fprintf(stderr, "map_bench: %u files failed to load\n", num_failed);
+
+	// keeps the reads from being optimized away
+	printf("map_bench: checksum %llu\n", static_cast<unsigned long long>(checksum));
+
+	return (num_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
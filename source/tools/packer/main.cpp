@@ -0,0 +1,378 @@
+#include "PackFormat.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <vector>
+
+/*
+ */
+namespace config
+{
+	// entries that compress worse than this are stored as is, so they can be mapped without copies
+	static constexpr float min_compression_ratio = 0.9f;
+}
+
+struct PackerOptions
+{
+	std::filesystem::path input;
+	std::filesystem::path output;
+	uint32_t alignment {pack::DEFAULT_ALIGNMENT};
+	bool compress {false};
+};
+
+struct PackerEntry
+{
+	std::filesystem::path absolute_path;
+	std::string path;
+	std::vector<uint8_t> data;
+	pack::Entry entry;
+};
+
+/*
+ */
+static void printUsage()
+{
+	printf("Usage: packer <assets_dir> <output.pack> [--compress] [--alignment N]\n");
+}
+
+static bool parseOptions(int argc, char **argv, PackerOptions &options)
+{
+	std::vector<const char *> positional;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		std::string argument = argv[i];
+
+		if (argument == "--compress")
+			options.compress = true;
+		else if (argument == "--alignment" && i + 1 < argc)
+			options.alignment = static_cast<uint32_t>(strtoul(argv[++i], nullptr, 10));
+		else if (argument.rfind("--", 0) == 0)
+			return false;
+		else
+			positional.push_back(argv[i]);
+	}
+
+	if (positional.size() != 2)
+		return false;
+
+	// alignment must be a power of two and keep the index aligned
+	if (options.alignment < alignof(pack::Entry) || (options.alignment & (options.alignment - 1)) != 0)
+	{
+		fprintf(stderr, "packer: alignment must be a power of two not less than %zu\n", alignof(pack::Entry));
+		return false;
+	}
+
+	options.input = std::filesystem::u8path(positional[0]);
+	options.output = std::filesystem::u8path(positional[1]);
+	return true;
+}
+
+static bool readFile(const std::filesystem::path &path, std::vector<uint8_t> &data)
+{
+	FILE *file = fopen(path.u8string().c_str(), "rb");
+	if (!file)
+		return false;
+
+	fseek(file, 0, SEEK_END);
+	long size = ftell(file);
+	fseek(file, 0, SEEK_SET);
+
+	data.resize(static_cast<size_t>(std::max(0L, size)));
+	size_t bytes_read = fread(data.data(), 1, data.size(), file);
+
+	fclose(file);
+	return bytes_read == data.size();
+}
+
+static uint64_t getModificationTime(const std::filesystem::path &path)
+{
+	// must match ApplicationFileSystem::mtime()
+	std::error_code error;
+	std::filesystem::file_time_type time = std::filesystem::last_write_time(path, error);
+	if (error)
+		return 0;
+
+	return static_cast<uint64_t>(time.time_since_epoch().count());
+}
+
+static uint64_t alignOffset(uint64_t offset, uint32_t alignment)
+{
+	return (offset + alignment - 1) & ~static_cast<uint64_t>(alignment - 1);
+}
+
+/*
+ */
+static bool compressEntry(PackerEntry &packer_entry)
+{
+	const std::vector<uint8_t> &data = packer_entry.data;
+	uint32_t num_blocks = pack::getNumBlocks(data.size());
+
+	if (num_blocks == 0)
+		return false;
+
+	size_t max_block_size = pack::lz4::getMaxCompressedSize(pack::BLOCK_SIZE);
+
+	std::vector<std::vector<uint8_t>> blocks(num_blocks);
+	std::vector<uint32_t> block_infos(num_blocks, 0);
+
+	for (uint32_t i = 0; i < num_blocks; ++i)
+	{
+		size_t offset = static_cast<size_t>(i) * pack::BLOCK_SIZE;
+		size_t size = std::min<size_t>(pack::BLOCK_SIZE, data.size() - offset);
+
+		std::vector<uint8_t> &block = blocks[i];
+		block.resize(max_block_size);
+
+		size_t compressed_size = pack::lz4::compress(data.data() + offset, size, block.data(), size);
+
+		// store incompressible blocks as is
+		if (compressed_size == 0 || compressed_size >= size)
+		{
+			block.assign(data.begin() + offset, data.begin() + offset + size);
+			block_infos[i] = static_cast<uint32_t>(size) | pack::RAW_BLOCK_FLAG;
+		}
+		else
+		{
+			block.resize(compressed_size);
+			block_infos[i] = static_cast<uint32_t>(compressed_size);
+		}
+	}
+
+	size_t stored_size = num_blocks * sizeof(uint32_t);
+	for (const std::vector<uint8_t> &block : blocks)
+		stored_size += block.size();
+
+	if (stored_size > static_cast<size_t>(data.size() * config::min_compression_ratio))
+		return false;
+
+	std::vector<uint8_t> result(stored_size);
+	uint8_t *dst = result.data();
+
+	memcpy(dst, block_infos.data(), num_blocks * sizeof(uint32_t));
+	dst += num_blocks * sizeof(uint32_t);
+
+	for (const std::vector<uint8_t> &block : blocks)
+	{
+		memcpy(dst, block.data(), block.size());
+		dst += block.size();
+	}
+
+	packer_entry.data = std::move(result);
+	packer_entry.entry.flags |= pack::ENTRY_FLAG_COMPRESSED;
+	packer_entry.entry.num_blocks = num_blocks;
+
+	return true;
+}
+
+static bool gatherEntries(const PackerOptions &options, std::vector<PackerEntry> &entries)
+{
+	std::error_code error;
+	std::filesystem::path output = std::filesystem::weakly_canonical(options.output, error);
+
+	for (const auto &it : std::filesystem::recursive_directory_iterator(options.input, error))
+	{
+		if (!it.is_regular_file())
+			continue;
+
+		// don't pack the previous pack
+		if (!output.empty() && std::filesystem::equivalent(it.path(), output, error))
+			continue;
+
+		PackerEntry packer_entry;
+		packer_entry.absolute_path = it.path();
+		packer_entry.path = it.path().lexically_relative(options.input).lexically_normal().generic_u8string();
+
+		entries.push_back(std::move(packer_entry));
+	}
+
+	if (error)
+	{
+		fprintf(stderr, "packer: can't traverse \"%s\": %s\n", options.input.u8string().c_str(), error.message().c_str());
+		return false;
+	}
+
+	return true;
+}
+
+static bool processEntries(const PackerOptions &options, std::vector<PackerEntry> &entries)
+{
+	std::atomic<size_t> next_entry {0};
+	std::atomic<bool> result {true};
+
+	auto worker = [&]()
+	{
+		for (size_t i = next_entry++; i < entries.size(); i = next_entry++)
+		{
+			PackerEntry &packer_entry = entries[i];
+			pack::Entry &entry = packer_entry.entry;
+
+			if (!readFile(packer_entry.absolute_path, packer_entry.data))
+			{
+				fprintf(stderr, "packer: can't read \"%s\"\n", packer_entry.absolute_path.u8string().c_str());
+				result = false;
+				continue;
+			}
+
+			entry.path_hash = pack::hashPath(packer_entry.path);
+			entry.size = packer_entry.data.size();
+			entry.mtime = getModificationTime(packer_entry.absolute_path);
+
+			if (options.compress)
+				compressEntry(packer_entry);
+
+			entry.stored_size = packer_entry.data.size();
+		}
+	};
+
+	uint32_t num_threads = std::max(1U, std::thread::hardware_concurrency());
+	std::vector<std::thread> threads;
+
+	for (uint32_t i = 0; i < num_threads; ++i)
+		threads.emplace_back(worker);
+
+	for (std::thread &thread : threads)
+		thread.join();
+
+	return result;
+}
+
+static bool writePack(const PackerOptions &options, std::vector<PackerEntry> &entries)
+{
+	std::sort(entries.begin(), entries.end(),
+		[](const PackerEntry &a, const PackerEntry &b)
+		{
+			if (a.entry.path_hash != b.entry.path_hash)
+				return a.entry.path_hash < b.entry.path_hash;
+
+			return a.path < b.path;
+		}
+	);
+
+	pack::Header header;
+	memcpy(header.magic, pack::MAGIC, sizeof(pack::MAGIC));
+	header.version = pack::VERSION;
+	header.num_entries = static_cast<uint32_t>(entries.size());
+	header.alignment = options.alignment;
+
+	// layout
+	std::string strings;
+	uint64_t offset = sizeof(pack::Header);
+
+	for (PackerEntry &packer_entry : entries)
+	{
+		pack::Entry &entry = packer_entry.entry;
+
+		offset = alignOffset(offset, options.alignment);
+		entry.data_offset = offset;
+		offset += entry.stored_size;
+
+		entry.path_offset = static_cast<uint32_t>(strings.size());
+		entry.path_length = static_cast<uint32_t>(packer_entry.path.size());
+		strings += packer_entry.path;
+	}
+
+	header.index_offset = alignOffset(offset, alignof(pack::Entry));
+	header.strings_offset = header.index_offset + entries.size() * sizeof(pack::Entry);
+	header.strings_size = strings.size();
+
+	// write
+	FILE *file = fopen(options.output.u8string().c_str(), "wb");
+	if (!file)
+	{
+		fprintf(stderr, "packer: can't open \"%s\" for writing\n", options.output.u8string().c_str());
+		return false;
+	}
+
+	std::vector<uint8_t> padding(options.alignment, 0);
+	uint64_t position = 0;
+
+	auto write = [&](const void *data, size_t size)
+	{
+		if (size == 0)
+			return;
+
+		fwrite(data, 1, size, file);
+		position += size;
+	};
+
+	auto pad = [&](uint64_t target)
+	{
+		assert(target >= position);
+		write(padding.data(), static_cast<size_t>(target - position));
+	};
+
+	write(&header, sizeof(pack::Header));
+
+	for (const PackerEntry &packer_entry : entries)
+	{
+		pad(packer_entry.entry.data_offset);
+		write(packer_entry.data.data(), packer_entry.data.size());
+	}
+
+	pad(header.index_offset);
+
+	for (const PackerEntry &packer_entry : entries)
+		write(&packer_entry.entry, sizeof(pack::Entry));
+
+	write(strings.data(), strings.size());
+
+	bool result = (ferror(file) == 0);
+	fclose(file);
+
+	if (!result)
+		fprintf(stderr, "packer: can't write \"%s\"\n", options.output.u8string().c_str());
+
+	return result;
+}
+
+/*
+ */
+int main(int argc, char **argv)
+{
+	PackerOptions options;
+	if (!parseOptions(argc, argv, options))
+	{
+		printUsage();
+		return EXIT_FAILURE;
+	}
+
+	std::vector<PackerEntry> entries;
+
+	if (!gatherEntries(options, entries))
+		return EXIT_FAILURE;
+
+	if (!processEntries(options, entries))
+		return EXIT_FAILURE;
+
+	if (!writePack(options, entries))
+		return EXIT_FAILURE;
+
+	uint64_t total_size = 0;
+	uint64_t total_stored_size = 0;
+	uint32_t num_compressed = 0;
+
+	for (const PackerEntry &packer_entry : entries)
+	{
+		total_size += packer_entry.entry.size;
+		total_stored_size += packer_entry.entry.stored_size;
+
+		if (packer_entry.entry.flags & pack::ENTRY_FLAG_COMPRESSED)
+			num_compressed++;
+	}
+
+	printf("packer: %zu files (%u compressed), %llu -> %llu bytes\n",
+		entries.size(),
+		num_compressed,
+		static_cast<unsigned long long>(total_size),
+		static_cast<unsigned long long>(total_stored_size)
+	);
+
+	return EXIT_SUCCESS;
+}
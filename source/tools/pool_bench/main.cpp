@@ -0,0 +1,166 @@
+#include "resources/impl/ResourcePool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace impl = scapes::foundation::resources::impl;
+
+/*
+ */
+struct BenchOptions
+{
+	std::vector<uint32_t> live_counts {10, 100, 1000, 10000, 100000, 1000000};
+	uint32_t num_operations {200000};
+	uint32_t element_size {64};
+	uint32_t seed {1};
+};
+
+struct BenchResult
+{
+	double fill_ns {0.0};
+	double touch_ns {0.0};
+	double churn_ns {0.0};
+	double drain_ns {0.0};
+	size_t num_pages {0};
+};
+
+using Clock = std::chrono::steady_clock;
+
+static double getNanoseconds(Clock::time_point start, uint64_t count)
+{
+	return std::chrono::duration<double, std::nano>(Clock::now() - start).count() / std::max<uint64_t>(count, 1);
+}
+
+/*
+ */
+static void printUsage()
+{
+	printf("Usage: pool_bench [--live N]... [--operations N] [--element-size BYTES] [--seed N]\n");
+}
+
+static bool parseOptions(int argc, char **argv, BenchOptions &options)
+{
+	std::vector<uint32_t> live_counts;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		std::string argument = argv[i];
+
+		if (i + 1 >= argc)
+			return false;
+
+		uint32_t value = static_cast<uint32_t>(strtoul(argv[++i], nullptr, 10));
+
+		if (argument == "--live")
+			live_counts.push_back(value);
+		else if (argument == "--operations")
+			options.num_operations = value;
+		else if (argument == "--element-size")
+			options.element_size = value;
+		else if (argument == "--seed")
+			options.seed = value;
+		else
+			return false;
+	}
+
+	if (!live_counts.empty())
+		options.live_counts = live_counts;
+
+	for (uint32_t live_count : options.live_counts)
+		if (live_count == 0)
+			return false;
+
+	return options.num_operations > 0 && options.element_size > 0;
+}
+
+/*
+ */
+static BenchResult runPass(uint32_t live_count, const BenchOptions &options)
+{
+	BenchResult result;
+
+	impl::ResourcePool pool(options.element_size);
+	std::mt19937 random(options.seed);
+
+	std::vector<void *> elements(live_count, nullptr);
+
+	Clock::time_point start = Clock::now();
+
+	for (uint32_t i = 0; i < live_count; ++i)
+		elements[i] = pool.allocate();
+
+	result.fill_ns = getNanoseconds(start, live_count);
+
+	// frees hit random pages, so deallocate() can't get away with looking at the last page only
+	std::vector<uint32_t> victims(options.num_operations);
+	std::uniform_int_distribution<uint32_t> distribution(0, live_count - 1);
+
+	for (uint32_t &victim : victims)
+		victim = distribution(random);
+
+	// the same random walk without the pool, cache misses on the elements alone
+	start = Clock::now();
+
+	for (uint32_t victim : victims)
+		reinterpret_cast<volatile uint8_t *>(elements[victim])[0] = 0;
+
+	result.touch_ns = getNanoseconds(start, options.num_operations);
+
+	start = Clock::now();
+
+	for (uint32_t victim : victims)
+	{
+		pool.deallocate(elements[victim]);
+		elements[victim] = pool.allocate();
+	}
+
+	result.churn_ns = getNanoseconds(start, options.num_operations);
+	result.num_pages = pool.getNumPages();
+
+	std::shuffle(elements.begin(), elements.end(), random);
+
+	start = Clock::now();
+
+	for (void *element : elements)
+		pool.deallocate(element);
+
+	result.drain_ns = getNanoseconds(start, live_count);
+
+	return result;
+}
+
+/*
+ */
+int main(int argc, char **argv)
+{
+	BenchOptions options;
+	if (!parseOptions(argc, argv, options))
+	{
+		printUsage();
+		return EXIT_FAILURE;
+	}
+
+	printf("pool_bench: %u byte elements, %u free/allocate pairs per pass\n", options.element_size, options.num_operations);
+	printf("pool_bench: %10s %8s %12s %12s %12s %12s\n", "live", "pages", "allocate ns", "touch ns", "churn ns", "free ns");
+
+	for (uint32_t live_count : options.live_counts)
+	{
+		BenchResult result = runPass(live_count, options);
+
+		printf("pool_bench: %10u %8zu %12.1f %12.1f %12.1f %12.1f\n",
+			live_count,
+			result.num_pages,
+			result.fill_ns,
+			result.touch_ns,
+			result.churn_ns,
+			result.drain_ns
+		);
+	}
+
+	return EXIT_SUCCESS;
+}
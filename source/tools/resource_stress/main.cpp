@@ -0,0 +1,391 @@
+#include <scapes/foundation/resources/ResourceManager.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace foundation = scapes::foundation;
+
+/*
+ */
+struct StressResource
+{
+	uint32_t value {0};
+	uint8_t payload[60] {};
+};
+
+template <>
+struct TypeTraits<StressResource>
+{
+	static constexpr const char *name = "tools::StressResource";
+};
+
+static std::atomic<uint32_t> num_loads {0};
+
+template <>
+struct ResourceTraits<StressResource>
+{
+	static size_t size()
+	{
+		return sizeof(StressResource);
+	}
+
+	static void create(foundation::resources::ResourceManager *, void *memory)
+	{
+		new (memory) StressResource();
+	}
+
+	static void destroy(foundation::resources::ResourceManager *, void *memory)
+	{
+		StressResource *resource = reinterpret_cast<StressResource *>(memory);
+		resource->~StressResource();
+	}
+
+	static foundation::resources::hash_t fetchHash(
+		foundation::resources::ResourceManager *,
+		foundation::io::FileSystem *file_system,
+		void *,
+		const foundation::io::URI &uri
+	)
+	{
+		return file_system->mtime(uri);
+	}
+
+	static bool reload(
+		foundation::resources::ResourceManager *,
+		foundation::io::FileSystem *,
+		void *,
+		const foundation::io::URI &
+	)
+	{
+		return true;
+	}
+
+	static bool loadFromMemory(
+		foundation::resources::ResourceManager *,
+		void *memory,
+		const uint8_t *data,
+		size_t
+	)
+	{
+		StressResource *resource = reinterpret_cast<StressResource *>(memory);
+		resource->value = data[0];
+
+		// pretend to decode, so concurrent fetches of the same uri actually overlap
+		std::this_thread::sleep_for(std::chrono::microseconds(200));
+
+		num_loads++;
+		return true;
+	}
+};
+
+/*
+ */
+class MemoryFileSystem : public foundation::io::FileSystem
+{
+public:
+	MemoryFileSystem()
+	{
+		for (size_t i = 0; i < sizeof(data); ++i)
+			data[i] = static_cast<uint8_t>(i);
+	}
+
+	foundation::io::Stream *open(const foundation::io::URI &, const char *) final { return nullptr; }
+	bool close(foundation::io::Stream *) final { return false; }
+
+	void *map(const foundation::io::URI &, size_t &size) final
+	{
+		size = sizeof(data);
+		return data;
+	}
+
+	bool unmap(void *memory) final { return memory == data; }
+	uint64_t mtime(const foundation::io::URI &) final { return 1; }
+
+	bool watch(const foundation::io::URI &) final { return false; }
+	bool unwatch(const foundation::io::URI &) final { return false; }
+	void fetchChanges(foundation::io::FileChangeCallback, void *) final { }
+
+	bool readAsync(const foundation::io::URI &, uint64_t, size_t, void *, foundation::io::ReadCallback, void *) final { return false; }
+	uint32_t fetchReads() final { return 0; }
+	void waitReads() final { }
+
+private:
+	uint8_t data[64];
+};
+
+/*
+ */
+struct StressOptions
+{
+	uint32_t num_threads {4};
+	uint32_t num_iterations {100000};
+	uint32_t num_uris {64};
+};
+
+using Clock = std::chrono::steady_clock;
+
+static double getSeconds(Clock::time_point start)
+{
+	return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+static void printUsage()
+{
+	printf("Usage: resource_stress [--threads N] [--iterations N] [--uris N]\n");
+}
+
+static bool parseOptions(int argc, char **argv, StressOptions &options)
+{
+	for (int i = 1; i < argc; ++i)
+	{
+		std::string argument = argv[i];
+
+		if (i + 1 >= argc)
+			return false;
+
+		uint32_t value = static_cast<uint32_t>(strtoul(argv[++i], nullptr, 10));
+		if (value == 0)
+			return false;
+
+		if (argument == "--threads")
+			options.num_threads = value;
+		else if (argument == "--iterations")
+			options.num_iterations = value;
+		else if (argument == "--uris")
+			options.num_uris = value;
+		else
+			return false;
+	}
+
+	return true;
+}
+
+/*
+ */
+static void runWorkload(foundation::resources::ResourceManager *resource_manager, const std::vector<foundation::io::URI> &uris, uint32_t seed, uint32_t num_iterations)
+{
+	// every iteration is one create/destroy pair and one fetch/release pair
+	for (uint32_t i = 0; i < num_iterations; ++i)
+	{
+		foundation::resources::ResourceHandle<StressResource> resource = resource_manager->create<StressResource>();
+		resource.get()->value = i;
+		resource_manager->destroy(resource);
+
+		const foundation::io::URI &uri = uris[(seed + i) % uris.size()];
+
+		foundation::resources::ResourceHandle<StressResource> cached = resource_manager->fetch<StressResource>(uri);
+		assert(cached.isReady());
+		resource_manager->release(cached);
+	}
+}
+
+static double runSingleThreaded(foundation::resources::ResourceManager *resource_manager, const std::vector<foundation::io::URI> &uris, const StressOptions &options)
+{
+	Clock::time_point start = Clock::now();
+
+	runWorkload(resource_manager, uris, 0, options.num_iterations);
+	resource_manager->update(0.0f);
+
+	return options.num_iterations * 2 / getSeconds(start);
+}
+
+static double runMultiThreaded(foundation::resources::ResourceManager *resource_manager, const std::vector<foundation::io::URI> &uris, const StressOptions &options)
+{
+	std::atomic<uint32_t> num_finished {0};
+	std::vector<std::thread> workers;
+
+	Clock::time_point start = Clock::now();
+
+	for (uint32_t i = 0; i < options.num_threads; ++i)
+		workers.emplace_back(
+			[&, i]()
+			{
+				runWorkload(resource_manager, uris, i * 7, options.num_iterations);
+				num_finished++;
+			}
+		);
+
+	// destruction from workers is deferred, so keep updating like the main loop would
+	while (num_finished.load() < options.num_threads)
+	{
+		resource_manager->update(0.0f);
+		std::this_thread::yield();
+	}
+
+	for (std::thread &worker : workers)
+		worker.join();
+
+	resource_manager->update(0.0f);
+
+	return static_cast<double>(options.num_iterations) * 2 * options.num_threads / getSeconds(start);
+}
+
+static bool runFetchRace(foundation::resources::ResourceManager *resource_manager, const StressOptions &options)
+{
+	// every thread fetches the same uri at once, it must be loaded exactly once
+	constexpr uint32_t num_rounds = 64;
+
+	bool success = true;
+
+	for (uint32_t round = 0; round < num_rounds; ++round)
+	{
+		std::string path = "race/" + std::to_string(round);
+		foundation::io::URI uri(path.c_str());
+
+		std::atomic<uint32_t> num_ready {0};
+		std::vector<void *> results(options.num_threads, nullptr);
+		std::vector<std::thread> workers;
+
+		uint32_t loads_before = num_loads.load();
+
+		for (uint32_t i = 0; i < options.num_threads; ++i)
+			workers.emplace_back(
+				[&, i]()
+				{
+					num_ready++;
+					while (num_ready.load() < options.num_threads)
+						std::this_thread::yield();
+
+					foundation::resources::ResourceHandle<StressResource> resource = resource_manager->fetch<StressResource>(uri);
+					results[i] = resource.getRaw();
+				}
+			);
+
+		for (std::thread &worker : workers)
+			worker.join();
+
+		uint32_t round_loads = num_loads.load() - loads_before;
+
+		for (void *result : results)
+			success = success && (result == results[0]);
+
+		if (round_loads != 1 || !success)
+		{
+			printf("resource_stress: \"%s\" was loaded %u times by %u threads\n", uri.c_str(), round_loads, options.num_threads);
+			return false;
+		}
+
+		foundation::resources::ResourceHandle<StressResource> resource = resource_manager->fetch<StressResource>(uri);
+		for (uint32_t i = 0; i <= options.num_threads; ++i)
+			resource_manager->release(resource);
+	}
+
+	return success;
+}
+
+static bool runCompaction(foundation::resources::ResourceManager *resource_manager)
+{
+	// leave holes all over the pool, then check IDs survive compaction and stale handles don't
+	constexpr uint32_t num_resources = 4096;
+
+	std::vector<foundation::resources::ResourceHandle<StressResource>> resources(num_resources);
+	std::vector<foundation::resources::ResourceID<StressResource>> ids(num_resources);
+
+	for (uint32_t i = 0; i < num_resources; ++i)
+	{
+		resources[i] = resource_manager->create<StressResource>();
+		resources[i].get()->value = i;
+		ids[i] = resource_manager->getID(resources[i]);
+	}
+
+	for (uint32_t i = 0; i < num_resources / 2; ++i)
+		resource_manager->destroy(resources[i * 2]);
+
+	size_t num_moved = resource_manager->compact<StressResource>();
+
+	uint32_t num_stale = 0;
+
+	for (uint32_t i = 0; i < num_resources / 2; ++i)
+	{
+		uint32_t index = i * 2 + 1;
+
+		StressResource *resource = resource_manager->get(ids[index]);
+		if (!resource || resource->value != index)
+		{
+			printf("resource_stress: ID %u doesn't resolve after compaction\n", index);
+			return false;
+		}
+
+		if (!resources[index].isValid())
+		{
+			num_stale++;
+			continue;
+		}
+
+		if (resources[index].get() != resource)
+		{
+			printf("resource_stress: stale handle %u still resolves after compaction\n", index);
+			return false;
+		}
+	}
+
+	if (num_stale != num_moved)
+	{
+		printf("resource_stress: %u stale handles for %zu moved resources\n", num_stale, num_moved);
+		return false;
+	}
+
+	for (uint32_t i = 0; i < num_resources / 2; ++i)
+		resource_manager->destroy(resource_manager->getHandle(ids[i * 2 + 1]));
+
+	// retired pages are released here
+	for (uint32_t i = 0; i < 32; ++i)
+		resource_manager->update(0.0f);
+
+	printf("resource_stress: compaction moved %zu of %u resources\n", num_moved, num_resources / 2);
+
+	return true;
+}
+
+/*
+ */
+int main(int argc, char **argv)
+{
+	StressOptions options;
+	options.num_threads = std::max<uint32_t>(2, std::thread::hardware_concurrency());
+
+	if (!parseOptions(argc, argv, options))
+	{
+		printUsage();
+		return EXIT_FAILURE;
+	}
+
+	MemoryFileSystem file_system;
+	foundation::resources::ResourceManager *resource_manager = foundation::resources::ResourceManager::create(&file_system);
+
+	std::vector<foundation::io::URI> uris;
+	uris.reserve(options.num_uris);
+
+	for (uint32_t i = 0; i < options.num_uris; ++i)
+	{
+		std::string path = "stress/" + std::to_string(i);
+		uris.emplace_back(path.c_str());
+
+		// warm the cache, so fetches measure lookups rather than loads
+		resource_manager->release(resource_manager->fetch<StressResource>(uris.back()));
+	}
+
+	bool success = runFetchRace(resource_manager, options);
+	success = runCompaction(resource_manager) && success;
+
+	double single_threaded = runSingleThreaded(resource_manager, uris, options);
+	double multi_threaded = runMultiThreaded(resource_manager, uris, options);
+
+	printf("resource_stress: owner thread %.0f ops/s, %u worker threads %.0f ops/s (%.2fx)\n",
+		single_threaded,
+		options.num_threads,
+		multi_threaded,
+		multi_threaded / single_threaded
+	);
+
+	foundation::resources::ResourceManager::destroy(resource_manager);
+
+	return (success) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,307 @@
+#include <scapes/foundation/game/World.h>
+#include <scapes/foundation/game/Query.h>
+#include <scapes/foundation/jobs/JobSystem.h>
+
+#include <scapes/visual/TransformSystem.h>
+#include <scapes/visual/components/Components.h>
+
+#include <algorithm>
+#include <cmath>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace foundation = scapes::foundation;
+namespace game = scapes::foundation::game;
+namespace jobs = scapes::foundation::jobs;
+namespace visual = scapes::visual;
+namespace components = scapes::visual::components;
+
+/*
+ */
+struct BenchOptions
+{
+	game::WorldBackend backend {game::WorldBackend::FLECS};
+	uint32_t num_nodes {100000};
+	uint32_t num_roots {1000};
+	uint32_t num_levels {3};
+	uint32_t animated_percent {1};
+	uint32_t num_threads {0};
+	uint32_t num_frames {100};
+};
+
+using Clock = std::chrono::steady_clock;
+
+static double getMilliseconds(Clock::time_point start, uint32_t count)
+{
+	return std::chrono::duration<double, std::milli>(Clock::now() - start).count() / std::max<uint32_t>(count, 1);
+}
+
+/*
+ */
+static void printUsage()
+{
+	printf("Usage: transform_bench [--backend flecs|native] [--nodes N] [--roots N] [--levels N] [--animated PERCENT] [--threads N] [--frames N]\n");
+}
+
+static bool parseOptions(int argc, char **argv, BenchOptions &options)
+{
+	for (int i = 1; i < argc; ++i)
+	{
+		std::string argument = argv[i];
+
+		if (i + 1 >= argc)
+			return false;
+
+		std::string value = argv[++i];
+		uint32_t number = static_cast<uint32_t>(strtoul(value.c_str(), nullptr, 10));
+
+		if (argument == "--backend" && value == "flecs")
+			options.backend = game::WorldBackend::FLECS;
+		else if (argument == "--backend" && value == "native")
+			options.backend = game::WorldBackend::NATIVE;
+		else if (argument == "--nodes")
+			options.num_nodes = number;
+		else if (argument == "--roots")
+			options.num_roots = number;
+		else if (argument == "--levels")
+			options.num_levels = number;
+		else if (argument == "--animated")
+			options.animated_percent = number;
+		else if (argument == "--threads")
+			options.num_threads = number;
+		else if (argument == "--frames")
+			options.num_frames = number;
+		else
+			return false;
+	}
+
+	// one worker plus the caller is the smallest job system
+	if (options.num_threads == 0)
+		options.num_threads = std::max(2U, std::thread::hardware_concurrency());
+
+	return options.num_roots > 0
+		&& options.num_nodes >= options.num_roots
+		&& options.num_levels > 0
+		&& options.animated_percent <= 100
+		&& options.num_threads >= 2
+		&& options.num_frames > 0;
+}
+
+/*
+ */
+static void populate(game::World *world, const BenchOptions &options, std::vector<game::EntityID *> &roots, std::vector<game::EntityID *> &leaves)
+{
+	// roots first, the remaining nodes are spread evenly over the deeper levels,
+	// every node is parented to a node of the level above, like an imported scene
+	std::vector<game::EntityID *> parent_level(options.num_roots);
+	std::vector<game::EntityID *> level;
+
+	std::vector<components::LocalTransform> locals(options.num_roots);
+	std::vector<components::Transform> transforms(options.num_roots);
+	std::vector<components::Parent> parents;
+
+	for (uint32_t i = 0; i < options.num_roots; ++i)
+		locals[i].transform = foundation::math::translate(foundation::math::mat4(1.0f), foundation::math::vec3(static_cast<float>(i), 0.0f, 0.0f));
+
+	world->createEntities(options.num_roots, parent_level.data(), locals.data(), transforms.data());
+	roots = parent_level;
+
+	uint32_t num_children = options.num_nodes - options.num_roots;
+	uint32_t num_child_levels = options.num_levels - 1;
+
+	for (uint32_t depth = 0; depth < num_child_levels; ++depth)
+	{
+		uint32_t count = num_children / num_child_levels + ((depth < num_children % num_child_levels) ? 1 : 0);
+		if (count == 0)
+			break;
+
+		level.resize(count);
+		locals.resize(count);
+		transforms.resize(count);
+		parents.resize(count);
+
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			locals[i].transform = foundation::math::translate(foundation::math::mat4(1.0f), foundation::math::vec3(0.0f, 1.0f, 0.0f));
+			parents[i].entity = parent_level[i % parent_level.size()];
+		}
+
+		world->createEntities(count, level.data(), locals.data(), transforms.data(), parents.data());
+		std::swap(parent_level, level);
+	}
+
+	leaves = parent_level;
+}
+
+static std::vector<components::LocalTransform *> pickAnimated(game::World *world, uint32_t percent)
+{
+	// every n-th node in table order, so roots and children are both animated
+	std::vector<components::LocalTransform *> result;
+	if (percent == 0)
+		return result;
+
+	uint32_t stride = 100 / percent;
+	uint32_t index = 0;
+
+	game::Query<components::LocalTransform> query(world);
+	query.forEach([&](components::LocalTransform &local)
+	{
+		if (index++ % stride == 0)
+			result.push_back(&local);
+	});
+
+	return result;
+}
+
+/*
+ */
+int main(int argc, char **argv)
+{
+	BenchOptions options;
+	if (!parseOptions(argc, argv, options))
+	{
+		printUsage();
+		return EXIT_FAILURE;
+	}
+
+	game::World *world = game::World::create(options.backend);
+	jobs::JobSystem *job_system = jobs::JobSystem::create(options.num_threads - 1);
+
+	Clock::time_point start = Clock::now();
+	std::vector<game::EntityID *> roots;
+	std::vector<game::EntityID *> leaves;
+	populate(world, options, roots, leaves);
+	double populate_ms = getMilliseconds(start, 1);
+
+	visual::TransformSystem *transform_system = visual::TransformSystem::create(world, job_system);
+
+	printf("transform_bench: %u nodes, %u roots, %u levels, %u threads, %s world\n",
+		options.num_nodes,
+		options.num_roots,
+		options.num_levels,
+		job_system->getNumThreads(),
+		(options.backend == game::WorldBackend::FLECS) ? "flecs" : "native"
+	);
+
+	printf("transform_bench: create %8.3f ms\n", populate_ms);
+
+	// the first update flattens the hierarchy and computes every node
+	start = Clock::now();
+	transform_system->update();
+	printf("transform_bench: first update %8.3f ms\n", getMilliseconds(start, 1));
+
+	// component pointers stay valid from here on, nothing changes the world structure anymore
+	std::vector<components::LocalTransform *> animated = pickAnimated(world, options.animated_percent);
+
+	start = Clock::now();
+
+	for (uint32_t frame = 0; frame < options.num_frames; ++frame)
+		transform_system->update();
+
+	printf("transform_bench: static frame %8.3f ms\n", getMilliseconds(start, options.num_frames));
+
+	start = Clock::now();
+
+	for (uint32_t frame = 0; frame < options.num_frames; ++frame)
+	{
+		for (components::LocalTransform *local : animated)
+		{
+			local->transform[3][2] = static_cast<float>(frame);
+			local->dirty = true;
+		}
+
+		transform_system->update();
+	}
+
+	printf("transform_bench: %u%% animated (%zu nodes) %8.3f ms\n", options.animated_percent, animated.size(), getMilliseconds(start, options.num_frames));
+
+	std::vector<components::LocalTransform *> everything = pickAnimated(world, 100);
+
+	start = Clock::now();
+
+	for (uint32_t frame = 0; frame < options.num_frames; ++frame)
+	{
+		for (components::LocalTransform *local : everything)
+			local->dirty = true;
+
+		transform_system->update();
+	}
+
+	printf("transform_bench: all dirty %8.3f ms\n", getMilliseconds(start, options.num_frames));
+
+	// one leaf moves under another root every frame, written in place and reported as a change
+	components::Parent *mover_parent = nullptr;
+	components::Transform *mover_transform = nullptr;
+	const components::LocalTransform *mover_local = nullptr;
+	bool succeeded = true;
+
+	{
+		game::Query<components::LocalTransform, components::Transform, components::Parent> query(world);
+
+		query.begin();
+
+		while (query.next() && !mover_parent)
+		{
+			uint32_t count = query.getNumComponents();
+			game::EntityID *const *entities = query.getEntities();
+
+			for (uint32_t i = 0; i < count; ++i)
+			{
+				if (entities[i] != leaves.front())
+					continue;
+
+				mover_local = &query.getComponents<components::LocalTransform>(0)[i];
+				mover_transform = &query.getComponents<components::Transform>(1)[i];
+				mover_parent = &query.getComponents<components::Parent>(2)[i];
+				break;
+			}
+		}
+	}
+
+	if (!mover_parent || roots.size() < 2)
+	{
+		fprintf(stderr, "transform_bench: the scene is too small to reparent\n");
+	}
+	else
+	{
+		start = Clock::now();
+
+		for (uint32_t frame = 0; frame < options.num_frames; ++frame)
+		{
+			mover_parent->entity = roots[frame % roots.size()];
+			world->markChanged<components::Parent>(leaves.front());
+
+			transform_system->update();
+		}
+
+		printf("transform_bench: reparent one node %8.3f ms\n", getMilliseconds(start, options.num_frames));
+
+		const components::Transform &root_transform = *reinterpret_cast<const components::Transform *>(world->getComponent(
+			mover_parent->entity,
+			TypeID<components::Transform>::value,
+			TypeTraits<components::Transform>::name,
+			sizeof(components::Transform),
+			alignof(components::Transform)
+		));
+
+		foundation::math::mat4 expected = root_transform.transform * mover_local->transform;
+		foundation::math::vec4 delta = expected[3] - mover_transform->transform[3];
+
+		if (std::abs(delta.x) + std::abs(delta.y) + std::abs(delta.z) > 1e-4f)
+		{
+			fprintf(stderr, "transform_bench: reparented node doesn't follow its new parent\n");
+			succeeded = false;
+		}
+	}
+
+	visual::TransformSystem::destroy(transform_system);
+
+	jobs::JobSystem::destroy(job_system);
+	game::World::destroy(world);
+
+	return (succeeded) ? EXIT_SUCCESS : EXIT_FAILURE;
+}